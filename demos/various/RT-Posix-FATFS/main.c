@@ -0,0 +1,264 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "simblk.h"
+#include "ff.h"
+
+/*
+ * Disk image, it is formatted on the first run.
+ */
+#define DISK_IMAGE              "build/disk.img"
+
+/*
+ * Benchmark parameters.
+ */
+#define SEQ_FILE_SIZE           (4U * 1024U * 1024U)
+#define SEQ_CHUNK_SIZE          (32U * 1024U)
+#define RND_FILE_SIZE           (1U * 1024U * 1024U)
+#define RND_CHUNK_SIZE          4096U
+#define RND_OPS                 256U
+#define QD_THREADS              8U
+#define QD_OPS                  128U
+
+/*
+ * 64MB device, latencies and transfer rate of a typical SD card.
+ */
+static const SimBlockConfig blkcfg = {
+  .path             = DISK_IMAGE,
+  .blk_size         = 512U,
+  .blk_num          = 131072U,
+  .read_latency     = 100U,
+  .write_latency    = 250U,
+  .transfer_time    = 10U,
+  .queue_depth      = 4U
+};
+
+static FATFS fs;
+static FIL file;
+static uint8_t buffer[SEQ_CHUNK_SIZE];
+static THD_WORKING_AREA(waQD[QD_THREADS], 1024);
+
+static uint32_t rnd_next(uint32_t *seedp) {
+
+  *seedp = (*seedp * 1103515245U) + 12345U;
+  return *seedp >> 8;
+}
+
+static unsigned kbps(uint32_t bytes, sysinterval_t elapsed) {
+
+  return (unsigned)(((uint64_t)bytes * 1000000U) /
+                    (TIME_I2US(elapsed) * 1024U + 1U));
+}
+
+static void check(FRESULT res, const char *what) {
+
+  if (res != FR_OK) {
+    printf("*** %s failed, error %d\n", what, (int)res);
+    exit(1);
+  }
+}
+
+static void mount(void) {
+  FRESULT res;
+
+  res = f_mount(&fs, "", 1);
+  if (res == FR_NO_FILESYSTEM) {
+    printf("--- Formatting %s\n", DISK_IMAGE);
+    check(f_mkfs("", FM_ANY, 0, buffer, sizeof buffer), "f_mkfs");
+    res = f_mount(&fs, "", 1);
+  }
+  check(res, "f_mount");
+}
+
+/*
+ * Sequential write then read of a file using large chunks.
+ */
+static void sequential(void) {
+  systime_t start;
+  UINT n;
+  uint32_t i;
+
+  printf("*** Sequential I/O, %u kB file, %u kB chunks\n",
+         SEQ_FILE_SIZE / 1024U, SEQ_CHUNK_SIZE / 1024U);
+
+  memset(buffer, 0x55, sizeof buffer);
+  check(f_open(&file, "seq.bin", FA_CREATE_ALWAYS | FA_WRITE), "f_open");
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < SEQ_FILE_SIZE; i += SEQ_CHUNK_SIZE) {
+    check(f_write(&file, buffer, SEQ_CHUNK_SIZE, &n), "f_write");
+  }
+  check(f_close(&file), "f_close");
+  printf("--- Write: %u kB/s\n",
+         kbps(SEQ_FILE_SIZE, chVTTimeElapsedSinceX(start)));
+
+  check(f_open(&file, "seq.bin", FA_READ), "f_open");
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < SEQ_FILE_SIZE; i += SEQ_CHUNK_SIZE) {
+    check(f_read(&file, buffer, SEQ_CHUNK_SIZE, &n), "f_read");
+  }
+  check(f_close(&file), "f_close");
+  printf("--- Read:  %u kB/s\n",
+         kbps(SEQ_FILE_SIZE, chVTTimeElapsedSinceX(start)));
+}
+
+/*
+ * Random accesses to a file, aligned to the chunk size.
+ */
+static void random_access(void) {
+  uint32_t seed = 1U;
+  sysinterval_t elapsed;
+  systime_t start;
+  UINT n;
+  uint32_t i;
+
+  printf("*** Random I/O, %u kB file, %u bytes chunks, %u operations\n",
+         RND_FILE_SIZE / 1024U, RND_CHUNK_SIZE, RND_OPS);
+
+  memset(buffer, 0xAA, sizeof buffer);
+  check(f_open(&file, "rnd.bin", FA_CREATE_ALWAYS | FA_WRITE | FA_READ),
+        "f_open");
+  for (i = 0U; i < RND_FILE_SIZE; i += SEQ_CHUNK_SIZE) {
+    check(f_write(&file, buffer, SEQ_CHUNK_SIZE, &n), "f_write");
+  }
+  check(f_sync(&file), "f_sync");
+
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < RND_OPS; i++) {
+    FSIZE_t pos = (rnd_next(&seed) % (RND_FILE_SIZE / RND_CHUNK_SIZE)) *
+                  RND_CHUNK_SIZE;
+
+    check(f_lseek(&file, pos), "f_lseek");
+    check(f_read(&file, buffer, RND_CHUNK_SIZE, &n), "f_read");
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+  printf("--- Read:  %u IOPS\n",
+         (unsigned)((RND_OPS * 1000000U) / (TIME_I2US(elapsed) + 1U)));
+
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < RND_OPS; i++) {
+    FSIZE_t pos = (rnd_next(&seed) % (RND_FILE_SIZE / RND_CHUNK_SIZE)) *
+                  RND_CHUNK_SIZE;
+
+    check(f_lseek(&file, pos), "f_lseek");
+    check(f_write(&file, buffer, RND_CHUNK_SIZE, &n), "f_write");
+  }
+  check(f_sync(&file), "f_sync");
+  elapsed = chVTTimeElapsedSinceX(start);
+  printf("--- Write: %u IOPS\n",
+         (unsigned)((RND_OPS * 1000000U) / (TIME_I2US(elapsed) + 1U)));
+
+  check(f_close(&file), "f_close");
+}
+
+/*
+ * Raw random reads issued by concurrent threads, FatFS serializes the
+ * accesses to a volume so the device is accessed directly.
+ */
+static THD_FUNCTION(qd_thread, arg) {
+  uint32_t seed = (uint32_t)(uintptr_t)arg;
+  uint8_t data[RND_CHUNK_SIZE];
+  uint32_t i;
+
+  for (i = 0U; i < QD_OPS; i++) {
+    uint32_t lba = (rnd_next(&seed) % (blkcfg.blk_num / 8U)) * 8U;
+
+    if (blkRead(&SIMBLKD1, lba, data, 8U) != HAL_SUCCESS) {
+      printf("*** blkRead failed\n");
+      exit(1);
+    }
+  }
+}
+
+static void queue_depth(void) {
+  unsigned threads;
+
+  printf("*** Raw random reads, %u bytes, device queue depth %u\n",
+         RND_CHUNK_SIZE, (unsigned)blkcfg.queue_depth);
+
+  for (threads = 1U; threads <= QD_THREADS; threads *= 2U) {
+    thread_t *tps[QD_THREADS];
+    sysinterval_t elapsed;
+    systime_t start;
+    unsigned i;
+
+    simblkResetStatistics(&SIMBLKD1);
+    start = chVTGetSystemTimeX();
+    for (i = 0U; i < threads; i++) {
+      tps[i] = chThdCreateStatic(waQD[i], sizeof waQD[i], NORMALPRIO + 1,
+                                 qd_thread, (void *)(uintptr_t)(i + 1U));
+    }
+    for (i = 0U; i < threads; i++) {
+      chThdWait(tps[i]);
+    }
+    elapsed = chVTTimeElapsedSinceX(start);
+    printf("--- %u threads: %u IOPS, max %u commands in progress\n",
+           threads,
+           (unsigned)((threads * QD_OPS * 1000000U) /
+                      (TIME_I2US(elapsed) + 1U)),
+           (unsigned)simblkGetStatistics(&SIMBLKD1)->max_inflight);
+  }
+}
+
+/*
+ * Simulator main.
+ */
+int main(int argc, char *argv[]) {
+  const simblk_stats_t *stats = simblkGetStatistics(&SIMBLKD1);
+
+  (void)argc;
+  (void)argv;
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /*
+   * Activates the simulated block device.
+   */
+  simblkObjectInit(&SIMBLKD1);
+  simblkStart(&SIMBLKD1, &blkcfg);
+  (void)blkConnect(&SIMBLKD1);
+
+  mount();
+  simblkResetStatistics(&SIMBLKD1);
+  sequential();
+  random_access();
+  printf("--- Device: %u reads (%llu blocks), %u writes (%llu blocks), "
+         "%u syncs\n",
+         (unsigned)stats->read_cmds, (unsigned long long)stats->read_blocks,
+         (unsigned)stats->write_cmds, (unsigned long long)stats->write_blocks,
+         (unsigned)stats->sync_cmds);
+  check(f_unmount(""), "f_unmount");
+
+  queue_depth();
+
+  (void)blkDisconnect(&SIMBLKD1);
+  simblkStop(&SIMBLKD1);
+
+  exit(0);
+}
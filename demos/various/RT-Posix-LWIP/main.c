@@ -0,0 +1,94 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "lwipthread.h"
+#include "lwip/api.h"
+#include "lwip/tcpip.h"
+#include "lwip/apps/httpd.h"
+#include "lwip/apps/lwiperf.h"
+
+#define UDP_ECHO_PORT       7
+
+/*
+ * UDP echo server thread, used for round-trip latency measurements.
+ */
+static THD_WORKING_AREA(wa_udp_echo, 1024);
+static THD_FUNCTION(udp_echo, arg) {
+  struct netconn *conn;
+  struct netbuf *buf;
+
+  (void)arg;
+  chRegSetThreadName("udp_echo");
+
+  conn = netconn_new(NETCONN_UDP);
+  osalDbgAssert(conn != NULL, "no connection");
+  netconn_bind(conn, IP_ADDR_ANY, UDP_ECHO_PORT);
+
+  while (netconn_recv(conn, &buf) == ERR_OK) {
+    (void)netconn_sendto(conn, buf, netbuf_fromaddr(buf),
+                         netbuf_fromport(buf));
+    netbuf_delete(buf);
+  }
+}
+
+/*------------------------------------------------------------------------*
+ * Simulator main.                                                        *
+ *------------------------------------------------------------------------*/
+int main(void) {
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /*
+   * TCP/IP stack initialization, the simulated MAC waits for a peer process
+   * on its socket.
+   */
+  lwipInit(NULL);
+
+  /*
+   * HTTP server on port 80 and iperf2 compatible server on port 5001, raw
+   * API services must be started from within the stack core lock.
+   */
+  LOCK_TCPIP_CORE();
+  httpd_init();
+  (void)lwiperf_start_tcp_server_default(NULL, NULL);
+  UNLOCK_TCPIP_CORE();
+
+  /*
+   * UDP echo server.
+   */
+  chThdCreateStatic(wa_udp_echo, sizeof(wa_udp_echo), NORMALPRIO,
+                    udp_echo, NULL);
+
+  /*
+   * Normal main() thread activity, nothing to do in this demo.
+   */
+  while (!chThdShouldTerminateX()) {
+    chThdSleepMilliseconds(1000);
+  }
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+#!/bin/bash
+# Builds the demo for the x86-64 simulator, captures a trace, converts it
+# into JSON and checks the decoded events.
+set -e
+
+SECONDS_TRACED=2
+
+if ! make -f Makefile_x64 > buildlog.txt 2>&1
+then
+  echo "Build failed, see buildlog.txt"
+  exit 1
+fi
+rm buildlog.txt
+./build/ch trace.bin $SECONDS_TRACED
+python3 ../../../tools/chtrace/chtrace2json.py trace.bin trace.json
+
+python3 - trace.json $SECONDS_TRACED <<'EOF'
+import json
+import sys
+
+with open(sys.argv[1]) as f:
+    trace = json.load(f)
+seconds = int(sys.argv[2])
+events = trace["traceEvents"]
+errors = []
+
+def count(name, ph=None):
+    return sum(1 for e in events
+               if e["name"] == name and (ph is None or e["ph"] == ph))
+
+if trace["otherData"]["lost"] != 0:
+    errors.append("%d records lost" % trace["otherData"]["lost"])
+
+names = set(e["args"]["name"] for e in events if e["name"] == "thread_name")
+for name in ("producer", "consumer", "locker1", "locker2", "ISRs"):
+    if name not in names:
+        errors.append("missing track %s" % name)
+
+# Each run slice is closed, the timestamps never go back.
+if count("run", "B") != count("run", "E"):
+    errors.append("unbalanced run slices")
+last = 0.0
+for e in events:
+    if "ts" in e:
+        if e["ts"] < last:
+            errors.append("timestamp going back at %f" % e["ts"])
+            break
+        last = e["ts"]
+
+# The producer writes a user record then signals the semaphore every 5mS,
+# the system tick interrupt is traced every 1mS.
+produced = count("user")
+if produced < seconds * 100:
+    errors.append("too few user records %d" % produced)
+if count("sem signal") != produced:
+    errors.append("sem signals not matching user records")
+if count("st_lld_serve_interrupt", "B") < seconds * 500:
+    errors.append("too few tick interrupts")
+if count("mtx lock") == 0 or count("mtx lock") != count("mtx unlock"):
+    errors.append("unbalanced mutex records")
+
+for error in errors:
+    print("error: " + error)
+if errors:
+    sys.exit(1)
+print("Trace check OK, %d events" % len(events))
+EOF
@@ -0,0 +1,178 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "trace_stream.h"
+
+#define WORKER_WA_SIZE      THD_WORKING_AREA_SIZE(2048)
+#define STREAMER_WA_SIZE    THD_WORKING_AREA_SIZE(4096)
+
+/*
+ * Sequential stream writing into a host file, the simulator can use the
+ * host C library.
+ */
+typedef struct {
+  const struct BaseSequentialStreamVMT *vmt;
+  FILE *f;
+} HostStream;
+
+static size_t fs_write(void *ip, const uint8_t *bp, size_t n) {
+
+  return fwrite(bp, 1, n, ((HostStream *)ip)->f);
+}
+
+static size_t fs_read(void *ip, uint8_t *bp, size_t n) {
+
+  (void)ip;
+  (void)bp;
+  (void)n;
+
+  return 0;
+}
+
+static msg_t fs_put(void *ip, uint8_t b) {
+
+  return fputc(b, ((HostStream *)ip)->f) == EOF ? MSG_RESET : MSG_OK;
+}
+
+static msg_t fs_get(void *ip) {
+
+  (void)ip;
+
+  return MSG_RESET;
+}
+
+static const struct BaseSequentialStreamVMT fs_vmt = {
+  fs_write, fs_read, fs_put, fs_get
+};
+
+static HostStream fs;
+static TraceStreamer streamer;
+
+static semaphore_t sem;
+static mutex_t mtx;
+static THD_WORKING_AREA(waProducer, WORKER_WA_SIZE);
+static THD_WORKING_AREA(waConsumer, WORKER_WA_SIZE);
+static THD_WORKING_AREA(waLocker1, WORKER_WA_SIZE);
+static THD_WORKING_AREA(waLocker2, WORKER_WA_SIZE);
+static THD_WORKING_AREA(waStreamer, STREAMER_WA_SIZE);
+
+/*
+ * Producer thread, signals a semaphore periodically.
+ */
+static THD_FUNCTION(producer, arg) {
+  uint32_t n = 0U;
+
+  (void)arg;
+  chRegSetThreadName("producer");
+  while (true) {
+    chThdSleepMilliseconds(5);
+    chDbgWriteTrace((void *)(uintptr_t)n++, NULL);
+    chSemSignal(&sem);
+  }
+}
+
+/*
+ * Consumer thread, waits on the semaphore and does some processing.
+ */
+static THD_FUNCTION(consumer, arg) {
+
+  (void)arg;
+  chRegSetThreadName("consumer");
+  while (true) {
+    (void)chSemWait(&sem);
+    chSysPolledDelayX((rtcnt_t)200);
+  }
+}
+
+/*
+ * Threads contending a mutex.
+ */
+static THD_FUNCTION(locker, arg) {
+
+  chRegSetThreadName((const char *)arg);
+  while (true) {
+    chMtxLock(&mtx);
+    chSysPolledDelayX((rtcnt_t)100);
+    chMtxUnlock(&mtx);
+    chThdSleepMilliseconds(3);
+  }
+}
+
+/*------------------------------------------------------------------------*
+ * Simulator main.                                                        *
+ *------------------------------------------------------------------------*/
+int main(int argc, char *argv[]) {
+  const char *name = argc > 1 ? argv[1] : "trace.bin";
+  int seconds = argc > 2 ? atoi(argv[2]) : 2;
+  thread_t *tp;
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  fs.vmt = &fs_vmt;
+  fs.f = fopen(name, "wb");
+  if (fs.f == NULL) {
+    perror(name);
+    exit(1);
+  }
+
+  /*
+   * The streamer is started first with the lowest priority, records are
+   * exported from this point on.
+   */
+  traceStreamObjectInit(&streamer, (BaseSequentialStream *)&fs);
+  tp = chThdCreateStatic(waStreamer, sizeof(waStreamer), LOWPRIO,
+                         traceStreamThread, &streamer);
+
+  /*
+   * Workload.
+   */
+  chSemObjectInit(&sem, 0);
+  chMtxObjectInit(&mtx);
+  chThdCreateStatic(waProducer, sizeof(waProducer), NORMALPRIO + 2,
+                    producer, NULL);
+  chThdCreateStatic(waConsumer, sizeof(waConsumer), NORMALPRIO + 1,
+                    consumer, NULL);
+  chThdCreateStatic(waLocker1, sizeof(waLocker1), NORMALPRIO + 1,
+                    locker, "locker1");
+  chThdCreateStatic(waLocker2, sizeof(waLocker2), NORMALPRIO + 3,
+                    locker, "locker2");
+
+  printf("Tracing into %s for %d seconds\n", name, seconds);
+  chThdSleepSeconds(seconds);
+
+  /*
+   * Final drain and clean simulator exit.
+   */
+  chThdTerminate(tp);
+  chThdWait(tp);
+  fclose(fs.f);
+  printf("Done, %lu records lost\n", (unsigned long)streamer.ts_lost);
+
+  return 0;
+}
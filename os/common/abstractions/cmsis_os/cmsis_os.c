@@ -66,12 +66,6 @@ static void timer_cb(void const *arg) {
 
   osTimerId timer_id = (osTimerId)arg;
   timer_id->ptimer(timer_id->argument);
-  if (timer_id->type == osTimerPeriodic) {
-    chSysLockFromISR();
-    chVTDoSetI(&timer_id->vt, TIME_MS2I(timer_id->millisec),
-               (vtfunc_t)timer_cb, timer_id);
-    chSysUnlockFromISR();
-  }
 }
 
 /*===========================================================================*/
@@ -190,7 +184,7 @@ osStatus osThreadSetPriority(osThreadId thread_id, osPriority newprio) {
     tp->state = CH_STATE_CURRENT;
 #endif
     /* Re-enqueues tp with its new priority on the ready list.*/
-    chSchReadyI(queue_dequeue(tp));
+    chSchReadyI(chSchDequeueReadyI(tp));
     break;
   }
 
@@ -221,12 +215,18 @@ osTimerId osTimerCreate(const osTimerDef_t *timer_def,
  * @brief   Start a timer.
  */
 osStatus osTimerStart(osTimerId timer_id, uint32_t millisec) {
+  sysinterval_t period = (sysinterval_t)0;
 
   if ((millisec == 0) || (millisec == osWaitForever))
     return osErrorValue;
 
+  /* Periodic timers are reloaded by the kernel on their deadlines.*/
+  if (timer_id->type == osTimerPeriodic)
+    period = TIME_MS2I(millisec);
+
   timer_id->millisec = millisec;
-  chVTSet(&timer_id->vt, TIME_MS2I(millisec), (vtfunc_t)timer_cb, timer_id);
+  chVTSetPeriodic(&timer_id->vt, TIME_MS2I(millisec), period,
+                  (vtfunc_t)timer_cb, timer_id);
 
   return osOK;
 }
@@ -161,7 +161,8 @@ static osal_t osal;
  * @brief   System time callback.
  */
 static void systime_update(void *p) {
-  sysinterval_t delay = (sysinterval_t)p;
+
+  (void)p;
 
   chSysLockFromISR();
   osal.localtime.microsecs += 1000;
@@ -169,7 +170,6 @@ static void systime_update(void *p) {
     osal.localtime.microsecs = 0;
     osal.localtime.seconds++;
   }
-  chVTDoSetI(&osal.vt, delay, systime_update, p);
   chSysUnlockFromISR();
 }
 
@@ -179,15 +179,9 @@ static void systime_update(void *p) {
 static void timer_handler(void *p) {
   osal_timer_t *otp = (osal_timer_t *)p;
 
-  /* Real callback.*/
+  /* Real callback, timers with an interval are reloaded by the kernel
+     on their deadlines.*/
   otp->callback_ptr((uint32)p);
-
-  /* Timer restart if an interval is defined.*/
-  if (otp->interval_time != 0) {
-    chSysLockFromISR();
-    chVTSetI(&otp->vt, TIME_US2I(otp->interval_time), timer_handler, p);
-    chSysUnlockFromISR();
-  }
 }
 
 /**
@@ -268,7 +262,7 @@ int32 OS_API_Init(void) {
   osal.localtime.microsecs = 0;
   osal.localtime.seconds   = 0;
   chVTObjectInit(&osal.vt);
-  chVTSet(&osal.vt, TIME_MS2I(1), systime_update, (void *)TIME_MS2I(1));
+  chVTSetPeriodic(&osal.vt, TIME_MS2I(1), TIME_MS2I(1), systime_update, NULL);
 
   /* Timers pool initialization.*/
   chPoolObjectInit(&osal.timers_pool,
@@ -560,7 +554,9 @@ int32 OS_TimerSet(uint32 timer_id, uint32 start_time, uint32 interval_time) {
   else {
     otp->start_time    = start_time;
     otp->interval_time = interval_time;
-    chVTSetI(&otp->vt, TIME_US2I(start_time), timer_handler, (void *)timer_id);
+    chVTSetPeriodicI(&otp->vt, TIME_US2I(start_time),
+                     TIME_US2I(interval_time), timer_handler,
+                     (void *)timer_id);
   }
 
   /* Leaving the critical zone.*/
@@ -1829,6 +1825,12 @@ int32 OS_TaskCreate(uint32 *task_id,
   if (rt_prio == 1) {
     rt_prio = 2;
   }
+#if CH_CFG_USE_EDF == TRUE
+  /* The EDF level is reserved to EDF threads.*/
+  if (rt_prio == CH_CFG_EDF_PRIO) {
+    rt_prio = CH_CFG_EDF_PRIO - 1;
+  }
+#endif
 
   thread_descriptor_t td = {
     task_name,
@@ -1836,7 +1838,11 @@ int32 OS_TaskCreate(uint32 *task_id,
     (stkalign_t *)((uint8_t *)stack_pointer + stack_size),
     rt_prio,
     (tfunc_t)function_pointer,
-    NULL
+    NULL,
+#if CH_CFG_USE_EDF == TRUE
+    (sysinterval_t)0,
+    (sysinterval_t)0
+#endif
   };
 
   /* Creating the task and detaching it, other APIs will have to gain a
@@ -1990,6 +1996,12 @@ int32 OS_TaskSetPriority(uint32 task_id, uint32 new_priority) {
   if (rt_newprio == 1) {
     rt_newprio = 2;
   }
+#if CH_CFG_USE_EDF == TRUE
+  /* The EDF level is reserved to EDF threads.*/
+  if (rt_newprio == CH_CFG_EDF_PRIO) {
+    rt_newprio = CH_CFG_EDF_PRIO - 1;
+  }
+#endif
 
   if (chThdGetPriorityX() == rt_newprio) {
     return OS_SUCCESS;
@@ -2030,7 +2042,7 @@ int32 OS_TaskSetPriority(uint32 task_id, uint32 new_priority) {
     tp->state = CH_STATE_CURRENT;
 #endif
     /* Re-enqueues tp with its new priority on the ready list.*/
-    chSchReadyI(queue_dequeue(tp));
+    chSchReadyI(chSchDequeueReadyI(tp));
     break;
   }
 
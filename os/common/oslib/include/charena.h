@@ -0,0 +1,210 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    charena.h
+ * @brief   Arena allocator macros and structures.
+ *
+ * @addtogroup arenas
+ * @{
+ */
+
+#ifndef CHARENA_H
+#define CHARENA_H
+
+#if !defined(CH_CFG_USE_ARENAS)
+#define CH_CFG_USE_ARENAS                   FALSE
+#endif
+
+#if (CH_CFG_USE_ARENAS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_MEMCORE == FALSE
+#error "CH_CFG_USE_ARENAS requires CH_CFG_USE_MEMCORE"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Source of the arena memory.
+ */
+typedef enum {
+  CH_ARENA_STATIC = 0,                  /**< Static buffer, no growth.      */
+  CH_ARENA_CORE = 1,                    /**< Core allocator.                */
+  CH_ARENA_HEAP = 2                     /**< Heap allocator.                */
+} arena_source_t;
+
+/**
+ * @brief   Type of an arena memory chunk header.
+ */
+typedef struct arena_chunk arena_chunk_t;
+
+/**
+ * @brief   Arena memory chunk header.
+ * @details The header is placed at the beginning of each chunk, the
+ *          allocatable area follows.
+ */
+struct arena_chunk {
+  arena_chunk_t         *next;      /**< @brief Next chunk in the arena.    */
+  uint8_t               *endmem;    /**< @brief End of the chunk area.      */
+};
+
+/**
+ * @brief   Type of arena statistics.
+ */
+typedef struct {
+  size_t                peak;       /**< @brief Peak usage in bytes.        */
+  ucnt_t                chunks;     /**< @brief Chunks obtained from the
+                                                memory source.              */
+  ucnt_t                failures;   /**< @brief Failed allocations.         */
+} arena_stats_t;
+
+/**
+ * @brief   Type of an arena mark.
+ * @details A mark records the arena state, restoring it releases all the
+ *          blocks allocated after the mark has been taken.
+ */
+typedef struct {
+  arena_chunk_t         *chunk;     /**< @brief Current chunk.              */
+  uint8_t               *nextmem;   /**< @brief Next free address.          */
+  size_t                offset;     /**< @brief Size of the previous
+                                                chunks.                     */
+} arena_mark_t;
+
+/**
+ * @brief   Type of an arena.
+ */
+typedef struct {
+  arena_chunk_t         *first;     /**< @brief First chunk.                */
+  arena_chunk_t         *current;   /**< @brief Chunk in use.               */
+  uint8_t               *nextmem;   /**< @brief Next free address in the
+                                                chunk in use.               */
+  size_t                offset;     /**< @brief Size of the chunks before
+                                                the chunk in use.           */
+  arena_source_t        source;     /**< @brief Memory source.              */
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+  memory_heap_t         *heapp;     /**< @brief Source heap.                */
+#endif
+  size_t                growth;     /**< @brief Size of the additional
+                                                chunks, zero if the arena
+                                                cannot grow.                */
+  arena_stats_t         stats;      /**< @brief Arena statistics.           */
+} memory_arena_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chArenaObjectInit(memory_arena_t *ap, void *buf, size_t size);
+  bool chArenaObjectInitFromCore(memory_arena_t *ap, size_t size,
+                                 size_t growth);
+#if CH_CFG_USE_HEAP == TRUE
+  bool chArenaObjectInitFromHeap(memory_arena_t *ap, memory_heap_t *heapp,
+                                 size_t size, size_t growth);
+  void chArenaDispose(memory_arena_t *ap);
+#endif
+  void *chArenaAllocAligned(memory_arena_t *ap, size_t size, unsigned align);
+  void chArenaRestore(memory_arena_t *ap, const arena_mark_t *mp);
+  void chArenaReset(memory_arena_t *ap);
+  const arena_stats_t *chArenaGetStatisticsX(memory_arena_t *ap);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Allocates a memory block from an arena.
+ * @details The allocated block is guaranteed to be properly aligned for a
+ *          pointer data type.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @param[in] size      the size of the block to be allocated
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         if the arena is exhausted.
+ *
+ * @api
+ */
+static inline void *chArenaAlloc(memory_arena_t *ap, size_t size) {
+
+  return chArenaAllocAligned(ap, size, PORT_NATURAL_ALIGN);
+}
+
+/**
+ * @brief   Takes a mark of the arena state.
+ * @details Marks can be nested, a mark must be restored before any mark
+ *          taken before it.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @param[out] mp       pointer to the @p arena_mark_t object
+ *
+ * @xclass
+ */
+static inline void chArenaSaveX(memory_arena_t *ap, arena_mark_t *mp) {
+
+  mp->chunk   = ap->current;
+  mp->nextmem = ap->nextmem;
+  mp->offset  = ap->offset;
+}
+
+/**
+ * @brief   Returns the arena memory in use.
+ * @note    The unused space at the end of the chunks which have been left
+ *          because too small for an allocation is counted as used.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @return              The size, in bytes, of the used memory.
+ *
+ * @xclass
+ */
+static inline size_t chArenaGetUsedX(memory_arena_t *ap) {
+
+  /*lint -save -e9033 [10.8] The cast is safe.*/
+  return ap->offset +
+         (size_t)(ap->nextmem - (uint8_t *)(void *)(ap->current + 1));
+  /*lint -restore*/
+}
+
+#endif /* CH_CFG_USE_ARENAS == TRUE */
+
+#endif /* CHARENA_H */
+
+/** @} */
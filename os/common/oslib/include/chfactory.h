@@ -86,6 +86,30 @@
 #define CH_CFG_FACTORY_OBJ_FIFOS            TRUE
 #endif
 
+/**
+ * @brief   Enables the objects names hash index.
+ * @details If enabled then the objects are also indexed by name in an open
+ *          addressing hash table, lookups, creation and release of objects
+ *          become O(1) operations on average instead of scanning the lists.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_INDEX) || defined(__DOXYGEN__)
+#define CH_CFG_FACTORY_HASH_INDEX           FALSE
+#endif
+
+/**
+ * @brief   Number of slots in the objects names hash index.
+ * @details Up to 3/4 of the slots are used, objects exceeding this number
+ *          are not indexed and are found by scanning the lists.
+ * @note    It must be a power of two.
+ * @note    While a list contains objects not indexed, lookups of names not
+ *          in the index scan the whole list of that object type, this
+ *          includes all lookups of absent names. Lists without objects
+ *          outside the index are not affected.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_FACTORY_HASH_SIZE            64
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -125,6 +149,17 @@
 #error "invalid CH_CFG_FACTORY_MAX_NAMES_LENGTH value"
 #endif
 
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+#if CH_CFG_FACTORY_MAX_NAMES_LENGTH == 0
+#error "CH_CFG_FACTORY_HASH_INDEX requires CH_CFG_FACTORY_MAX_NAMES_LENGTH > 0"
+#endif
+
+#if (CH_CFG_FACTORY_HASH_SIZE < 4) ||                                       \
+    ((CH_CFG_FACTORY_HASH_SIZE & (CH_CFG_FACTORY_HASH_SIZE - 1)) != 0)
+#error "invalid CH_CFG_FACTORY_HASH_SIZE value"
+#endif
+#endif
+
 #if (CH_CFG_USE_MUTEXES == FALSE) && (CH_CFG_USE_SEMAPHORES == FALSE)
 #error "CH_CFG_USE_FACTORY requires CH_CFG_USE_MUTEXES and/or CH_CFG_USE_SEMAPHORES"
 #endif
@@ -153,6 +188,12 @@ typedef struct ch_dyn_element {
    * @brief   Next dynamic object in the list.
    */
   struct ch_dyn_element *next;
+#if (CH_CFG_FACTORY_HASH_INDEX == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Previous dynamic object in the list.
+   */
+  struct ch_dyn_element *prev;
+#endif
   /**
    * @brief   Number of references to this object.
    */
@@ -162,6 +203,12 @@ typedef struct ch_dyn_element {
 #else
   const char            *name;
 #endif
+#if (CH_CFG_FACTORY_HASH_INDEX == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Hash of the object name, calculated on creation.
+   */
+  uint32_t              hash;
+#endif
 } dyn_element_t;
 
 /**
@@ -169,6 +216,14 @@ typedef struct ch_dyn_element {
  */
 typedef struct ch_dyn_list {
     dyn_element_t       *next;
+#if (CH_CFG_FACTORY_HASH_INDEX == TRUE) || defined(__DOXYGEN__)
+    dyn_element_t       *prev;
+    /**
+     * @brief   Number of objects in the list not indexed because the
+     *          index was full.
+     */
+    ucnt_t              unindexed;
+#endif
 } dyn_list_t;
 
 #if (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) || defined(__DOXYGEN__)
@@ -319,6 +374,16 @@ typedef struct ch_objects_factory {
    */
   dyn_list_t            fifo_list;
 #endif /* CH_CFG_FACTORY_OBJ_FIFOS = TRUE */
+#if (CH_CFG_FACTORY_HASH_INDEX == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Objects names hash index.
+   */
+  dyn_element_t         *index[CH_CFG_FACTORY_HASH_SIZE];
+  /**
+   * @brief   Number of indexed objects.
+   */
+  ucnt_t                indexed;
+#endif
 } objects_factory_t;
 
 /*===========================================================================*/
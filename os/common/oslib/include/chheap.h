@@ -44,6 +44,8 @@
  */
 #if (SIZEOF_PTR == 4) || defined(__DOXYGEN__)
 #define CH_HEAP_ALIGNMENT   8U
+#elif (SIZEOF_PTR == 8)
+#define CH_HEAP_ALIGNMENT   16U
 #elif (SIZEOF_PTR == 2)
 #define CH_HEAP_ALIGNMENT   4U
 #else
@@ -54,6 +56,79 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   TLSF heap allocator.
+ */
+#if !defined(CH_CFG_HEAP_TLSF) || defined(__DOXYGEN__)
+#define CH_CFG_HEAP_TLSF                    FALSE
+#endif
+
+/**
+ * @brief   Number of TLSF first level classes.
+ * @details Each first level class covers a power of two range of block
+ *          sizes, blocks larger than the covered range are kept in the
+ *          last class.
+ * @note    Allocations larger than the covered range can fail even if a
+ *          large enough free block exists.
+ */
+#if !defined(CH_HEAP_TLSF_FL_COUNT) || defined(__DOXYGEN__)
+#define CH_HEAP_TLSF_FL_COUNT               16U
+#endif
+
+/**
+ * @brief   Number of bits of the TLSF second level index.
+ * @details Each first level class is split in 2^N second level classes.
+ */
+#if !defined(CH_HEAP_TLSF_SL_BITS) || defined(__DOXYGEN__)
+#define CH_HEAP_TLSF_SL_BITS                3U
+#endif
+
+/**
+ * @brief   Heap allocations profiler.
+ */
+#if !defined(CH_CFG_HEAP_PROFILER) || defined(__DOXYGEN__)
+#define CH_CFG_HEAP_PROFILER                FALSE
+#endif
+
+/**
+ * @brief   Number of call sites recorded by a profiler.
+ * @details The last entry collects the allocations performed by call
+ *          sites not fitting in the table.
+ */
+#if !defined(CH_HEAP_PROFILER_SITES) || defined(__DOXYGEN__)
+#define CH_HEAP_PROFILER_SITES              16U
+#endif
+
+/**
+ * @brief   Number of buckets of the profiler histograms.
+ * @details Bucket N counts values from 2^N to 2^(N+1)-1, bucket zero also
+ *          counts zero and the last bucket counts all the larger values.
+ */
+#if !defined(CH_HEAP_PROFILER_BUCKETS) || defined(__DOXYGEN__)
+#define CH_HEAP_PROFILER_BUCKETS            16U
+#endif
+
+/**
+ * @brief   Number of fragmentation samples kept by a profiler.
+ */
+#if !defined(CH_HEAP_PROFILER_HISTORY) || defined(__DOXYGEN__)
+#define CH_HEAP_PROFILER_HISTORY            16U
+#endif
+
+/**
+ * @brief   Returns the call site of an allocation.
+ * @note    The return address of @p chHeapAllocAligned() is used, it is
+ *          the caller of @p chHeapAlloc() when the inline function is
+ *          actually inlined.
+ */
+#if !defined(CH_HEAP_PROFILER_CALLER) || defined(__DOXYGEN__)
+#if defined(__GNUC__) || defined(__DOXYGEN__)
+#define CH_HEAP_PROFILER_CALLER()           __builtin_return_address(0)
+#else
+#define CH_HEAP_PROFILER_CALLER()           NULL
+#endif
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -66,6 +141,36 @@
 #error "CH_CFG_USE_HEAP requires CH_CFG_USE_MUTEXES and/or CH_CFG_USE_SEMAPHORES"
 #endif
 
+#if (CH_CFG_HEAP_TLSF == TRUE) || defined(__DOXYGEN__)
+#if (CH_HEAP_TLSF_SL_BITS < 1U) || (CH_HEAP_TLSF_SL_BITS > 5U)
+#error "invalid CH_HEAP_TLSF_SL_BITS value specified"
+#endif
+
+#if (CH_HEAP_TLSF_FL_COUNT < 2U) ||                                         \
+    ((CH_HEAP_TLSF_FL_COUNT + CH_HEAP_TLSF_SL_BITS) > 31U)
+#error "invalid CH_HEAP_TLSF_FL_COUNT value specified"
+#endif
+
+/**
+ * @brief   Number of TLSF second level classes.
+ */
+#define CH_HEAP_TLSF_SL_COUNT               (1U << CH_HEAP_TLSF_SL_BITS)
+#endif /* CH_CFG_HEAP_TLSF == TRUE */
+
+#if (CH_CFG_HEAP_PROFILER == TRUE) || defined(__DOXYGEN__)
+#if (CH_HEAP_PROFILER_SITES < 2U) || (CH_HEAP_PROFILER_SITES > 255U)
+#error "invalid CH_HEAP_PROFILER_SITES value specified"
+#endif
+
+#if CH_HEAP_PROFILER_BUCKETS < 1U
+#error "invalid CH_HEAP_PROFILER_BUCKETS value specified"
+#endif
+
+#if CH_HEAP_PROFILER_HISTORY < 1U
+#error "invalid CH_HEAP_PROFILER_HISTORY value specified"
+#endif
+#endif /* CH_CFG_HEAP_PROFILER == TRUE */
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -80,6 +185,7 @@ typedef struct memory_heap memory_heap_t;
  */
 typedef union heap_header heap_header_t;
 
+#if (CH_CFG_HEAP_TLSF == FALSE) || defined(__DOXYGEN__)
 /**
  * @brief   Memory heap block header.
  */
@@ -93,6 +199,77 @@ union heap_header {
     size_t              size;       /**< @brief Size of the area in bytes.  */
   } used;
 };
+#else
+/*
+ * In TLSF mode the first word of the header also carries the block state
+ * flags, the free lists back links and the boundary tags are stored in
+ * the area of free blocks so the used blocks overhead is unchanged.
+ */
+union heap_header {
+  struct {
+    size_t              pages;      /**< @brief Size of the area in pages
+                                                and flags.                  */
+    heap_header_t       *next;      /**< @brief Next block in free list.    */
+  } free;
+  struct {
+    memory_heap_t       *heap;      /**< @brief Block owner heap and
+                                                flags.                      */
+    size_t              size;       /**< @brief Size of the area in bytes.  */
+  } used;
+};
+#endif
+
+#if (CH_CFG_HEAP_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a profiler call site record.
+ */
+typedef struct {
+  const void            *site;      /**< @brief Call site return address,
+                                                @p NULL for the entries
+                                                not yet used and for the
+                                                overflow entry.             */
+  ucnt_t                allocs;     /**< @brief Allocations.                */
+  ucnt_t                frees;      /**< @brief Releases.                   */
+  size_t                live;       /**< @brief Allocated bytes.            */
+  size_t                peak;       /**< @brief Peak of allocated bytes.    */
+} heap_site_t;
+
+/**
+ * @brief   Type of a profiler fragmentation sample.
+ */
+typedef struct {
+  systime_t             time;       /**< @brief Sample time.                */
+  size_t                total;      /**< @brief Total free memory.          */
+  size_t                largest;    /**< @brief Largest free block.         */
+  unsigned              index;      /**< @brief Fragmentation index in
+                                                thousandths.                */
+} heap_sample_t;
+
+/**
+ * @brief   Type of a heap profiler.
+ */
+typedef struct {
+  size_t                epoch;      /**< @brief Profiling session tag.      */
+  ucnt_t                allocs;     /**< @brief Allocations.                */
+  ucnt_t                frees;      /**< @brief Releases.                   */
+  ucnt_t                failures;   /**< @brief Failed allocations.         */
+  size_t                live;       /**< @brief Allocated bytes.            */
+  size_t                peak;       /**< @brief Peak of allocated bytes.    */
+  heap_site_t           sites[CH_HEAP_PROFILER_SITES];
+                                    /**< @brief Call sites records.         */
+  ucnt_t                sizes[CH_HEAP_PROFILER_BUCKETS];
+                                    /**< @brief Allocations by size in
+                                                bytes.                      */
+  ucnt_t                lifetimes[CH_HEAP_PROFILER_BUCKETS];
+                                    /**< @brief Releases by block lifetime
+                                                in system ticks.            */
+  heap_sample_t         history[CH_HEAP_PROFILER_HISTORY];
+                                    /**< @brief Fragmentation samples.      */
+  unsigned              nsamples;   /**< @brief Samples taken, saturated to
+                                                the history size.           */
+  unsigned              nextsample; /**< @brief Next history entry.         */
+} heap_profiler_t;
+#endif /* CH_CFG_HEAP_PROFILER == TRUE */
 
 /**
  * @brief   Structure describing a memory heap.
@@ -100,12 +277,25 @@ union heap_header {
 struct memory_heap {
   memgetfunc2_t         provider;   /**< @brief Memory blocks provider for
                                                 this heap.                  */
+#if (CH_CFG_HEAP_TLSF == FALSE) || defined(__DOXYGEN__)
   heap_header_t         header;     /**< @brief Free blocks list header.    */
+#else
+  uint32_t              fl_map;     /**< @brief First level classes with
+                                                free blocks.                */
+  uint32_t              sl_map[CH_HEAP_TLSF_FL_COUNT];
+                                    /**< @brief Second level classes with
+                                                free blocks.                */
+  heap_header_t         *free[CH_HEAP_TLSF_FL_COUNT][CH_HEAP_TLSF_SL_COUNT];
+                                    /**< @brief Free blocks lists.          */
+#endif
 #if CH_CFG_USE_MUTEXES == TRUE
   mutex_t               mtx;        /**< @brief Heap access mutex.          */
 #else
   semaphore_t           sem;        /**< @brief Heap access semaphore.      */
 #endif
+#if (CH_CFG_HEAP_PROFILER == TRUE) || defined(__DOXYGEN__)
+  heap_profiler_t       *profiler;  /**< @brief Heap profiler or @p NULL.   */
+#endif
 };
 
 /*===========================================================================*/
@@ -128,9 +318,20 @@ extern "C" {
 #endif
   void _heap_init(void);
   void chHeapObjectInit(memory_heap_t *heapp, void *buf, size_t size);
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  bool chHeapObjectInitFromRegion(memory_heap_t *heapp,
+                                  memory_region_t *rp,
+                                  size_t size);
+#endif
   void *chHeapAllocAligned(memory_heap_t *heapp, size_t size, unsigned align);
   void chHeapFree(void *p);
   size_t chHeapStatus(memory_heap_t *heapp, size_t *totalp, size_t *largestp);
+#if CH_CFG_HEAP_PROFILER == TRUE
+  void chHeapProfilerStart(memory_heap_t *heapp, heap_profiler_t *hpp);
+  void chHeapProfilerStop(memory_heap_t *heapp);
+  unsigned chHeapProfilerSample(memory_heap_t *heapp);
+  bool chHeapProfilerSnapshot(memory_heap_t *heapp, heap_profiler_t *hpp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -140,8 +341,7 @@ extern "C" {
 /*===========================================================================*/
 
 /**
- * @brief   Allocates a block of memory from the heap by using the first-fit
- *          algorithm.
+ * @brief   Allocates a block of memory from the heap.
  * @details The allocated block is guaranteed to be properly aligned for a
  *          pointer data type.
  *
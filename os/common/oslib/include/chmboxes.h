@@ -70,6 +70,11 @@ typedef struct {
 /* Module macros.                                                            */
 /*===========================================================================*/
 
+/* Kernels not implementing the objects trace just get an empty macro.*/
+#if !defined(_trace_mbox)
+#define _trace_mbox(event, mbp, msg)
+#endif
+
 /**
  * @brief   Data part of a static mailbox initializer.
  * @details This macro should be used when statically initializing a
@@ -38,6 +38,31 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Memory region attributes
+ * @{
+ */
+/**
+ * @brief   No specific attributes.
+ */
+#define CH_MEM_ATTR_NONE                    0U
+
+/**
+ * @brief   Zero wait states memory, suitable for stacks and hot data.
+ */
+#define CH_MEM_ATTR_FAST                    1U
+
+/**
+ * @brief   Memory accessible by the DMA controllers.
+ */
+#define CH_MEM_ATTR_DMA                     2U
+
+/**
+ * @brief   Memory not cached by the data cache.
+ */
+#define CH_MEM_ATTR_NOCACHE                 4U
+/** @} */
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -57,6 +82,24 @@
 #define CH_CFG_MEMCORE_SIZE                 0
 #endif
 
+/**
+ * @brief   Multiple memory regions support.
+ * @details If enabled then additional memory regions can be registered
+ *          and memory can be allocated from a specific region or from
+ *          any region having the required attributes.
+ */
+#if !defined(CH_CFG_USE_MEMCORE_REGIONS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_MEMCORE_REGIONS          FALSE
+#endif
+
+/**
+ * @brief   Attributes of the default core memory region.
+ * @note    Requires @p CH_CFG_USE_MEMCORE_REGIONS.
+ */
+#if !defined(CH_MEMCORE_ATTRIBUTES) || defined(__DOXYGEN__)
+#define CH_MEMCORE_ATTRIBUTES               CH_MEM_ATTR_DMA
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -79,6 +122,44 @@ typedef void *(*memgetfunc_t)(size_t size, unsigned align);
  */
 typedef void *(*memgetfunc2_t)(size_t size, unsigned align, size_t offset);
 
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a memory attributes mask.
+ */
+typedef uint32_t memattr_t;
+
+/**
+ * @brief   Type of a memory region.
+ */
+typedef struct memory_region memory_region_t;
+
+/**
+ * @brief   Structure representing a memory region.
+ */
+struct memory_region {
+  /**
+   * @brief   Next region in the list.
+   */
+  memory_region_t *next;
+  /**
+   * @brief   Region name.
+   */
+  const char *name;
+  /**
+   * @brief   Next free address.
+   */
+  uint8_t *nextmem;
+  /**
+   * @brief   Final address.
+   */
+  uint8_t *endmem;
+  /**
+   * @brief   Region attributes.
+   */
+  memattr_t attributes;
+};
+#endif
+
 /**
  * @brief   Type of memory core object.
  */
@@ -91,6 +172,12 @@ typedef struct {
    * @brief   Final address.
    */
   uint8_t *endmem;
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   List of the additional memory regions.
+   */
+  memory_region_t *regions;
+#endif
 } memcore_t;
 
 /*===========================================================================*/
@@ -116,6 +203,23 @@ extern "C" {
                                      unsigned align,
                                      size_t offset);
   size_t chCoreGetStatusX(void);
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  void chCoreAddRegion(memory_region_t *rp, const char *name,
+                       void *base, size_t size, memattr_t attributes);
+  memory_region_t *chCoreFindRegion(const char *name);
+  void *chCoreAllocFromRegionAlignedWithOffsetI(memory_region_t *rp,
+                                                size_t size,
+                                                unsigned align,
+                                                size_t offset);
+  void *chCoreAllocFromRegionAlignedWithOffset(memory_region_t *rp,
+                                               size_t size,
+                                               unsigned align,
+                                               size_t offset);
+  void *chCoreAllocHintAlignedI(size_t size, unsigned align,
+                                memattr_t hint);
+  void *chCoreAllocHintAligned(size_t size, unsigned align, memattr_t hint);
+  size_t chCoreGetRegionStatusX(memory_region_t *rp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -195,6 +299,50 @@ static inline void *chCoreAlloc(size_t size) {
   return chCoreAllocAlignedWithOffset(size, PORT_NATURAL_ALIGN, 0U);
 }
 
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Allocates a memory block from a memory region.
+ * @details The allocated block is guaranteed to be properly aligned to the
+ *          specified alignment.
+ *
+ * @param[in] rp        pointer to the memory region or @p NULL for the
+ *                      default core memory region
+ * @param[in] size      the size of the block to be allocated
+ * @param[in] align     desired memory alignment
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, region memory exhausted.
+ *
+ * @iclass
+ */
+static inline void *chCoreAllocFromRegionAlignedI(memory_region_t *rp,
+                                                  size_t size,
+                                                  unsigned align) {
+
+  return chCoreAllocFromRegionAlignedWithOffsetI(rp, size, align, 0U);
+}
+
+/**
+ * @brief   Allocates a memory block from a memory region.
+ * @details The allocated block is guaranteed to be properly aligned to the
+ *          specified alignment.
+ *
+ * @param[in] rp        pointer to the memory region or @p NULL for the
+ *                      default core memory region
+ * @param[in] size      the size of the block to be allocated
+ * @param[in] align     desired memory alignment
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, region memory exhausted.
+ *
+ * @api
+ */
+static inline void *chCoreAllocFromRegionAligned(memory_region_t *rp,
+                                                 size_t size,
+                                                 unsigned align) {
+
+  return chCoreAllocFromRegionAlignedWithOffset(rp, size, align, 0U);
+}
+#endif /* CH_CFG_USE_MEMCORE_REGIONS == TRUE */
+
 #endif /* CH_CFG_USE_MEMCORE == TRUE */
 
 #endif /* CHMEMCORE_H */
@@ -32,6 +32,10 @@
 #define CH_CFG_USE_MEMPOOLS                 FALSE
 #endif
 
+#if !defined(CH_CFG_USE_POOL_MAGAZINES)
+#define CH_CFG_USE_POOL_MAGAZINES           FALSE
+#endif
+
 #if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
 
 /*===========================================================================*/
@@ -42,6 +46,23 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Number of objects a magazine can hold.
+ */
+#if !defined(CH_POOL_MAGAZINE_SIZE) || defined(__DOXYGEN__)
+#define CH_POOL_MAGAZINE_SIZE               16U
+#endif
+
+/**
+ * @brief   Number of objects moved from/to the pool when a magazine is
+ *          refilled or flushed.
+ * @note    Objects are moved within a single critical zone, this value
+ *          bounds the length of that zone.
+ */
+#if !defined(CH_POOL_MAGAZINE_BATCH) || defined(__DOXYGEN__)
+#define CH_POOL_MAGAZINE_BATCH              (CH_POOL_MAGAZINE_SIZE / 2U)
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -50,6 +71,13 @@
 #error "CH_CFG_USE_MEMPOOLS requires CH_CFG_USE_MEMCORE"
 #endif
 
+#if CH_CFG_USE_POOL_MAGAZINES == TRUE
+#if (CH_POOL_MAGAZINE_BATCH < 1U) ||                                        \
+    (CH_POOL_MAGAZINE_BATCH > CH_POOL_MAGAZINE_SIZE)
+#error "invalid CH_POOL_MAGAZINE_BATCH value specified"
+#endif
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -85,6 +113,41 @@ typedef struct {
 } guarded_memory_pool_t;
 #endif /* CH_CFG_USE_SEMAPHORES == TRUE */
 
+#if (CH_CFG_USE_POOL_MAGAZINES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Magazine statistics.
+ */
+typedef struct {
+  ucnt_t                alloc_hits;     /**< @brief Allocations served by
+                                                    the magazine.           */
+  ucnt_t                alloc_misses;   /**< @brief Allocations that
+                                                    required a refill.      */
+  ucnt_t                free_hits;      /**< @brief Releases absorbed by
+                                                    the magazine.           */
+  ucnt_t                free_misses;    /**< @brief Releases that required
+                                                    a flush.                */
+  ucnt_t                refilled;       /**< @brief Objects moved from the
+                                                    pool.                   */
+  ucnt_t                flushed;        /**< @brief Objects moved to the
+                                                    pool.                   */
+} pool_magazine_stats_t;
+
+/**
+ * @brief   Memory pool magazine descriptor.
+ * @details A magazine is a small stack of objects owned by a single
+ *          thread, it is accessed without locking.
+ */
+typedef struct {
+  memory_pool_t         *pool;          /**< @brief Underlying memory
+                                                    pool.                   */
+  thread_t              *owner;         /**< @brief Owner thread.           */
+  size_t                cnt;            /**< @brief Cached objects.         */
+  void                  *objects[CH_POOL_MAGAZINE_SIZE];
+                                        /**< @brief Cached objects stack.   */
+  pool_magazine_stats_t stats;          /**< @brief Magazine statistics.    */
+} pool_magazine_t;
+#endif /* CH_CFG_USE_POOL_MAGAZINES == TRUE */
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -144,6 +207,19 @@ typedef struct {
   guarded_memory_pool_t name = _GUARDEDMEMORYPOOL_DATA(name, size, align)
 #endif /* CH_CFG_USE_SEMAPHORES == TRUE */
 
+#if (CH_CFG_USE_POOL_MAGAZINES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the magazine statistics.
+ *
+ * @param[in] mgp       pointer to a @p pool_magazine_t structure
+ * @return              Pointer to the @p pool_magazine_stats_t structure.
+ *
+ * @xclass
+ */
+#define chPoolMagazineGetStatisticsX(mgp)                                   \
+  ((const pool_magazine_stats_t *)&(mgp)->stats)
+#endif /* CH_CFG_USE_POOL_MAGAZINES == TRUE */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -154,6 +230,9 @@ extern "C" {
   void chPoolObjectInitAligned(memory_pool_t *mp, size_t size,
                                unsigned align, memgetfunc_t provider);
   void chPoolLoadArray(memory_pool_t *mp, void *p, size_t n);
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  bool chPoolLoadFromRegion(memory_pool_t *mp, memory_region_t *rp, size_t n);
+#endif
   void *chPoolAllocI(memory_pool_t *mp);
   void *chPoolAlloc(memory_pool_t *mp);
   void chPoolFreeI(memory_pool_t *mp, void *objp);
@@ -170,6 +249,12 @@ extern "C" {
   void chGuardedPoolFreeI(guarded_memory_pool_t *gmp, void *objp);
   void chGuardedPoolFree(guarded_memory_pool_t *gmp, void *objp);
 #endif
+#if CH_CFG_USE_POOL_MAGAZINES == TRUE
+  void chPoolMagazineObjectInit(pool_magazine_t *mgp, memory_pool_t *mp);
+  void *chPoolMagazineAlloc(pool_magazine_t *mgp);
+  void chPoolMagazineFree(pool_magazine_t *mgp, void *objp);
+  void chPoolMagazineFlush(pool_magazine_t *mgp);
+#endif
 #ifdef __cplusplus
 }
 #endif
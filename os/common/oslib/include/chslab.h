@@ -0,0 +1,122 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chslab.h
+ * @brief   Slab allocator macros and structures.
+ *
+ * @addtogroup slabs
+ * @{
+ */
+
+#ifndef CHSLAB_H
+#define CHSLAB_H
+
+#if !defined(CH_CFG_USE_SLAB)
+#define CH_CFG_USE_SLAB                     FALSE
+#endif
+
+#if (CH_CFG_USE_SLAB == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size classes of the slab allocator.
+ * @details Comma separated list of object sizes in ascending order, each
+ *          size class is served by its own memory pool. Larger requests
+ *          are served by the default heap.
+ */
+#if !defined(CH_SLAB_SIZES) || defined(__DOXYGEN__)
+#define CH_SLAB_SIZES                       16U, 32U, 64U, 128U, 256U, 512U
+#endif
+
+/**
+ * @brief   Alignment of the allocated objects.
+ */
+#if !defined(CH_SLAB_ALIGNMENT) || defined(__DOXYGEN__)
+#define CH_SLAB_ALIGNMENT                   PORT_NATURAL_ALIGN
+#endif
+
+/**
+ * @brief   Number of objects obtained from the core allocator when a size
+ *          class runs out of objects.
+ */
+#if !defined(CH_SLAB_REFILL_OBJECTS) || defined(__DOXYGEN__)
+#define CH_SLAB_REFILL_OBJECTS              8U
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_MEMPOOLS == FALSE
+#error "CH_CFG_USE_SLAB requires CH_CFG_USE_MEMPOOLS"
+#endif
+
+#if CH_SLAB_REFILL_OBJECTS < 1U
+#error "invalid CH_SLAB_REFILL_OBJECTS value specified"
+#endif
+
+/**
+ * @brief   Size of the header preceding each object.
+ * @details The header contains the size class of the object.
+ */
+#define CH_SLAB_HEADER_SIZE                                                 \
+  MEM_ALIGN_NEXT(sizeof (size_t), CH_SLAB_ALIGNMENT)
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void _slab_init(void);
+  void *chSlabAlloc(size_t size);
+  void chSlabFree(void *p);
+  size_t chSlabGetSize(const void *p);
+  void *chSlabCalloc(size_t n, size_t size);
+  void *chSlabRealloc(void *p, size_t size);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* CH_CFG_USE_SLAB == TRUE */
+
+#endif /* CHSLAB_H */
+
+/** @} */
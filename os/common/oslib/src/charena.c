@@ -0,0 +1,408 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    charena.c
+ * @brief   Arena allocator code.
+ *
+ * @addtogroup arenas
+ * @details Arena allocator related APIs and services.
+ *          <h2>Operation mode</h2>
+ *          An arena allocates memory blocks by simply advancing a pointer
+ *          into a memory chunk, blocks are not released individually but
+ *          all together by resetting the arena or by restoring a mark
+ *          previously taken.<br>
+ *          This is useful for request-scoped work, for example parsing a
+ *          frame or assembling a packet, where a lot of small blocks are
+ *          allocated and then released together.<br>
+ *          The arena memory can be a static buffer or can be obtained from
+ *          the core allocator or from an heap, in the latter two cases the
+ *          arena can optionally grow by obtaining additional chunks. The
+ *          chunks are retained by the arena when it is reset so that reset
+ *          is always O(1).
+ * @pre     In order to use the arena allocator APIs the @p CH_CFG_USE_ARENAS
+ *          option must be enabled in @p chconf.h.
+ * @note    Arenas are not thread safe, an arena is meant to be used by a
+ *          single thread.
+ * @note    Compatible with RT and NIL.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_ARENAS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the base of the allocatable area of a chunk.
+ */
+#define chunk_base(cp)      ((uint8_t *)(void *)((cp) + 1))
+
+/**
+ * @brief   Initializes an arena on its first chunk.
+ *
+ * @param[out] ap       pointer to a @p memory_arena_t structure
+ * @param[in] cp        pointer to the first chunk
+ * @param[in] size      size of the first chunk, header included
+ * @param[in] source    source of the arena memory
+ * @param[in] growth    size of the additional chunks
+ *
+ * @notapi
+ */
+static void arena_init(memory_arena_t *ap, arena_chunk_t *cp, size_t size,
+                       arena_source_t source, size_t growth) {
+
+  cp->next   = NULL;
+  cp->endmem = (uint8_t *)cp + size;
+
+  ap->first          = cp;
+  ap->current        = cp;
+  ap->nextmem        = chunk_base(cp);
+  ap->offset         = (size_t)0;
+  ap->source         = source;
+  ap->growth         = growth;
+  ap->stats.peak     = (size_t)0;
+  ap->stats.chunks   = (ucnt_t)1;
+  ap->stats.failures = (ucnt_t)0;
+}
+
+/**
+ * @brief   Obtains an additional chunk from the arena memory source.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @param[in] size      minimum size of the chunk area
+ * @return              The pointer to the new chunk.
+ * @retval NULL         if the arena cannot grow or the memory source is
+ *                      exhausted.
+ *
+ * @notapi
+ */
+static arena_chunk_t *arena_grow(memory_arena_t *ap, size_t size) {
+  arena_chunk_t *cp;
+
+  if (ap->growth == (size_t)0) {
+    return NULL;
+  }
+
+  if (size < ap->growth) {
+    size = ap->growth;
+  }
+  if (size > ((size_t)-1 - sizeof (arena_chunk_t))) {
+    return NULL;
+  }
+  size += sizeof (arena_chunk_t);
+
+  switch (ap->source) {
+  case CH_ARENA_CORE:
+    cp = chCoreAllocAligned(size, PORT_NATURAL_ALIGN);
+    break;
+#if CH_CFG_USE_HEAP == TRUE
+  case CH_ARENA_HEAP:
+    cp = chHeapAlloc(ap->heapp, size);
+    break;
+#endif
+  default:
+    cp = NULL;
+    break;
+  }
+
+  if (cp != NULL) {
+    cp->next   = NULL;
+    cp->endmem = (uint8_t *)cp + size;
+    ap->stats.chunks++;
+  }
+
+  return cp;
+}
+
+/**
+ * @brief   Updates the peak usage statistic.
+ * @note    The usage only decreases when the arena is reset or a mark is
+ *          restored so the peak is only updated at those times.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ *
+ * @notapi
+ */
+static void arena_update_peak(memory_arena_t *ap) {
+  size_t used = chArenaGetUsedX(ap);
+
+  if (used > ap->stats.peak) {
+    ap->stats.peak = used;
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an arena on a static buffer.
+ * @note    The buffer base and size are adjusted if the passed buffer is
+ *          not aligned to @p PORT_NATURAL_ALIGN, part of the buffer is also
+ *          used for the chunk header. The arena cannot grow.
+ *
+ * @param[out] ap       pointer to a @p memory_arena_t structure
+ * @param[in] buf       arena buffer base
+ * @param[in] size      arena buffer size
+ *
+ * @init
+ */
+void chArenaObjectInit(memory_arena_t *ap, void *buf, size_t size) {
+  arena_chunk_t *cp = (arena_chunk_t *)MEM_ALIGN_NEXT(buf, PORT_NATURAL_ALIGN);
+  size_t adj;
+
+  /*lint -save -e9033 [10.8] Required cast operations.*/
+  adj = (size_t)((uint8_t *)cp - (uint8_t *)buf);
+  /*lint restore*/
+
+  chDbgCheck((ap != NULL) && (buf != NULL) &&
+             (size >= adj + sizeof (arena_chunk_t)));
+
+  arena_init(ap, cp, size - adj, CH_ARENA_STATIC, (size_t)0);
+}
+
+/**
+ * @brief   Initializes an arena using memory from the core allocator.
+ * @note    The core memory is never released, the arena should be
+ *          long-lived and reset after each use.
+ *
+ * @param[out] ap       pointer to a @p memory_arena_t structure
+ * @param[in] size      size of the first chunk area
+ * @param[in] growth    size of the additional chunks obtained when the
+ *                      arena is exhausted, zero if the arena cannot grow
+ * @return              The operation status.
+ * @retval false        if the arena has been initialized.
+ * @retval true         if the core memory is exhausted.
+ *
+ * @api
+ */
+bool chArenaObjectInitFromCore(memory_arena_t *ap, size_t size,
+                               size_t growth) {
+  arena_chunk_t *cp;
+
+  chDbgCheck((ap != NULL) && (size > 0U));
+
+  cp = chCoreAllocAligned(sizeof (arena_chunk_t) + size, PORT_NATURAL_ALIGN);
+  if (cp == NULL) {
+    return true;
+  }
+
+  arena_init(ap, cp, sizeof (arena_chunk_t) + size, CH_ARENA_CORE, growth);
+
+  return false;
+}
+
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an arena using memory from an heap.
+ * @note    The memory is returned to the heap by @p chArenaDispose().
+ *
+ * @param[out] ap       pointer to a @p memory_arena_t structure
+ * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
+ *                      access the default heap.
+ * @param[in] size      size of the first chunk area
+ * @param[in] growth    size of the additional chunks obtained when the
+ *                      arena is exhausted, zero if the arena cannot grow
+ * @return              The operation status.
+ * @retval false        if the arena has been initialized.
+ * @retval true         if the heap memory is exhausted.
+ *
+ * @api
+ */
+bool chArenaObjectInitFromHeap(memory_arena_t *ap, memory_heap_t *heapp,
+                               size_t size, size_t growth) {
+  arena_chunk_t *cp;
+
+  chDbgCheck((ap != NULL) && (size > 0U));
+
+  cp = chHeapAlloc(heapp, sizeof (arena_chunk_t) + size);
+  if (cp == NULL) {
+    return true;
+  }
+
+  ap->heapp = heapp;
+  arena_init(ap, cp, sizeof (arena_chunk_t) + size, CH_ARENA_HEAP, growth);
+
+  return false;
+}
+
+/**
+ * @brief   Returns all the arena chunks to the heap.
+ * @post    The arena must be initialized again before being used.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ *
+ * @api
+ */
+void chArenaDispose(memory_arena_t *ap) {
+  arena_chunk_t *cp;
+
+  chDbgCheck(ap != NULL);
+  chDbgAssert(ap->source == CH_ARENA_HEAP, "not an heap arena");
+
+  cp = ap->first;
+  while (cp != NULL) {
+    arena_chunk_t *next = cp->next;
+
+    chHeapFree(cp);
+    cp = next;
+  }
+
+  ap->first   = NULL;
+  ap->current = NULL;
+  ap->nextmem = NULL;
+}
+#endif /* CH_CFG_USE_HEAP == TRUE */
+
+/**
+ * @brief   Allocates a memory block from an arena.
+ * @details The block is allocated from the chunk in use, if there is not
+ *          enough space then the following chunk is used. If the chunk in
+ *          use is the last one then a new chunk is obtained from the
+ *          memory source, if the arena can grow.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @param[in] size      the size of the block to be allocated
+ * @param[in] align     desired memory alignment
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         if the arena is exhausted.
+ *
+ * @api
+ */
+void *chArenaAllocAligned(memory_arena_t *ap, size_t size, unsigned align) {
+  arena_chunk_t *cp;
+  uint8_t *p;
+
+  chDbgCheck((ap != NULL) && MEM_IS_VALID_ALIGNMENT(align));
+  chDbgAssert(ap->current != NULL, "disposed arena");
+
+  while (true) {
+    cp = ap->current;
+    p = (uint8_t *)MEM_ALIGN_NEXT(ap->nextmem, align);
+
+    /* Considering also the case where there is numeric overflow.*/
+    if ((p >= ap->nextmem) && (p <= cp->endmem) &&
+        (size <= (size_t)(cp->endmem - p))) {
+      ap->nextmem = p + size;
+      return (void *)p;
+    }
+
+    /* Not enough space in this chunk, the following one is used or a new
+       one is obtained, the worst case alignment space is reserved.*/
+    if (cp->next == NULL) {
+      if (size > ((size_t)-1 - (size_t)align)) {
+        ap->stats.failures++;
+        return NULL;
+      }
+      cp->next = arena_grow(ap, size + (size_t)align);
+      if (cp->next == NULL) {
+        ap->stats.failures++;
+        return NULL;
+      }
+    }
+
+    /* The space left at the end of the chunk is counted as used.*/
+    /*lint -save -e9033 [10.8] The cast is safe.*/
+    ap->offset += (size_t)(cp->endmem - chunk_base(cp));
+    /*lint -restore*/
+    ap->current = cp->next;
+    ap->nextmem = chunk_base(cp->next);
+  }
+}
+
+/**
+ * @brief   Restores a mark previously taken.
+ * @details All the blocks allocated after the mark has been taken are
+ *          released in a single operation.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @param[in] mp        pointer to the @p arena_mark_t object
+ *
+ * @api
+ */
+void chArenaRestore(memory_arena_t *ap, const arena_mark_t *mp) {
+
+  chDbgCheck((ap != NULL) && (mp != NULL));
+  chDbgAssert((mp->offset < ap->offset) ||
+              ((mp->chunk == ap->current) && (mp->nextmem <= ap->nextmem)),
+              "invalid mark");
+
+  arena_update_peak(ap);
+
+  ap->current = mp->chunk;
+  ap->nextmem = mp->nextmem;
+  ap->offset  = mp->offset;
+}
+
+/**
+ * @brief   Releases all the blocks allocated from an arena.
+ * @details The arena chunks are retained and will be used again by the
+ *          following allocations.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ *
+ * @api
+ */
+void chArenaReset(memory_arena_t *ap) {
+
+  chDbgCheck(ap != NULL);
+
+  arena_update_peak(ap);
+
+  ap->current = ap->first;
+  ap->nextmem = chunk_base(ap->first);
+  ap->offset  = (size_t)0;
+}
+
+/**
+ * @brief   Returns the arena statistics.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @return              Pointer to the @p arena_stats_t structure.
+ *
+ * @xclass
+ */
+const arena_stats_t *chArenaGetStatisticsX(memory_arena_t *ap) {
+
+  chDbgCheck(ap != NULL);
+
+  arena_update_peak(ap);
+
+  return &ap->stats;
+}
+
+#endif /* CH_CFG_USE_ARENAS == TRUE */
+
+/** @} */
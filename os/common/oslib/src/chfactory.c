@@ -31,6 +31,10 @@
  *          Allocated OS objects are handled using a reference counter, only
  *          when all references have been released then the object memory is
  *          freed in a pool.<br>
+ *          Objects are found by name scanning the list of their type, if
+ *          the @p CH_CFG_FACTORY_HASH_INDEX option is enabled then the
+ *          objects are also indexed by name hash so that lookups do not
+ *          depend on the number of existing objects.
  * @pre     This subsystem requires the @p CH_CFG_USE_MEMCORE and
  *          @p CH_CFG_USE_MEMPOOLS options to be set to @p TRUE. The
  *          option @p CH_CFG_USE_HEAP is also required if the support
@@ -60,6 +64,20 @@
 #define F_UNLOCK()      chSemSignal(&ch_factory.sem)
 #endif
 
+#if (CH_CFG_FACTORY_HASH_INDEX == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Mask of the hash index slot numbers.
+ */
+#define DYN_INDEX_MASK  ((uint32_t)CH_CFG_FACTORY_HASH_SIZE - 1U)
+
+/**
+ * @brief   Maximum number of indexed objects.
+ * @note    Some slots are always left empty in order to keep the probe
+ *          sequences short.
+ */
+#define DYN_INDEX_LIMIT ((ucnt_t)((CH_CFG_FACTORY_HASH_SIZE * 3) / 4))
+#endif
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -83,16 +101,136 @@ objects_factory_t ch_factory;
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_FACTORY_HASH_INDEX == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Calculates the hash of an object name.
+ * @details The FNV-1a hash of the name is used, the address of the list
+ *          is mixed in because objects of different types can have the
+ *          same name.
+ */
+static uint32_t dyn_hash(const char *name, const dyn_list_t *dlp) {
+  uint32_t h = 2166136261U;
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)CH_CFG_FACTORY_MAX_NAMES_LENGTH; i++) {
+    if (name[i] == '\0') {
+      break;
+    }
+    h = (h ^ (uint32_t)(uint8_t)name[i]) * 16777619U;
+  }
+
+  return h ^ (uint32_t)(uintptr_t)dlp;
+}
+
+static void dyn_index_insert(dyn_element_t *element, dyn_list_t *dlp) {
+  uint32_t i;
+
+  if (ch_factory.indexed >= DYN_INDEX_LIMIT) {
+    /* Index full, the object will be found by scanning its list.*/
+    dlp->unindexed++;
+    return;
+  }
+
+  /* Linear probing for a free slot.*/
+  i = element->hash & DYN_INDEX_MASK;
+  while (ch_factory.index[i] != NULL) {
+    i = (i + 1U) & DYN_INDEX_MASK;
+  }
+  ch_factory.index[i] = element;
+  ch_factory.indexed++;
+}
+
+static void dyn_index_remove(dyn_element_t *element, dyn_list_t *dlp) {
+  uint32_t i, j, k;
+
+  /* Searching the object slot.*/
+  i = element->hash & DYN_INDEX_MASK;
+  while (ch_factory.index[i] != element) {
+    if (ch_factory.index[i] == NULL) {
+      /* The object was not indexed.*/
+      dlp->unindexed--;
+      return;
+    }
+    i = (i + 1U) & DYN_INDEX_MASK;
+  }
+  ch_factory.indexed--;
+
+  /* The following objects in the same cluster are moved back into the
+     hole if it is part of their probe sequence, this way no deleted
+     markers are required.*/
+  j = (i + 1U) & DYN_INDEX_MASK;
+  while (ch_factory.index[j] != NULL) {
+    k = ch_factory.index[j]->hash & DYN_INDEX_MASK;
+    if (((j - k) & DYN_INDEX_MASK) >= ((j - i) & DYN_INDEX_MASK)) {
+      ch_factory.index[i] = ch_factory.index[j];
+      i = j;
+    }
+    j = (j + 1U) & DYN_INDEX_MASK;
+  }
+  ch_factory.index[i] = NULL;
+}
+
+static dyn_element_t *dyn_index_find(const char *name, uint32_t h) {
+  dyn_element_t *p;
+  uint32_t i;
+
+  i = h & DYN_INDEX_MASK;
+  p = ch_factory.index[i];
+  while (p != NULL) {
+    if ((p->hash == h) &&
+        (strncmp(p->name, name, CH_CFG_FACTORY_MAX_NAMES_LENGTH) == 0)) {
+      return p;
+    }
+    i = (i + 1U) & DYN_INDEX_MASK;
+    p = ch_factory.index[i];
+  }
+
+  return NULL;
+}
+#endif /* CH_CFG_FACTORY_HASH_INDEX == TRUE */
+
 static inline void dyn_list_init(dyn_list_t *dlp) {
 
   dlp->next = (dyn_element_t *)dlp;
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+  dlp->prev = (dyn_element_t *)dlp;
+  dlp->unindexed = (ucnt_t)0;
+#endif
+}
+
+static void dyn_list_link(dyn_element_t *element, dyn_list_t *dlp) {
+
+  element->next = dlp->next;
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+  element->prev = (dyn_element_t *)dlp;
+  dlp->next->prev = element;
+  element->hash = dyn_hash(element->name, dlp);
+  dyn_index_insert(element, dlp);
+#endif
+  dlp->next = element;
 }
 
 static dyn_element_t *dyn_list_find(const char *name, dyn_list_t *dlp) {
-  dyn_element_t *p = dlp->next;
+  dyn_element_t *p;
+
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+  p = dyn_index_find(name, dyn_hash(name, dlp));
+  if ((p != NULL) || (dlp->unindexed == (ucnt_t)0)) {
+    return p;
+  }
+#endif
 
+  p = dlp->next;
   while (p != (dyn_element_t *)dlp) {
     if (strncmp(p->name, name, CH_CFG_FACTORY_MAX_NAMES_LENGTH) == 0) {
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+      /* Found an object which is not indexed, adding it to the index if
+         there is space now.*/
+      if (ch_factory.indexed < DYN_INDEX_LIMIT) {
+        dlp->unindexed--;
+        dyn_index_insert(p, dlp);
+      }
+#endif
       return p;
     }
     p = p->next;
@@ -103,6 +241,14 @@ static dyn_element_t *dyn_list_find(const char *name, dyn_list_t *dlp) {
 
 static dyn_element_t *dyn_list_unlink(dyn_element_t *element,
                                       dyn_list_t *dlp) {
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+
+  element->prev->next = element->next;
+  element->next->prev = element->prev;
+  dyn_index_remove(element, dlp);
+
+  return element;
+#else
   dyn_element_t *prev = (dyn_element_t *)dlp;
 
   /* Scanning the list.*/
@@ -118,6 +264,7 @@ static dyn_element_t *dyn_list_unlink(dyn_element_t *element,
   }
 
   return NULL;
+#endif
 }
 
 #if CH_FACTORY_REQUIRES_HEAP || defined(__DOXYGEN__)
@@ -146,10 +293,9 @@ static dyn_element_t *dyn_create_object_heap(const char *name,
   strncpy(dep->name, name, CH_CFG_FACTORY_MAX_NAMES_LENGTH);
   /*lint -restore*/
   dep->refs = (ucnt_t)1;
-  dep->next = dlp->next;
 
   /* Updating factory list.*/
-  dlp->next = dep;
+  dyn_list_link(dep, dlp);
 
   return dep;
 }
@@ -195,10 +341,9 @@ static dyn_element_t *dyn_create_object_pool(const char *name,
   strncpy(dep->name, name, CH_CFG_FACTORY_MAX_NAMES_LENGTH);
   /*lint -restore*/
   dep->refs = (ucnt_t)1;
-  dep->next = dlp->next;
 
   /* Updating factory list.*/
-  dlp->next = (dyn_element_t *)dep;
+  dyn_list_link(dep, dlp);
 
   return dep;
 }
@@ -250,6 +395,11 @@ void _factory_init(void) {
   chSemObjectInit(&ch_factory.sem, (cnt_t)1);
 #endif
 
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+  memset(ch_factory.index, 0, sizeof ch_factory.index);
+  ch_factory.indexed = (ucnt_t)0;
+#endif
+
 #if CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE
   dyn_list_init(&ch_factory.obj_list);
   chPoolObjectInit(&ch_factory.obj_pool,
@@ -413,7 +563,7 @@ dyn_buffer_t *chFactoryCreateBuffer(const char *name, size_t size) {
 
   dbp = (dyn_buffer_t *)dyn_create_object_heap(name,
                                                &ch_factory.buf_list,
-                                               size);
+                                               sizeof (dyn_buffer_t) + size);
   if (dbp != NULL) {
     /* Initializing buffer object data.*/
     memset((void *)dbp->buffer, 0, size);
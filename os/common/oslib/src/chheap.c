@@ -29,12 +29,24 @@
  *          library functions. The main difference is that the OS heap APIs
  *          are guaranteed to be thread safe and there is the ability to
  *          return memory blocks aligned to arbitrary powers of two.<br>
+ *          If @p CH_CFG_HEAP_TLSF is enabled then a Two-Level Segregated
+ *          Fit strategy is used instead, free blocks are kept in lists
+ *          segregated by size class and indexed by bitmaps so that the
+ *          allocation and release times are bounded regardless of the
+ *          heap fragmentation.<br>
+ *          If @p CH_CFG_HEAP_PROFILER is enabled then allocations and
+ *          releases are recorded by call site, by size and by lifetime,
+ *          the fragmentation of the heap can be sampled over time. Each
+ *          block is followed by a tag holding its call site and its
+ *          allocation time.<br>
  * @pre     In order to use the heap APIs the @p CH_CFG_USE_HEAP option must
  *          be enabled in @p chconf.h.
  * @note    Compatible with RT and NIL.
  * @{
  */
 
+#include <string.h>
+
 #include "ch.h"
 
 #if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
@@ -66,6 +78,80 @@
 
 #define H_SIZE(hp)      ((hp)->used.size)
 
+#if (CH_CFG_HEAP_TLSF == TRUE) || defined(__DOXYGEN__)
+/*
+ * TLSF blocks state. The first header word of a free block contains its
+ * size in pages and the H_FREE flag, the first word of a used block
+ * contains its owner heap and the H_PREV_FREE flag. A null first word
+ * marks a single unit absorbed at the end of the previous used block
+ * because it was too small to become a free block.
+ */
+#define H_FREE          ((size_t)1U)
+
+#define H_PREV_FREE     ((size_t)2U)
+
+#define H_FLAGS         (H_FREE | H_PREV_FREE)
+
+#define H_TAG(hp)       ((hp)->free.pages)
+
+#define H_IS_FREE(hp)   ((H_TAG(hp) & H_FREE) != 0U)
+
+#define H_FPAGES(hp)    (H_TAG(hp) >> 2)
+
+#define H_OWNER(hp)     ((memory_heap_t *)(H_TAG(hp) & ~H_FLAGS))
+
+/*
+ * Free blocks lists back link, it is the first word of the free area.
+ */
+#define H_FPREV(hp)     (((heap_header_t **)H_BLOCK(hp))[0])
+
+/*
+ * Free blocks boundary tag, it is the last word of the free area and
+ * points to the block header.
+ */
+#define H_FOOTER(hp, pages)                                                 \
+  (((heap_header_t **)(H_BLOCK(hp) + (pages)))[-1])
+
+/*
+ * Smallest block size for which the size classes are not exact.
+ */
+#define TLSF_SL_COUNT   ((size_t)CH_HEAP_TLSF_SL_COUNT)
+
+/*
+ * Smallest block size kept in the last class regardless of its size.
+ */
+#define TLSF_MAX_PAGES                                                      \
+  ((size_t)1U << (CH_HEAP_TLSF_FL_COUNT + CH_HEAP_TLSF_SL_BITS - 1U))
+#endif /* CH_CFG_HEAP_TLSF == TRUE */
+
+#if (CH_CFG_HEAP_PROFILER == TRUE) || defined(__DOXYGEN__)
+/*
+ * Units added at the end of each block for the profiler tag, the tag is
+ * not part of the block size.
+ */
+#define H_PROF_PAGES                                                        \
+  ((sizeof (heap_tag_t) + sizeof (heap_header_t) - 1U) /                    \
+   sizeof (heap_header_t))
+
+/*
+ * Profiler tag of an used block.
+ */
+#define H_PTAG(hp)                                                          \
+  ((heap_tag_t *)(void *)(H_BLOCK(hp) +                                     \
+                          (MEM_ALIGN_NEXT(H_SIZE(hp), CH_HEAP_ALIGNMENT) /  \
+                           CH_HEAP_ALIGNMENT)))
+
+/*
+ * Profiling session tags increment, the lower bits of the tag of a block
+ * contain the index of its call site.
+ */
+#define PROF_EPOCH_INC  ((size_t)256U)
+
+#define PROF_SITE_MASK  (PROF_EPOCH_INC - 1U)
+#else
+#define H_PROF_PAGES    0U
+#endif /* CH_CFG_HEAP_PROFILER == TRUE */
+
 /*
  * Number of pages between two pointers in a MISRA-compatible way.
  */
@@ -82,6 +168,17 @@
 /* Module local types.                                                       */
 /*===========================================================================*/
 
+#if (CH_CFG_HEAP_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Profiler tag of an allocated block.
+ */
+typedef struct {
+  size_t                site;       /**< @brief Profiling session tag and
+                                                call site index.            */
+  systime_t             time;       /**< @brief Allocation time.            */
+} heap_tag_t;
+#endif
+
 /*===========================================================================*/
 /* Module local variables.                                                   */
 /*===========================================================================*/
@@ -91,10 +188,360 @@
  */
 static memory_heap_t default_heap;
 
+#if (CH_CFG_HEAP_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Default heap profiler.
+ */
+static heap_profiler_t default_profiler;
+
+/**
+ * @brief   Last profiling session tag.
+ */
+static size_t prof_epoch;
+#endif
+
 /*===========================================================================*/
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_HEAP_TLSF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Index of the most significant bit set in a non-zero word.
+ * @note    Ports can provide an optimized @p port_clz() macro, the compiler
+ *          builtin or a constant time software fallback is used otherwise.
+ *
+ * @param[in] w         the word to be scanned, must not be zero
+ * @return              The bit index.
+ *
+ * @notapi
+ */
+static inline unsigned tlsf_msb(uint32_t w) {
+#if defined(port_clz)
+  return 31U - (unsigned)port_clz(w);
+#elif defined(__GNUC__)
+  return 31U - (unsigned)__builtin_clz(w);
+#else
+  unsigned n = 0U;
+
+  if ((w & 0xFFFF0000U) != 0U) {n += 16U; w >>= 16;}
+  if ((w & 0x0000FF00U) != 0U) {n +=  8U; w >>=  8;}
+  if ((w & 0x000000F0U) != 0U) {n +=  4U; w >>=  4;}
+  if ((w & 0x0000000CU) != 0U) {n +=  2U; w >>=  2;}
+  if ((w & 0x00000002U) != 0U) {n +=  1U;}
+
+  return n;
+#endif
+}
+
+/**
+ * @brief   Index of the least significant bit set in a non-zero word.
+ *
+ * @param[in] w         the word to be scanned, must not be zero
+ * @return              The bit index.
+ *
+ * @notapi
+ */
+static inline unsigned tlsf_lsb(uint32_t w) {
+
+  return tlsf_msb(w & (~w + 1U));
+}
+
+/**
+ * @brief   Size class of a free block.
+ *
+ * @param[in] pages     size of the block area in pages
+ * @param[out] flp      first level index
+ * @param[out] slp      second level index
+ *
+ * @notapi
+ */
+static void tlsf_mapping(size_t pages, unsigned *flp, unsigned *slp) {
+
+  if (pages < TLSF_SL_COUNT) {
+    *flp = 0U;
+    *slp = (unsigned)pages;
+  }
+  else if (pages >= TLSF_MAX_PAGES) {
+    *flp = CH_HEAP_TLSF_FL_COUNT - 1U;
+    *slp = CH_HEAP_TLSF_SL_COUNT - 1U;
+  }
+  else {
+    unsigned m = tlsf_msb((uint32_t)pages);
+
+    *flp = (m - CH_HEAP_TLSF_SL_BITS) + 1U;
+    *slp = (unsigned)(pages >> (m - CH_HEAP_TLSF_SL_BITS)) -
+           CH_HEAP_TLSF_SL_COUNT;
+  }
+}
+
+/**
+ * @brief   Inserts a free block in the list of its size class.
+ *
+ * @param[in] heapp     pointer to the heap
+ * @param[in] hp        pointer to the free block header
+ *
+ * @notapi
+ */
+static void tlsf_insert(memory_heap_t *heapp, heap_header_t *hp) {
+  unsigned fl, sl;
+
+  tlsf_mapping(H_FPAGES(hp), &fl, &sl);
+  H_NEXT(hp) = heapp->free[fl][sl];
+  H_FPREV(hp) = NULL;
+  if (H_NEXT(hp) != NULL) {
+    H_FPREV(H_NEXT(hp)) = hp;
+  }
+  heapp->free[fl][sl] = hp;
+  heapp->fl_map |= (uint32_t)1U << fl;
+  heapp->sl_map[fl] |= (uint32_t)1U << sl;
+}
+
+/**
+ * @brief   Removes a free block from the list of its size class.
+ *
+ * @param[in] heapp     pointer to the heap
+ * @param[in] hp        pointer to the free block header
+ *
+ * @notapi
+ */
+static void tlsf_remove(memory_heap_t *heapp, heap_header_t *hp) {
+  unsigned fl, sl;
+
+  tlsf_mapping(H_FPAGES(hp), &fl, &sl);
+  if (H_NEXT(hp) != NULL) {
+    H_FPREV(H_NEXT(hp)) = H_FPREV(hp);
+  }
+  if (H_FPREV(hp) != NULL) {
+    H_NEXT(H_FPREV(hp)) = H_NEXT(hp);
+  }
+  else {
+    heapp->free[fl][sl] = H_NEXT(hp);
+    if (H_NEXT(hp) == NULL) {
+      heapp->sl_map[fl] &= ~((uint32_t)1U << sl);
+      if (heapp->sl_map[fl] == 0U) {
+        heapp->fl_map &= ~((uint32_t)1U << fl);
+      }
+    }
+  }
+}
+
+/**
+ * @brief   Marks a block as free.
+ * @details The block size, flag and boundary tag are written and the
+ *          following block is notified.
+ *
+ * @param[in] hp        pointer to the block header
+ * @param[in] pages     size of the block area in pages, at least one
+ *
+ * @notapi
+ */
+static void tlsf_set_free(heap_header_t *hp, size_t pages) {
+
+  H_TAG(hp) = (pages << 2) | H_FREE;
+  H_FOOTER(hp, pages) = hp;
+  H_TAG(H_BLOCK(hp) + pages) |= H_PREV_FREE;
+}
+
+/**
+ * @brief   Finds a free block with an area of at least the specified size.
+ * @details The size is rounded up to the next size class so that any
+ *          block in the first non-empty class is large enough, the lists
+ *          are not scanned. If no such class exists then the first block
+ *          of the class containing the size is tried as last chance.
+ *
+ * @param[in] heapp     pointer to the heap
+ * @param[in] pages     minimum size of the block area in pages
+ * @return              Pointer to the free block header.
+ * @retval NULL         if a block has not been found.
+ *
+ * @notapi
+ */
+static heap_header_t *tlsf_find(memory_heap_t *heapp, size_t pages) {
+  heap_header_t *hp;
+  size_t rpages = pages;
+  unsigned fl, sl;
+
+  if ((pages >= TLSF_SL_COUNT) && (pages < TLSF_MAX_PAGES)) {
+    rpages += ((size_t)1U << (tlsf_msb((uint32_t)pages) -
+                              CH_HEAP_TLSF_SL_BITS)) - 1U;
+  }
+
+  if (rpages < TLSF_MAX_PAGES) {
+    uint32_t map;
+
+    tlsf_mapping(rpages, &fl, &sl);
+    map = heapp->sl_map[fl] & (~(uint32_t)0U << sl);
+    if (map == 0U) {
+      map = heapp->fl_map & (~(uint32_t)0U << (fl + 1U));
+      if (map != 0U) {
+        fl = tlsf_lsb(map);
+        map = heapp->sl_map[fl];
+      }
+    }
+    if (map != 0U) {
+      return heapp->free[fl][tlsf_lsb(map)];
+    }
+  }
+
+  /* Last chance, the first block of the class containing the size.*/
+  tlsf_mapping(pages, &fl, &sl);
+  hp = heapp->free[fl][sl];
+  if ((hp != NULL) && (H_FPAGES(hp) >= pages)) {
+    return hp;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Pointer to the first aligned area fitting in a free block.
+ * @details If the area is not at the start of the block then the space
+ *          before it must be able to contain a free block.
+ *
+ * @param[in] hp        pointer to the free block header
+ * @param[in] align     desired memory alignment
+ * @return              Pointer to the header of the aligned area.
+ *
+ * @notapi
+ */
+static heap_header_t *tlsf_align(heap_header_t *hp, unsigned align) {
+  heap_header_t *ahp;
+
+  ahp = (heap_header_t *)MEM_ALIGN_NEXT(H_BLOCK(hp), align) - 1U;
+  if (ahp == hp + 1U) {
+    ahp = (heap_header_t *)((uint8_t *)ahp + align);
+  }
+
+  return ahp;
+}
+
+/**
+ * @brief   Initializes a free memory region.
+ * @details The region is terminated by an used block header without area
+ *          so that the free block can never be merged beyond it.
+ *
+ * @param[in] heapp     pointer to the heap
+ * @param[in] hp        pointer to the region base
+ * @param[in] units     region size in allocation units, at least three
+ *
+ * @notapi
+ */
+static void tlsf_add_region(memory_heap_t *heapp, heap_header_t *hp,
+                            size_t units) {
+  heap_header_t *ehp = hp + (units - 1U);
+
+  H_TAG(ehp) = (size_t)heapp;
+  H_SIZE(ehp) = 0U;
+  tlsf_set_free(hp, units - 2U);
+  tlsf_insert(heapp, hp);
+}
+#endif /* CH_CFG_HEAP_TLSF == TRUE */
+
+#if (CH_CFG_HEAP_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Histogram bucket of a value.
+ *
+ * @param[in] v         the value
+ * @return              The bucket index.
+ *
+ * @notapi
+ */
+static unsigned prof_bucket(size_t v) {
+  unsigned b = 0U;
+
+  while ((v > 1U) && (b < (CH_HEAP_PROFILER_BUCKETS - 1U))) {
+    v >>= 1;
+    b++;
+  }
+
+  return b;
+}
+
+/**
+ * @brief   Records an allocation.
+ * @details The block tag is written, the allocation is accounted if the
+ *          heap is being profiled.
+ * @note    Must be invoked with the heap locked.
+ *
+ * @param[in] heapp     pointer to the heap
+ * @param[in] hp        pointer to the allocated block header
+ * @param[in] caller    call site of the allocation
+ *
+ * @notapi
+ */
+static void prof_alloc(memory_heap_t *heapp, heap_header_t *hp,
+                       const void *caller) {
+  heap_profiler_t *hpp = heapp->profiler;
+  heap_tag_t *tp = H_PTAG(hp);
+  size_t size = H_SIZE(hp);
+  heap_site_t *sp;
+  unsigned i;
+
+  tp->time = chVTGetSystemTimeX();
+  if (hpp == NULL) {
+    tp->site = (size_t)0;
+    return;
+  }
+
+  /* Searching the call site record, the last entry is used if the table
+     is full.*/
+  for (i = 0U; i < (CH_HEAP_PROFILER_SITES - 1U); i++) {
+    if (hpp->sites[i].site == caller) {
+      break;
+    }
+    if (hpp->sites[i].site == NULL) {
+      hpp->sites[i].site = caller;
+      break;
+    }
+  }
+  sp = &hpp->sites[i];
+  tp->site = hpp->epoch | (size_t)i;
+
+  /* Updating counters.*/
+  sp->allocs++;
+  sp->live += size;
+  if (sp->live > sp->peak) {
+    sp->peak = sp->live;
+  }
+  hpp->allocs++;
+  hpp->live += size;
+  if (hpp->live > hpp->peak) {
+    hpp->peak = hpp->live;
+  }
+  hpp->sizes[prof_bucket(size)]++;
+}
+
+/**
+ * @brief   Records a release.
+ * @details The release is accounted only if the block has been allocated
+ *          in the current profiling session.
+ * @note    Must be invoked with the heap locked.
+ *
+ * @param[in] heapp     pointer to the heap
+ * @param[in] hp        pointer to the block header
+ *
+ * @notapi
+ */
+static void prof_free(memory_heap_t *heapp, heap_header_t *hp) {
+  heap_profiler_t *hpp = heapp->profiler;
+  heap_tag_t *tp = H_PTAG(hp);
+
+  if ((hpp != NULL) && ((tp->site & ~PROF_SITE_MASK) == hpp->epoch)) {
+    heap_site_t *sp = &hpp->sites[tp->site & PROF_SITE_MASK];
+    size_t size = H_SIZE(hp);
+
+    chDbgAssert((tp->site & PROF_SITE_MASK) < CH_HEAP_PROFILER_SITES,
+                "invalid tag");
+
+    sp->frees++;
+    sp->live -= size;
+    hpp->frees++;
+    hpp->live -= size;
+    hpp->lifetimes[prof_bucket((size_t)chVTTimeElapsedSinceX(tp->time))]++;
+  }
+}
+#endif /* CH_CFG_HEAP_PROFILER == TRUE */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -107,13 +554,24 @@ static memory_heap_t default_heap;
 void _heap_init(void) {
 
   default_heap.provider = chCoreAllocAlignedWithOffset;
+#if CH_CFG_HEAP_TLSF == TRUE
+  memset(default_heap.free, 0, sizeof default_heap.free);
+  memset(default_heap.sl_map, 0, sizeof default_heap.sl_map);
+  default_heap.fl_map = 0U;
+#else /* CH_CFG_HEAP_TLSF == FALSE */
   H_NEXT(&default_heap.header) = NULL;
   H_PAGES(&default_heap.header) = 0;
+#endif /* CH_CFG_HEAP_TLSF == FALSE */
 #if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
   chMtxObjectInit(&default_heap.mtx);
 #else
   chSemObjectInit(&default_heap.sem, (cnt_t)1);
 #endif
+#if CH_CFG_HEAP_PROFILER == TRUE
+  prof_epoch = PROF_EPOCH_INC;
+  default_profiler.epoch = prof_epoch;
+  default_heap.profiler = &default_profiler;
+#endif
 }
 
 /**
@@ -141,17 +599,71 @@ void chHeapObjectInit(memory_heap_t *heapp, void *buf, size_t size) {
 
   /* Initializing the heap header.*/
   heapp->provider = NULL;
+#if CH_CFG_HEAP_TLSF == TRUE
+  chDbgCheck(size >= (3U * sizeof (heap_header_t)));
+
+  memset(heapp->free, 0, sizeof heapp->free);
+  memset(heapp->sl_map, 0, sizeof heapp->sl_map);
+  heapp->fl_map = 0U;
+  tlsf_add_region(heapp, hp, size / sizeof (heap_header_t));
+#else /* CH_CFG_HEAP_TLSF == FALSE */
   H_NEXT(&heapp->header) = hp;
   H_PAGES(&heapp->header) = 0;
   H_NEXT(hp) = NULL;
   H_PAGES(hp) = (size - sizeof (heap_header_t)) / CH_HEAP_ALIGNMENT;
+#endif /* CH_CFG_HEAP_TLSF == FALSE */
 #if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
   chMtxObjectInit(&heapp->mtx);
 #else
   chSemObjectInit(&heapp->sem, (cnt_t)1);
 #endif
+#if CH_CFG_HEAP_PROFILER == TRUE
+  heapp->profiler = NULL;
+#endif
 }
 
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a memory heap in a memory region.
+ * @details The heap buffer is allocated from the specified memory region,
+ *          the blocks allocated from the heap, for example the working
+ *          areas of threads created using @p chThdCreateFromHeap(), are
+ *          then placed in that region.
+ * @note    The heap has no provider, its size cannot grow after the
+ *          initialization.
+ *
+ * @param[out] heapp    pointer to the memory heap descriptor to be initialized
+ * @param[in] rp        pointer to the memory region or @p NULL for the
+ *                      default core memory region
+ * @param[in] size      heap size, zero means all the free region memory
+ * @return              The operation status.
+ * @retval false        if the heap has been initialized.
+ * @retval true         if the region has not enough free memory.
+ *
+ * @api
+ */
+bool chHeapObjectInitFromRegion(memory_heap_t *heapp,
+                                memory_region_t *rp,
+                                size_t size) {
+  void *buf;
+
+  chSysLock();
+  if (size == 0U) {
+    size = chCoreGetRegionStatusX(rp);
+  }
+  buf = chCoreAllocFromRegionAlignedWithOffsetI(rp, size, 1U, 0U);
+  chSysUnlock();
+
+  if ((buf == NULL) || (size == 0U)) {
+    return true;
+  }
+
+  chHeapObjectInit(heapp, buf, size);
+
+  return false;
+}
+#endif /* CH_CFG_USE_MEMCORE_REGIONS == TRUE */
+
 /**
  * @brief   Allocates a block of memory from the heap by using the first-fit
  *          algorithm.
@@ -170,8 +682,15 @@ void chHeapObjectInit(memory_heap_t *heapp, void *buf, size_t size) {
  * @api
  */
 void *chHeapAllocAligned(memory_heap_t *heapp, size_t size, unsigned align) {
+#if CH_CFG_HEAP_TLSF == TRUE
+  heap_header_t *hp, *ahp;
+#else
   heap_header_t *qp, *hp, *ahp;
+#endif
   size_t pages;
+#if CH_CFG_HEAP_PROFILER == TRUE
+  const void *caller = CH_HEAP_PROFILER_CALLER();
+#endif
 
   chDbgCheck((size > 0U) && MEM_IS_VALID_ALIGNMENT(align));
 
@@ -185,12 +704,75 @@ void *chHeapAllocAligned(memory_heap_t *heapp, size_t size, unsigned align) {
     align = CH_HEAP_ALIGNMENT;
   }
 
-  /* Size is converted in number of elementary allocation units.*/
-  pages = MEM_ALIGN_NEXT(size, CH_HEAP_ALIGNMENT) / CH_HEAP_ALIGNMENT;
+  /* Size is converted in number of elementary allocation units, the
+     profiler tag is included.*/
+  pages = (MEM_ALIGN_NEXT(size, CH_HEAP_ALIGNMENT) / CH_HEAP_ALIGNMENT) +
+          H_PROF_PAGES;
 
   /* Taking heap mutex/semaphore.*/
   H_LOCK(heapp);
 
+#if CH_CFG_HEAP_TLSF == TRUE
+  {
+    size_t epages = 0U;
+
+    /* Worst case space required before an aligned area.*/
+    if (align > CH_HEAP_ALIGNMENT) {
+      epages = ((size_t)align / CH_HEAP_ALIGNMENT) + 1U;
+    }
+
+    hp = tlsf_find(heapp, pages + epages);
+    if (hp != NULL) {
+      heap_header_t *fp;
+      size_t bpages;
+
+      tlsf_remove(heapp, hp);
+      bpages = H_FPAGES(hp);
+
+      ahp = hp;
+      if (align > CH_HEAP_ALIGNMENT) {
+        ahp = tlsf_align(hp, align);
+      }
+      if (ahp > hp) {
+        /* The block is not properly aligned, the space before the
+           aligned area becomes a free block.*/
+        tlsf_set_free(hp, NPAGES(ahp, hp) - 1U);
+        tlsf_insert(heapp, hp);
+        bpages -= NPAGES(ahp, hp);
+      }
+
+      fp = H_BLOCK(ahp) + pages;
+      if (bpages - pages >= 2U) {
+        /* The block is bigger than required, the excess becomes a free
+           block.*/
+        tlsf_set_free(fp, (bpages - pages) - 1U);
+        tlsf_insert(heapp, fp);
+      }
+      else {
+        if (bpages - pages == 1U) {
+          /* The excess is too small for a free block, it is absorbed.*/
+          H_TAG(fp) = 0U;
+          fp++;
+        }
+        H_TAG(fp) &= ~H_PREV_FREE;
+      }
+
+      /* Setting in the block owner heap and size.*/
+      H_TAG(ahp) = (size_t)heapp | ((ahp > hp) ? H_PREV_FREE : 0U);
+      H_SIZE(ahp) = size;
+#if CH_CFG_HEAP_PROFILER == TRUE
+      prof_alloc(heapp, ahp, caller);
+#endif
+
+      /* Releasing heap mutex/semaphore.*/
+      H_UNLOCK(heapp);
+
+      /*lint -save -e9087 [11.3] Safe cast.*/
+      return (void *)H_BLOCK(ahp);
+      /*lint -restore*/
+    }
+  }
+#else /* CH_CFG_HEAP_TLSF == FALSE */
   /* Start of the free blocks list.*/
   qp = &heapp->header;
   while (H_NEXT(qp) != NULL) {
@@ -247,6 +829,9 @@ void *chHeapAllocAligned(memory_heap_t *heapp, size_t size, unsigned align) {
       /* Setting in the block owner heap and size.*/
       H_SIZE(hp) = size;
       H_HEAP(hp) = heapp;
+#if CH_CFG_HEAP_PROFILER == TRUE
+      prof_alloc(heapp, hp, caller);
+#endif
 
       /* Releasing heap mutex/semaphore.*/
       H_UNLOCK(heapp);
@@ -259,6 +844,7 @@ void *chHeapAllocAligned(memory_heap_t *heapp, size_t size, unsigned align) {
     /* Next in the free blocks list.*/
     qp = hp;
   }
+#endif /* CH_CFG_HEAP_TLSF == FALSE */
 
   /* Releasing heap mutex/semaphore.*/
   H_UNLOCK(heapp);
@@ -266,13 +852,29 @@ void *chHeapAllocAligned(memory_heap_t *heapp, size_t size, unsigned align) {
   /* More memory is required, tries to get it from the associated provider
      else fails.*/
   if (heapp->provider != NULL) {
+#if CH_CFG_HEAP_TLSF == TRUE
+    /* In TLSF mode the block is followed by a region terminator.*/
+    ahp = heapp->provider((pages + 2U) * CH_HEAP_ALIGNMENT,
+                          align,
+                          sizeof (heap_header_t));
+#else
     ahp = heapp->provider((pages + 1U) * CH_HEAP_ALIGNMENT,
                           align,
                           sizeof (heap_header_t));
+#endif
     if (ahp != NULL) {
       hp = ahp - 1U;
       H_HEAP(hp) = heapp;
       H_SIZE(hp) = size;
+#if CH_CFG_HEAP_TLSF == TRUE
+      H_HEAP(H_BLOCK(hp) + pages) = heapp;
+      H_SIZE(H_BLOCK(hp) + pages) = 0U;
+#endif
+#if CH_CFG_HEAP_PROFILER == TRUE
+      H_LOCK(heapp);
+      prof_alloc(heapp, hp, caller);
+      H_UNLOCK(heapp);
+#endif
 
       /*lint -save -e9087 [11.3] Safe cast.*/
       return (void *)ahp;
@@ -280,6 +882,14 @@ void *chHeapAllocAligned(memory_heap_t *heapp, size_t size, unsigned align) {
     }
   }
 
+#if CH_CFG_HEAP_PROFILER == TRUE
+  H_LOCK(heapp);
+  if (heapp->profiler != NULL) {
+    heapp->profiler->failures++;
+  }
+  H_UNLOCK(heapp);
+#endif
+
   return NULL;
 }
 
@@ -293,22 +903,66 @@ void *chHeapAllocAligned(memory_heap_t *heapp, size_t size, unsigned align) {
 void chHeapFree(void *p) {
   heap_header_t *qp, *hp;
   memory_heap_t *heapp;
+#if CH_CFG_HEAP_TLSF == TRUE
+  size_t pages;
+#endif
 
   chDbgCheck((p != NULL) && MEM_IS_ALIGNED(p, CH_HEAP_ALIGNMENT));
 
   /*lint -save -e9087 [11.3] Safe cast.*/
   hp = (heap_header_t *)p - 1U;
   /*lint -restore*/
+#if CH_CFG_HEAP_TLSF == TRUE
+  chDbgAssert(!H_IS_FREE(hp) && (H_TAG(hp) != 0U), "not allocated");
+
+  heapp = H_OWNER(hp);
+  pages = (MEM_ALIGN_NEXT(H_SIZE(hp), CH_HEAP_ALIGNMENT) / CH_HEAP_ALIGNMENT) +
+          H_PROF_PAGES;
+
+  /* Taking heap mutex/semaphore.*/
+  H_LOCK(heapp);
+
+#if CH_CFG_HEAP_PROFILER == TRUE
+  prof_free(heapp, hp);
+#endif
+
+  /* Unit absorbed at the end of the block.*/
+  qp = H_BLOCK(hp) + pages;
+  if (H_TAG(qp) == 0U) {
+    pages++;
+    qp++;
+  }
+
+  if (H_IS_FREE(qp)) {
+    /* Merge with the next block.*/
+    tlsf_remove(heapp, qp);
+    pages += H_FPAGES(qp) + 1U;
+  }
+  if ((H_TAG(hp) & H_PREV_FREE) != 0U) {
+    /* Merge with the previous block, found using its boundary tag.*/
+    qp = ((heap_header_t **)hp)[-1];
+    tlsf_remove(heapp, qp);
+    pages += H_FPAGES(qp) + 1U;
+    hp = qp;
+  }
+  tlsf_set_free(hp, pages);
+  tlsf_insert(heapp, hp);
+#else /* CH_CFG_HEAP_TLSF == FALSE */
   heapp = H_HEAP(hp);
   qp = &heapp->header;
 
-  /* Size is converted in number of elementary allocation units.*/
-  H_PAGES(hp) = MEM_ALIGN_NEXT(H_SIZE(hp),
-                               CH_HEAP_ALIGNMENT) / CH_HEAP_ALIGNMENT;
-
   /* Taking heap mutex/semaphore.*/
   H_LOCK(heapp);
 
+#if CH_CFG_HEAP_PROFILER == TRUE
+  prof_free(heapp, hp);
+#endif
+
+  /* Size is converted in number of elementary allocation units.*/
+  H_PAGES(hp) = (MEM_ALIGN_NEXT(H_SIZE(hp),
+                                CH_HEAP_ALIGNMENT) / CH_HEAP_ALIGNMENT) +
+                H_PROF_PAGES;
+
   while (true) {
     chDbgAssert((hp < qp) || (hp >= H_LIMIT(qp)), "within free block");
 
@@ -332,6 +986,7 @@ void chHeapFree(void *p) {
     }
     qp = H_NEXT(qp);
   }
+#endif /* CH_CFG_HEAP_TLSF == FALSE */
 
   /* Releasing heap mutex/semaphore.*/
   H_UNLOCK(heapp);
@@ -343,6 +998,9 @@ void chHeapFree(void *p) {
  * @brief   Reports the heap status.
  * @note    This function is meant to be used in the test suite, it should
  *          not be really useful for the application code.
+ * @note    If the heap profiler is enabled then the space taken by the
+ *          tag of a block is excluded from the reported sizes so that the
+ *          reported sizes can be allocated.
  *
  * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
  *                      access the default heap.
@@ -366,10 +1024,36 @@ size_t chHeapStatus(memory_heap_t *heapp, size_t *totalp, size_t *largestp) {
   tpages = 0U;
   lpages = 0U;
   n = 0U;
+#if CH_CFG_HEAP_TLSF == TRUE
+  {
+    unsigned fl, sl;
+
+    for (fl = 0U; fl < CH_HEAP_TLSF_FL_COUNT; fl++) {
+      for (sl = 0U; sl < CH_HEAP_TLSF_SL_COUNT; sl++) {
+        for (qp = heapp->free[fl][sl]; qp != NULL; qp = H_NEXT(qp)) {
+          size_t pages = H_FPAGES(qp);
+
+          /* Excluding the space of the profiler tag.*/
+          pages = (pages > H_PROF_PAGES) ? pages - H_PROF_PAGES : 0U;
+
+          /* Updating counters.*/
+          n++;
+          tpages += pages;
+          if (pages > lpages) {
+            lpages = pages;
+          }
+        }
+      }
+    }
+  }
+#else /* CH_CFG_HEAP_TLSF == FALSE */
   qp = &heapp->header;
   while (H_NEXT(qp) != NULL) {
     size_t pages = H_PAGES(H_NEXT(qp));
 
+    /* Excluding the space of the profiler tag.*/
+    pages = (pages > H_PROF_PAGES) ? pages - H_PROF_PAGES : 0U;
+
     /* Updating counters.*/
     n++;
     tpages += pages;
@@ -379,6 +1063,7 @@ size_t chHeapStatus(memory_heap_t *heapp, size_t *totalp, size_t *largestp) {
 
     qp = H_NEXT(qp);
   }
+#endif /* CH_CFG_HEAP_TLSF == FALSE */
 
   /* Writing out fragmented free memory.*/
   if (totalp != NULL) {
@@ -394,6 +1079,148 @@ size_t chHeapStatus(memory_heap_t *heapp, size_t *totalp, size_t *largestp) {
   return n;
 }
 
+#if (CH_CFG_HEAP_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts profiling a heap.
+ * @details The profiler object is cleared and associated to the heap, the
+ *          releases of blocks allocated before the start are not
+ *          accounted.
+ * @note    The default heap is profiled from the system start using an
+ *          internal profiler object.
+ *
+ * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
+ *                      access the default heap.
+ * @param[out] hpp      pointer to the @p heap_profiler_t object
+ *
+ * @api
+ */
+void chHeapProfilerStart(memory_heap_t *heapp, heap_profiler_t *hpp) {
+  size_t epoch;
+
+  chDbgCheck(hpp != NULL);
+
+  if (heapp == NULL) {
+    heapp = &default_heap;
+  }
+
+  /* New session tag, zero is reserved for the blocks not profiled.*/
+  chSysLock();
+  do {
+    prof_epoch += PROF_EPOCH_INC;
+  } while (prof_epoch == (size_t)0);
+  epoch = prof_epoch;
+  chSysUnlock();
+
+  H_LOCK(heapp);
+  memset(hpp, 0, sizeof (heap_profiler_t));
+  hpp->epoch = epoch;
+  heapp->profiler = hpp;
+  H_UNLOCK(heapp);
+}
+
+/**
+ * @brief   Stops profiling a heap.
+ * @details The profiler object retains the collected data.
+ *
+ * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
+ *                      access the default heap.
+ *
+ * @api
+ */
+void chHeapProfilerStop(memory_heap_t *heapp) {
+
+  if (heapp == NULL) {
+    heapp = &default_heap;
+  }
+
+  H_LOCK(heapp);
+  heapp->profiler = NULL;
+  H_UNLOCK(heapp);
+}
+
+/**
+ * @brief   Samples the heap fragmentation.
+ * @details The fragmentation index is the fraction of the free memory not
+ *          contained in the largest free block, it is zero when the free
+ *          memory is contiguous. If the heap is being profiled then the
+ *          sample is stored in the profiler history.
+ * @note    The heap free blocks are scanned, this function is meant to be
+ *          invoked periodically from a low priority thread.
+ *
+ * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
+ *                      access the default heap.
+ * @return              The fragmentation index in thousandths.
+ *
+ * @api
+ */
+unsigned chHeapProfilerSample(memory_heap_t *heapp) {
+  size_t total, largest;
+  unsigned index;
+
+  if (heapp == NULL) {
+    heapp = &default_heap;
+  }
+
+  (void)chHeapStatus(heapp, &total, &largest);
+  index = 0U;
+  if (total > 0U) {
+    index = 1000U - (unsigned)(((uint64_t)largest * 1000U) / total);
+  }
+
+  H_LOCK(heapp);
+  if (heapp->profiler != NULL) {
+    heap_profiler_t *hpp = heapp->profiler;
+    heap_sample_t *smp = &hpp->history[hpp->nextsample];
+
+    smp->time    = chVTGetSystemTimeX();
+    smp->total   = total;
+    smp->largest = largest;
+    smp->index   = index;
+    hpp->nextsample = (hpp->nextsample + 1U) % CH_HEAP_PROFILER_HISTORY;
+    if (hpp->nsamples < CH_HEAP_PROFILER_HISTORY) {
+      hpp->nsamples++;
+    }
+  }
+  H_UNLOCK(heapp);
+
+  return index;
+}
+
+/**
+ * @brief   Copies the profiler data of a heap.
+ * @details The data is copied with the heap locked so that the copy is
+ *          consistent.
+ *
+ * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
+ *                      access the default heap.
+ * @param[out] hpp      pointer to the @p heap_profiler_t object receiving
+ *                      the copy
+ * @return              The operation status.
+ * @retval false        if the data has been copied.
+ * @retval true         if the heap is not being profiled.
+ *
+ * @api
+ */
+bool chHeapProfilerSnapshot(memory_heap_t *heapp, heap_profiler_t *hpp) {
+  bool result = true;
+
+  chDbgCheck(hpp != NULL);
+
+  if (heapp == NULL) {
+    heapp = &default_heap;
+  }
+
+  H_LOCK(heapp);
+  if (heapp->profiler != NULL) {
+    *hpp = *heapp->profiler;
+    result = false;
+  }
+  H_UNLOCK(heapp);
+
+  return result;
+}
+#endif /* CH_CFG_HEAP_PROFILER == TRUE */
+
 #endif /* CH_CFG_USE_HEAP == TRUE */
 
 /** @} */
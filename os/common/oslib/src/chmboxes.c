@@ -135,6 +135,8 @@ void chMBResetI(mailbox_t *mbp) {
   chDbgCheckClassI();
   chDbgCheck(mbp != NULL);
 
+  _trace_mbox(CH_TRACE_EVENT_RESET, mbp, 0);
+
   mbp->wrptr = mbp->buffer;
   mbp->rdptr = mbp->buffer;
   mbp->cnt   = (size_t)0;
@@ -210,6 +212,7 @@ msg_t chMBPostTimeoutS(mailbox_t *mbp, msg_t msg, sysinterval_t timeout) {
         mbp->wrptr = mbp->buffer;
       }
       mbp->cnt++;
+      _trace_mbox(CH_TRACE_EVENT_POST, mbp, msg);
 
       /* If there is a reader waiting then makes it ready.*/
       chThdDequeueNextI(&mbp->qr, MSG_OK);
@@ -257,6 +260,7 @@ msg_t chMBPostI(mailbox_t *mbp, msg_t msg) {
       mbp->wrptr = mbp->buffer;
     }
     mbp->cnt++;
+    _trace_mbox(CH_TRACE_EVENT_POST, mbp, msg);
 
     /* If there is a reader waiting then makes it ready.*/
     chThdDequeueNextI(&mbp->qr, MSG_OK);
@@ -335,6 +339,7 @@ msg_t chMBPostAheadTimeoutS(mailbox_t *mbp, msg_t msg, sysinterval_t timeout) {
       }
       *mbp->rdptr = msg;
       mbp->cnt++;
+      _trace_mbox(CH_TRACE_EVENT_POST, mbp, msg);
 
       /* If there is a reader waiting then makes it ready.*/
       chThdDequeueNextI(&mbp->qr, MSG_OK);
@@ -382,6 +387,7 @@ msg_t chMBPostAheadI(mailbox_t *mbp, msg_t msg) {
     }
     *mbp->rdptr = msg;
     mbp->cnt++;
+    _trace_mbox(CH_TRACE_EVENT_POST, mbp, msg);
 
     /* If there is a reader waiting then makes it ready.*/
     chThdDequeueNextI(&mbp->qr, MSG_OK);
@@ -460,6 +466,7 @@ msg_t chMBFetchTimeoutS(mailbox_t *mbp, msg_t *msgp, sysinterval_t timeout) {
         mbp->rdptr = mbp->buffer;
       }
       mbp->cnt--;
+      _trace_mbox(CH_TRACE_EVENT_FETCH, mbp, *msgp);
 
       /* If there is a writer waiting then makes it ready.*/
       chThdDequeueNextI(&mbp->qw, MSG_OK);
@@ -507,6 +514,7 @@ msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp) {
       mbp->rdptr = mbp->buffer;
     }
     mbp->cnt--;
+    _trace_mbox(CH_TRACE_EVENT_FETCH, mbp, *msgp);
 
     /* If there is a writer waiting then makes it ready.*/
     chThdDequeueNextI(&mbp->qw, MSG_OK);
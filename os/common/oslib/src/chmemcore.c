@@ -37,13 +37,20 @@
  *          can coexist and share the main memory.<br>
  *          This allocator, alone, is also useful for very simple
  *          applications that just require a simple way to get memory
- *          blocks.
+ *          blocks.<br>
+ *          Optionally, additional memory regions can be registered, for
+ *          example tightly coupled or non-cacheable RAM. Each region has
+ *          a name and a set of attributes, blocks can be allocated from
+ *          a specific region or from any region having the required
+ *          attributes.
  * @pre     In order to use the core memory manager APIs the @p CH_CFG_USE_MEMCORE
  *          option must be enabled in @p chconf.h.
  * @note    Compatible with RT and NIL.
  * @{
  */
 
+#include <string.h>
+
 #include "ch.h"
 
 #if (CH_CFG_USE_MEMCORE == TRUE) || defined(__DOXYGEN__)
@@ -69,6 +76,37 @@ memcore_t ch_memcore;
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Allocates a memory block from a memory area.
+ *
+ * @param[in,out] nextmemp  pointer to the next free address of the area
+ * @param[in] endmem        final address of the area
+ * @param[in] size          the size of the block to be allocated.
+ * @param[in] align         desired memory alignment
+ * @param[in] offset        aligned pointer offset
+ * @return                  A pointer to the allocated memory block.
+ * @retval NULL             allocation failed, area memory exhausted.
+ *
+ * @notapi
+ */
+static void *core_alloc(uint8_t **nextmemp, uint8_t *endmem,
+                        size_t size, unsigned align, size_t offset) {
+  uint8_t *p, *next;
+
+  size = MEM_ALIGN_NEXT(size, align);
+  p = (uint8_t *)MEM_ALIGN_NEXT(*nextmemp + offset, align);
+  next = p + size;
+
+  /* Considering also the case where there is numeric overflow.*/
+  if ((next > endmem) || (next < *nextmemp)) {
+    return NULL;
+  }
+
+  *nextmemp = next;
+
+  return p;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -93,6 +131,9 @@ void _core_init(void) {
   ch_memcore.nextmem = &static_heap[0];
   ch_memcore.endmem  = &static_heap[CH_CFG_MEMCORE_SIZE];
 #endif
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  ch_memcore.regions = NULL;
+#endif
 }
 
 /**
@@ -112,23 +153,12 @@ void _core_init(void) {
 void *chCoreAllocAlignedWithOffsetI(size_t size,
                                     unsigned align,
                                     size_t offset) {
-  uint8_t *p, *next;
 
   chDbgCheckClassI();
   chDbgCheck(MEM_IS_VALID_ALIGNMENT(align));
 
-  size = MEM_ALIGN_NEXT(size, align);
-  p = (uint8_t *)MEM_ALIGN_NEXT(ch_memcore.nextmem + offset, align);
-  next = p + size;
-
-  /* Considering also the case where there is numeric overflow.*/
-  if ((next > ch_memcore.endmem) || (next < ch_memcore.nextmem)) {
-    return NULL;
-  }
-
-  ch_memcore.nextmem = next;
-
-  return p;
+  return core_alloc(&ch_memcore.nextmem, ch_memcore.endmem,
+                    size, align, offset);
 }
 
 /**
@@ -170,6 +200,216 @@ size_t chCoreGetStatusX(void) {
   return (size_t)(ch_memcore.endmem - ch_memcore.nextmem);
   /*lint -restore*/
 }
+
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Adds a memory region to the core memory manager.
+ * @details The region is appended to the list of the additional regions,
+ *          regions are searched in the order they have been added.
+ * @note    The region base and size are usually obtained from the linker
+ *          script, for example using the @p __ramN_free__ and
+ *          @p __ramN_end__ symbols.
+ *
+ * @param[out] rp       pointer to the @p memory_region_t object
+ * @param[in] name      region name, the string is not copied
+ * @param[in] base      region base address
+ * @param[in] size      region size in bytes
+ * @param[in] attributes region attributes mask
+ *
+ * @api
+ */
+void chCoreAddRegion(memory_region_t *rp, const char *name,
+                     void *base, size_t size, memattr_t attributes) {
+  memory_region_t **rpp;
+
+  chDbgCheck((rp != NULL) && (name != NULL) && (base != NULL));
+
+  rp->next       = NULL;
+  rp->name       = name;
+  rp->nextmem    = (uint8_t *)base;
+  rp->endmem     = (uint8_t *)base + size;
+  rp->attributes = attributes;
+
+  chSysLock();
+  rpp = &ch_memcore.regions;
+  while (*rpp != NULL) {
+    chDbgAssert(*rpp != rp, "already added");
+    rpp = &(*rpp)->next;
+  }
+  *rpp = rp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Retrieves a memory region by name.
+ *
+ * @param[in] name      region name
+ * @return              The pointer to the memory region.
+ * @retval NULL         if a region with the specified name does not exist.
+ *
+ * @api
+ */
+memory_region_t *chCoreFindRegion(const char *name) {
+  memory_region_t *rp;
+
+  chDbgCheck(name != NULL);
+
+  chSysLock();
+  rp = ch_memcore.regions;
+  while ((rp != NULL) && (strcmp(rp->name, name) != 0)) {
+    rp = rp->next;
+  }
+  chSysUnlock();
+
+  return rp;
+}
+
+/**
+ * @brief   Allocates a memory block from a memory region.
+ * @details This function allocates a block of @p offset + @p size bytes. The
+ *          returned pointer has @p offset bytes before its address and
+ *          @p size bytes after.
+ *
+ * @param[in] rp        pointer to the memory region or @p NULL for the
+ *                      default core memory region
+ * @param[in] size      the size of the block to be allocated.
+ * @param[in] align     desired memory alignment
+ * @param[in] offset    aligned pointer offset
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, region memory exhausted.
+ *
+ * @iclass
+ */
+void *chCoreAllocFromRegionAlignedWithOffsetI(memory_region_t *rp,
+                                              size_t size,
+                                              unsigned align,
+                                              size_t offset) {
+
+  if (rp == NULL) {
+    return chCoreAllocAlignedWithOffsetI(size, align, offset);
+  }
+
+  chDbgCheckClassI();
+  chDbgCheck(MEM_IS_VALID_ALIGNMENT(align));
+
+  return core_alloc(&rp->nextmem, rp->endmem, size, align, offset);
+}
+
+/**
+ * @brief   Allocates a memory block from a memory region.
+ * @details This function allocates a block of @p offset + @p size bytes. The
+ *          returned pointer has @p offset bytes before its address and
+ *          @p size bytes after.
+ *
+ * @param[in] rp        pointer to the memory region or @p NULL for the
+ *                      default core memory region
+ * @param[in] size      the size of the block to be allocated.
+ * @param[in] align     desired memory alignment
+ * @param[in] offset    aligned pointer offset
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, region memory exhausted.
+ *
+ * @api
+ */
+void *chCoreAllocFromRegionAlignedWithOffset(memory_region_t *rp,
+                                             size_t size,
+                                             unsigned align,
+                                             size_t offset) {
+  void *p;
+
+  chSysLock();
+  p = chCoreAllocFromRegionAlignedWithOffsetI(rp, size, align, offset);
+  chSysUnlock();
+
+  return p;
+}
+
+/**
+ * @brief   Allocates a memory block using a placement hint.
+ * @details The block is allocated from the first region having all the
+ *          attributes specified in the hint and enough free memory. The
+ *          default core memory region is tried first, then the additional
+ *          regions in the order they have been added.
+ * @note    Using @p CH_MEM_ATTR_NONE as hint any region is acceptable.
+ *
+ * @param[in] size      the size of the block to be allocated.
+ * @param[in] align     desired memory alignment
+ * @param[in] hint      required region attributes mask
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, no region with the required
+ *                      attributes has enough free memory.
+ *
+ * @iclass
+ */
+void *chCoreAllocHintAlignedI(size_t size, unsigned align, memattr_t hint) {
+  memory_region_t *rp;
+  void *p = NULL;
+
+  chDbgCheckClassI();
+  chDbgCheck(MEM_IS_VALID_ALIGNMENT(align));
+
+  if (((memattr_t)CH_MEMCORE_ATTRIBUTES & hint) == hint) {
+    p = core_alloc(&ch_memcore.nextmem, ch_memcore.endmem, size, align, 0U);
+  }
+
+  rp = ch_memcore.regions;
+  while ((p == NULL) && (rp != NULL)) {
+    if ((rp->attributes & hint) == hint) {
+      p = core_alloc(&rp->nextmem, rp->endmem, size, align, 0U);
+    }
+    rp = rp->next;
+  }
+
+  return p;
+}
+
+/**
+ * @brief   Allocates a memory block using a placement hint.
+ * @details The block is allocated from the first region having all the
+ *          attributes specified in the hint and enough free memory. The
+ *          default core memory region is tried first, then the additional
+ *          regions in the order they have been added.
+ * @note    Using @p CH_MEM_ATTR_NONE as hint any region is acceptable.
+ *
+ * @param[in] size      the size of the block to be allocated.
+ * @param[in] align     desired memory alignment
+ * @param[in] hint      required region attributes mask
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, no region with the required
+ *                      attributes has enough free memory.
+ *
+ * @api
+ */
+void *chCoreAllocHintAligned(size_t size, unsigned align, memattr_t hint) {
+  void *p;
+
+  chSysLock();
+  p = chCoreAllocHintAlignedI(size, align, hint);
+  chSysUnlock();
+
+  return p;
+}
+
+/**
+ * @brief   Memory region status.
+ *
+ * @param[in] rp        pointer to the memory region or @p NULL for the
+ *                      default core memory region
+ * @return              The size, in bytes, of the free region memory.
+ *
+ * @xclass
+ */
+size_t chCoreGetRegionStatusX(memory_region_t *rp) {
+
+  if (rp == NULL) {
+    return chCoreGetStatusX();
+  }
+
+  /*lint -save -e9033 [10.8] The cast is safe.*/
+  return (size_t)(rp->endmem - rp->nextmem);
+  /*lint -restore*/
+}
+#endif /* CH_CFG_USE_MEMCORE_REGIONS == TRUE */
 #endif /* CH_CFG_USE_MEMCORE == TRUE */
 
 /** @} */
@@ -30,6 +30,10 @@
  *          Memory Pools do not enforce any alignment constraint on the
  *          contained object however the objects must be properly aligned
  *          to contain a pointer to void.
+ *          Optionally a per-thread magazine can be placed in front of a
+ *          pool, the owner thread allocates and releases objects from
+ *          the magazine without locking and objects are moved from/to
+ *          the pool in batches.
  * @pre     In order to use the memory pools APIs the @p CH_CFG_USE_MEMPOOLS option
  *          must be enabled in @p chconf.h.
  * @note    Compatible with RT and NIL.
@@ -113,6 +117,40 @@ void chPoolLoadArray(memory_pool_t *mp, void *p, size_t n) {
   }
 }
 
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Loads a memory pool with objects allocated from a memory region.
+ * @details The objects are allocated as a single array from the specified
+ *          memory region with the alignment of the pool, this allows to
+ *          place frequently accessed objects in a specific memory.
+ * @pre     The memory pool must already be initialized.
+ *
+ * @param[in] mp        pointer to a @p memory_pool_t structure
+ * @param[in] rp        pointer to the memory region or @p NULL for the
+ *                      default core memory region
+ * @param[in] n         number of objects to be loaded
+ * @return              The operation status.
+ * @retval false        if the objects have been loaded.
+ * @retval true         if the region has not enough free memory.
+ *
+ * @api
+ */
+bool chPoolLoadFromRegion(memory_pool_t *mp, memory_region_t *rp, size_t n) {
+  void *p;
+
+  chDbgCheck((mp != NULL) && (n != 0U));
+
+  p = chCoreAllocFromRegionAligned(rp, mp->object_size * n, mp->align);
+  if (p == NULL) {
+    return true;
+  }
+
+  chPoolLoadArray(mp, p, n);
+
+  return false;
+}
+#endif /* CH_CFG_USE_MEMCORE_REGIONS == TRUE */
+
 /**
  * @brief   Allocates an object from a memory pool.
  * @pre     The memory pool must already be initialized.
@@ -344,6 +382,150 @@ void chGuardedPoolFree(guarded_memory_pool_t *gmp, void *objp) {
 }
 #endif
 
+#if (CH_CFG_USE_POOL_MAGAZINES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an empty magazine over a memory pool.
+ * @details The magazine is owned by the calling thread, only the owner
+ *          thread is allowed to use it.
+ * @note    Magazines cannot be placed in front of guarded memory pools
+ *          because objects cached in a magazine would not be accounted
+ *          by the pool semaphore.
+ *
+ * @param[out] mgp      pointer to a @p pool_magazine_t structure
+ * @param[in] mp        pointer to the underlying @p memory_pool_t
+ *
+ * @init
+ */
+void chPoolMagazineObjectInit(pool_magazine_t *mgp, memory_pool_t *mp) {
+
+  chDbgCheck((mgp != NULL) && (mp != NULL));
+
+  mgp->pool = mp;
+  mgp->owner = chThdGetSelfX();
+  mgp->cnt = (size_t)0;
+  mgp->stats.alloc_hits   = (ucnt_t)0;
+  mgp->stats.alloc_misses = (ucnt_t)0;
+  mgp->stats.free_hits    = (ucnt_t)0;
+  mgp->stats.free_misses  = (ucnt_t)0;
+  mgp->stats.refilled     = (ucnt_t)0;
+  mgp->stats.flushed      = (ucnt_t)0;
+}
+
+/**
+ * @brief   Allocates an object through a magazine.
+ * @details The object is taken from the magazine without locking, if the
+ *          magazine is empty then up to @p CH_POOL_MAGAZINE_BATCH objects
+ *          are moved from the pool within a single critical zone. The
+ *          pool provider is only invoked if the pool has no free objects.
+ *
+ * @param[in] mgp       pointer to a @p pool_magazine_t structure
+ * @return              The pointer to the allocated object.
+ * @retval NULL         if both the magazine and the pool are empty.
+ *
+ * @api
+ */
+void *chPoolMagazineAlloc(pool_magazine_t *mgp) {
+  void *objp;
+
+  chDbgCheck(mgp != NULL);
+  chDbgAssert(mgp->owner == chThdGetSelfX(), "not owner");
+
+  if (mgp->cnt > (size_t)0) {
+    mgp->cnt--;
+    objp = mgp->objects[mgp->cnt];
+    mgp->stats.alloc_hits++;
+  }
+  else {
+    memory_pool_t *mp = mgp->pool;
+    size_t n = (size_t)0;
+
+    /* Refill, the first object is returned to the caller.*/
+    chSysLock();
+    objp = chPoolAllocI(mp);
+    if (objp != NULL) {
+      while ((n < ((size_t)CH_POOL_MAGAZINE_BATCH - (size_t)1)) &&
+             (mp->next != NULL)) {
+        mgp->objects[n] = chPoolAllocI(mp);
+        n++;
+      }
+    }
+    chSysUnlock();
+
+    mgp->cnt = n;
+    mgp->stats.alloc_misses++;
+    if (objp != NULL) {
+      mgp->stats.refilled += (ucnt_t)n + (ucnt_t)1;
+    }
+  }
+
+  return objp;
+}
+
+/**
+ * @brief   Releases an object through a magazine.
+ * @details The object is put in the magazine without locking, if the
+ *          magazine is full then @p CH_POOL_MAGAZINE_BATCH objects are
+ *          moved to the pool within a single critical zone.
+ * @pre     The freed object must be of the right size for the underlying
+ *          memory pool.
+ *
+ * @param[in] mgp       pointer to a @p pool_magazine_t structure
+ * @param[in] objp      the pointer to the object to be released
+ *
+ * @api
+ */
+void chPoolMagazineFree(pool_magazine_t *mgp, void *objp) {
+
+  chDbgCheck((mgp != NULL) && (objp != NULL));
+  chDbgAssert(mgp->owner == chThdGetSelfX(), "not owner");
+
+  if (mgp->cnt >= (size_t)CH_POOL_MAGAZINE_SIZE) {
+    size_t n = (size_t)CH_POOL_MAGAZINE_BATCH;
+
+    chSysLock();
+    while (n > (size_t)0) {
+      mgp->cnt--;
+      chPoolFreeI(mgp->pool, mgp->objects[mgp->cnt]);
+      n--;
+    }
+    chSysUnlock();
+
+    mgp->stats.free_misses++;
+    mgp->stats.flushed += (ucnt_t)CH_POOL_MAGAZINE_BATCH;
+  }
+  else {
+    mgp->stats.free_hits++;
+  }
+
+  mgp->objects[mgp->cnt] = objp;
+  mgp->cnt++;
+}
+
+/**
+ * @brief   Returns all the objects cached in a magazine to the pool.
+ * @note    A magazine should be flushed before its owner thread terminates
+ *          or the cached objects are lost.
+ *
+ * @param[in] mgp       pointer to a @p pool_magazine_t structure
+ *
+ * @api
+ */
+void chPoolMagazineFlush(pool_magazine_t *mgp) {
+
+  chDbgCheck(mgp != NULL);
+  chDbgAssert(mgp->owner == chThdGetSelfX(), "not owner");
+
+  mgp->stats.flushed += (ucnt_t)mgp->cnt;
+
+  chSysLock();
+  while (mgp->cnt > (size_t)0) {
+    mgp->cnt--;
+    chPoolFreeI(mgp->pool, mgp->objects[mgp->cnt]);
+  }
+  chSysUnlock();
+}
+#endif /* CH_CFG_USE_POOL_MAGAZINES == TRUE */
+
 #endif /* CH_CFG_USE_MEMPOOLS == TRUE */
 
 /** @} */
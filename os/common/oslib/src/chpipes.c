@@ -0,0 +1,575 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chpipes.c
+ * @brief   Pipes code.
+ *
+ * @addtogroup pipes
+ * @details Byte pipes.
+ *          <h2>Operation mode</h2>
+ *          A pipe is a circular bytes buffer for streaming data between
+ *          threads.<br>
+ *          Operations defined for pipes:
+ *          - <b>Write</b>: A block of bytes is copied into the pipe, the
+ *            writer waits for space when the pipe is full.
+ *          - <b>Read</b>: A block of bytes is copied from the pipe, the
+ *            reader waits for data when the pipe is empty.
+ *          - <b>Acquire</b>: A contiguous span of free space, or of data,
+ *            is made directly accessible to the caller.
+ *          - <b>Commit</b>: The bytes written into, or read from, an
+ *            acquired span are added to, or removed from, the pipe.
+ *          - <b>Reset</b>: The pipe is emptied and all the stored bytes
+ *            are lost.
+ *          .
+ *          Blocks are copied with at most two @p memcpy() calls, waiting
+ *          threads are woken once for each copied block or committed span
+ *          rather than for each byte.
+ * @pre     In order to use the pipes APIs the @p CH_CFG_USE_PIPES
+ *          option must be enabled in @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+
+#if (CH_CFG_USE_PIPES == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Non-blocking pipe write.
+ * @details The function writes data from a buffer to a pipe. The
+ *          operation completes when the specified amount of data has been
+ *          transferred or when the pipe has been filled.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @return              The number of bytes effectively transferred.
+ *
+ * @notapi
+ */
+static size_t pipe_write(pipe_t *pp, const uint8_t *bp, size_t n) {
+  size_t s1, s2;
+
+  /* Number of bytes that can be written in a single atomic operation.*/
+  if (n > chPipeGetFreeCountI(pp)) {
+    n = chPipeGetFreeCountI(pp);
+  }
+
+  /* Number of bytes before buffer limit.*/
+  /*lint -save -e9033 [10.8] Checked to be safe.*/
+  s1 = (size_t)(pp->top - pp->wrptr);
+  /*lint -restore*/
+  if (n < s1) {
+    memcpy((void *)pp->wrptr, (const void *)bp, n);
+    pp->wrptr += n;
+  }
+  else if (n > s1) {
+    memcpy((void *)pp->wrptr, (const void *)bp, s1);
+    bp += s1;
+    s2 = n - s1;
+    memcpy((void *)pp->buffer, (const void *)bp, s2);
+    pp->wrptr = pp->buffer + s2;
+  }
+  else { /* n == s1 */
+    memcpy((void *)pp->wrptr, (const void *)bp, n);
+    pp->wrptr = pp->buffer;
+  }
+
+  pp->cnt += n;
+  return n;
+}
+
+/**
+ * @brief   Non-blocking pipe read.
+ * @details The function reads data from a pipe into a buffer. The
+ *          operation completes when the specified amount of data has been
+ *          transferred or when the pipe has been emptied.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the maximum amount of data to be transferred
+ * @return              The number of bytes effectively transferred.
+ *
+ * @notapi
+ */
+static size_t pipe_read(pipe_t *pp, uint8_t *bp, size_t n) {
+  size_t s1, s2;
+
+  /* Number of bytes that can be read in a single atomic operation.*/
+  if (n > chPipeGetUsedCountI(pp)) {
+    n = chPipeGetUsedCountI(pp);
+  }
+
+  /* Number of bytes before buffer limit.*/
+  /*lint -save -e9033 [10.8] Checked to be safe.*/
+  s1 = (size_t)(pp->top - pp->rdptr);
+  /*lint -restore*/
+  if (n < s1) {
+    memcpy((void *)bp, (void *)pp->rdptr, n);
+    pp->rdptr += n;
+  }
+  else if (n > s1) {
+    memcpy((void *)bp, (void *)pp->rdptr, s1);
+    bp += s1;
+    s2 = n - s1;
+    memcpy((void *)bp, (void *)pp->buffer, s2);
+    pp->rdptr = pp->buffer + s2;
+  }
+  else { /* n == s1 */
+    memcpy((void *)bp, (void *)pp->rdptr, n);
+    pp->rdptr = pp->buffer;
+  }
+
+  pp->cnt -= n;
+  return n;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p pipe_t object.
+ *
+ * @param[out] pp       the pointer to the @p pipe_t structure to be
+ *                      initialized
+ * @param[in] buf       pointer to the pipe buffer as an array of @p uint8_t
+ * @param[in] n         number of elements in the buffer array
+ *
+ * @init
+ */
+void chPipeObjectInit(pipe_t *pp, uint8_t *buf, size_t n) {
+
+  chDbgCheck((pp != NULL) && (buf != NULL) && (n > (size_t)0));
+
+  pp->buffer = buf;
+  pp->rdptr  = buf;
+  pp->wrptr  = buf;
+  pp->top    = &buf[n];
+  pp->cnt    = (size_t)0;
+  pp->reset  = false;
+  pp->generation = (ucnt_t)0;
+  chThdQueueObjectInit(&pp->qw);
+  chThdQueueObjectInit(&pp->qr);
+}
+
+/**
+ * @brief   Resets a @p pipe_t object.
+ * @details All the waiting threads are resumed with status @p MSG_RESET and
+ *          the queued data is lost.
+ * @post    The pipe is in reset state, all operations will fail and
+ *          transfer no data until the pipe is enabled again using
+ *          @p chPipeResumeX().
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ *
+ * @api
+ */
+void chPipeReset(pipe_t *pp) {
+
+  chSysLock();
+  chPipeResetI(pp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Resets a @p pipe_t object.
+ * @details All the waiting threads are resumed with status @p MSG_RESET and
+ *          the queued data is lost.
+ * @post    The pipe is in reset state, all operations will fail and
+ *          transfer no data until the pipe is enabled again using
+ *          @p chPipeResumeX().
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ *
+ * @iclass
+ */
+void chPipeResetI(pipe_t *pp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(pp != NULL);
+
+  pp->wrptr = pp->buffer;
+  pp->rdptr = pp->buffer;
+  pp->cnt   = (size_t)0;
+  pp->reset = true;
+  pp->generation++;
+  chThdDequeueAllI(&pp->qw, MSG_RESET);
+  chThdDequeueAllI(&pp->qr, MSG_RESET);
+}
+
+/**
+ * @brief   Pipe write with timeout.
+ * @details The function writes data from a buffer to a pipe. The
+ *          operation completes when the specified amount of data has been
+ *          transferred or after the specified timeout or if the pipe has
+ *          been reset.
+ * @note    The function is not atomic, if you need atomicity it is suggested
+ *          to use a semaphore or a mutex for mutual exclusion.
+ * @note    A waiting reader is woken once for each block copied into the
+ *          pipe.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[in] bp        pointer to the data buffer
+ * @param[in] n         the number of bytes to be written, the value 0 is
+ *                      reserved
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively transferred.
+ *
+ * @api
+ */
+size_t chPipeWriteTimeout(pipe_t *pp, const uint8_t *bp,
+                          size_t n, sysinterval_t timeout) {
+  size_t wr = (size_t)0;
+
+  chDbgCheck((pp != NULL) && (bp != NULL) && (n > (size_t)0));
+
+  chSysLock();
+
+  /* If the pipe is in reset state then returns immediately.*/
+  while ((wr < n) && !pp->reset) {
+    size_t done;
+
+    done = pipe_write(pp, bp, n - wr);
+    if (done == (size_t)0) {
+      /* No space in the pipe, waiting for space to become available,
+         anything except MSG_OK causes the operation to stop.*/
+      if (chThdEnqueueTimeoutS(&pp->qw, timeout) != MSG_OK) {
+        break;
+      }
+    }
+    else {
+      /* If there is a reader waiting then makes it ready.*/
+      chThdDequeueNextI(&pp->qr, MSG_OK);
+      chSchRescheduleS();
+
+      wr += done;
+      bp += done;
+    }
+  }
+
+  /* If there is still space then another waiting writer can proceed.*/
+  if (!pp->reset && (chPipeGetFreeCountI(pp) > (size_t)0)) {
+    chThdDequeueNextI(&pp->qw, MSG_OK);
+    chSchRescheduleS();
+  }
+
+  chSysUnlock();
+
+  return wr;
+}
+
+/**
+ * @brief   Pipe read with timeout.
+ * @details The function reads data from a pipe into a buffer. The
+ *          operation completes when the specified amount of data has been
+ *          transferred or after the specified timeout or if the pipe has
+ *          been reset.
+ * @note    The function is not atomic, if you need atomicity it is suggested
+ *          to use a semaphore or a mutex for mutual exclusion.
+ * @note    A waiting writer is woken once for each block copied from the
+ *          pipe.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[out] bp       pointer to the data buffer
+ * @param[in] n         the number of bytes to be read, the value 0 is
+ *                      reserved
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively transferred.
+ *
+ * @api
+ */
+size_t chPipeReadTimeout(pipe_t *pp, uint8_t *bp,
+                         size_t n, sysinterval_t timeout) {
+  size_t rd = (size_t)0;
+
+  chDbgCheck((pp != NULL) && (bp != NULL) && (n > (size_t)0));
+
+  chSysLock();
+
+  /* If the pipe is in reset state then returns immediately.*/
+  while ((rd < n) && !pp->reset) {
+    size_t done;
+
+    done = pipe_read(pp, bp, n - rd);
+    if (done == (size_t)0) {
+      /* No data in the pipe, waiting for data to become available,
+         anything except MSG_OK causes the operation to stop.*/
+      if (chThdEnqueueTimeoutS(&pp->qr, timeout) != MSG_OK) {
+        break;
+      }
+    }
+    else {
+      /* If there is a writer waiting then makes it ready.*/
+      chThdDequeueNextI(&pp->qw, MSG_OK);
+      chSchRescheduleS();
+
+      rd += done;
+      bp += done;
+    }
+  }
+
+  /* If there is still data then another waiting reader can proceed.*/
+  if (!pp->reset && (chPipeGetUsedCountI(pp) > (size_t)0)) {
+    chThdDequeueNextI(&pp->qr, MSG_OK);
+    chSchRescheduleS();
+  }
+
+  chSysUnlock();
+
+  return rd;
+}
+
+/**
+ * @brief   Acquires a span of free space in a pipe.
+ * @details The function waits for free space then returns the contiguous
+ *          span following the write pointer, the caller can write the
+ *          data directly in the span then make it available to readers
+ *          using @p chPipeWriteCommit().
+ * @note    The span is invalidated by a pipe reset, data committed in a
+ *          span acquired before a reset is discarded, also after the pipe
+ *          has been resumed.
+ * @note    Spans must not be acquired while other threads write into the
+ *          same pipe.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[out] psp      pointer to the @p pipe_span_t object describing
+ *                      the span, it is also filled when no span is acquired
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The size of the span in bytes.
+ * @retval 0            if the operation has timed out or the pipe has been
+ *                      reset.
+ *
+ * @api
+ */
+size_t chPipeWriteAcquireTimeout(pipe_t *pp, pipe_span_t *psp,
+                                 sysinterval_t timeout) {
+  size_t n = (size_t)0;
+
+  chDbgCheck((pp != NULL) && (psp != NULL));
+
+  chSysLock();
+
+  psp->buffer = NULL;
+
+  /* If the pipe is in reset state then returns immediately.*/
+  while (!pp->reset) {
+    if (chPipeGetFreeCountI(pp) > (size_t)0) {
+      /* The span ends at the buffer limit or where the data begins.*/
+      /*lint -save -e9033 [10.8] Checked to be safe.*/
+      n = (size_t)(pp->top - pp->wrptr);
+      /*lint -restore*/
+      if (n > chPipeGetFreeCountI(pp)) {
+        n = chPipeGetFreeCountI(pp);
+      }
+      psp->buffer = pp->wrptr;
+      break;
+    }
+
+    /* No space in the pipe, waiting for space to become available.*/
+    if (chThdEnqueueTimeoutS(&pp->qw, timeout) != MSG_OK) {
+      break;
+    }
+  }
+  psp->size       = n;
+  psp->generation = pp->generation;
+
+  chSysUnlock();
+
+  return n;
+}
+
+/**
+ * @brief   Commits data written in an acquired span.
+ * @details The first @p n bytes of the span acquired by
+ *          @p chPipeWriteAcquireTimeout() are made available to readers,
+ *          a waiting reader is woken once for the whole span.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[in] psp       pointer to the @p pipe_span_t object describing
+ *                      the span
+ * @param[in] n         the number of bytes written in the span, it must not
+ *                      exceed the span size
+ *
+ * @api
+ */
+void chPipeWriteCommit(pipe_t *pp, const pipe_span_t *psp, size_t n) {
+
+  chDbgCheck((pp != NULL) && (psp != NULL));
+
+  chSysLock();
+
+  /* Data written in a span acquired before a reset is discarded.*/
+  if ((psp->generation == pp->generation) && (n > (size_t)0)) {
+    chDbgAssert((n <= psp->size) && (n <= chPipeGetFreeCountI(pp)) &&
+                (n <= (size_t)(pp->top - pp->wrptr)),
+                "span overflow");
+
+    pp->wrptr += n;
+    if (pp->wrptr >= pp->top) {
+      pp->wrptr = pp->buffer;
+    }
+    pp->cnt += n;
+
+    /* If there is a reader waiting then makes it ready.*/
+    chThdDequeueNextI(&pp->qr, MSG_OK);
+    chSchRescheduleS();
+  }
+
+  chSysUnlock();
+}
+
+/**
+ * @brief   Acquires a span of data in a pipe.
+ * @details The function waits for data then returns the contiguous span
+ *          following the read pointer, the caller can access the data
+ *          directly in the span then release it to writers using
+ *          @p chPipeReadCommit().
+ * @note    The span is invalidated by a pipe reset, commits of a span
+ *          acquired before a reset are ignored, also after the pipe has
+ *          been resumed.
+ * @note    Spans must not be acquired while other threads read from the
+ *          same pipe.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[out] psp      pointer to the @p pipe_span_t object describing
+ *                      the span, it is also filled when no span is acquired
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The size of the span in bytes.
+ * @retval 0            if the operation has timed out or the pipe has been
+ *                      reset.
+ *
+ * @api
+ */
+size_t chPipeReadAcquireTimeout(pipe_t *pp, pipe_span_t *psp,
+                                sysinterval_t timeout) {
+  size_t n = (size_t)0;
+
+  chDbgCheck((pp != NULL) && (psp != NULL));
+
+  chSysLock();
+
+  psp->buffer = NULL;
+
+  /* If the pipe is in reset state then returns immediately.*/
+  while (!pp->reset) {
+    if (chPipeGetUsedCountI(pp) > (size_t)0) {
+      /* The span ends at the buffer limit or where the data ends.*/
+      /*lint -save -e9033 [10.8] Checked to be safe.*/
+      n = (size_t)(pp->top - pp->rdptr);
+      /*lint -restore*/
+      if (n > chPipeGetUsedCountI(pp)) {
+        n = chPipeGetUsedCountI(pp);
+      }
+      psp->buffer = pp->rdptr;
+      break;
+    }
+
+    /* No data in the pipe, waiting for data to become available.*/
+    if (chThdEnqueueTimeoutS(&pp->qr, timeout) != MSG_OK) {
+      break;
+    }
+  }
+  psp->size       = n;
+  psp->generation = pp->generation;
+
+  chSysUnlock();
+
+  return n;
+}
+
+/**
+ * @brief   Releases data read from an acquired span.
+ * @details The first @p n bytes of the span acquired by
+ *          @p chPipeReadAcquireTimeout() are removed from the pipe, a
+ *          waiting writer is woken once for the whole span.
+ *
+ * @param[in] pp        the pointer to an initialized @p pipe_t object
+ * @param[in] psp       pointer to the @p pipe_span_t object describing
+ *                      the span
+ * @param[in] n         the number of bytes read from the span, it must not
+ *                      exceed the span size
+ *
+ * @api
+ */
+void chPipeReadCommit(pipe_t *pp, const pipe_span_t *psp, size_t n) {
+
+  chDbgCheck((pp != NULL) && (psp != NULL));
+
+  chSysLock();
+
+  /* Spans acquired before a reset have already been released.*/
+  if ((psp->generation == pp->generation) && (n > (size_t)0)) {
+    chDbgAssert((n <= psp->size) && (n <= chPipeGetUsedCountI(pp)) &&
+                (n <= (size_t)(pp->top - pp->rdptr)),
+                "span overflow");
+
+    pp->rdptr += n;
+    if (pp->rdptr >= pp->top) {
+      pp->rdptr = pp->buffer;
+    }
+    pp->cnt -= n;
+
+    /* If there is a writer waiting then makes it ready.*/
+    chThdDequeueNextI(&pp->qw, MSG_OK);
+    chSchRescheduleS();
+  }
+
+  chSysUnlock();
+}
+
+#endif /* CH_CFG_USE_PIPES == TRUE */
+
+/** @} */
@@ -0,0 +1,319 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chslab.c
+ * @brief   Slab allocator code.
+ *
+ * @addtogroup slabs
+ * @details Slab allocator related APIs and services.
+ *          <h2>Operation mode</h2>
+ *          Small objects are allocated from a set of memory pools, one
+ *          for each size class, so that objects of the same size are
+ *          grouped together and the heap is not fragmented by them.<br>
+ *          Memory pools are refilled in chunks of objects from the core
+ *          allocator, objects are never returned to the core allocator.
+ *          Requests larger than the largest size class are served by the
+ *          default heap.<br>
+ *          The APIs are functionally equivalent to the usual @p malloc(),
+ *          @p calloc(), @p realloc() and @p free() library functions and
+ *          are thread safe.
+ * @pre     In order to use the slab allocator APIs the @p CH_CFG_USE_SLAB
+ *          option must be enabled in @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+
+#if (CH_CFG_USE_SLAB == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Size classes.
+ */
+static const size_t slab_sizes[] = {CH_SLAB_SIZES};
+
+/**
+ * @brief   Number of size classes.
+ * @note    This value also marks objects allocated from the heap.
+ */
+#define SLAB_CLASSES        (sizeof slab_sizes / sizeof slab_sizes[0])
+
+/**
+ * @brief   Memory pools, one for each size class.
+ */
+static memory_pool_t slab_pools[SLAB_CLASSES];
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the header of an object.
+ */
+#define slab_header(p)                                                      \
+  ((size_t *)(void *)((uint8_t *)(p) - CH_SLAB_HEADER_SIZE))
+
+/**
+ * @brief   Allocates a new object from the core allocator.
+ * @details A chunk of objects is allocated, the first one is returned and
+ *          the others are added to the pool. If the chunk cannot be
+ *          allocated then a single object is tried.
+ *
+ * @param[in] mp        pointer to the memory pool of the size class
+ * @return              The pointer to the object.
+ * @retval NULL         if the core memory is exhausted.
+ */
+static void *slab_refill(memory_pool_t *mp) {
+  uint8_t *p;
+
+  p = chCoreAllocAligned(mp->object_size * (size_t)CH_SLAB_REFILL_OBJECTS,
+                         CH_SLAB_ALIGNMENT);
+  if (p == NULL) {
+    return chCoreAllocAligned(mp->object_size, CH_SLAB_ALIGNMENT);
+  }
+
+#if CH_SLAB_REFILL_OBJECTS > 1U
+  chPoolLoadArray(mp, p + mp->object_size,
+                  (size_t)CH_SLAB_REFILL_OBJECTS - (size_t)1);
+#endif
+
+  return p;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes the slab allocator.
+ *
+ * @notapi
+ */
+void _slab_init(void) {
+  size_t i;
+
+  for (i = 0U; i < SLAB_CLASSES; i++) {
+    chDbgAssert((i == 0U) || (slab_sizes[i] > slab_sizes[i - 1U]),
+                "size classes not in ascending order");
+
+    chPoolObjectInitAligned(&slab_pools[i],
+                            MEM_ALIGN_NEXT(CH_SLAB_HEADER_SIZE +
+                                           slab_sizes[i],
+                                           CH_SLAB_ALIGNMENT),
+                            CH_SLAB_ALIGNMENT, NULL);
+  }
+}
+
+/**
+ * @brief   Allocates an object.
+ * @details The object is allocated from the smallest size class able to
+ *          contain it, if the size class has no free objects then it is
+ *          refilled from the core allocator. Objects larger than the
+ *          largest size class, or not obtainable from the core allocator,
+ *          are allocated from the default heap.
+ *
+ * @param[in] size      the size of the object to be allocated
+ * @return              A pointer to the allocated object.
+ * @retval NULL         if the allocation failed.
+ *
+ * @api
+ */
+void *chSlabAlloc(size_t size) {
+  size_t i, *hp;
+
+  hp = NULL;
+  for (i = 0U; i < SLAB_CLASSES; i++) {
+    if (size <= slab_sizes[i]) {
+      hp = chPoolAlloc(&slab_pools[i]);
+      if (hp == NULL) {
+        hp = slab_refill(&slab_pools[i]);
+      }
+      break;
+    }
+  }
+
+#if CH_CFG_USE_HEAP == TRUE
+  if (hp == NULL) {
+    /* The header would make the heap request size wrap around.*/
+    if (size > ((size_t)-1 - CH_SLAB_HEADER_SIZE)) {
+      return NULL;
+    }
+    i = SLAB_CLASSES;
+    hp = chHeapAllocAligned(NULL, CH_SLAB_HEADER_SIZE + size,
+                            CH_SLAB_ALIGNMENT);
+  }
+#endif
+
+  if (hp == NULL) {
+    return NULL;
+  }
+
+  *hp = i;
+
+  /*lint -save -e9087 [11.3] Safe cast.*/
+  return (void *)((uint8_t *)hp + CH_SLAB_HEADER_SIZE);
+  /*lint -restore*/
+}
+
+/**
+ * @brief   Frees an object.
+ * @note    Passing a @p NULL pointer is allowed, nothing is done.
+ *
+ * @param[in] p         pointer to the object to be freed
+ *
+ * @api
+ */
+void chSlabFree(void *p) {
+  size_t *hp;
+
+  if (p == NULL) {
+    return;
+  }
+
+  hp = slab_header(p);
+  chDbgAssert(*hp <= SLAB_CLASSES, "invalid object");
+
+#if CH_CFG_USE_HEAP == TRUE
+  if (*hp == SLAB_CLASSES) {
+    chHeapFree(hp);
+    return;
+  }
+#endif
+
+  chPoolFree(&slab_pools[*hp], hp);
+}
+
+/**
+ * @brief   Returns the usable size of an object.
+ * @note    The returned value is the size of the size class, it can be
+ *          larger than the requested size.
+ *
+ * @param[in] p         pointer to the object
+ * @return              The usable size in bytes.
+ *
+ * @api
+ */
+size_t chSlabGetSize(const void *p) {
+  const size_t *hp;
+
+  chDbgCheck(p != NULL);
+
+  /*lint -save -e9087 [11.3] Safe cast.*/
+  hp = (const size_t *)(const void *)((const uint8_t *)p -
+                                      CH_SLAB_HEADER_SIZE);
+  /*lint -restore*/
+  chDbgAssert(*hp <= SLAB_CLASSES, "invalid object");
+
+#if CH_CFG_USE_HEAP == TRUE
+  if (*hp == SLAB_CLASSES) {
+    return chHeapGetSize(hp) - CH_SLAB_HEADER_SIZE;
+  }
+#endif
+
+  return slab_sizes[*hp];
+}
+
+/**
+ * @brief   Allocates a zero-filled array of objects.
+ *
+ * @param[in] n         number of elements
+ * @param[in] size      size of each element
+ * @return              A pointer to the allocated array.
+ * @retval NULL         if the allocation failed or the total size
+ *                      overflows.
+ *
+ * @api
+ */
+void *chSlabCalloc(size_t n, size_t size) {
+  void *p;
+
+  if ((size != 0U) && (n > ((size_t)-1 / size))) {
+    return NULL;
+  }
+
+  p = chSlabAlloc(n * size);
+  if (p != NULL) {
+    memset(p, 0, n * size);
+  }
+
+  return p;
+}
+
+/**
+ * @brief   Changes the size of an object.
+ * @details The object is moved only if the new size exceeds its usable
+ *          size, the content is preserved up to the smaller of the old
+ *          and new sizes.
+ * @note    If @p p is @p NULL then this function is equivalent to
+ *          @p chSlabAlloc(), if @p size is zero then the object is freed
+ *          and @p NULL is returned.
+ *
+ * @param[in] p         pointer to the object or @p NULL
+ * @param[in] size      the new size
+ * @return              A pointer to the resized object.
+ * @retval NULL         if the allocation failed, the original object is
+ *                      left untouched.
+ *
+ * @api
+ */
+void *chSlabRealloc(void *p, size_t size) {
+  size_t oldsize;
+  void *newp;
+
+  if (p == NULL) {
+    return chSlabAlloc(size);
+  }
+
+  if (size == 0U) {
+    chSlabFree(p);
+    return NULL;
+  }
+
+  oldsize = chSlabGetSize(p);
+  if (size <= oldsize) {
+    return p;
+  }
+
+  newp = chSlabAlloc(size);
+  if (newp != NULL) {
+    memcpy(newp, p, oldsize);
+    chSlabFree(p);
+  }
+
+  return newp;
+}
+
+#endif /* CH_CFG_USE_SLAB == TRUE */
+
+/** @} */
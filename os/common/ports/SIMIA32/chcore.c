@@ -44,6 +44,13 @@
 bool port_isr_context_flag;
 syssts_t port_irq_sts;
 
+#if (PORT_SIM_VIRTUAL_TIME == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Virtual cycles counter.
+ */
+uint64_t port_sim_vtime;
+#endif
+
 /*===========================================================================*/
 /* Module local types.                                                       */
 /*===========================================================================*/
@@ -71,14 +78,14 @@ static void __dummy(thread_t *ntp, thread_t *otp) {
 
   asm volatile (
 #if defined(WIN32)
-                ".globl @port_switch@8                          \n\t"
-                "@port_switch@8:"
+                ".globl @_port_switch@8                         \n\t"
+                "@_port_switch@8:"
 #elif defined(__APPLE__)
+                ".globl __port_switch                           \n\t"
+                "__port_switch:"
+#else
                 ".globl _port_switch                            \n\t"
                 "_port_switch:"
-#else
-                ".globl port_switch                             \n\t"
-                "port_switch:"
 #endif
                 "push    %ebp                                   \n\t"
                 "push    %esi                                   \n\t"
@@ -110,11 +117,17 @@ void _port_thread_start(msg_t (*pf)(void *), void *p) {
 
 /**
  * @brief   Returns the current value of the realtime counter.
+ * @note    In virtual time mode the counter is the virtual cycles counter
+ *          and each read is charged @p PORT_SIM_COUNTER_COST cycles.
  *
  * @return              The realtime counter value.
  */
 rtcnt_t port_rt_get_counter_value(void) {
-#if defined(WIN32)
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+
+  PORT_SIM_CONSUME(PORT_SIM_COUNTER_COST);
+  return (rtcnt_t)port_sim_vtime;
+#elif defined(WIN32)
   LARGE_INTEGER n;
 
   QueryPerformanceCounter(&n);
@@ -128,4 +141,30 @@ rtcnt_t port_rt_get_counter_value(void) {
 #endif
 }
 
+#if ((PORT_SIM_VIRTUAL_TIME == TRUE) && (PORT_SIM_FUNCTION_COST > 0)) ||      \
+    defined(__DOXYGEN__)
+/**
+ * @brief   Functions entry hook.
+ * @details Charges @p PORT_SIM_FUNCTION_COST cycles for each call of the
+ *          code compiled with @p -finstrument-functions.
+ */
+__attribute__((no_instrument_function))
+void __cyg_profile_func_enter(void *this_fn, void *call_site) {
+
+  (void)this_fn;
+  (void)call_site;
+  PORT_SIM_CONSUME(PORT_SIM_FUNCTION_COST);
+}
+
+/**
+ * @brief   Functions exit hook.
+ */
+__attribute__((no_instrument_function))
+void __cyg_profile_func_exit(void *this_fn, void *call_site) {
+
+  (void)this_fn;
+  (void)call_site;
+}
+#endif
+
 /** @} */
@@ -123,6 +123,66 @@
 #define PORT_USE_ALT_TIMER              FALSE
 #endif
 
+/**
+ * @brief   Enables the deterministic virtual time mode.
+ * @details In this mode the realtime counter and the system time are no
+ *          more derived from the host clocks but from a virtual cycles
+ *          counter that is advanced by a fixed cost for each kernel
+ *          operation, idle periods are skipped. Runs are reproducible
+ *          regardless of the host load.
+ */
+#if !defined(PORT_SIM_VIRTUAL_TIME) || defined(__DOXYGEN__)
+#define PORT_SIM_VIRTUAL_TIME           FALSE
+#endif
+
+/**
+ * @brief   Frequency of the virtual cycles counter.
+ * @note    It must be a divisor of 1000000000.
+ */
+#if !defined(PORT_SIM_VT_FREQUENCY) || defined(__DOXYGEN__)
+#define PORT_SIM_VT_FREQUENCY           100000000
+#endif
+
+/**
+ * @brief   Virtual cycles charged for each kernel lock.
+ */
+#if !defined(PORT_SIM_LOCK_COST) || defined(__DOXYGEN__)
+#define PORT_SIM_LOCK_COST              10
+#endif
+
+/**
+ * @brief   Virtual cycles charged for each context switch.
+ */
+#if !defined(PORT_SIM_SWITCH_COST) || defined(__DOXYGEN__)
+#define PORT_SIM_SWITCH_COST            50
+#endif
+
+/**
+ * @brief   Virtual cycles charged for each realtime counter read.
+ * @note    It must be non-zero or polling loops on the counter would never
+ *          terminate.
+ */
+#if !defined(PORT_SIM_COUNTER_COST) || defined(__DOXYGEN__)
+#define PORT_SIM_COUNTER_COST           1
+#endif
+
+/**
+ * @brief   Virtual cycles charged for each simulated interrupts check.
+ */
+#if !defined(PORT_SIM_POLL_COST) || defined(__DOXYGEN__)
+#define PORT_SIM_POLL_COST              10
+#endif
+
+/**
+ * @brief   Virtual cycles charged for each instrumented function call.
+ * @details If non-zero the application code can be compiled with
+ *          @p -finstrument-functions in order to charge each function call
+ *          and have the virtual time follow the code flow more closely.
+ */
+#if !defined(PORT_SIM_FUNCTION_COST) || defined(__DOXYGEN__)
+#define PORT_SIM_FUNCTION_COST          0
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -131,6 +191,25 @@
 #error "option CH_DBG_ENABLE_STACK_CHECK not supported by this port"
 #endif
 
+#if (PORT_SIM_VIRTUAL_TIME == TRUE) || defined(__DOXYGEN__)
+#if defined(WIN32)
+#error "PORT_SIM_VIRTUAL_TIME not supported on Win32 hosts"
+#endif
+
+#if (1000000000 % PORT_SIM_VT_FREQUENCY) != 0
+#error "PORT_SIM_VT_FREQUENCY must be a divisor of 1000000000"
+#endif
+
+#if PORT_SIM_COUNTER_COST <= 0
+#error "invalid PORT_SIM_COUNTER_COST value"
+#endif
+
+/**
+ * @brief   Duration of a virtual cycle in nanoseconds.
+ */
+#define PORT_SIM_VT_CYCLE_NS            (1000000000 / PORT_SIM_VT_FREQUENCY)
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -275,6 +354,33 @@ struct port_context {
  */
 #define PORT_FAST_IRQ_HANDLER(id) void id(void)
 
+/**
+ * @brief   Charges a number of cycles to the virtual time.
+ * @note    Does nothing if @p PORT_SIM_VIRTUAL_TIME is disabled.
+ *
+ * @param[in] n         number of virtual cycles
+ */
+#if (PORT_SIM_VIRTUAL_TIME == TRUE) || defined(__DOXYGEN__)
+#define PORT_SIM_CONSUME(n) (port_sim_vtime += (uint64_t)(n))
+#else
+#define PORT_SIM_CONSUME(n)
+#endif
+
+/**
+ * @brief   Performs a context switch between two threads.
+ * @details This is the most critical code in any port, this function
+ *          is responsible for the context switch between 2 threads.
+ * @note    The implementation of this code affects <b>directly</b> the context
+ *          switch performance so optimize here as much as you can.
+ *
+ * @param[in] ntp       the thread to be switched in
+ * @param[in] otp       the thread to be switched out
+ */
+#define port_switch(ntp, otp) {                                             \
+  PORT_SIM_CONSUME(PORT_SIM_SWITCH_COST);                                   \
+  _port_switch(ntp, otp);                                                   \
+}
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -285,17 +391,21 @@ struct port_context {
 
 extern bool port_isr_context_flag;
 extern syssts_t port_irq_sts;
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+extern uint64_t port_sim_vtime;
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
   /*lint -save -e950 [Dir-2.1] Non-ANSI keywords are fine in the port layer.*/
-  __attribute__((fastcall)) void port_switch(thread_t *ntp, thread_t *otp);
+  __attribute__((fastcall)) void _port_switch(thread_t *ntp, thread_t *otp);
   __attribute__((cdecl, noreturn)) void _port_thread_start(msg_t (*pf)(void *p),
                                                            void *p);
   /*lint -restore*/
   rtcnt_t port_rt_get_counter_value(void);
   void _sim_check_for_interrupts(void);
+  void _sim_wait_for_interrupts(void);
 #ifdef __cplusplus
 }
 #endif
@@ -361,6 +471,7 @@ static inline bool port_is_isr_context(void) {
  */
 static inline void port_lock(void) {
 
+  PORT_SIM_CONSUME(PORT_SIM_LOCK_COST);
   port_irq_sts = (syssts_t)1;
 }
 
@@ -380,6 +491,7 @@ static inline void port_unlock(void) {
  */
 static inline void port_lock_from_isr(void) {
 
+  PORT_SIM_CONSUME(PORT_SIM_LOCK_COST);
   port_irq_sts = (syssts_t)1;
 }
 
@@ -423,11 +535,11 @@ static inline void port_enable(void) {
  *          The simplest implementation is an empty function or macro but this
  *          would not take advantage of architecture-specific power saving
  *          modes.
- * @note    Implemented as an inlined @p WFI instruction.
+ * @note    The host process sleeps until the next simulated interrupt.
  */
 static inline void port_wait_for_interrupt(void) {
 
-  _sim_check_for_interrupts();
+  _sim_wait_for_interrupts();
 }
 
 #endif /* !defined(_FROM_ASM_) */
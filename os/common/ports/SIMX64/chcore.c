@@ -0,0 +1,182 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    SIMX64/chcore.c
+ * @brief   Simulator on x86-64 port code.
+ *
+ * @addtogroup SIMX64_GCC_CORE
+ * @{
+ */
+
+#include <sys/time.h>
+
+#include "ch.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+bool port_isr_context_flag;
+syssts_t port_irq_sts;
+
+#if (PORT_SIM_VIRTUAL_TIME == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Virtual cycles counter.
+ */
+uint64_t port_sim_vtime;
+#endif
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * Performs a context switch between two threads.
+ * @param ntp the thread to be switched in
+ * @param otp the thread to be switched out
+ */
+__attribute__((used))
+static void __dummy(thread_t *ntp, thread_t *otp) {
+  (void)ntp; (void)otp;
+
+  asm volatile (
+#if defined(__APPLE__)
+                ".globl __port_switch                           \n\t"
+                "__port_switch:"
+#else
+                ".globl _port_switch                            \n\t"
+                "_port_switch:"
+#endif
+                "push    %%rbp                                  \n\t"
+                "push    %%rbx                                  \n\t"
+                "push    %%r12                                  \n\t"
+                "push    %%r13                                  \n\t"
+                "push    %%r14                                  \n\t"
+                "push    %%r15                                  \n\t"
+                "movq    %%rsp, %c0(%%rsi)                      \n\t"
+                "movq    %c0(%%rdi), %%rsp                      \n\t"
+                "pop     %%r15                                  \n\t"
+                "pop     %%r14                                  \n\t"
+                "pop     %%r13                                  \n\t"
+                "pop     %%r12                                  \n\t"
+                "pop     %%rbx                                  \n\t"
+                "pop     %%rbp                                  \n\t"
+                "ret                                            \n\t"
+#if defined(__APPLE__)
+                ".globl __port_thread_trampoline                \n\t"
+                "__port_thread_trampoline:"
+#else
+                ".globl _port_thread_trampoline                 \n\t"
+                "_port_thread_trampoline:"
+#endif
+                "movq    %%r12, %%rdi                           \n\t"
+                "movq    %%r13, %%rsi                           \n\t"
+#if defined(__APPLE__)
+                "call    __port_thread_start                    \n\t"
+#else
+                "call    _port_thread_start                     \n\t"
+#endif
+                "hlt"
+                : : "i" (offsetof(thread_t, ctx.sp)));
+}
+
+/**
+ * @brief   Start a thread by invoking its work function.
+ * @details If the work function returns @p chThdExit() is automatically
+ *          invoked. In NIL threads are not supposed to return so the system
+ *          is halted instead.
+ */
+__attribute__((noreturn))
+void _port_thread_start(msg_t (*pf)(void *), void *p) {
+
+  chSysUnlock();
+  pf(p);
+#if defined(_CHIBIOS_RT_CONF_)
+  chThdExit(0);
+#endif
+#if defined(_CHIBIOS_NIL_CONF_)
+  chSysHalt("thread exit");
+#endif
+  while(1);
+}
+
+/**
+ * @brief   Returns the current value of the realtime counter.
+ * @note    In virtual time mode the counter is the virtual cycles counter
+ *          and each read is charged @p PORT_SIM_COUNTER_COST cycles.
+ *
+ * @return              The realtime counter value.
+ */
+rtcnt_t port_rt_get_counter_value(void) {
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+
+  PORT_SIM_CONSUME(PORT_SIM_COUNTER_COST);
+  return (rtcnt_t)port_sim_vtime;
+#else
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return ((rtcnt_t)tv.tv_sec * (rtcnt_t)1000000) + (rtcnt_t)tv.tv_usec;
+#endif
+}
+
+#if ((PORT_SIM_VIRTUAL_TIME == TRUE) && (PORT_SIM_FUNCTION_COST > 0)) ||      \
+    defined(__DOXYGEN__)
+/**
+ * @brief   Functions entry hook.
+ * @details Charges @p PORT_SIM_FUNCTION_COST cycles for each call of the
+ *          code compiled with @p -finstrument-functions.
+ */
+__attribute__((no_instrument_function))
+void __cyg_profile_func_enter(void *this_fn, void *call_site) {
+
+  (void)this_fn;
+  (void)call_site;
+  PORT_SIM_CONSUME(PORT_SIM_FUNCTION_COST);
+}
+
+/**
+ * @brief   Functions exit hook.
+ */
+__attribute__((no_instrument_function))
+void __cyg_profile_func_exit(void *this_fn, void *call_site) {
+
+  (void)this_fn;
+  (void)call_site;
+}
+#endif
+
+/** @} */
@@ -274,13 +274,32 @@ static mfs_error_t mfs_record_check(MFSDriver *mfsp,
         return MFS_NO_ERROR;
       }
 #if MFS_CFG_STRONG_CHECKING == TRUE
-      {
-        /* TODO: Checking the CRC while reading the record data.*/
-        (void)mfsp;
+      /* Checking the CRC while reading the record data, zero-sized records
+         are erase markers without data.*/
+      if (dhdrp->fields.size > 0U) {
+        flash_offset_t data_offset = offset +
+                                     (flash_offset_t)sizeof (mfs_data_header_t);
+        uint32_t total = dhdrp->fields.size;
+        uint16_t crc = 0xFFFFU;
+
+        while (total > 0U) {
+          uint32_t chunk = total > MFS_CFG_BUFFER_SIZE ?
+                           MFS_CFG_BUFFER_SIZE : total;
+
+          RET_ON_ERROR(mfs_flash_read(mfsp, data_offset, chunk,
+                                      mfsp->buffer.data8));
+          crc = crc16(crc, mfsp->buffer.data8, chunk);
+          data_offset += chunk;
+          total       -= chunk;
+        }
+        if (crc != dhdrp->fields.crc) {
+          *sts = MFS_RECORD_CRC;
+          return MFS_NO_ERROR;
+        }
       }
-#else
-      (void)mfsp;
 #endif
+      *sts = MFS_RECORD_OK;
+      return MFS_NO_ERROR;
     }
   }
 
@@ -433,6 +452,7 @@ static mfs_error_t mfs_bank_scan_records(MFSDriver *mfsp,
                                          mfs_bank_t bank,
                                          mfs_bank_state_t *statep) {
   flash_offset_t hdr_offset, start_offset, end_offset;
+  mfs_data_header_t dhdr;
   mfs_record_state_t sts;
   bool warning = false;
 
@@ -442,13 +462,14 @@ static mfs_error_t mfs_bank_scan_records(MFSDriver *mfsp,
   /* Scanning records.*/
   hdr_offset = start_offset + (flash_offset_t)sizeof(mfs_bank_header_t);
   while (hdr_offset < end_offset) {
-    /* Reading the current record header.*/
+    /* Reading the current record header, the transient buffer is used
+       by the integrity check.*/
     RET_ON_ERROR(mfs_flash_read(mfsp, hdr_offset,
                                 sizeof (mfs_data_header_t),
-                                (void *)&mfsp->buffer.dhdr));
+                                dhdr.hdr8));
 
     /* Checking header/data integrity.*/
-    RET_ON_ERROR(mfs_record_check(mfsp, &mfsp->buffer.dhdr,
+    RET_ON_ERROR(mfs_record_check(mfsp, &dhdr,
                                   hdr_offset, end_offset, &sts));
     if (sts == MFS_RECORD_ERASED) {
       /* Record area fully erased, stopping scan.*/
@@ -456,16 +477,16 @@ static mfs_error_t mfs_bank_scan_records(MFSDriver *mfsp,
     }
     else if (sts == MFS_RECORD_OK) {
       /* Record OK.*/
-      uint32_t size = mfsp->buffer.dhdr.fields.size;
+      uint32_t size = dhdr.fields.size;
 
       /* Zero-sized records are erase markers.*/
       if (size == 0U) {
-        mfsp->descriptors[mfsp->buffer.dhdr.fields.id - 1U].offset = 0U;
-        mfsp->descriptors[mfsp->buffer.dhdr.fields.id - 1U].size   = 0U;
+        mfsp->descriptors[dhdr.fields.id - 1U].offset = 0U;
+        mfsp->descriptors[dhdr.fields.id - 1U].size   = 0U;
       }
       else {
-        mfsp->descriptors[mfsp->buffer.dhdr.fields.id - 1U].offset = hdr_offset;
-        mfsp->descriptors[mfsp->buffer.dhdr.fields.id - 1U].size   = size;
+        mfsp->descriptors[dhdr.fields.id - 1U].offset = hdr_offset;
+        mfsp->descriptors[dhdr.fields.id - 1U].size   = size;
       }
     }
     else if (sts == MFS_RECORD_CRC) {
@@ -478,6 +499,10 @@ static mfs_error_t mfs_bank_scan_records(MFSDriver *mfsp,
       warning = true;
       break;
     }
+
+    /* Next record.*/
+    hdr_offset += (flash_offset_t)sizeof (mfs_data_header_t) +
+                  (flash_offset_t)dhdr.fields.size;
   }
 
   if (hdr_offset > end_offset) {
@@ -950,7 +975,7 @@ mfs_error_t mfsReadRecord(MFSDriver *mfsp, mfs_id_t id,
   /* Header read from flash.*/
   RET_ON_ERROR(mfs_flash_read(mfsp,
                               mfsp->descriptors[id - 1U].offset,
-                              *np,
+                              sizeof (mfs_data_header_t),
                               mfsp->buffer.data8));
 
   /* Data read from flash.*/
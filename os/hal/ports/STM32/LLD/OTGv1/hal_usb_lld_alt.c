@@ -937,7 +937,11 @@ void usb_lld_start(USBDriver *usbp) {
         THD_WORKING_AREA_END(usbp->wa_pump),
         STM32_USB_OTG_THREAD_PRIO,
         usb_lld_pump,
-        (void *)usbp
+        (void *)usbp,
+#if CH_CFG_USE_EDF == TRUE
+        (sysinterval_t)0,
+        (sysinterval_t)0
+#endif
       };
 
       usbp->tr = chThdCreateI(&usbpump_descriptor);
@@ -22,12 +22,29 @@
  * @{
  */
 
+#if !defined(__APPLE__)
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/time.h>
+#include <time.h>
+#include <poll.h>
+#if !defined(__APPLE__)
+#include <sys/prctl.h>
+#endif
 
 #include "hal.h"
 
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum number of host descriptors waited for in idle state.
+ */
+#define SIM_MAX_POLLFDS     8U
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -36,9 +53,6 @@
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
-static struct timeval nextcnt;
-static struct timeval tick = {0UL, 1000000UL / OSAL_ST_FREQUENCY};
-
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -60,16 +74,19 @@ void hal_lld_init(void) {
   puts("ChibiOS/RT simulator (OS X)\n");
 #else
   puts("ChibiOS/RT simulator (Linux)\n");
+
+  /* Minimal timer slack, sleeps are meant to be as accurate as possible.*/
+  (void)prctl(PR_SET_TIMERSLACK, 1UL);
 #endif
-  gettimeofday(&nextcnt, NULL);
-  timeradd(&nextcnt, &tick, &nextcnt);
 }
 
 /**
  * @brief   Interrupt simulation.
+ * @details Serves the pending simulated interrupt sources without waiting.
  */
 void _sim_check_for_interrupts(void) {
-  struct timeval tv;
+
+  PORT_SIM_CONSUME(PORT_SIM_POLL_COST);
 
 #if HAL_USE_SERIAL
   if (sd_lld_interrupt_pending()) {
@@ -81,23 +98,83 @@ void _sim_check_for_interrupts(void) {
   }
 #endif
 
-  gettimeofday(&tv, NULL);
-  if (timercmp(&tv, &nextcnt, >=)) {
-    timeradd(&nextcnt, &tick, &nextcnt);
-
-    CH_IRQ_PROLOGUE();
-
-    chSysLockFromISR();
-    chSysTimerHandlerI();
-    chSysUnlockFromISR();
-
-    CH_IRQ_EPILOGUE();
+#if HAL_USE_MAC
+  if (mac_lld_interrupt_pending()) {
+    _dbg_check_lock();
+    if (chSchIsPreemptionRequired())
+      chSchDoReschedule();
+    _dbg_check_unlock();
+    return;
+  }
+#endif
 
+#if OSAL_ST_MODE != OSAL_ST_MODE_NONE
+  if (st_lld_serve_interrupt()) {
     _dbg_check_lock();
     if (chSchIsPreemptionRequired())
       chSchDoReschedule();
     _dbg_check_unlock();
   }
+#endif
+}
+
+/**
+ * @brief   Waits for a simulated interrupt.
+ * @details The host process sleeps until the next system timer event or
+ *          until a simulated peripheral has activity on its descriptors,
+ *          then the interrupt sources are served. This function is meant
+ *          to be invoked from the idle state.
+ * @note    In virtual time mode the host does not sleep, the virtual time
+ *          is advanced to the next system timer event instead.
+ */
+void _sim_wait_for_interrupts(void) {
+  struct pollfd fds[SIM_MAX_POLLFDS];
+  nfds_t n = 0U;
+  int64_t ns = -1;
+
+#if HAL_USE_SERIAL
+  n += (nfds_t)sd_lld_get_pollfds(&fds[n]);
+#endif
+
+#if HAL_USE_MAC
+  n += (nfds_t)mac_lld_get_pollfds(&fds[n]);
+#endif
+
+#if OSAL_ST_MODE != OSAL_ST_MODE_NONE
+  ns = st_lld_get_timeout();
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+  /* In virtual time the idle period is skipped by moving the virtual clock
+     forward to the next timer event, the host only blocks if there is no
+     timer event scheduled.*/
+  if (ns > 0) {
+    PORT_SIM_CONSUME((ns + (int64_t)PORT_SIM_VT_CYCLE_NS - 1) /
+                     (int64_t)PORT_SIM_VT_CYCLE_NS);
+    ns = 0;
+  }
+#else
+  if (ns > (int64_t)SIM_IDLE_GUARD_NS) {
+    ns -= (int64_t)SIM_IDLE_GUARD_NS;
+  }
+  else if (ns > 0) {
+    ns = 0;
+  }
+#endif
+#endif
+
+  if (ns != 0) {
+#if defined(__APPLE__)
+    /* No ppoll() on OS X, the timeout is rounded up to milliseconds.*/
+    (void)poll(fds, n, ns < 0 ? -1 : (int)((ns + 999999) / 1000000));
+#else
+    struct timespec ts;
+
+    ts.tv_sec  = (time_t)(ns / 1000000000);
+    ts.tv_nsec = (long)(ns % 1000000000);
+    (void)ppoll(fds, n, ns < 0 ? NULL : &ts, NULL);
+#endif
+  }
+
+  _sim_check_for_interrupts();
 }
 
 /** @} */
@@ -29,10 +29,9 @@
 #include <windows.h>
 #else
 #include <sys/types.h>
-#include <sys/socket.h>
-#include <netdb.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 #endif
 #include <stdio.h>
 
@@ -53,6 +52,18 @@
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Idle wait guard time in nanoseconds.
+ * @details When idle the simulator sleeps until this amount of time before
+ *          the next system timer event then polls for the remaining time,
+ *          this hides the host wake-up latency. Higher values improve the
+ *          timing accuracy, lower values reduce the host CPU load, zero
+ *          means no polling at all.
+ */
+#if !defined(SIM_IDLE_GUARD_NS) || defined(__DOXYGEN__)
+#define SIM_IDLE_GUARD_NS                   200000
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -70,6 +81,7 @@ extern "C" {
 #endif
   void hal_lld_init(void);
   void _sim_check_for_interrupts(void);
+  void _sim_wait_for_interrupts(void);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,732 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_mac_lld.c
+ * @brief   Posix simulator low level MAC driver code.
+ *
+ * @addtogroup MAC
+ * @{
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "hal.h"
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+#if defined(__APPLE__)
+#error "the simulated MAC requires SOCK_SEQPACKET Unix sockets"
+#endif
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @name    pcap file format constants
+ * @{
+ */
+#define PCAP_MAGIC_US               0xA1B2C3D4U
+#define PCAP_MAGIC_NS               0xA1B23C4DU
+#define PCAP_LINKTYPE_ETHERNET      1U
+/** @} */
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Ethernet driver 1.
+ */
+MACDriver ETHD1;
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+static sim_eth_descriptor_t __eth_rd[SIM_MAC_RECEIVE_BUFFERS];
+static sim_eth_descriptor_t __eth_td[SIM_MAC_TRANSMIT_BUFFERS];
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t pcap_word(MACDriver *macp, uint32_t w) {
+
+  return macp->pcap_swapped ? __builtin_bswap32(w) : w;
+}
+
+static void pcap_open(MACDriver *macp, const char *path) {
+  uint32_t hdr[6];
+
+  macp->pcap = fopen(path, "rb");
+  if (macp->pcap == NULL) {
+    printf("ETHD1: Error opening %s\n", path);
+    exit(1);
+  }
+
+  if (fread(hdr, sizeof (hdr), 1, macp->pcap) != 1) {
+    printf("ETHD1: Error reading %s\n", path);
+    exit(1);
+  }
+
+  if ((hdr[0] == PCAP_MAGIC_US) || (hdr[0] == PCAP_MAGIC_NS)) {
+    macp->pcap_swapped = false;
+  }
+  else if ((__builtin_bswap32(hdr[0]) == PCAP_MAGIC_US) ||
+           (__builtin_bswap32(hdr[0]) == PCAP_MAGIC_NS)) {
+    macp->pcap_swapped = true;
+  }
+  else {
+    printf("ETHD1: %s is not a pcap file\n", path);
+    exit(1);
+  }
+
+  if (pcap_word(macp, hdr[5]) != PCAP_LINKTYPE_ETHERNET) {
+    printf("ETHD1: %s is not an Ethernet capture\n", path);
+    exit(1);
+  }
+  printf("ETHD1: replaying %s\n", path);
+}
+
+static void pcap_close(MACDriver *macp) {
+
+  if (macp->pcap != NULL) {
+    fclose(macp->pcap);
+    macp->pcap = NULL;
+  }
+}
+
+/**
+ * @brief   Reads the next frame from the replayed pcap file.
+ * @details Frames larger than the buffers are skipped.
+ *
+ * @return              The frame size.
+ * @retval 0            if the end of the capture has been reached.
+ */
+static size_t pcap_read(MACDriver *macp, uint8_t *buf) {
+  uint32_t rec[4];
+
+  while (fread(rec, sizeof (rec), 1, macp->pcap) == 1) {
+    size_t n = (size_t)pcap_word(macp, rec[2]);
+
+    if (n > SIM_MAC_BUFFERS_SIZE) {
+      if (fseek(macp->pcap, (long)n, SEEK_CUR) != 0) {
+        break;
+      }
+      continue;
+    }
+    if ((n > 0U) && (fread(buf, n, 1, macp->pcap) == 1)) {
+      return n;
+    }
+  }
+
+  printf("ETHD1: replay completed\n");
+  pcap_close(macp);
+  return 0U;
+}
+
+static void disconnect(MACDriver *macp) {
+
+  close(macp->eth_data);
+  macp->eth_data = -1;
+}
+
+/**
+ * @brief   Sends the released transmit descriptors in order.
+ * @details Frames are discarded if there is no connected peer, like a real
+ *          MAC without carrier would do.
+ *
+ * @return              The transmission status.
+ * @retval false        if no descriptors have been freed.
+ * @retval true         if at least one descriptor has been freed.
+ */
+static bool txsend(MACDriver *macp) {
+  sim_eth_descriptor_t *tdes;
+  bool freed = false;
+
+  while (((tdes = &__eth_td[macp->txsend])->flags & SIM_MAC_DESC_OWN) != 0U) {
+    if (macp->eth_data != -1) {
+      if (send(macp->eth_data, tdes->buffer, tdes->size, MSG_NOSIGNAL) < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+          break;
+        }
+        disconnect(macp);
+      }
+    }
+    tdes->flags = 0U;
+    macp->txsend = (macp->txsend + 1U) % SIM_MAC_TRANSMIT_BUFFERS;
+    freed = true;
+  }
+  return freed;
+}
+
+static bool connint(MACDriver *macp) {
+
+  if ((macp->eth_data == -1) && (macp->eth_listen != -1)) {
+    macp->eth_data = accept(macp->eth_listen, NULL, NULL);
+    if (macp->eth_data == -1) {
+      return false;
+    }
+
+    int flags = fcntl(macp->eth_data, F_GETFL, 0);
+    if (fcntl(macp->eth_data, F_SETFL, flags | O_NONBLOCK) != 0) {
+      printf("ETHD1: Unable to setup non blocking mode on data socket\n");
+      exit(1);
+    }
+    return true;
+  }
+  return false;
+}
+
+static bool rxint(MACDriver *macp) {
+  sim_eth_descriptor_t *rdes = &__eth_rd[macp->rxfill];
+  size_t size = 0U;
+
+  /* No free buffers, the frames are left in the host socket.*/
+  if ((rdes->flags & SIM_MAC_DESC_OWN) == 0U) {
+    return false;
+  }
+
+  /* A frame from the peer, oversized frames are dropped.*/
+  while ((size == 0U) && (macp->eth_data != -1)) {
+    ssize_t n = recv(macp->eth_data, rdes->buffer, SIM_MAC_BUFFERS_SIZE,
+                     MSG_TRUNC);
+    if (n == 0) {
+      disconnect(macp);
+    }
+    else if (n < 0) {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        break;
+      }
+      disconnect(macp);
+    }
+    else if ((size_t)n <= SIM_MAC_BUFFERS_SIZE) {
+      size = (size_t)n;
+    }
+  }
+
+  /* Else a frame from the replayed capture.*/
+  if ((size == 0U) && (macp->pcap != NULL)) {
+    size = pcap_read(macp, rdes->buffer);
+  }
+
+  if (size == 0U) {
+    return false;
+  }
+
+  rdes->size  = size;
+  rdes->flags = 0U;
+  macp->rxfill = (macp->rxfill + 1U) % SIM_MAC_RECEIVE_BUFFERS;
+
+  osalSysLockFromISR();
+  osalThreadDequeueAllI(&macp->rdqueue, MSG_RESET);
+#if MAC_USE_EVENTS
+  osalEventBroadcastFlagsI(&macp->rdevent, 0);
+#endif
+  osalSysUnlockFromISR();
+
+  return true;
+}
+
+static bool txint(MACDriver *macp) {
+
+  if (!txsend(macp)) {
+    return false;
+  }
+
+  osalSysLockFromISR();
+  osalThreadDequeueAllI(&macp->tdqueue, MSG_RESET);
+  osalSysUnlockFromISR();
+
+  return true;
+}
+
+static unsigned getfds(MACDriver *macp, struct pollfd *fdp) {
+  bool rxfree = (__eth_rd[macp->rxfill].flags & SIM_MAC_DESC_OWN) != 0U;
+  unsigned n = 0U;
+
+  if (macp->eth_data != -1) {
+    short events = 0;
+
+    if (rxfree) {
+      events |= POLLIN;
+    }
+    if ((__eth_td[macp->txsend].flags & SIM_MAC_DESC_OWN) != 0U) {
+      events |= POLLOUT;
+    }
+    if (events != 0) {
+      fdp[n].fd = macp->eth_data;
+      fdp[n].events = events;
+      n++;
+    }
+  }
+  else if (macp->eth_listen != -1) {
+    fdp[n].fd = macp->eth_listen;
+    fdp[n].events = POLLIN;
+    n++;
+  }
+
+  /* A regular file is always readable, the wait is not blocking while
+     there are frames to replay and free buffers.*/
+  if ((macp->pcap != NULL) && rxfree) {
+    fdp[n].fd = fileno(macp->pcap);
+    fdp[n].events = POLLIN;
+    n++;
+  }
+
+  return n;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   MAC simulated interrupt.
+ * @details Accepts a peer connection, receives one frame and sends the
+ *          pending frames.
+ *
+ * @return              The interrupt status.
+ * @retval false        if there was nothing to serve.
+ * @retval true         if the driver state changed.
+ *
+ * @notapi
+ */
+bool mac_lld_interrupt_pending(void) {
+  bool b;
+
+  OSAL_IRQ_PROLOGUE();
+
+  b = connint(&ETHD1);
+  b = rxint(&ETHD1) || b;
+  b = txint(&ETHD1) || b;
+
+  OSAL_IRQ_EPILOGUE();
+
+  return b;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level MAC initialization.
+ *
+ * @notapi
+ */
+void mac_lld_init(void) {
+
+  macObjectInit(&ETHD1);
+  ETHD1.link_up    = false;
+  ETHD1.eth_listen = -1;
+  ETHD1.eth_data   = -1;
+  ETHD1.pcap       = NULL;
+}
+
+/**
+ * @brief   Configures and activates the MAC peripheral.
+ * @details The listening socket is created, a peer process can connect
+ *          to it at any time.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_start(MACDriver *macp) {
+  struct sockaddr_un sun;
+  const char *path = SIM_MAC_SOCKET_PATH;
+  const char *pcap;
+  unsigned i;
+
+  /* Descriptor tables are initialized, all the receive buffers are
+     available.*/
+  for (i = 0; i < SIM_MAC_RECEIVE_BUFFERS; i++) {
+    __eth_rd[i].flags = SIM_MAC_DESC_OWN;
+  }
+  for (i = 0; i < SIM_MAC_TRANSMIT_BUFFERS; i++) {
+    __eth_td[i].flags = 0U;
+  }
+  macp->rxidx  = 0U;
+  macp->rxfill = 0U;
+  macp->txidx  = 0U;
+  macp->txsend = 0U;
+
+  if (strlen(path) >= sizeof (sun.sun_path)) {
+    printf("ETHD1: Socket path too long\n");
+    goto abort;
+  }
+
+  macp->eth_listen = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+  if (macp->eth_listen == -1) {
+    printf("ETHD1: Error creating simulator socket\n");
+    goto abort;
+  }
+
+  int flags = fcntl(macp->eth_listen, F_GETFL, 0);
+  if (fcntl(macp->eth_listen, F_SETFL, flags | O_NONBLOCK) != 0) {
+    printf("ETHD1: Unable to setup non blocking mode on socket\n");
+    goto abort;
+  }
+
+  memset(&sun, 0, sizeof (sun));
+  sun.sun_family = AF_UNIX;
+  strcpy(sun.sun_path, path);
+  (void)unlink(path);
+  if (bind(macp->eth_listen, (struct sockaddr *)&sun, sizeof (sun))) {
+    printf("ETHD1: Error binding socket\n");
+    goto abort;
+  }
+
+  if (listen(macp->eth_listen, 1) != 0) {
+    printf("ETHD1: Error listening socket\n");
+    goto abort;
+  }
+  printf("Ethernet ETHD1 listening on %s\n", path);
+
+  pcap = SIM_MAC_PCAP_PATH;
+  if (pcap != NULL) {
+    pcap_open(macp, pcap);
+  }
+  return;
+
+abort:
+  if (macp->eth_listen != -1)
+    close(macp->eth_listen);
+  exit(1);
+}
+
+/**
+ * @brief   Deactivates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_stop(MACDriver *macp) {
+
+  if (macp->state != MAC_STOP) {
+    if (macp->eth_data != -1) {
+      disconnect(macp);
+    }
+    close(macp->eth_listen);
+    macp->eth_listen = -1;
+    pcap_close(macp);
+    macp->link_up = false;
+  }
+}
+
+/**
+ * @brief   Returns a transmission descriptor.
+ * @details One of the available transmission descriptors is locked and
+ *          returned.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] tdp      pointer to a @p MACTransmitDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                      MACTransmitDescriptor *tdp) {
+  sim_eth_descriptor_t *tdes;
+
+  if (!macp->link_up)
+    return MSG_TIMEOUT;
+
+  osalSysLock();
+
+  /* Get Current TX descriptor.*/
+  tdes = &__eth_td[macp->txidx];
+
+  /* Ensure that descriptor isn't waiting to be sent or locked by another
+     thread.*/
+  if (tdes->flags & (SIM_MAC_DESC_OWN | SIM_MAC_DESC_LOCKED)) {
+    osalSysUnlock();
+    return MSG_TIMEOUT;
+  }
+
+  /* Marks the current descriptor as locked.*/
+  tdes->flags |= SIM_MAC_DESC_LOCKED;
+
+  /* Next TX descriptor to use.*/
+  macp->txidx = (macp->txidx + 1U) % SIM_MAC_TRANSMIT_BUFFERS;
+
+  osalSysUnlock();
+
+  /* Set the buffer size and configuration.*/
+  tdp->offset   = 0;
+  tdp->size     = SIM_MAC_BUFFERS_SIZE;
+  tdp->physdesc = tdes;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a transmit descriptor and starts the transmission of the
+ *          enqueued data as a single frame.
+ * @details The frame is sent immediately if the host socket can accept it,
+ *          else it is sent by the simulated interrupt.
+ *
+ * @param[in] tdp       the pointer to the @p MACTransmitDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
+
+  osalDbgAssert(!(tdp->physdesc->flags & SIM_MAC_DESC_OWN),
+              "attempt to release descriptor already owned by DMA");
+
+  osalSysLock();
+
+  tdp->physdesc->size  = tdp->offset;
+  tdp->physdesc->flags = SIM_MAC_DESC_OWN;
+
+  if (txsend(&ETHD1)) {
+    osalThreadDequeueAllI(&ETHD1.tdqueue, MSG_RESET);
+    osalOsRescheduleS();
+  }
+
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns a receive descriptor.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                     MACReceiveDescriptor *rdp) {
+  sim_eth_descriptor_t *rdes;
+
+  osalSysLock();
+
+  /* Get Current RX descriptor.*/
+  rdes = &__eth_rd[macp->rxidx];
+
+  /* The descriptor is still owned by the simulated DMA, no frames.*/
+  if (rdes->flags & SIM_MAC_DESC_OWN) {
+    osalSysUnlock();
+    return MSG_TIMEOUT;
+  }
+
+  rdp->offset   = 0;
+  rdp->size     = rdes->size;
+  rdp->physdesc = rdes;
+  macp->rxidx   = (macp->rxidx + 1U) % SIM_MAC_RECEIVE_BUFFERS;
+
+  osalSysUnlock();
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a receive descriptor.
+ * @details The descriptor and its buffer are made available for more incoming
+ *          frames.
+ *
+ * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
+
+  osalDbgAssert(!(rdp->physdesc->flags & SIM_MAC_DESC_OWN),
+              "attempt to release descriptor already owned by DMA");
+
+  osalSysLock();
+
+  /* Give buffer back to the simulated DMA.*/
+  rdp->physdesc->flags = SIM_MAC_DESC_OWN;
+
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Updates and returns the link status.
+ * @details The link is up while a peer is connected or a capture is being
+ *          replayed.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The link status.
+ * @retval true         if the link is active.
+ * @retval false        if the link is down.
+ *
+ * @notapi
+ */
+bool mac_lld_poll_link_status(MACDriver *macp) {
+
+  return macp->link_up = (macp->eth_data != -1) || (macp->pcap != NULL);
+}
+
+/**
+ * @brief   Writes to a transmit descriptor's stream.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] buf       pointer to the buffer containing the data to be
+ *                      written
+ * @param[in] size      number of bytes to be written
+ * @return              The number of bytes written into the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if the maximum
+ *                      frame size is reached.
+ *
+ * @notapi
+ */
+size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                         uint8_t *buf,
+                                         size_t size) {
+
+  osalDbgAssert(!(tdp->physdesc->flags & SIM_MAC_DESC_OWN),
+              "attempt to write descriptor already owned by DMA");
+
+  if (size > tdp->size - tdp->offset)
+    size = tdp->size - tdp->offset;
+
+  if (size > 0) {
+    memcpy(tdp->physdesc->buffer + tdp->offset, buf, size);
+    tdp->offset += size;
+  }
+  return size;
+}
+
+/**
+ * @brief   Reads from a receive descriptor's stream.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[in] buf       pointer to the buffer that will receive the read data
+ * @param[in] size      number of bytes to be read
+ * @return              The number of bytes read from the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if there are
+ *                      no more bytes to read.
+ *
+ * @notapi
+ */
+size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                       uint8_t *buf,
+                                       size_t size) {
+
+  osalDbgAssert(!(rdp->physdesc->flags & SIM_MAC_DESC_OWN),
+              "attempt to read descriptor already owned by DMA");
+
+  if (size > rdp->size - rdp->offset)
+    size = rdp->size - rdp->offset;
+
+  if (size > 0) {
+    memcpy(buf, rdp->physdesc->buffer + rdp->offset, size);
+    rdp->offset += size;
+  }
+  return size;
+}
+
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a pointer to the next transmit buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that enough buffers can be requested to fill
+ *          a whole frame.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] size      size of the requested buffer. Specify the frame size
+ *                      on the first call then scale the value down subtracting
+ *                      the amount of data already copied into the previous
+ *                      buffers.
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ *                      Note that a returned size lower than the amount
+ *                      requested means that more buffers must be requested
+ *                      in order to fill the frame data entirely.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                          size_t size,
+                                          size_t *sizep) {
+
+  if (tdp->offset == 0) {
+    *sizep      = tdp->size;
+    tdp->offset = size;
+    return tdp->physdesc->buffer;
+  }
+  *sizep = 0;
+  return NULL;
+}
+
+/**
+ * @brief   Returns a pointer to the next receive buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that the descriptor chain contains a whole
+ *          frame.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                               size_t *sizep) {
+
+  if (rdp->size > 0) {
+    *sizep      = rdp->size;
+    rdp->offset = rdp->size;
+    rdp->size   = 0;
+    return rdp->physdesc->buffer;
+  }
+  *sizep = 0;
+  return NULL;
+}
+#endif /* MAC_USE_ZERO_COPY */
+
+/**
+ * @brief   Returns the host descriptors to be waited for.
+ * @details The listening socket is returned while not connected, the data
+ *          socket is returned when connected, read readiness is requested
+ *          only if there are free receive buffers and write readiness only
+ *          if there are frames waiting to be sent.
+ *
+ * @param[out] fds      array receiving the descriptors, it must have space
+ *                      for two entries
+ * @return              The number of descriptors written in @p fds.
+ *
+ * @notapi
+ */
+unsigned mac_lld_get_pollfds(struct pollfd *fds) {
+
+  return getfds(&ETHD1, fds);
+}
+
+#endif /* HAL_USE_MAC */
+
+/** @} */
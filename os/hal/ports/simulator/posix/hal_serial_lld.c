@@ -25,6 +25,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <sys/socket.h>
+#include <netdb.h>
 
 #include "hal.h"
 
@@ -215,6 +217,25 @@ static bool outint(SerialDriver *sdp) {
   return false;
 }
 
+static unsigned getfds(SerialDriver *sdp, struct pollfd *fdp) {
+
+  if (sdp->com_data != -1) {
+    fdp->fd = sdp->com_data;
+    fdp->events = POLLIN;
+    osalSysLock();
+    if (!oqIsEmptyI(&sdp->oqueue))
+      fdp->events |= POLLOUT;
+    osalSysUnlock();
+    return 1U;
+  }
+  if (sdp->com_listen != -1) {
+    fdp->fd = sdp->com_listen;
+    fdp->events = POLLIN;
+    return 1U;
+  }
+  return 0U;
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -293,6 +314,29 @@ bool sd_lld_interrupt_pending(void) {
   return b;
 }
 
+/**
+ * @brief   Returns the host descriptors to be waited for.
+ * @details The listening socket is returned while not connected, the data
+ *          socket is returned when connected, write readiness is requested
+ *          only if there is data in the output queue.
+ *
+ * @param[out] fds      array receiving the descriptors, it must have space
+ *                      for two entries
+ * @return              The number of descriptors written in @p fds.
+ */
+unsigned sd_lld_get_pollfds(struct pollfd *fds) {
+  unsigned n = 0U;
+
+#if USE_SIM_SERIAL1
+  n += getfds(&SD1, &fds[n]);
+#endif
+#if USE_SIM_SERIAL2
+  n += getfds(&SD2, &fds[n]);
+#endif
+
+  return n;
+}
+
 #endif /* HAL_USE_SERIAL */
 
 /** @} */
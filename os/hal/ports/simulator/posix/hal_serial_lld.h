@@ -132,6 +132,7 @@ extern "C" {
   void sd_lld_start(SerialDriver *sdp, const SerialConfig *config);
   void sd_lld_stop(SerialDriver *sdp);
   bool sd_lld_interrupt_pending(void);
+  unsigned sd_lld_get_pollfds(struct pollfd *fds);
 #ifdef __cplusplus
 }
 #endif
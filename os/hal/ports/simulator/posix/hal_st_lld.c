@@ -0,0 +1,317 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_st_lld.c
+ * @brief   Posix simulator ST subsystem low level driver source.
+ *
+ * @addtogroup ST
+ * @{
+ */
+
+#include <time.h>
+
+#include "hal.h"
+
+#if (OSAL_ST_MODE != OSAL_ST_MODE_NONE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Duration of a system tick in nanoseconds.
+ */
+#define ST_TICK_NS          (1000000000ULL / (uint64_t)OSAL_ST_FREQUENCY)
+
+/**
+ * @brief   Value marking the alarm as already served.
+ */
+#define ST_NO_DEADLINE      UINT64_MAX
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Host monotonic time at initialization, in nanoseconds.
+ */
+static uint64_t st_base;
+
+#if (OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC) || defined(__DOXYGEN__)
+/**
+ * @brief   Number of the next system tick to be served.
+ */
+static uint64_t st_next;
+#endif
+
+#if (OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING) || defined(__DOXYGEN__)
+/**
+ * @brief   Alarm enable flag.
+ */
+static bool st_alarm_active;
+
+/**
+ * @brief   Alarm time as programmed by the OS.
+ */
+static systime_t st_alarm;
+
+/**
+ * @brief   Absolute tick number of the alarm.
+ * @note    It is @p ST_NO_DEADLINE after the alarm has been served, the
+ *          alarm stays active but it is not triggered again until it is
+ *          reprogrammed.
+ */
+static uint64_t st_deadline;
+#endif
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the host monotonic time in nanoseconds.
+ * @note    In virtual time mode the virtual time is returned instead.
+ */
+static uint64_t st_host_ns(void) {
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+
+  return port_sim_vtime * (uint64_t)PORT_SIM_VT_CYCLE_NS;
+#else
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief   Returns the number of ticks elapsed since initialization.
+ */
+static uint64_t st_get_ticks(void) {
+
+  return (st_host_ns() - st_base) / ST_TICK_NS;
+}
+
+/**
+ * @brief   Returns the nanoseconds left before the specified tick.
+ */
+static int64_t st_ns_to_tick(uint64_t tick) {
+  uint64_t now = st_host_ns() - st_base;
+
+  if (tick * ST_TICK_NS <= now) {
+    return (int64_t)0;
+  }
+  return (int64_t)((tick * ST_TICK_NS) - now);
+}
+
+#if (OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING) || defined(__DOXYGEN__)
+/**
+ * @brief   Programs the alarm deadline.
+ * @note    A host process can be preempted for much longer than
+ *          @p CH_CFG_ST_TIMEDELTA, an alarm time that is already in the past
+ *          is triggered as soon as possible instead of after a counter
+ *          wrap-around like a real comparator would do. Times beyond half
+ *          the counter range are considered in the past, the worst case
+ *          is a spurious early alarm which is harmless.
+ */
+static void st_program(systime_t time) {
+  uint64_t now = st_get_ticks();
+  systime_t delta = (systime_t)(time - (systime_t)now);
+
+  st_alarm = time;
+  if (delta > (systime_t)(((systime_t)-1) / (systime_t)2)) {
+    st_deadline = now;
+  }
+  else {
+    st_deadline = now + (uint64_t)delta;
+  }
+}
+#endif
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   System timer simulated interrupt.
+ * @details Invokes the OS timer handler if a tick is due, in periodic mode,
+ *          or if the alarm time has been reached, in free running mode.
+ *          Ticks lost because of host latencies are served one per call.
+ *
+ * @return              The interrupt status.
+ * @retval false        if there was nothing to serve.
+ * @retval true         if the OS timer handler has been invoked.
+ *
+ * @notapi
+ */
+bool st_lld_serve_interrupt(void) {
+
+#if OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC
+  if (st_get_ticks() < st_next) {
+    return false;
+  }
+  st_next++;
+#else
+  if (!st_alarm_active || (st_get_ticks() < st_deadline)) {
+    return false;
+  }
+  st_deadline = ST_NO_DEADLINE;
+#endif
+
+  OSAL_IRQ_PROLOGUE();
+
+  osalSysLockFromISR();
+  osalOsTimerHandlerI();
+  osalSysUnlockFromISR();
+
+  OSAL_IRQ_EPILOGUE();
+
+  return true;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level ST driver initialization.
+ *
+ * @notapi
+ */
+void st_lld_init(void) {
+
+  st_base = st_host_ns();
+#if OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC
+  st_next = 1U;
+#else
+  st_alarm_active = false;
+  st_deadline = ST_NO_DEADLINE;
+#endif
+}
+
+/**
+ * @brief   Returns the time left before the next timer event.
+ * @details The simulator uses this value as timeout when waiting for
+ *          simulated interrupts.
+ *
+ * @return              The time left in nanoseconds, zero if an event is
+ *                      already pending.
+ * @retval -1           if no timer event is scheduled.
+ *
+ * @notapi
+ */
+int64_t st_lld_get_timeout(void) {
+
+#if OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC
+  return st_ns_to_tick(st_next);
+#else
+  if (!st_alarm_active || (st_deadline == ST_NO_DEADLINE)) {
+    return (int64_t)-1;
+  }
+  return st_ns_to_tick(st_deadline);
+#endif
+}
+
+#if (OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the time counter value.
+ *
+ * @return              The counter value.
+ *
+ * @notapi
+ */
+systime_t st_lld_get_counter(void) {
+
+  return (systime_t)st_get_ticks();
+}
+
+/**
+ * @brief   Starts the alarm.
+ * @note    Makes sure that no spurious alarms are triggered after
+ *          this call.
+ *
+ * @param[in] time      the time to be set for the first alarm
+ *
+ * @notapi
+ */
+void st_lld_start_alarm(systime_t time) {
+
+  st_program(time);
+  st_alarm_active = true;
+}
+
+/**
+ * @brief   Stops the alarm interrupt.
+ *
+ * @notapi
+ */
+void st_lld_stop_alarm(void) {
+
+  st_alarm_active = false;
+  st_deadline = ST_NO_DEADLINE;
+}
+
+/**
+ * @brief   Sets the alarm time.
+ *
+ * @param[in] time      the time to be set for the next alarm
+ *
+ * @notapi
+ */
+void st_lld_set_alarm(systime_t time) {
+
+  st_program(time);
+}
+
+/**
+ * @brief   Returns the current alarm time.
+ *
+ * @return              The currently set alarm time.
+ *
+ * @notapi
+ */
+systime_t st_lld_get_alarm(void) {
+
+  return st_alarm;
+}
+
+/**
+ * @brief   Determines if the alarm is active.
+ *
+ * @return              The alarm status.
+ * @retval false        if the alarm is not active.
+ * @retval true         is the alarm is active
+ *
+ * @notapi
+ */
+bool st_lld_is_alarm_active(void) {
+
+  return st_alarm_active;
+}
+#endif /* OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING */
+
+#endif /* OSAL_ST_MODE != OSAL_ST_MODE_NONE */
+
+/** @} */
@@ -0,0 +1,356 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/simblk.c
+ * @brief   Posix simulator block device code.
+ *
+ * @addtogroup SIMBLK
+ * @{
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "hal.h"
+#include "simblk.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Simulated block device 1.
+ */
+SimBlockDriver SIMBLKD1;
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+static bool simblk_is_inserted(void *instance);
+static bool simblk_is_protected(void *instance);
+static bool simblk_connect(void *instance);
+static bool simblk_disconnect(void *instance);
+static bool simblk_read(void *instance, uint32_t startblk,
+                        uint8_t *buffer, uint32_t n);
+static bool simblk_write(void *instance, uint32_t startblk,
+                         const uint8_t *buffer, uint32_t n);
+static bool simblk_sync(void *instance);
+static bool simblk_get_info(void *instance, BlockDeviceInfo *bdip);
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct SimBlockDriverVMT simblk_vmt = {
+  simblk_is_inserted, simblk_is_protected,
+  simblk_connect, simblk_disconnect,
+  simblk_read, simblk_write, simblk_sync,
+  simblk_get_info
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Waits for a free command slot.
+ *
+ * @param[in] devp      pointer to the @p SimBlockDriver object
+ */
+static void simblk_acquire(SimBlockDriver *devp) {
+
+  osalSysLock();
+  while (devp->inflight >= devp->config->queue_depth) {
+    (void) osalThreadEnqueueTimeoutS(&devp->queue, TIME_INFINITE);
+  }
+  devp->inflight++;
+  if (devp->inflight > devp->stats.max_inflight) {
+    devp->stats.max_inflight = devp->inflight;
+  }
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Emulates the command latency then releases the command slot.
+ *
+ * @param[in] devp      pointer to the @p SimBlockDriver object
+ * @param[in] latency   command latency in microseconds
+ * @param[in] n         number of transferred blocks
+ */
+static void simblk_complete(SimBlockDriver *devp, uint32_t latency,
+                            uint32_t n) {
+  uint32_t busy_time = latency + (n * devp->config->transfer_time);
+
+  /* Other threads can issue commands meanwhile, up to the queue depth.*/
+  if (busy_time > 0U) {
+    osalThreadSleepMicroseconds(busy_time);
+  }
+
+  osalSysLock();
+  devp->inflight--;
+  osalThreadDequeueNextI(&devp->queue, MSG_OK);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+static bool simblk_is_inserted(void *instance) {
+  SimBlockDriver *devp = (SimBlockDriver *)instance;
+
+  return devp->fd >= 0;
+}
+
+static bool simblk_is_protected(void *instance) {
+
+  (void)instance;
+
+  return false;
+}
+
+static bool simblk_connect(void *instance) {
+  SimBlockDriver *devp = (SimBlockDriver *)instance;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgAssert((devp->state == BLK_ACTIVE) || (devp->state == BLK_READY),
+                "invalid state");
+
+  devp->state = BLK_READY;
+
+  return HAL_SUCCESS;
+}
+
+static bool simblk_disconnect(void *instance) {
+  SimBlockDriver *devp = (SimBlockDriver *)instance;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgAssert((devp->state == BLK_ACTIVE) || (devp->state == BLK_READY),
+                "invalid state");
+
+  devp->state = BLK_ACTIVE;
+
+  return HAL_SUCCESS;
+}
+
+static bool simblk_read(void *instance, uint32_t startblk,
+                        uint8_t *buffer, uint32_t n) {
+  SimBlockDriver *devp = (SimBlockDriver *)instance;
+  size_t size;
+
+  osalDbgCheck((instance != NULL) && (buffer != NULL) && (n > 0U));
+
+  /* The state stays BLK_READY while commands are in progress because more
+     than one command can be served at the same time.*/
+  if ((devp->state != BLK_READY) || (startblk >= devp->blk_num) ||
+      (n > devp->blk_num - startblk)) {
+    return HAL_FAILED;
+  }
+
+  simblk_acquire(devp);
+
+  size = (size_t)n * (size_t)devp->config->blk_size;
+  if (pread(devp->fd, buffer, size,
+            (off_t)startblk * (off_t)devp->config->blk_size) !=
+      (ssize_t)size) {
+    simblk_complete(devp, 0U, 0U);
+    return HAL_FAILED;
+  }
+  devp->stats.read_cmds++;
+  devp->stats.read_blocks += n;
+
+  simblk_complete(devp, devp->config->read_latency, n);
+
+  return HAL_SUCCESS;
+}
+
+static bool simblk_write(void *instance, uint32_t startblk,
+                         const uint8_t *buffer, uint32_t n) {
+  SimBlockDriver *devp = (SimBlockDriver *)instance;
+  size_t size;
+
+  osalDbgCheck((instance != NULL) && (buffer != NULL) && (n > 0U));
+
+  if ((devp->state != BLK_READY) || (startblk >= devp->blk_num) ||
+      (n > devp->blk_num - startblk)) {
+    return HAL_FAILED;
+  }
+
+  simblk_acquire(devp);
+
+  size = (size_t)n * (size_t)devp->config->blk_size;
+  if (pwrite(devp->fd, buffer, size,
+             (off_t)startblk * (off_t)devp->config->blk_size) !=
+      (ssize_t)size) {
+    simblk_complete(devp, 0U, 0U);
+    return HAL_FAILED;
+  }
+  devp->stats.write_cmds++;
+  devp->stats.write_blocks += n;
+
+  simblk_complete(devp, devp->config->write_latency, n);
+
+  return HAL_SUCCESS;
+}
+
+static bool simblk_sync(void *instance) {
+  SimBlockDriver *devp = (SimBlockDriver *)instance;
+
+  osalDbgCheck(instance != NULL);
+
+  if (devp->state != BLK_READY) {
+    return HAL_FAILED;
+  }
+
+  /* Writes are completed when the command returns, the image is not
+     flushed to the host storage.*/
+  devp->stats.sync_cmds++;
+
+  return HAL_SUCCESS;
+}
+
+static bool simblk_get_info(void *instance, BlockDeviceInfo *bdip) {
+  SimBlockDriver *devp = (SimBlockDriver *)instance;
+
+  osalDbgCheck((instance != NULL) && (bdip != NULL));
+
+  if (devp->state != BLK_READY) {
+    return HAL_FAILED;
+  }
+
+  bdip->blk_num  = devp->blk_num;
+  bdip->blk_size = devp->config->blk_size;
+
+  return HAL_SUCCESS;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] devp     pointer to the @p SimBlockDriver object
+ *
+ * @init
+ */
+void simblkObjectInit(SimBlockDriver *devp) {
+
+  osalDbgCheck(devp != NULL);
+
+  devp->vmt      = &simblk_vmt;
+  devp->state    = BLK_STOP;
+  devp->config   = NULL;
+  devp->fd       = -1;
+  devp->blk_num  = 0U;
+  devp->inflight = 0U;
+  osalThreadQueueObjectInit(&devp->queue);
+  memset(&devp->stats, 0, sizeof devp->stats);
+}
+
+/**
+ * @brief   Configures and activates the simulated block device.
+ * @details The disk image is opened, failures of the host system are
+ *          fatal. The device must then be connected using
+ *          @p blkConnect().
+ *
+ * @param[in] devp      pointer to the @p SimBlockDriver object
+ * @param[in] config    pointer to the configuration
+ *
+ * @api
+ */
+void simblkStart(SimBlockDriver *devp, const SimBlockConfig *config) {
+
+  osalDbgCheck((devp != NULL) && (config != NULL) &&
+               (config->path != NULL) && (config->blk_size > 0U) &&
+               (config->queue_depth > 0U));
+  osalDbgAssert((devp->state == BLK_STOP) || (devp->state == BLK_ACTIVE),
+                "invalid state");
+
+  devp->config = config;
+
+  if (devp->state == BLK_STOP) {
+    struct stat st;
+
+    devp->fd = open(config->path, O_RDWR | O_CREAT, 0644);
+    if ((devp->fd < 0) || (fstat(devp->fd, &st) < 0)) {
+      printf("SIMBLK: cannot open %s\n", config->path);
+      exit(1);
+    }
+
+    /* Device size, a shorter image is extended with zeros.*/
+    if (config->blk_num == 0U) {
+      devp->blk_num = (uint32_t)(st.st_size / config->blk_size);
+    }
+    else {
+      devp->blk_num = config->blk_num;
+      if ((st.st_size < (off_t)config->blk_num * (off_t)config->blk_size) &&
+          (ftruncate(devp->fd,
+                     (off_t)config->blk_num * (off_t)config->blk_size) < 0)) {
+        printf("SIMBLK: cannot resize %s\n", config->path);
+        exit(1);
+      }
+    }
+
+    devp->state = BLK_ACTIVE;
+  }
+}
+
+/**
+ * @brief   Deactivates the simulated block device.
+ *
+ * @param[in] devp      pointer to the @p SimBlockDriver object
+ *
+ * @api
+ */
+void simblkStop(SimBlockDriver *devp) {
+
+  osalDbgCheck(devp != NULL);
+  osalDbgAssert((devp->state == BLK_STOP) || (devp->state == BLK_ACTIVE) ||
+                (devp->state == BLK_READY), "invalid state");
+  osalDbgAssert(devp->inflight == 0U, "commands in progress");
+
+  if (devp->state != BLK_STOP) {
+    (void)close(devp->fd);
+    devp->fd      = -1;
+    devp->blk_num = 0U;
+    devp->config  = NULL;
+    devp->state   = BLK_STOP;
+  }
+}
+
+/**
+ * @brief   Clears the device statistics.
+ *
+ * @param[in] devp      pointer to the @p SimBlockDriver object
+ *
+ * @api
+ */
+void simblkResetStatistics(SimBlockDriver *devp) {
+
+  osalDbgCheck(devp != NULL);
+
+  memset(&devp->stats, 0, sizeof devp->stats);
+}
+
+/** @} */
@@ -0,0 +1,202 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/simblk.h
+ * @brief   Posix simulator block device header.
+ * @details Block device backed by a disk image file, commands are served
+ *          with emulated latencies and a limited number of commands can
+ *          be in progress at the same time.
+ *
+ * @addtogroup SIMBLK
+ * @{
+ */
+
+#ifndef SIMBLK_H
+#define SIMBLK_H
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a simulated block device configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Path of the disk image file.
+   * @note    The file is created, or extended with zeros, if it is shorter
+   *          than @p blk_num blocks.
+   */
+  const char                    *path;
+  /**
+   * @brief   Block size in bytes.
+   */
+  uint32_t                      blk_size;
+  /**
+   * @brief   Number of blocks.
+   * @note    If zero then the size of the existing image file is used.
+   */
+  uint32_t                      blk_num;
+  /**
+   * @brief   Read command latency in microseconds.
+   */
+  uint32_t                      read_latency;
+  /**
+   * @brief   Write command latency in microseconds.
+   */
+  uint32_t                      write_latency;
+  /**
+   * @brief   Per block transfer time in microseconds.
+   */
+  uint32_t                      transfer_time;
+  /**
+   * @brief   Number of commands that can be in progress at the same time.
+   * @details Commands issued by further threads wait for a free slot.
+   */
+  uint32_t                      queue_depth;
+} SimBlockConfig;
+
+/**
+ * @brief   Type of simulated block device statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Number of read commands.
+   */
+  uint32_t                      read_cmds;
+  /**
+   * @brief   Number of blocks read.
+   */
+  uint64_t                      read_blocks;
+  /**
+   * @brief   Number of write commands.
+   */
+  uint32_t                      write_cmds;
+  /**
+   * @brief   Number of blocks written.
+   */
+  uint64_t                      write_blocks;
+  /**
+   * @brief   Number of sync commands.
+   */
+  uint32_t                      sync_cmds;
+  /**
+   * @brief   Maximum number of commands in progress at the same time.
+   */
+  uint32_t                      max_inflight;
+} simblk_stats_t;
+
+/**
+ * @brief   @p SimBlockDriver specific methods.
+ */
+#define _simblk_methods                                                     \
+  _base_block_device_methods
+
+/**
+ * @extends BaseBlockDeviceVMT
+ *
+ * @brief   @p SimBlockDriver virtual methods table.
+ */
+struct SimBlockDriverVMT {
+  _simblk_methods
+};
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   Type of a simulated block device driver.
+ */
+typedef struct {
+  /**
+   * @brief   SimBlockDriver Virtual Methods Table.
+   */
+  const struct SimBlockDriverVMT *vmt;
+  _base_block_device_data
+  /**
+   * @brief   Current configuration data.
+   */
+  const SimBlockConfig          *config;
+  /**
+   * @brief   Disk image file descriptor or -1.
+   */
+  int                           fd;
+  /**
+   * @brief   Number of blocks.
+   */
+  uint32_t                      blk_num;
+  /**
+   * @brief   Number of commands in progress.
+   */
+  uint32_t                      inflight;
+  /**
+   * @brief   Threads waiting for a free command slot.
+   */
+  threads_queue_t               queue;
+  /**
+   * @brief   Device statistics.
+   */
+  simblk_stats_t                stats;
+} SimBlockDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the device statistics.
+ *
+ * @param[in] devp      pointer to the @p SimBlockDriver object
+ * @return              Pointer to the @p simblk_stats_t structure.
+ *
+ * @api
+ */
+#define simblkGetStatistics(devp) (&(devp)->stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if !defined(__DOXYGEN__)
+extern SimBlockDriver SIMBLKD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void simblkObjectInit(SimBlockDriver *devp);
+  void simblkStart(SimBlockDriver *devp, const SimBlockConfig *config);
+  void simblkStop(SimBlockDriver *devp);
+  void simblkResetStatistics(SimBlockDriver *devp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIMBLK_H */
+
+/** @} */
@@ -0,0 +1,9 @@
+# List of all the simulated block device files.
+SIMBLKSRC := $(CHIBIOS)/os/hal/ports/simulator/posix/simblk.c
+
+# Required include directories
+SIMBLKINC := $(CHIBIOS)/os/hal/ports/simulator/posix
+
+# Shared variables
+ALLCSRC += $(SIMBLKSRC)
+ALLINC  += $(SIMBLKINC)
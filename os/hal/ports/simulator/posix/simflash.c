@@ -0,0 +1,568 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/simflash.c
+ * @brief   Posix simulator flash device code.
+ *
+ * @addtogroup SIMFLASH
+ * @{
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "hal.h"
+#include "simflash.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+#define ERASED_BYTE                         0xFFU
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+static const flash_descriptor_t *simflash_get_descriptor(void *instance);
+static flash_error_t simflash_read(void *instance, flash_offset_t offset,
+                                   size_t n, uint8_t *rp);
+static flash_error_t simflash_program(void *instance, flash_offset_t offset,
+                                      size_t n, const uint8_t *pp);
+static flash_error_t simflash_start_erase_all(void *instance);
+static flash_error_t simflash_start_erase_sector(void *instance,
+                                                 flash_sector_t sector);
+static flash_error_t simflash_query_erase(void *instance, uint32_t *msec);
+static flash_error_t simflash_verify_erase(void *instance,
+                                           flash_sector_t sector);
+
+/**
+ * @brief   Virtual methods table.
+ */
+static const struct SimFlashDriverVMT simflash_vmt = {
+  simflash_get_descriptor, simflash_read, simflash_program,
+  simflash_start_erase_all, simflash_start_erase_sector,
+  simflash_query_erase, simflash_verify_erase
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static flash_offset_t simflash_sector_offset(SimFlashDriver *devp,
+                                             flash_sector_t sector) {
+
+  if (devp->config->sectors != NULL) {
+    return devp->config->sectors[sector].offset;
+  }
+  return (flash_offset_t)sector * (flash_offset_t)devp->config->sectors_size;
+}
+
+static uint32_t simflash_sector_size(SimFlashDriver *devp,
+                                     flash_sector_t sector) {
+
+  if (devp->config->sectors != NULL) {
+    return devp->config->sectors[sector].size;
+  }
+  return devp->config->sectors_size;
+}
+
+static bool simflash_is_erased(const uint8_t *p, size_t n) {
+
+  while (n > 0U) {
+    if (*p++ != ERASED_BYTE) {
+      return false;
+    }
+    n--;
+  }
+  return true;
+}
+
+/**
+ * @brief   Accounts a program or erase operation for power failure.
+ *
+ * @param[in] devp      pointer to the @p SimFlashDriver object
+ * @return              The operation outcome.
+ * @retval false        if the operation can be performed normally.
+ * @retval true         if the power fails during this operation.
+ */
+static bool simflash_power_fails(SimFlashDriver *devp) {
+
+  if (devp->pf_countdown == 0U) {
+    return false;
+  }
+  if (--devp->pf_countdown > 0U) {
+    return false;
+  }
+  devp->pf_failed = true;
+  return true;
+}
+
+/**
+ * @brief   Erases a sector or a part of it.
+ * @note    If the power fails during the operation then only the first
+ *          half of the sector is erased.
+ *
+ * @param[in] devp      pointer to the @p SimFlashDriver object
+ * @param[in] sector    sector to be erased
+ * @return              The operation outcome.
+ * @retval false        if the sector has been erased.
+ * @retval true         if the power failed.
+ */
+static bool simflash_erase(SimFlashDriver *devp, flash_sector_t sector) {
+  flash_offset_t offset = simflash_sector_offset(devp, sector);
+  uint32_t size = simflash_sector_size(devp, sector);
+
+  if (simflash_power_fails(devp)) {
+    memset(&devp->mem[offset], ERASED_BYTE, size / 2U);
+    return true;
+  }
+
+  memset(&devp->mem[offset], ERASED_BYTE, size);
+  devp->stats.erase_ops++;
+  devp->stats.erase_bytes += size;
+
+  return false;
+}
+
+static const flash_descriptor_t *simflash_get_descriptor(void *instance) {
+  SimFlashDriver *devp = (SimFlashDriver *)instance;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgAssert((devp->state != FLASH_UNINIT) && (devp->state != FLASH_STOP),
+                "invalid state");
+
+  return &devp->descriptor;
+}
+
+static flash_error_t simflash_read(void *instance, flash_offset_t offset,
+                                   size_t n, uint8_t *rp) {
+  SimFlashDriver *devp = (SimFlashDriver *)instance;
+
+  osalDbgCheck((instance != NULL) && (rp != NULL) && (n > 0U));
+  osalDbgCheck((size_t)offset + n <= devp->size);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  if (devp->pf_failed) {
+    return FLASH_ERROR_HW_FAILURE;
+  }
+
+  if (devp->state == FLASH_ERASE) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  memcpy(rp, &devp->mem[offset], n);
+  devp->stats.read_ops++;
+  devp->stats.read_bytes += n;
+
+  return FLASH_NO_ERROR;
+}
+
+static flash_error_t simflash_program(void *instance, flash_offset_t offset,
+                                      size_t n, const uint8_t *pp) {
+  SimFlashDriver *devp = (SimFlashDriver *)instance;
+  uint32_t granularity = devp->config->granularity;
+  uint32_t page_size = devp->config->page_size;
+  uint32_t busy_time = 0U;
+  size_t i;
+
+  osalDbgCheck((instance != NULL) && (pp != NULL) && (n > 0U));
+  osalDbgCheck((size_t)offset + n <= devp->size);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  if (devp->pf_failed) {
+    return FLASH_ERROR_HW_FAILURE;
+  }
+
+  if (devp->state == FLASH_ERASE) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  /* Checking that the operation is possible before touching the memory,
+     bits can only be cleared and program units can only be programmed
+     once if the granularity is greater than one.*/
+  if (granularity > 1U) {
+    if (((offset % granularity) != 0U) || ((n % granularity) != 0U) ||
+        !simflash_is_erased(&devp->mem[offset], n)) {
+      return FLASH_ERROR_PROGRAM;
+    }
+  }
+  else {
+    for (i = 0U; i < n; i++) {
+      if ((devp->mem[offset + i] & pp[i]) != pp[i]) {
+        return FLASH_ERROR_PROGRAM;
+      }
+    }
+  }
+
+  /* FLASH_PGM state while the operation is performed.*/
+  devp->state = FLASH_PGM;
+
+  /* Data is programmed page by page.*/
+  while (n > 0U) {
+
+    /* Data size that can be written in a single program page operation.*/
+    size_t chunk = (size_t)(page_size - (offset % page_size));
+    if (chunk > n) {
+      chunk = n;
+    }
+
+    /* Torn write, only the first half of the page gets programmed.*/
+    if (simflash_power_fails(devp)) {
+      size_t half = (chunk / 2U) - ((chunk / 2U) % granularity);
+
+      for (i = 0U; i < half; i++) {
+        devp->mem[offset + i] &= pp[i];
+      }
+      devp->state = FLASH_READY;
+
+      return FLASH_ERROR_HW_FAILURE;
+    }
+
+    for (i = 0U; i < chunk; i++) {
+      devp->mem[offset + i] &= pp[i];
+    }
+    devp->stats.program_ops++;
+    devp->stats.program_bytes += chunk;
+    busy_time += devp->config->program_time;
+
+    /* Next page.*/
+    offset += chunk;
+    pp     += chunk;
+    n      -= chunk;
+  }
+
+  /* Emulated program latency, other threads can run meanwhile.*/
+  if (busy_time > 0U) {
+    osalThreadSleepMicroseconds(busy_time);
+  }
+
+  /* Ready state again.*/
+  devp->state = FLASH_READY;
+
+  return FLASH_NO_ERROR;
+}
+
+static flash_error_t simflash_start_erase_all(void *instance) {
+  SimFlashDriver *devp = (SimFlashDriver *)instance;
+  flash_sector_t sector;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  if (devp->pf_failed) {
+    return FLASH_ERROR_HW_FAILURE;
+  }
+
+  if (devp->state == FLASH_ERASE) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  for (sector = 0U; sector < devp->config->sectors_count; sector++) {
+    if (simflash_erase(devp, sector)) {
+      return FLASH_ERROR_HW_FAILURE;
+    }
+  }
+
+  /* FLASH_ERASE state until the emulated erase time has elapsed.*/
+  devp->state       = FLASH_ERASE;
+  devp->erase_start = osalOsGetSystemTimeX();
+  devp->erase_time  = OSAL_MS2I(devp->config->erase_time *
+                                devp->config->sectors_count);
+
+  return FLASH_NO_ERROR;
+}
+
+static flash_error_t simflash_start_erase_sector(void *instance,
+                                                 flash_sector_t sector) {
+  SimFlashDriver *devp = (SimFlashDriver *)instance;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgCheck(sector < devp->config->sectors_count);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  if (devp->pf_failed) {
+    return FLASH_ERROR_HW_FAILURE;
+  }
+
+  if (devp->state == FLASH_ERASE) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  if (simflash_erase(devp, sector)) {
+    return FLASH_ERROR_HW_FAILURE;
+  }
+
+  /* FLASH_ERASE state until the emulated erase time has elapsed.*/
+  devp->state       = FLASH_ERASE;
+  devp->erase_start = osalOsGetSystemTimeX();
+  devp->erase_time  = OSAL_MS2I(devp->config->erase_time);
+
+  return FLASH_NO_ERROR;
+}
+
+static flash_error_t simflash_verify_erase(void *instance,
+                                           flash_sector_t sector) {
+  SimFlashDriver *devp = (SimFlashDriver *)instance;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgCheck(sector < devp->config->sectors_count);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  if (devp->pf_failed) {
+    return FLASH_ERROR_HW_FAILURE;
+  }
+
+  if (devp->state == FLASH_ERASE) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  if (!simflash_is_erased(&devp->mem[simflash_sector_offset(devp, sector)],
+                          simflash_sector_size(devp, sector))) {
+    return FLASH_ERROR_VERIFY;
+  }
+
+  return FLASH_NO_ERROR;
+}
+
+static flash_error_t simflash_query_erase(void *instance, uint32_t *msec) {
+  SimFlashDriver *devp = (SimFlashDriver *)instance;
+
+  osalDbgCheck(instance != NULL);
+  osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
+                "invalid state");
+
+  if (devp->pf_failed) {
+    return FLASH_ERROR_HW_FAILURE;
+  }
+
+  /* If there is an erase in progress then the emulated time must be
+     checked.*/
+  if (devp->state == FLASH_ERASE) {
+    sysinterval_t elapsed = osalTimeDiffX(devp->erase_start,
+                                          osalOsGetSystemTimeX());
+
+    if (elapsed < devp->erase_time) {
+
+      /* Recommended time before polling again, the remaining time rounded
+         up to the next millisecond.*/
+      if (msec != NULL) {
+        *msec = (uint32_t)TIME_I2MS(devp->erase_time - elapsed);
+      }
+
+      return FLASH_BUSY_ERASING;
+    }
+
+    /* The device is ready to accept commands.*/
+    devp->state = FLASH_READY;
+  }
+
+  return FLASH_NO_ERROR;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] devp     pointer to the @p SimFlashDriver object
+ *
+ * @init
+ */
+void simflashObjectInit(SimFlashDriver *devp) {
+
+  osalDbgCheck(devp != NULL);
+
+  devp->vmt          = &simflash_vmt;
+  devp->state        = FLASH_STOP;
+  devp->config       = NULL;
+  devp->mem          = NULL;
+  devp->fd           = -1;
+  devp->pf_countdown = 0U;
+  devp->pf_failed    = false;
+  memset(&devp->stats, 0, sizeof devp->stats);
+}
+
+/**
+ * @brief   Configures and activates the simulated flash device.
+ * @details The device memory is mapped from the backing file, if any, and
+ *          an injected power failure condition is cleared. Failures of
+ *          the host system are fatal.
+ *
+ * @param[in] devp      pointer to the @p SimFlashDriver object
+ * @param[in] config    pointer to the configuration
+ *
+ * @api
+ */
+void simflashStart(SimFlashDriver *devp, const SimFlashConfig *config) {
+
+  osalDbgCheck((devp != NULL) && (config != NULL));
+  osalDbgCheck((config->sectors_count > 0U) && (config->page_size > 0U) &&
+               (config->granularity > 0U) &&
+               ((config->sectors != NULL) || (config->sectors_size > 0U)));
+  osalDbgAssert(devp->state != FLASH_UNINIT, "invalid state");
+
+  devp->config = config;
+
+  if (devp->state == FLASH_STOP) {
+    flash_sector_t last = config->sectors_count - 1U;
+    struct stat st;
+
+    /* Setting up the device descriptor and size.*/
+    devp->descriptor.attributes    = FLASH_ATTR_ERASED_IS_ONE;
+    if (config->granularity == 1U) {
+      devp->descriptor.attributes |= FLASH_ATTR_REWRITABLE;
+    }
+    devp->descriptor.page_size     = config->page_size;
+    devp->descriptor.sectors_count = config->sectors_count;
+    devp->descriptor.sectors       = config->sectors;
+    devp->descriptor.sectors_size  = config->sectors != NULL ?
+                                     0U : config->sectors_size;
+    devp->descriptor.address       = 0U;
+    devp->size = (size_t)simflash_sector_offset(devp, last) +
+                 (size_t)simflash_sector_size(devp, last);
+
+    if (config->path == NULL) {
+      /* Volatile device in anonymous memory.*/
+      devp->mem = mmap(NULL, devp->size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (devp->mem == MAP_FAILED) {
+        printf("SIMFLASH: mmap() failed\n");
+        exit(1);
+      }
+      memset(devp->mem, ERASED_BYTE, devp->size);
+    }
+    else {
+      /* Persistent device, a shorter file is extended with erased bytes.*/
+      devp->fd = open(config->path, O_RDWR | O_CREAT, 0644);
+      if ((devp->fd < 0) || (fstat(devp->fd, &st) < 0)) {
+        printf("SIMFLASH: cannot open %s\n", config->path);
+        exit(1);
+      }
+      if (((size_t)st.st_size < devp->size) &&
+          (ftruncate(devp->fd, (off_t)devp->size) < 0)) {
+        printf("SIMFLASH: cannot resize %s\n", config->path);
+        exit(1);
+      }
+      devp->mem = mmap(NULL, devp->size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, devp->fd, 0);
+      if (devp->mem == MAP_FAILED) {
+        printf("SIMFLASH: mmap() failed on %s\n", config->path);
+        exit(1);
+      }
+      if ((size_t)st.st_size < devp->size) {
+        memset(&devp->mem[st.st_size], ERASED_BYTE,
+               devp->size - (size_t)st.st_size);
+      }
+    }
+
+    /* Powered up.*/
+    devp->pf_countdown = 0U;
+    devp->pf_failed    = false;
+
+    /* Driver in ready state.*/
+    devp->state = FLASH_READY;
+  }
+}
+
+/**
+ * @brief   Deactivates the simulated flash device.
+ * @note    The content of a device without backing file is lost.
+ *
+ * @param[in] devp      pointer to the @p SimFlashDriver object
+ *
+ * @api
+ */
+void simflashStop(SimFlashDriver *devp) {
+
+  osalDbgCheck(devp != NULL);
+  osalDbgAssert(devp->state != FLASH_UNINIT, "invalid state");
+
+  if (devp->state != FLASH_STOP) {
+
+    /* Releasing the device memory.*/
+    (void)munmap(devp->mem, devp->size);
+    devp->mem = NULL;
+    if (devp->fd >= 0) {
+      (void)close(devp->fd);
+      devp->fd = -1;
+    }
+
+    /* Deleting current configuration.*/
+    devp->config = NULL;
+
+    /* Driver stopped.*/
+    devp->state = FLASH_STOP;
+  }
+}
+
+/**
+ * @brief   Arms a power failure.
+ * @details The power fails during the @p ops-th next page program or
+ *          sector erase operation. A page program operation programs only
+ *          the first half of the page, a sector erase operation erases only
+ *          the first half of the sector. After the failure all operations
+ *          return @p FLASH_ERROR_HW_FAILURE until the device is restarted
+ *          using @p simflashStop() and @p simflashStart().
+ * @note    The number of page program and sector erase operations
+ *          performed by a workload, and then the number of possible
+ *          injection points, is found in the device statistics.
+ *
+ * @param[in] devp      pointer to the @p SimFlashDriver object
+ * @param[in] ops       operation at which the power fails, zero disarms
+ *                      a pending power failure
+ *
+ * @api
+ */
+void simflashInjectPowerFail(SimFlashDriver *devp, uint32_t ops) {
+
+  osalDbgCheck(devp != NULL);
+
+  devp->pf_countdown = ops;
+}
+
+/**
+ * @brief   Clears the device statistics.
+ *
+ * @param[in] devp      pointer to the @p SimFlashDriver object
+ *
+ * @api
+ */
+void simflashResetStatistics(SimFlashDriver *devp) {
+
+  osalDbgCheck(devp != NULL);
+
+  memset(&devp->stats, 0, sizeof devp->stats);
+}
+
+/** @} */
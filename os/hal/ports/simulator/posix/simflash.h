@@ -0,0 +1,244 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/simflash.h
+ * @brief   Posix simulator flash device header.
+ * @details NOR-like flash device emulated in host memory, optionally
+ *          backed by a memory mapped file so that the content survives
+ *          across runs.
+ *
+ * @addtogroup SIMFLASH
+ * @{
+ */
+
+#ifndef SIMFLASH_H
+#define SIMFLASH_H
+
+#include "hal_flash.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a simulated flash device configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Path of the backing file.
+   * @note    The file is created, and filled with erased bytes, if it does
+   *          not exist or is shorter than the device.
+   * @note    If @p NULL then the device is backed by anonymous memory and
+   *          it is fully erased on start.
+   */
+  const char                    *path;
+  /**
+   * @brief   Number of sectors in the device.
+   */
+  flash_sector_t                sectors_count;
+  /**
+   * @brief   List of sectors for devices with non-uniform sector sizes.
+   * @note    If @p NULL then the device has uniform sectors size equal
+   *          to @p sectors_size.
+   */
+  const flash_sector_descriptor_t *sectors;
+  /**
+   * @brief   Size of sectors for devices with uniform sector size.
+   */
+  uint32_t                      sectors_size;
+  /**
+   * @brief   Size of write page.
+   * @details Program operations are split in pages, the program latency
+   *          is applied to each page.
+   */
+  uint32_t                      page_size;
+  /**
+   * @brief   Program granularity.
+   * @details If one then bits can be cleared by successive program
+   *          operations as in NOR devices. If greater than one then
+   *          offset and size of program operations must be multiple of
+   *          it and each unit can only be programmed once after erase, as
+   *          in ECC-protected devices.
+   */
+  uint32_t                      granularity;
+  /**
+   * @brief   Page program time in microseconds.
+   */
+  uint32_t                      program_time;
+  /**
+   * @brief   Sector erase time in milliseconds.
+   * @note    The whole device erase time is this value multiplied by the
+   *          number of sectors.
+   */
+  uint32_t                      erase_time;
+} SimFlashConfig;
+
+/**
+ * @brief   Type of simulated flash device statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Number of read operations.
+   */
+  uint32_t                      read_ops;
+  /**
+   * @brief   Number of bytes read.
+   */
+  uint64_t                      read_bytes;
+  /**
+   * @brief   Number of page program operations.
+   */
+  uint32_t                      program_ops;
+  /**
+   * @brief   Number of bytes programmed.
+   */
+  uint64_t                      program_bytes;
+  /**
+   * @brief   Number of sector erase operations.
+   * @note    A whole device erase counts as one operation per sector.
+   */
+  uint32_t                      erase_ops;
+  /**
+   * @brief   Number of bytes erased.
+   */
+  uint64_t                      erase_bytes;
+} simflash_stats_t;
+
+/**
+ * @brief   @p SimFlashDriver specific methods.
+ */
+#define _simflash_methods                                                   \
+  _base_flash_methods
+
+/**
+ * @extends BaseFlashVMT
+ *
+ * @brief   @p SimFlashDriver virtual methods table.
+ */
+struct SimFlashDriverVMT {
+  _simflash_methods
+};
+
+/**
+ * @extends BaseFlash
+ *
+ * @brief   Type of a simulated flash device driver.
+ */
+typedef struct {
+  /**
+   * @brief   SimFlashDriver Virtual Methods Table.
+   */
+  const struct SimFlashDriverVMT *vmt;
+  _base_flash_data
+  /**
+   * @brief   Current configuration data.
+   */
+  const SimFlashConfig          *config;
+  /**
+   * @brief   Device descriptor.
+   */
+  flash_descriptor_t            descriptor;
+  /**
+   * @brief   Device size.
+   */
+  size_t                        size;
+  /**
+   * @brief   Device memory.
+   */
+  uint8_t                       *mem;
+  /**
+   * @brief   Backing file descriptor or -1.
+   */
+  int                           fd;
+  /**
+   * @brief   Start time of the erase operation in progress.
+   */
+  systime_t                     erase_start;
+  /**
+   * @brief   Duration of the erase operation in progress.
+   */
+  sysinterval_t                 erase_time;
+  /**
+   * @brief   Remaining operations before the injected power failure.
+   * @note    Zero if no power failure is armed.
+   */
+  uint32_t                      pf_countdown;
+  /**
+   * @brief   Power failed, the device no longer responds.
+   */
+  bool                          pf_failed;
+  /**
+   * @brief   Device statistics.
+   */
+  simflash_stats_t              stats;
+} SimFlashDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the device statistics.
+ *
+ * @param[in] devp      pointer to the @p SimFlashDriver object
+ * @return              Pointer to the @p simflash_stats_t structure.
+ *
+ * @api
+ */
+#define simflashGetStatistics(devp) (&(devp)->stats)
+
+/**
+ * @brief   Returns @p true if an injected power failure happened.
+ *
+ * @param[in] devp      pointer to the @p SimFlashDriver object
+ * @return              The power failure state.
+ *
+ * @api
+ */
+#define simflashIsPowerFailed(devp) ((devp)->pf_failed)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void simflashObjectInit(SimFlashDriver *devp);
+  void simflashStart(SimFlashDriver *devp, const SimFlashConfig *config);
+  void simflashStop(SimFlashDriver *devp);
+  void simflashInjectPowerFail(SimFlashDriver *devp, uint32_t ops);
+  void simflashResetStatistics(SimFlashDriver *devp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIMFLASH_H */
+
+/** @} */
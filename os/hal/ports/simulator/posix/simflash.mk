@@ -0,0 +1,11 @@
+# List of all the simulated flash device files.
+SIMFLASHSRC := $(CHIBIOS)/os/hal/lib/peripherals/flash/hal_flash.c \
+               $(CHIBIOS)/os/hal/ports/simulator/posix/simflash.c
+
+# Required include directories
+SIMFLASHINC := $(CHIBIOS)/os/hal/lib/peripherals/flash \
+               $(CHIBIOS)/os/hal/ports/simulator/posix
+
+# Shared variables
+ALLCSRC += $(SIMFLASHSRC)
+ALLINC  += $(SIMFLASHINC)
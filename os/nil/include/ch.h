@@ -1558,9 +1558,12 @@ extern "C" {
 
 /* Optional subsystems.*/
 #include "chmboxes.h"
+#include "chpipes.h"
 #include "chmemcore.h"
 #include "chheap.h"
 #include "chmempools.h"
+#include "chslab.h"
+#include "charena.h"
 #include "chfifo.h"
 #include "chfactory.h"
 
@@ -6,6 +6,9 @@ KERNSRC := ${CHIBIOS}/os/nil/src/ch.c
 ifneq ($(findstring CH_CFG_USE_MAILBOXES TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chmboxes.c
 endif
+ifneq ($(findstring CH_CFG_USE_PIPES TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/common/oslib/src/chpipes.c
+endif
 ifneq ($(findstring CH_CFG_USE_MEMCORE TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chmemcore.c
 endif
@@ -15,15 +18,24 @@ endif
 ifneq ($(findstring CH_CFG_USE_MEMPOOLS TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chmempools.c
 endif
+ifneq ($(findstring CH_CFG_USE_SLAB TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/common/oslib/src/chslab.c
+endif
+ifneq ($(findstring CH_CFG_USE_ARENAS TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/common/oslib/src/charena.c
+endif
 ifneq ($(findstring CH_CFG_USE_FACTORY TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chfactory.c
 endif
 else
 KERNSRC := ${CHIBIOS}/os/nil/src/ch.c \
            $(CHIBIOS)/os/common/oslib/src/chmboxes.c \
+           $(CHIBIOS)/os/common/oslib/src/chpipes.c \
            $(CHIBIOS)/os/common/oslib/src/chmemcore.c \
            $(CHIBIOS)/os/common/oslib/src/chheap.c \
            $(CHIBIOS)/os/common/oslib/src/chmempools.c \
+           $(CHIBIOS)/os/common/oslib/src/chslab.c \
+           $(CHIBIOS)/os/common/oslib/src/charena.c \
            $(CHIBIOS)/os/common/oslib/src/chfactory.c
 endif
 
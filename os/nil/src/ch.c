@@ -270,6 +270,11 @@ void chSysInit(void) {
   _heap_init();
 #endif
 
+  /* Slab allocator initialization, if enabled.*/
+#if CH_CFG_USE_SLAB == TRUE
+  _slab_init();
+#endif
+
   /* Factory initialization, if enabled.*/
 #if CH_CFG_USE_FACTORY == TRUE
   _factory_init();
@@ -134,6 +134,15 @@
  */
 #define CH_CFG_USE_MAILBOXES                TRUE
 
+/**
+ * @brief   Pipes APIs.
+ * @details If enabled then the byte pipes APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_PIPES                    FALSE
+
 /**
  * @brief   Core Memory Manager APIs.
  * @details If enabled then the core memory manager APIs are included
@@ -143,6 +152,17 @@
  */
 #define CH_CFG_USE_MEMCORE                  TRUE
 
+/**
+ * @brief   Core Memory Manager regions.
+ * @details If enabled then the core memory manager can also allocate from
+ *          additional memory regions, each one with its own attributes,
+ *          for example tightly coupled or non-cacheable RAM.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMCORE.
+ */
+#define CH_CFG_USE_MEMCORE_REGIONS          FALSE
+
 /**
  * @brief   Heap Allocator APIs.
  * @details If enabled then the memory heap allocator APIs are included
@@ -152,6 +172,33 @@
  */
 #define CH_CFG_USE_HEAP                     TRUE
 
+/**
+ * @brief   TLSF heap allocator.
+ * @details If enabled then the heap allocator uses a Two-Level Segregated
+ *          Fit strategy instead of first-fit, allocation and release of
+ *          blocks become constant time operations regardless of the heap
+ *          fragmentation.
+ *
+ * @note    This option increases the size of the heap structure by the
+ *          free lists table.
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_HEAP.
+ */
+#define CH_CFG_HEAP_TLSF                    FALSE
+
+/**
+ * @brief   Heap allocations profiler.
+ * @details If enabled then the heap allocations and releases are recorded
+ *          by call site, size and lifetime, the heap fragmentation can be
+ *          sampled over time. The default heap is profiled from the
+ *          system start.
+ *
+ * @note    This option adds a tag to each allocated heap block.
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_HEAP.
+ */
+#define CH_CFG_HEAP_PROFILER                FALSE
+
 /**
  * @brief   Memory Pools Allocator APIs.
  * @details If enabled then the memory pools allocator APIs are included
@@ -161,6 +208,39 @@
  */
 #define CH_CFG_USE_MEMPOOLS                 TRUE
 
+/**
+ * @brief   Memory Pools magazine caches.
+ * @details If enabled then per-thread magazines can be placed in front of
+ *          memory pools, objects are allocated and released without
+ *          locking and moved from/to the pool in batches.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#define CH_CFG_USE_POOL_MAGAZINES           FALSE
+
+/**
+ * @brief   Slab allocator APIs.
+ * @details If enabled then the slab allocator APIs are included in the
+ *          kernel, small objects are allocated from memory pools of
+ *          configurable size classes instead of the heap.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#define CH_CFG_USE_SLAB                     FALSE
+
+/**
+ * @brief   Arena allocator APIs.
+ * @details If enabled then the arena allocator APIs are included in the
+ *          kernel, blocks are allocated by advancing a pointer and are
+ *          released all together.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMCORE.
+ */
+#define CH_CFG_USE_ARENAS                   FALSE
+
 /**
  * @brief  Objects FIFOs APIs.
  * @details If enabled then the objects FIFOs APIs are included
@@ -233,6 +313,24 @@
  */
 #define CH_CFG_FACTORY_OBJ_FIFOS            TRUE
 
+/**
+ * @brief   Enables the objects names hash index.
+ * @details If enabled then the objects are also indexed by name in an open
+ *          addressing hash table, lookups, creation and release of objects
+ *          become O(1) operations on average instead of scanning the lists.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_FACTORY_HASH_INDEX           FALSE
+
+/**
+ * @brief   Number of slots in the objects names hash index.
+ * @details Up to 3/4 of the slots are used, objects exceeding this number
+ *          are not indexed and are found by scanning the lists.
+ * @note    It must be a power of two.
+ */
+#define CH_CFG_FACTORY_HASH_SIZE            64
+
 /** @} */
 
 /*===========================================================================*/
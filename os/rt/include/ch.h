@@ -115,6 +115,7 @@ extern "C" {
 #include "chsys.h"
 #include "chvt.h"
 #include "chthreads.h"
+#include "chbudget.h"
 
 /* Optional subsystems headers.*/
 #include "chregistry.h"
@@ -127,9 +128,12 @@ extern "C" {
 
 /* OSLIB headers.*/
 #include "chmboxes.h"
+#include "chpipes.h"
 #include "chmemcore.h"
 #include "chheap.h"
 #include "chmempools.h"
+#include "chslab.h"
+#include "charena.h"
 #include "chfifo.h"
 #include "chfactory.h"
 #include "chdynamic.h"
@@ -0,0 +1,132 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chbudget.h
+ * @brief   CPU budgets module macros and structures.
+ *
+ * @addtogroup budgets
+ * @{
+ */
+
+#ifndef CHBUDGET_H
+#define CHBUDGET_H
+
+#if (CH_CFG_USE_BUDGETS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Background priority of threads with an exhausted budget.
+ */
+#if !defined(CH_CFG_BUDGET_PRIO) || defined(__DOXYGEN__)
+#define CH_CFG_BUDGET_PRIO                  LOWPRIO
+#endif
+
+/**
+ * @brief   Budgets enforcement check interval in system ticks.
+ */
+#if !defined(CH_CFG_BUDGET_CHECK_INTERVAL) || defined(__DOXYGEN__)
+#define CH_CFG_BUDGET_CHECK_INTERVAL        1
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if PORT_SUPPORTS_RT == FALSE
+#error "CH_CFG_USE_BUDGETS requires PORT_SUPPORTS_RT"
+#endif
+
+#if CH_CFG_BUDGET_CHECK_INTERVAL < 1
+#error "invalid CH_CFG_BUDGET_CHECK_INTERVAL value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void _budget_init(void);
+  void _budget_thread_exit(thread_t *tp);
+  void _budget_switch(thread_t *ntp, thread_t *otp);
+  void chBudgetSetI(thread_t *tp, rtcnt_t budget, sysinterval_t period);
+  void chBudgetSet(thread_t *tp, rtcnt_t budget, sysinterval_t period);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns @p true if the thread budget is exhausted.
+ * @details A thread with an exhausted budget runs at the
+ *          @p CH_CFG_BUDGET_PRIO priority until its budget is replenished.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The budget state.
+ *
+ * @xclass
+ */
+static inline bool chBudgetIsExhaustedX(thread_t *tp) {
+
+  return tp->bdemoted;
+}
+
+/**
+ * @brief   Returns the number of budget exhaustions of a thread.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The number of times the thread has been demoted.
+ *
+ * @xclass
+ */
+static inline ucnt_t chBudgetGetExhaustionsX(thread_t *tp) {
+
+  return tp->bexhausted;
+}
+
+#else /* CH_CFG_USE_BUDGETS == FALSE */
+
+/* Stub functions for when the budgets module is disabled. */
+#define _budget_switch(ntp, otp)
+
+#endif /* CH_CFG_USE_BUDGETS == FALSE */
+
+#endif /* CHBUDGET_H */
+
+/** @} */
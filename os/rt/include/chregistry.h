@@ -180,6 +180,23 @@ static inline void chRegSetThreadNameX(thread_t *tp, const char *name) {
 #endif
 }
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the number of deadline misses of the specified thread.
+ * @note    This function is only available when the @p CH_CFG_USE_EDF
+ *          configuration option is enabled.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The number of jobs completed after their deadline.
+ *
+ * @xclass
+ */
+static inline ucnt_t chRegGetThreadMissesX(thread_t *tp) {
+
+  return tp->misses;
+}
+#endif
+
 #endif /* CHREGISTRY_H */
 
 /** @} */
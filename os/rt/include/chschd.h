@@ -110,10 +110,132 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Bitmap-indexed ready list.
+ */
+#if !defined(CH_CFG_RLIST_BITMAP) || defined(__DOXYGEN__)
+#define CH_CFG_RLIST_BITMAP                 FALSE
+#endif
+
+/**
+ * @brief   Timing wheel virtual timers.
+ * @details If enabled then virtual timers are kept in a hierarchical timing
+ *          wheel instead of a delta list, arming and disarming a timer
+ *          become constant time operations.
+ */
+#if !defined(CH_CFG_VT_WHEEL) || defined(__DOXYGEN__)
+#define CH_CFG_VT_WHEEL                     FALSE
+#endif
+
+/**
+ * @brief   Number of levels in the virtual timers wheel.
+ * @details Each level has 32 slots, the wheel covers a range of
+ *          2^(5 * @p CH_CFG_VT_WHEEL_LEVELS) ticks, longer timers are
+ *          parked in the last level and re-evaluated there.
+ */
+#if !defined(CH_CFG_VT_WHEEL_LEVELS) || defined(__DOXYGEN__)
+#define CH_CFG_VT_WHEEL_LEVELS              4
+#endif
+
+/**
+ * @brief   Virtual timers slack.
+ * @details If enabled then virtual timers can be armed with a tolerated
+ *          expiration delay, in tick-less mode timers whose windows
+ *          overlap are served by a single alarm event.
+ */
+#if !defined(CH_CFG_VT_SLACK) || defined(__DOXYGEN__)
+#define CH_CFG_VT_SLACK                     FALSE
+#endif
+
+/**
+ * @brief   Virtual timers deferred callbacks.
+ * @details If enabled then virtual timers can be armed so that their
+ *          callbacks are executed by a dedicated kernel thread instead of
+ *          the timer interrupt.
+ */
+#if !defined(CH_CFG_VT_DEFERRED) || defined(__DOXYGEN__)
+#define CH_CFG_VT_DEFERRED                  FALSE
+#endif
+
+/**
+ * @brief   Priority of the virtual timers thread.
+ */
+#if !defined(CH_CFG_VT_DEFERRED_PRIO) || defined(__DOXYGEN__)
+#define CH_CFG_VT_DEFERRED_PRIO             HIGHPRIO
+#endif
+
+/**
+ * @brief   Stack size of the virtual timers thread.
+ */
+#if !defined(CH_CFG_VT_DEFERRED_STACK_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_VT_DEFERRED_STACK_SIZE       256
+#endif
+
+/**
+ * @brief   Earliest deadline first scheduling class.
+ * @details If enabled then threads created with a non-zero period are
+ *          scheduled at the @p CH_CFG_EDF_PRIO priority level ordered by
+ *          absolute deadline, fixed priority threads are not affected.
+ */
+#if !defined(CH_CFG_USE_EDF) || defined(__DOXYGEN__)
+#define CH_CFG_USE_EDF                      FALSE
+#endif
+
+/**
+ * @brief   Priority level reserved to EDF threads.
+ * @details Fixed priority threads cannot be created at this level nor moved
+ *          to it, they can reach it only when boosted by the priority
+ *          inheritance of a mutex, then they run ahead of the EDF threads
+ *          until the mutex is released.
+ */
+#if !defined(CH_CFG_EDF_PRIO) || defined(__DOXYGEN__)
+#define CH_CFG_EDF_PRIO                     (HIGHPRIO - 1)
+#endif
+
+/**
+ * @brief   Threads CPU budgets.
+ * @details If enabled then threads can be assigned a CPU budget replenished
+ *          over a period, a thread exhausting its budget runs at the
+ *          @p CH_CFG_BUDGET_PRIO priority until replenishment.
+ */
+#if !defined(CH_CFG_USE_BUDGETS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_BUDGETS                  FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (CH_CFG_RLIST_BITMAP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Number of priority levels tracked by the ready list bitmap.
+ * @note    It must be equal to @p HIGHPRIO plus one.
+ */
+#define CH_RLIST_PRIO_LEVELS    256U
+
+/**
+ * @brief   Number of 32 bits words in the ready list bitmap.
+ */
+#define CH_RLIST_MAP_WORDS      (CH_RLIST_PRIO_LEVELS / 32U)
+#endif /* CH_CFG_RLIST_BITMAP == TRUE */
+
+#if (CH_CFG_VT_WHEEL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Number of bits of the time consumed by each wheel level.
+ */
+#define CH_VT_WHEEL_SLOT_BITS   5U
+
+/**
+ * @brief   Number of slots in each wheel level.
+ */
+#define CH_VT_WHEEL_SLOTS       32U
+
+#if (CH_CFG_VT_WHEEL_LEVELS < 1) ||                                         \
+    ((CH_CFG_VT_WHEEL_LEVELS * 5) >= CH_CFG_INTERVALS_SIZE)
+#error "invalid CH_CFG_VT_WHEEL_LEVELS value specified"
+#endif
+#endif /* CH_CFG_VT_WHEEL == TRUE */
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -133,6 +255,38 @@ struct ch_threads_queue {
   thread_t              *prev;      /**< @brief Previous in the queue.      */
 };
 
+/**
+ * @extends virtual_timers_list_t
+ *
+ * @brief   Virtual Timer descriptor structure.
+ */
+struct ch_virtual_timer {
+  virtual_timer_t       *next;      /**< @brief Next timer in the list.     */
+  virtual_timer_t       *prev;      /**< @brief Previous timer in the list. */
+  sysinterval_t         delta;      /**< @brief Time delta before timeout,
+                                                when the timing wheel is
+                                                enabled it is the wheel time
+                                                of expiration instead.      */
+  vtfunc_t              func;       /**< @brief Timer callback function
+                                                pointer.                    */
+  void                  *par;       /**< @brief Timer callback function
+                                                parameter.                  */
+  sysinterval_t         reload;     /**< @brief Reload period, zero for
+                                                one-shot timers.            */
+#if (CH_CFG_VT_SLACK == TRUE) || defined(__DOXYGEN__)
+  sysinterval_t         slack;      /**< @brief Tolerated expiration
+                                                delay.                      */
+#endif
+#if (CH_CFG_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+  virtual_timer_t       *dnext;     /**< @brief Next timer in the deferred
+                                                callbacks queue.            */
+  bool                  deferred;   /**< @brief Callback executed by the
+                                                virtual timers thread.      */
+  bool                  pending;    /**< @brief Callback pending in the
+                                                deferred callbacks queue.   */
+#endif
+};
+
 /**
  * @brief   Structure representing a thread.
  * @note    Not all the listed fields are always needed, by switching off some
@@ -286,6 +440,62 @@ struct ch_thread {
    */
   tprio_t               realprio;
 #endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   EDF period, zero for fixed priority threads.
+   */
+  sysinterval_t         period;
+  /**
+   * @brief   EDF relative deadline.
+   */
+  sysinterval_t         reldeadline;
+  /**
+   * @brief   Release time of the current job.
+   */
+  systime_t             release;
+  /**
+   * @brief   Absolute deadline of the current job.
+   */
+  systime_t             deadline;
+  /**
+   * @brief   Number of jobs completed after their deadline.
+   */
+  ucnt_t                misses;
+#endif
+#if (CH_CFG_USE_BUDGETS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   CPU budget in realtime counter cycles, zero if not enforced.
+   */
+  rtcnt_t               budget;
+  /**
+   * @brief   Cycles consumed in the current replenishment period.
+   */
+  rtcnt_t               bused;
+  /**
+   * @brief   Realtime counter value when the thread was switched in.
+   */
+  rtcnt_t               bstart;
+  /**
+   * @brief   Budget replenishment period.
+   */
+  sysinterval_t         bperiod;
+  /**
+   * @brief   Budget replenishment timer.
+   */
+  virtual_timer_t       bvt;
+  /**
+   * @brief   Number of budget exhaustions.
+   */
+  ucnt_t                bexhausted;
+  /**
+   * @brief   Priority restored on replenishment.
+   */
+  tprio_t               bprio;
+  /**
+   * @brief   Budget exhausted, the thread runs at background priority.
+   */
+  bool                  bdemoted;
+#endif
 #if ((CH_CFG_USE_DYNAMIC == TRUE) && (CH_CFG_USE_MEMPOOLS == TRUE)) ||      \
     defined(__DOXYGEN__)
   /**
@@ -298,6 +508,18 @@ struct ch_thread {
    * @brief   Thread statistics.
    */
   time_measurement_t    stats;
+  /**
+   * @brief   Cycles spent in ISRs while this thread was current.
+   */
+  rttime_t              isrcycles;
+  /**
+   * @brief   Thread net cycles at the start of the current window.
+   */
+  rttime_t              wsnap;
+  /**
+   * @brief   Thread net cycles in the last completed window.
+   */
+  rtcnt_t               wcycles;
 #endif
 #if defined(CH_CFG_THREAD_EXTRA_FIELDS)
   /* Extra fields defined in chconf.h.*/
@@ -305,20 +527,17 @@ struct ch_thread {
 #endif
 };
 
+#if (CH_CFG_VT_WHEEL == TRUE) || defined(__DOXYGEN__)
 /**
- * @extends virtual_timers_list_t
- *
- * @brief   Virtual Timer descriptor structure.
+ * @brief   Virtual timers wheel slot.
+ * @note    The slot is the header of a circular timers list, its layout
+ *          must match the first fields of @p virtual_timer_t.
  */
-struct ch_virtual_timer {
-  virtual_timer_t       *next;      /**< @brief Next timer in the list.     */
-  virtual_timer_t       *prev;      /**< @brief Previous timer in the list. */
-  sysinterval_t         delta;      /**< @brief Time delta before timeout.  */
-  vtfunc_t              func;       /**< @brief Timer callback function
-                                                pointer.                    */
-  void                  *par;       /**< @brief Timer callback function
-                                                parameter.                  */
-};
+typedef struct {
+  virtual_timer_t       *next;      /**< @brief First timer in the slot.    */
+  virtual_timer_t       *prev;      /**< @brief Last timer in the slot.     */
+} vt_slot_t;
+#endif
 
 /**
  * @brief   Virtual timers list header.
@@ -327,11 +546,24 @@ struct ch_virtual_timer {
  *          timer is often used in the code.
  */
 struct ch_virtual_timers_list {
+#if (CH_CFG_VT_WHEEL == FALSE) || defined(__DOXYGEN__)
   virtual_timer_t       *next;      /**< @brief Next timer in the delta
                                                 list.                       */
   virtual_timer_t       *prev;      /**< @brief Last timer in the delta
                                                 list.                       */
   sysinterval_t         delta;      /**< @brief Must be initialized to -1.  */
+  sysinterval_t         taildelta;  /**< @brief Distance of the last timer
+                                                from the list base time.    */
+#endif
+#if (CH_CFG_VT_WHEEL == TRUE) || defined(__DOXYGEN__)
+  sysinterval_t         wheeltime;  /**< @brief Time of the last processed
+                                                wheel tick.                 */
+  uint32_t              map[CH_CFG_VT_WHEEL_LEVELS];
+                                    /**< @brief Non-empty slots bitmaps,
+                                                one per level.              */
+  vt_slot_t             slots[CH_CFG_VT_WHEEL_LEVELS][CH_VT_WHEEL_SLOTS];
+                                    /**< @brief Wheel slots.                */
+#endif
 #if (CH_CFG_ST_TIMEDELTA == 0) || defined(__DOXYGEN__)
   volatile systime_t    systime;    /**< @brief System Time counter.        */
 #endif
@@ -342,6 +574,14 @@ struct ch_virtual_timers_list {
   systime_t             lasttime;   /**< @brief System time of the last
                                                 tick event.                 */
 #endif
+#if (CH_CFG_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+  virtual_timer_t       *dhead;     /**< @brief First timer in the deferred
+                                                callbacks queue.            */
+  virtual_timer_t       *dtail;     /**< @brief Last timer in the deferred
+                                                callbacks queue.            */
+  thread_reference_t    dthread;    /**< @brief Virtual timers thread, if
+                                                waiting for callbacks.      */
+#endif
 };
 
 /**
@@ -360,6 +600,24 @@ struct ch_ready_list {
   /* End of the fields shared with the thread_t structure.*/
   thread_t              *current;   /**< @brief The currently running
                                                 thread.                     */
+#if (CH_CFG_RLIST_BITMAP == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Map of the non-empty bitmap words.
+   * @note    Bit @p n is set if word @p n of @p map is not zero.
+   */
+  uint32_t              summary;
+  /**
+   * @brief   Map of the non-empty priority levels.
+   * @note    Levels are stored in reverse order, the highest priority
+   *          is associated to the bit zero of the first word.
+   */
+  uint32_t              map[CH_RLIST_MAP_WORDS];
+  /**
+   * @brief   Last thread of each priority level in the ready list.
+   * @note    The entry is @p NULL if the priority level is empty.
+   */
+  thread_t              *tails[CH_RLIST_PRIO_LEVELS];
+#endif
 };
 
 /**
@@ -425,6 +683,16 @@ struct ch_system {
    * @brief   Global kernel statistics.
    */
   kernel_stats_t        kernel_stats;
+  /**
+   * @brief   CPU load window timer.
+   */
+  virtual_timer_t       stats_vt;
+#endif
+#if (CH_CFG_USE_BUDGETS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   CPU budgets enforcement timer.
+   */
+  virtual_timer_t       budget_vt;
 #endif
   CH_CFG_SYSTEM_EXTRA_FIELDS
 };
@@ -472,6 +740,7 @@ extern "C" {
   void chSchDoRescheduleBehind(void);
   void chSchDoRescheduleAhead(void);
   void chSchDoReschedule(void);
+  thread_t *chSchDequeueReadyI(thread_t *tp);
 #if CH_CFG_OPTIMIZE_SPEED == FALSE
   void queue_prio_insert(thread_t *tp, threads_queue_t *tqp);
   void queue_insert(thread_t *tp, threads_queue_t *tqp);
@@ -630,6 +899,101 @@ static inline thread_t *queue_dequeue(thread_t *tp) {
 }
 #endif /* CH_CFG_OPTIMIZE_SPEED == TRUE */
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Determines if two threads are both at the EDF priority level.
+ * @note    Fixed priority threads can reach the @p CH_CFG_EDF_PRIO level
+ *          only when boosted by the priority inheritance of a mutex.
+ *
+ * @param[in] ntp       the first thread
+ * @param[in] otp       the second thread
+ * @return              The priority level of the threads.
+ * @retval false        if at least one thread is not at the
+ *                      @p CH_CFG_EDF_PRIO level.
+ * @retval true         if both threads are at the @p CH_CFG_EDF_PRIO level.
+ *
+ * @notapi
+ */
+static inline bool sch_edf_level(const thread_t *ntp, const thread_t *otp) {
+
+  return (bool)((ntp->prio == CH_CFG_EDF_PRIO) &&
+                (otp->prio == CH_CFG_EDF_PRIO));
+}
+
+/**
+ * @brief   Determines if a deadline is earlier than another deadline.
+ * @note    The difference is interpreted as a signed value in order to
+ *          handle the system time wrap around.
+ *
+ * @param[in] d1        the first deadline
+ * @param[in] d2        the second deadline
+ * @return              The deadlines order.
+ *
+ * @notapi
+ */
+static inline bool sch_edf_earlier(systime_t d1, systime_t d2) {
+
+  return (bool)(chTimeDiffX(d2, d1) >
+                (sysinterval_t)(TIME_MAX_SYSTIME / (systime_t)2));
+}
+#endif /* CH_CFG_USE_EDF == TRUE */
+
+/**
+ * @brief   Determines if a thread must run before another thread.
+ * @details A thread precedes another thread if it has higher priority or,
+ *          when both are EDF threads, if it has an earlier deadline. At the
+ *          EDF level boosted fixed priority threads precede EDF threads.
+ * @note    The first parameter can also be the ready list header.
+ *
+ * @param[in] ntp       the thread to be evaluated
+ * @param[in] otp       the thread to be compared against
+ * @return              The scheduling order.
+ * @retval false        if @p ntp does not precede @p otp.
+ * @retval true         if @p ntp precedes @p otp.
+ *
+ * @notapi
+ */
+static inline bool sch_precedes(const thread_t *ntp, const thread_t *otp) {
+
+#if CH_CFG_USE_EDF == TRUE
+  if (sch_edf_level(ntp, otp)) {
+    return (bool)((otp->period > (sysinterval_t)0) &&
+                  ((ntp->period == (sysinterval_t)0) ||
+                   sch_edf_earlier(ntp->deadline, otp->deadline)));
+  }
+#endif
+
+  return (bool)(ntp->prio > otp->prio);
+}
+
+/**
+ * @brief   Determines if a thread is a peer of another thread or precedes it.
+ * @details A thread is a peer if it has equal priority or, when both are EDF
+ *          threads, if it has the same deadline. At the EDF level boosted
+ *          fixed priority threads are peers.
+ * @note    The first parameter can also be the ready list header.
+ *
+ * @param[in] ntp       the thread to be evaluated
+ * @param[in] otp       the thread to be compared against
+ * @return              The scheduling order.
+ * @retval false        if @p otp precedes @p ntp.
+ * @retval true         if @p ntp is a peer of @p otp or precedes it.
+ *
+ * @notapi
+ */
+static inline bool sch_reaches(const thread_t *ntp, const thread_t *otp) {
+
+#if CH_CFG_USE_EDF == TRUE
+  if (sch_edf_level(ntp, otp)) {
+    return (bool)((ntp->period == (sysinterval_t)0) ||
+                  ((otp->period > (sysinterval_t)0) &&
+                   !sch_edf_earlier(otp->deadline, ntp->deadline)));
+  }
+#endif
+
+  return (bool)(ntp->prio >= otp->prio);
+}
+
 /**
  * @brief   Determines if the current thread must reschedule.
  * @details This function returns @p true if there is a ready thread with
@@ -645,7 +1009,7 @@ static inline bool chSchIsRescRequiredI(void) {
 
   chDbgCheckClassI();
 
-  return firstprio(&ch.rlist.queue) > currp->prio;
+  return sch_precedes(ch.rlist.queue.next, currp);
 }
 
 /**
@@ -663,7 +1027,7 @@ static inline bool chSchCanYieldS(void) {
 
   chDbgCheckClassS();
 
-  return firstprio(&ch.rlist.queue) >= currp->prio;
+  return sch_reaches(ch.rlist.queue.next, currp);
 }
 
 /**
@@ -690,22 +1054,20 @@ static inline void chSchDoYieldS(void) {
  * @special
  */
 static inline void chSchPreemption(void) {
-  tprio_t p1 = firstprio(&ch.rlist.queue);
-  tprio_t p2 = currp->prio;
 
 #if CH_CFG_TIME_QUANTUM > 0
   if (currp->ticks > (tslices_t)0) {
-    if (p1 > p2) {
+    if (sch_precedes(ch.rlist.queue.next, currp)) {
       chSchDoRescheduleAhead();
     }
   }
   else {
-    if (p1 >= p2) {
+    if (sch_reaches(ch.rlist.queue.next, currp)) {
       chSchDoRescheduleBehind();
     }
   }
 #else /* CH_CFG_TIME_QUANTUM == 0 */
-  if (p1 > p2) {
+  if (sch_precedes(ch.rlist.queue.next, currp)) {
     chSchDoRescheduleAhead();
   }
 #endif /* CH_CFG_TIME_QUANTUM == 0 */
@@ -28,8 +28,6 @@
 #ifndef CHSTATS_H
 #define CHSTATS_H
 
-#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
-
 /*===========================================================================*/
 /* Module constants.                                                         */
 /*===========================================================================*/
@@ -38,14 +36,31 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
-#if CH_CFG_USE_TM == FALSE
-#error "CH_DBG_STATISTICS requires CH_CFG_USE_TM"
+/**
+ * @brief   CPU load sliding window size in milliseconds.
+ * @details Threads, ISRs and total CPU loads are computed over the last
+ *          completed window of this size.
+ * @note    The window duration in realtime counter cycles must fit
+ *          an @p rtcnt_t.
+ */
+#if !defined(CH_DBG_STATISTICS_WINDOW) || defined(__DOXYGEN__)
+#define CH_DBG_STATISTICS_WINDOW            1000
 #endif
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+
+#if CH_CFG_USE_TM == FALSE
+#error "CH_DBG_STATISTICS requires CH_CFG_USE_TM"
+#endif
+
+#if CH_DBG_STATISTICS_WINDOW <= 0
+#error "invalid CH_DBG_STATISTICS_WINDOW value"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -56,10 +71,36 @@
 typedef struct {
   ucnt_t                n_irq;      /**< @brief Number of IRQs.             */
   ucnt_t                n_ctxswc;   /**< @brief Number of context switches. */
+  ucnt_t                n_vt_alarms;/**< @brief Number of virtual timers
+                                                alarm events, tick-less
+                                                mode only.                  */
+  ucnt_t                n_vt_merged;/**< @brief Number of timers served by
+                                                an alarm event triggered
+                                                by another timer.           */
   time_measurement_t    m_crit_thd; /**< @brief Measurement of threads
                                                 critical zones duration.    */
   time_measurement_t    m_crit_isr; /**< @brief Measurement of ISRs critical
                                                 zones duration.             */
+  cnt_t                 isr_nest;   /**< @brief ISRs nesting level.         */
+  rtcnt_t               isr_start;  /**< @brief Outermost ISR start time
+                                                stamp.                      */
+  rttime_t              isr_cycles; /**< @brief Cumulative ISRs cycles.     */
+  rttime_t              isr_wsnap;  /**< @brief ISRs cycles at the start of
+                                                the current window.         */
+  rtcnt_t               isr_wcycles;/**< @brief ISRs cycles in the last
+                                                completed window.           */
+  rtcnt_t               wstart;     /**< @brief Current window start time
+                                                stamp.                      */
+  rtcnt_t               wcycles;    /**< @brief Duration in cycles of the
+                                                last completed window.      */
+  rtcnt_t               busy_wcycles;/**< @brief Non-idle cycles in the last
+                                                completed window.           */
+#if (CH_CFG_USE_TM_HISTOGRAMS == TRUE) || defined(__DOXYGEN__)
+  tm_histogram_t        h_crit_thd; /**< @brief Histogram of threads
+                                                critical zones duration.    */
+  tm_histogram_t        h_crit_isr; /**< @brief Histogram of ISRs critical
+                                                zones duration.             */
+#endif
 } kernel_stats_t;
 
 /*===========================================================================*/
@@ -74,12 +115,24 @@ typedef struct {
 extern "C" {
 #endif
   void _stats_init(void);
+  void _stats_start_window(void);
   void _stats_increase_irq(void);
+  void _stats_leave_irq(void);
   void _stats_ctxswc(thread_t *ntp, thread_t *otp);
+  void _stats_increase_vt_alarm(void);
+  void _stats_increase_vt_merged(void);
   void _stats_start_measure_crit_thd(void);
   void _stats_stop_measure_crit_thd(void);
   void _stats_start_measure_crit_isr(void);
   void _stats_stop_measure_crit_isr(void);
+  rttime_t chStatsGetThreadCyclesI(thread_t *tp);
+  uint32_t chStatsGetThreadLoadX(thread_t *tp);
+  uint32_t chStatsGetISRLoadX(void);
+  uint32_t chStatsGetCPULoadX(void);
+#if CH_CFG_USE_TM_HISTOGRAMS == TRUE
+  void chStatsSnapshotHistograms(tm_histogram_t *thdp, tm_histogram_t *isrp,
+                                 bool reset);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -92,7 +145,10 @@ extern "C" {
 
 /* Stub functions for when the statistics module is disabled. */
 #define _stats_increase_irq()
+#define _stats_leave_irq()
 #define _stats_ctxswc(old, new)
+#define _stats_increase_vt_alarm()
+#define _stats_increase_vt_merged()
 #define _stats_start_measure_crit_thd()
 #define _stats_stop_measure_crit_thd()
 #define _stats_start_measure_crit_isr()
@@ -124,6 +124,7 @@
 #define CH_IRQ_EPILOGUE()                                                   \
   _dbg_check_leave_isr();                                                   \
   _trace_isr_leave(__func__);                                               \
+  _stats_leave_irq();                                                       \
   CH_CFG_IRQ_EPILOGUE_HOOK();                                               \
   PORT_IRQ_EPILOGUE()
 
@@ -267,6 +268,7 @@
                                                                             \
   _trace_switch(ntp, otp);                                                  \
   _stats_ctxswc(ntp, otp);                                                  \
+  _budget_switch(ntp, otp);                                                 \
   CH_CFG_CONTEXT_SWITCH_HOOK(ntp, otp);                                     \
   port_switch(ntp, otp);                                                    \
 }
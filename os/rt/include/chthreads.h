@@ -79,6 +79,19 @@ typedef struct {
    * @brief   Thread argument.
    */
   void              *arg;
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   EDF period.
+   * @note    If non-zero then the thread is an EDF thread and its priority
+   *          must be @p CH_CFG_EDF_PRIO.
+   */
+  sysinterval_t     period;
+  /**
+   * @brief   EDF relative deadline.
+   * @note    If zero then the deadline is equal to the period.
+   */
+  sysinterval_t     deadline;
+#endif
 } thread_descriptor_t;
 
 /*===========================================================================*/
@@ -254,6 +267,9 @@ extern "C" {
   void chThdSleepUntil(systime_t time);
   systime_t chThdSleepUntilWindowed(systime_t prev, systime_t next);
   void chThdYield(void);
+#if CH_CFG_USE_EDF == TRUE
+  void chThdWaitNextPeriod(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -38,6 +38,25 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Time measurement histograms.
+ * @details If enabled then measurements can also be recorded into
+ *          logarithmic-bucket histograms.
+ */
+#if !defined(CH_CFG_USE_TM_HISTOGRAMS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_TM_HISTOGRAMS            FALSE
+#endif
+
+/**
+ * @brief   Number of buckets in a time measurement histogram.
+ * @details Bucket zero counts null measurements, bucket @p i counts
+ *          measurements in the range <tt>[2^(i-1), 2^i)</tt> cycles, the
+ *          last bucket also counts all larger measurements.
+ */
+#if !defined(CH_CFG_TM_HISTOGRAM_BUCKETS) || defined(__DOXYGEN__)
+#define CH_CFG_TM_HISTOGRAM_BUCKETS         24
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -46,6 +65,10 @@
 #error "CH_CFG_USE_TM requires PORT_SUPPORTS_RT"
 #endif
 
+#if (CH_CFG_TM_HISTOGRAM_BUCKETS < 2) || (CH_CFG_TM_HISTOGRAM_BUCKETS > 33)
+#error "invalid CH_CFG_TM_HISTOGRAM_BUCKETS value"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -60,6 +83,17 @@ typedef struct {
   rtcnt_t               offset;
 } tm_calibration_t;
 
+#if (CH_CFG_USE_TM_HISTOGRAMS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a time measurement histogram.
+ */
+typedef struct {
+  ucnt_t                n;              /**< @brief Number of samples.      */
+  ucnt_t                buckets[CH_CFG_TM_HISTOGRAM_BUCKETS];
+                                        /**< @brief Logarithmic buckets.    */
+} tm_histogram_t;
+#endif
+
 /**
  * @brief   Type of a Time Measurement object.
  * @note    The maximum measurable time period depends on the implementation
@@ -75,6 +109,10 @@ typedef struct {
   rtcnt_t               last;           /**< @brief Last measurement.       */
   ucnt_t                n;              /**< @brief Number of measurements. */
   rttime_t              cumulative;     /**< @brief Cumulative measurement. */
+#if (CH_CFG_USE_TM_HISTOGRAMS == TRUE) || defined(__DOXYGEN__)
+  tm_histogram_t        *histogram;     /**< @brief Associated histogram or
+                                                    @p NULL.                */
+#endif
 } time_measurement_t;
 
 /*===========================================================================*/
@@ -94,6 +132,11 @@ extern "C" {
   NOINLINE void chTMStopMeasurementX(time_measurement_t *tmp);
   NOINLINE void chTMChainMeasurementToX(time_measurement_t *tmp1,
                                         time_measurement_t *tmp2);
+#if CH_CFG_USE_TM_HISTOGRAMS == TRUE
+  void chTMHistogramObjectInit(tm_histogram_t *hp);
+  void chTMHistogramSnapshotX(tm_histogram_t *hp, tm_histogram_t *snapp,
+                              bool reset);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -102,6 +145,24 @@ extern "C" {
 /* Module inline functions.                                                  */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_TM_HISTOGRAMS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Associates a histogram to a time measurement object.
+ * @details Measurements stopped after this call are also recorded into
+ *          the histogram, a @p NULL pointer removes the association.
+ *
+ * @param[in,out] tmp   pointer to a @p time_measurement_t structure
+ * @param[in] hp        pointer to a @p tm_histogram_t structure or @p NULL
+ *
+ * @xclass
+ */
+static inline void chTMSetHistogramX(time_measurement_t *tmp,
+                                     tm_histogram_t *hp) {
+
+  tmp->histogram = hp;
+}
+#endif
+
 #endif /* CH_CFG_USE_TM == TRUE */
 
 #endif /* CHTM_H */
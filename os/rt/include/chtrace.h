@@ -42,25 +42,62 @@
 #define CH_TRACE_TYPE_ISR_LEAVE             3U
 #define CH_TRACE_TYPE_HALT                  4U
 #define CH_TRACE_TYPE_USER                  5U
+#define CH_TRACE_TYPE_SEM                   6U
+#define CH_TRACE_TYPE_MTX                   7U
+#define CH_TRACE_TYPE_MBOX                  8U
+#define CH_TRACE_TYPE_COND                  9U
+#define CH_TRACE_TYPE_VT                    10U
+/** @} */
+
+/**
+ * @name    Objects trace events
+ * @note    The event is stored in the @p state field of the objects
+ *          trace records.
+ * @{
+ */
+#define CH_TRACE_EVENT_WAIT                 0U
+#define CH_TRACE_EVENT_SIGNAL               1U
+#define CH_TRACE_EVENT_BROADCAST            2U
+#define CH_TRACE_EVENT_RESET                3U
+#define CH_TRACE_EVENT_LOCK                 4U
+#define CH_TRACE_EVENT_UNLOCK               5U
+#define CH_TRACE_EVENT_BOOST                6U
+#define CH_TRACE_EVENT_POST                 7U
+#define CH_TRACE_EVENT_FETCH                8U
+#define CH_TRACE_EVENT_ARM                  9U
+#define CH_TRACE_EVENT_FIRE                 10U
 /** @} */
 
 /**
  * @name    Events to trace
+ * @note    The mask is 16 bits wide, @p CH_DBG_TRACE_MASK_DISABLED does
+ *          not fit in eight bits anymore because 255 is a valid mask.
  * @{
  */
-#define CH_DBG_TRACE_MASK_DISABLED          255U
+#define CH_DBG_TRACE_MASK_DISABLED          0xFFFFU
 #define CH_DBG_TRACE_MASK_NONE              0U
 #define CH_DBG_TRACE_MASK_SWITCH            1U
 #define CH_DBG_TRACE_MASK_ISR               2U
 #define CH_DBG_TRACE_MASK_HALT              4U
 #define CH_DBG_TRACE_MASK_USER              8U
+#define CH_DBG_TRACE_MASK_SEM               16U
+#define CH_DBG_TRACE_MASK_MTX               32U
+#define CH_DBG_TRACE_MASK_MBOX              64U
+#define CH_DBG_TRACE_MASK_COND              128U
+#define CH_DBG_TRACE_MASK_VT                256U
 #define CH_DBG_TRACE_MASK_SLOW              (CH_DBG_TRACE_MASK_SWITCH |     \
                                              CH_DBG_TRACE_MASK_HALT |       \
                                              CH_DBG_TRACE_MASK_USER)
+#define CH_DBG_TRACE_MASK_OBJECTS           (CH_DBG_TRACE_MASK_SEM |        \
+                                             CH_DBG_TRACE_MASK_MTX |        \
+                                             CH_DBG_TRACE_MASK_MBOX |       \
+                                             CH_DBG_TRACE_MASK_COND |       \
+                                             CH_DBG_TRACE_MASK_VT)
 #define CH_DBG_TRACE_MASK_ALL               (CH_DBG_TRACE_MASK_SWITCH |     \
                                              CH_DBG_TRACE_MASK_ISR |        \
                                              CH_DBG_TRACE_MASK_HALT |       \
-                                             CH_DBG_TRACE_MASK_USER)
+                                             CH_DBG_TRACE_MASK_USER |       \
+                                             CH_DBG_TRACE_MASK_OBJECTS)
 /** @} */
 
 /*===========================================================================*/
@@ -102,14 +139,23 @@
  * @brief   Trace buffer record.
  */
 typedef struct {
+#if ((CH_DBG_TRACE_MASK & CH_DBG_TRACE_MASK_OBJECTS) != 0U) ||               \
+    defined(__DOXYGEN__)
   /**
    * @brief   Record type.
+   * @note    The field is four bits wide only if an objects trace class
+   *          is enabled, else the original three bits type and five bits
+   *          state layout is retained.
    */
-  uint32_t              type:3;
+  uint32_t              type:4;
   /**
-   * @brief   Switched out thread state.
+   * @brief   Switched out thread state or object event.
    */
+  uint32_t              state:4;
+#else
+  uint32_t              type:3;
   uint32_t              state:5;
+#endif
   /**
    * @brief   Accurate time stamp.
    * @note    This field only available if the post supports
@@ -165,6 +211,22 @@ typedef struct {
        */
       void                  *up2;
     } user;
+    /**
+     * @brief   Structure representing an object event.
+     */
+    struct {
+      /**
+       * @brief   Object the event refers to.
+       */
+      void                  *objp;
+      /**
+       * @brief   Event argument.
+       * @details It is the affected thread for semaphores, mutexes and
+       *          condition variables, the message for mailboxes and the
+       *          callback parameter for virtual timers.
+       */
+      void                  *argp;
+    } obj;
   } u;
 } ch_trace_event_t;
 /*lint -restore*/
@@ -189,6 +251,11 @@ typedef struct {
    * @brief   Ring buffer.
    */
   ch_trace_event_t      buffer[CH_DBG_TRACE_BUFFER_SIZE];
+  /**
+   * @brief   Sequence number of the next record to be written.
+   * @note    It counts all the records ever written, wrapping.
+   */
+  uint32_t              seq;
 } ch_trace_buffer_t;
 #endif /* CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED */
 
@@ -223,6 +290,88 @@ typedef struct {
 #endif
 #endif /* CH_DBG_TRACE_MASK == CH_DBG_TRACE_MASK_DISABLED */
 
+/**
+ * @brief   Inserts an object event record if the class is not suspended.
+ * @note    The suspension check is performed inline so that the cost of
+ *          a suspended class is a single test.
+ *
+ * @param[in] mask      the trace class mask
+ * @param[in] type      the record type
+ * @param[in] event     the object event
+ * @param[in] objp      pointer to the object
+ * @param[in] argp      event argument
+ *
+ * @notapi
+ */
+#define _trace_object_event(mask, type, event, objp, argp) do {            \
+  if ((ch.dbg.trace_buffer.suspended & (uint16_t)(mask)) == 0U) {           \
+    _trace_object((uint8_t)(type), (uint8_t)(event),                        \
+                  (void *)(objp), (void *)(argp));                          \
+  }                                                                         \
+} while (false)
+
+/* Objects trace classes not enabled in CH_DBG_TRACE_MASK are replaced by
+   empty macros.*/
+#if !defined(_trace_sem)
+#if ((CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED) &&                   \
+     ((CH_DBG_TRACE_MASK & CH_DBG_TRACE_MASK_SEM) != 0U)) ||                \
+    defined(__DOXYGEN__)
+#define _trace_sem(event, sp, argp)                                         \
+  _trace_object_event(CH_DBG_TRACE_MASK_SEM, CH_TRACE_TYPE_SEM,             \
+                      event, sp, argp)
+#else
+#define _trace_sem(event, sp, argp)
+#endif
+#endif
+
+#if !defined(_trace_mtx)
+#if ((CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED) &&                   \
+     ((CH_DBG_TRACE_MASK & CH_DBG_TRACE_MASK_MTX) != 0U)) ||                \
+    defined(__DOXYGEN__)
+#define _trace_mtx(event, mp, argp)                                         \
+  _trace_object_event(CH_DBG_TRACE_MASK_MTX, CH_TRACE_TYPE_MTX,             \
+                      event, mp, argp)
+#else
+#define _trace_mtx(event, mp, argp)
+#endif
+#endif
+
+#if !defined(_trace_mbox)
+#if ((CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED) &&                   \
+     ((CH_DBG_TRACE_MASK & CH_DBG_TRACE_MASK_MBOX) != 0U)) ||               \
+    defined(__DOXYGEN__)
+#define _trace_mbox(event, mbp, msg)                                        \
+  _trace_object_event(CH_DBG_TRACE_MASK_MBOX, CH_TRACE_TYPE_MBOX,           \
+                      event, mbp, (uintptr_t)(msg))
+#else
+#define _trace_mbox(event, mbp, msg)
+#endif
+#endif
+
+#if !defined(_trace_cond)
+#if ((CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED) &&                   \
+     ((CH_DBG_TRACE_MASK & CH_DBG_TRACE_MASK_COND) != 0U)) ||               \
+    defined(__DOXYGEN__)
+#define _trace_cond(event, cp, argp)                                        \
+  _trace_object_event(CH_DBG_TRACE_MASK_COND, CH_TRACE_TYPE_COND,           \
+                      event, cp, argp)
+#else
+#define _trace_cond(event, cp, argp)
+#endif
+#endif
+
+#if !defined(_trace_vt)
+#if ((CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED) &&                   \
+     ((CH_DBG_TRACE_MASK & CH_DBG_TRACE_MASK_VT) != 0U)) ||                 \
+    defined(__DOXYGEN__)
+#define _trace_vt(event, vtp)                                               \
+  _trace_object_event(CH_DBG_TRACE_MASK_VT, CH_TRACE_TYPE_VT,               \
+                      event, vtp, (vtp)->par)
+#else
+#define _trace_vt(event, vtp)
+#endif
+#endif
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -236,12 +385,14 @@ extern "C" {
   void _trace_isr_enter(const char *isr);
   void _trace_isr_leave(const char *isr);
   void _trace_halt(const char *reason);
+  void _trace_object(uint8_t type, uint8_t event, void *objp, void *argp);
   void chDbgWriteTraceI(void *up1, void *up2);
   void chDbgWriteTrace(void *up1, void *up2);
   void chDbgSuspendTraceI(uint16_t mask);
   void chDbgSuspendTrace(uint16_t mask);
   void chDbgResumeTraceI(uint16_t mask);
   void chDbgResumeTrace(uint16_t mask);
+  bool chDbgFetchTraceI(uint32_t *seqp, ch_trace_event_t *tep);
 #endif /* CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED */
 #ifdef __cplusplus
 }
@@ -32,6 +32,16 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+#if (CH_CFG_VT_WHEEL == FALSE) || defined(__DOXYGEN__)
+/**
+ * @brief   Unknown distance of the last timer in the delta list.
+ * @details The distance is unknown after a timer has been inserted beyond
+ *          the numeric range of the intervals, it is known again once the
+ *          list has been emptied.
+ */
+#define CH_VT_TAILDELTA_UNKNOWN     ((sysinterval_t)-1)
+#endif
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -74,7 +84,29 @@ extern "C" {
   void _vt_init(void);
   void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
                   vtfunc_t vtfunc, void *par);
+  void chVTDoSetPeriodicI(virtual_timer_t *vtp, sysinterval_t delay,
+                          sysinterval_t period, vtfunc_t vtfunc, void *par);
   void chVTDoResetI(virtual_timer_t *vtp);
+#if CH_CFG_VT_WHEEL == FALSE
+  void _vt_reload(virtual_timer_t *vtp);
+#endif
+#if CH_CFG_VT_DEFERRED == TRUE
+  void chVTDoSetDeferredI(virtual_timer_t *vtp, sysinterval_t delay,
+                          sysinterval_t period, vtfunc_t vtfunc, void *par);
+  void _vt_defer(virtual_timer_t *vtp, vtfunc_t fn);
+  void _vt_thread(void *p);
+#endif
+#if CH_CFG_VT_SLACK == TRUE
+  void chVTDoSetWithSlackI(virtual_timer_t *vtp, sysinterval_t delay,
+                           sysinterval_t slack, vtfunc_t vtfunc, void *par);
+#if CH_CFG_ST_TIMEDELTA > 0
+  sysinterval_t _vt_coalesce_alarm(void);
+#endif
+#endif
+#if CH_CFG_VT_WHEEL == TRUE
+  bool _vt_wheel_next_event(sysinterval_t *deltap);
+  void _vt_wheel_tick(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -196,6 +228,8 @@ static inline bool chVTIsSystemTimeWithin(systime_t start, systime_t end) {
  *          in excess of @p CH_CFG_ST_TIMEDELTA ticks.
  * @note    The interval returned by this function is only meaningful if
  *          more timers are not added to the list until the returned time.
+ * @note    When the timing wheel is enabled the next event can be a slot
+ *          cascade preceding the first timer expiration.
  *
  * @param[out] timep    pointer to a variable that will contain the time
  *                      interval until the next timer elapses. This pointer
@@ -207,14 +241,33 @@ static inline bool chVTIsSystemTimeWithin(systime_t start, systime_t end) {
  * @iclass
  */
 static inline bool chVTGetTimersStateI(sysinterval_t *timep) {
+#if CH_CFG_VT_WHEEL == TRUE
+  sysinterval_t delta;
+#endif
 
   chDbgCheckClassI();
 
+#if CH_CFG_VT_WHEEL == TRUE
+  if (!_vt_wheel_next_event(&delta)) {
+    return false;
+  }
+#else
   if (&ch.vtlist == (virtual_timers_list_t *)ch.vtlist.next) {
     return false;
   }
+#endif
 
   if (timep != NULL) {
+#if CH_CFG_VT_WHEEL == TRUE
+#if CH_CFG_ST_TIMEDELTA == 0
+    *timep = delta;
+#else
+    *timep = chTimeDiffX(chVTGetSystemTimeX(),
+                         chTimeAddX(ch.vtlist.lasttime,
+                                    delta +
+                                    (sysinterval_t)CH_CFG_ST_TIMEDELTA));
+#endif
+#else /* CH_CFG_VT_WHEEL == FALSE */
 #if CH_CFG_ST_TIMEDELTA == 0
     *timep = ch.vtlist.next->delta;
 #else
@@ -223,6 +276,7 @@ static inline bool chVTGetTimersStateI(sysinterval_t *timep) {
                                     ch.vtlist.next->delta +
                                     (sysinterval_t)CH_CFG_ST_TIMEDELTA));
 #endif
+#endif /* CH_CFG_VT_WHEEL == FALSE */
   }
 
   return true;
@@ -358,6 +412,207 @@ static inline void chVTSet(virtual_timer_t *vtp, sysinterval_t delay,
   chSysUnlock();
 }
 
+/**
+ * @brief   Enables a periodic virtual timer.
+ * @details If the virtual timer was already enabled then it is re-enabled
+ *          using the new parameters.
+ * @pre     The timer must have been initialized using @p chVTObjectInit()
+ *          or @p chVTDoSetI().
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the first expiration, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] period    the number of ticks between expirations, zero for
+ *                      a one-shot timer
+ * @param[in] vtfunc    the timer callback function
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+static inline void chVTSetPeriodicI(virtual_timer_t *vtp,
+                                    sysinterval_t delay,
+                                    sysinterval_t period,
+                                    vtfunc_t vtfunc, void *par) {
+
+  chVTResetI(vtp);
+  chVTDoSetPeriodicI(vtp, delay, period, vtfunc, par);
+}
+
+/**
+ * @brief   Enables a periodic virtual timer.
+ * @details If the virtual timer was already enabled then it is re-enabled
+ *          using the new parameters.
+ * @pre     The timer must have been initialized using @p chVTObjectInit()
+ *          or @p chVTDoSetI().
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the first expiration, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] period    the number of ticks between expirations, zero for
+ *                      a one-shot timer
+ * @param[in] vtfunc    the timer callback function
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @api
+ */
+static inline void chVTSetPeriodic(virtual_timer_t *vtp,
+                                   sysinterval_t delay,
+                                   sysinterval_t period,
+                                   vtfunc_t vtfunc, void *par) {
+
+  chSysLock();
+  chVTSetPeriodicI(vtp, delay, period, vtfunc, par);
+  chSysUnlock();
+}
+
+#if (CH_CFG_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Enables a virtual timer with a deferred callback.
+ * @details If the virtual timer was already enabled then it is re-enabled
+ *          using the new parameters.
+ * @pre     The timer must have been initialized using @p chVTObjectInit()
+ *          or @p chVTDoSetI().
+ * @note    The callback function is invoked from thread context with the
+ *          kernel unlocked, it must use the normal thread API.
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the first expiration, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] period    the number of ticks between expirations, zero for
+ *                      a one-shot timer
+ * @param[in] vtfunc    the timer callback function
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+static inline void chVTSetDeferredI(virtual_timer_t *vtp,
+                                    sysinterval_t delay,
+                                    sysinterval_t period,
+                                    vtfunc_t vtfunc, void *par) {
+
+  chVTResetI(vtp);
+  chVTDoSetDeferredI(vtp, delay, period, vtfunc, par);
+}
+
+/**
+ * @brief   Enables a virtual timer with a deferred callback.
+ * @details If the virtual timer was already enabled then it is re-enabled
+ *          using the new parameters.
+ * @pre     The timer must have been initialized using @p chVTObjectInit()
+ *          or @p chVTDoSetI().
+ * @note    The callback function is invoked from thread context with the
+ *          kernel unlocked, it must use the normal thread API.
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the first expiration, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] period    the number of ticks between expirations, zero for
+ *                      a one-shot timer
+ * @param[in] vtfunc    the timer callback function
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @api
+ */
+static inline void chVTSetDeferred(virtual_timer_t *vtp,
+                                   sysinterval_t delay,
+                                   sysinterval_t period,
+                                   vtfunc_t vtfunc, void *par) {
+
+  chSysLock();
+  chVTSetDeferredI(vtp, delay, period, vtfunc, par);
+  chSysUnlock();
+}
+#endif /* CH_CFG_VT_DEFERRED == TRUE */
+
+#if (CH_CFG_VT_SLACK == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Enables a virtual timer with a tolerated expiration delay.
+ * @details If the virtual timer was already enabled then it is re-enabled
+ *          using the new parameters.
+ * @pre     The timer must have been initialized using @p chVTObjectInit()
+ *          or @p chVTDoSetI().
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the operation timeouts, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] slack     the number of ticks the expiration can be delayed
+ *                      in order to be coalesced with other timers
+ * @param[in] vtfunc    the timer callback function. After invoking the
+ *                      callback the timer is disabled and the structure can
+ *                      be disposed or reused.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+static inline void chVTSetWithSlackI(virtual_timer_t *vtp,
+                                     sysinterval_t delay,
+                                     sysinterval_t slack,
+                                     vtfunc_t vtfunc, void *par) {
+
+  chVTResetI(vtp);
+  chVTDoSetWithSlackI(vtp, delay, slack, vtfunc, par);
+}
+
+/**
+ * @brief   Enables a virtual timer with a tolerated expiration delay.
+ * @details If the virtual timer was already enabled then it is re-enabled
+ *          using the new parameters.
+ * @pre     The timer must have been initialized using @p chVTObjectInit()
+ *          or @p chVTDoSetI().
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the operation timeouts, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] slack     the number of ticks the expiration can be delayed
+ *                      in order to be coalesced with other timers
+ * @param[in] vtfunc    the timer callback function. After invoking the
+ *                      callback the timer is disabled and the structure can
+ *                      be disposed or reused.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @api
+ */
+static inline void chVTSetWithSlack(virtual_timer_t *vtp,
+                                    sysinterval_t delay,
+                                    sysinterval_t slack,
+                                    vtfunc_t vtfunc, void *par) {
+
+  chSysLock();
+  chVTSetWithSlackI(vtp, delay, slack, vtfunc, par);
+  chSysUnlock();
+}
+#endif /* CH_CFG_VT_SLACK == TRUE */
+
 /**
  * @brief   Virtual timers ticker.
  * @note    The system lock is released before entering the callback and
@@ -371,20 +626,37 @@ static inline void chVTDoTickI(void) {
 
   chDbgCheckClassI();
 
-#if CH_CFG_ST_TIMEDELTA == 0
+#if CH_CFG_VT_WHEEL == TRUE
+  _vt_wheel_tick();
+#elif CH_CFG_ST_TIMEDELTA == 0
   ch.vtlist.systime++;
   if (&ch.vtlist != (virtual_timers_list_t *)ch.vtlist.next) {
     /* The list is not empty, processing elements on top.*/
     --ch.vtlist.next->delta;
+    --ch.vtlist.taildelta;
     while (ch.vtlist.next->delta == (sysinterval_t)0) {
       virtual_timer_t *vtp;
       vtfunc_t fn;
 
       vtp = ch.vtlist.next;
+      _trace_vt(CH_TRACE_EVENT_FIRE, vtp);
       fn = vtp->func;
-      vtp->func = NULL;
       vtp->next->prev = (virtual_timer_t *)&ch.vtlist;
       ch.vtlist.next = vtp->next;
+      if (vtp->reload > (sysinterval_t)0) {
+        /* Periodic timer, it is re-armed one period after its deadline.*/
+        _vt_reload(vtp);
+      }
+      else {
+        vtp->func = NULL;
+      }
+#if CH_CFG_VT_DEFERRED == TRUE
+      if (vtp->deferred) {
+        /* The callback is executed by the virtual timers thread.*/
+        _vt_defer(vtp, fn);
+        continue;
+      }
+#endif
       chSysUnlockFromISR();
       fn(vtp->par);
       chSysLockFromISR();
@@ -394,6 +666,9 @@ static inline void chVTDoTickI(void) {
   virtual_timer_t *vtp;
   systime_t now;
   sysinterval_t delta, nowdelta;
+  bool merged = false;
+
+  _stats_increase_vt_alarm();
 
   /* Looping through timers.*/
   vtp = ch.vtlist.next;
@@ -417,21 +692,51 @@ static inline void chVTDoTickI(void) {
       /* The "last time" becomes this timer's expiration time.*/
       ch.vtlist.lasttime += vtp->delta;
       nowdelta -= vtp->delta;
+      if (ch.vtlist.taildelta != CH_VT_TAILDELTA_UNKNOWN) {
+        ch.vtlist.taildelta -= vtp->delta;
+      }
 
       vtp->next->prev = (virtual_timer_t *)&ch.vtlist;
       ch.vtlist.next = vtp->next;
+      _trace_vt(CH_TRACE_EVENT_FIRE, vtp);
       fn = vtp->func;
-      vtp->func = NULL;
+      if (vtp->reload > (sysinterval_t)0) {
+        /* Periodic timer, it is re-armed one period after its deadline so
+           that the callback latency does not accumulate.*/
+        _vt_reload(vtp);
+      }
+      else {
+        vtp->func = NULL;
+      }
+
+      /* Timers after the first are served by a merged alarm.*/
+      if (merged) {
+        _stats_increase_vt_merged();
+      }
+      merged = true;
 
       /* if the list becomes empty then the timer is stopped.*/
       if (ch.vtlist.next == (virtual_timer_t *)&ch.vtlist) {
         port_timer_stop_alarm();
       }
 
+#if CH_CFG_VT_DEFERRED == TRUE
+      if (vtp->deferred) {
+        /* The callback is executed by the virtual timers thread.*/
+        _vt_defer(vtp, fn);
+      }
+      else {
+        /* The callback is invoked outside the kernel critical zone.*/
+        chSysUnlockFromISR();
+        fn(vtp->par);
+        chSysLockFromISR();
+      }
+#else
       /* The callback is invoked outside the kernel critical zone.*/
       chSysUnlockFromISR();
       fn(vtp->par);
       chSysLockFromISR();
+#endif
 
       /* Next element in the list.*/
       vtp = ch.vtlist.next;
@@ -448,9 +753,18 @@ static inline void chVTDoTickI(void) {
      and subtracted to next timer's delta.*/
   ch.vtlist.lasttime += nowdelta;
   ch.vtlist.next->delta -= nowdelta;
+  if (ch.vtlist.taildelta != CH_VT_TAILDELTA_UNKNOWN) {
+    ch.vtlist.taildelta -= nowdelta;
+  }
 
   /* Recalculating the next alarm time.*/
+#if CH_CFG_VT_SLACK == TRUE
+  /* Timers whose windows overlap are served by a single alarm, note that
+     "last time" is now equal to "now".*/
+  delta = _vt_coalesce_alarm();
+#else
   delta = chTimeDiffX(now, chTimeAddX(ch.vtlist.lasttime, vtp->delta));
+#endif
   if (delta < (sysinterval_t)CH_CFG_ST_TIMEDELTA) {
     delta = (sysinterval_t)CH_CFG_ST_TIMEDELTA;
   }
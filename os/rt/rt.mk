@@ -24,6 +24,9 @@ endif
 ifneq ($(findstring CH_CFG_USE_REGISTRY TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chregistry.c
 endif
+ifneq ($(findstring CH_CFG_USE_BUDGETS TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chbudget.c
+endif
 ifneq ($(findstring CH_CFG_USE_SEMAPHORES TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chsem.c
 endif
@@ -45,6 +48,9 @@ endif
 ifneq ($(findstring CH_CFG_USE_MAILBOXES TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chmboxes.c
 endif
+ifneq ($(findstring CH_CFG_USE_PIPES TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/common/oslib/src/chpipes.c
+endif
 ifneq ($(findstring CH_CFG_USE_MEMCORE TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chmemcore.c
 endif
@@ -54,6 +60,12 @@ endif
 ifneq ($(findstring CH_CFG_USE_MEMPOOLS TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chmempools.c
 endif
+ifneq ($(findstring CH_CFG_USE_SLAB TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/common/oslib/src/chslab.c
+endif
+ifneq ($(findstring CH_CFG_USE_ARENAS TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/common/oslib/src/charena.c
+endif
 ifneq ($(findstring CH_CFG_USE_FACTORY TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/common/oslib/src/chfactory.c
 endif
@@ -67,6 +79,7 @@ KERNSRC := $(CHIBIOS)/os/rt/src/chsys.c \
            $(CHIBIOS)/os/rt/src/chtm.c \
            $(CHIBIOS)/os/rt/src/chstats.c \
            $(CHIBIOS)/os/rt/src/chregistry.c \
+           $(CHIBIOS)/os/rt/src/chbudget.c \
            $(CHIBIOS)/os/rt/src/chsem.c \
            $(CHIBIOS)/os/rt/src/chmtx.c \
            $(CHIBIOS)/os/rt/src/chcond.c \
@@ -74,9 +87,12 @@ KERNSRC := $(CHIBIOS)/os/rt/src/chsys.c \
            $(CHIBIOS)/os/rt/src/chmsg.c \
            $(CHIBIOS)/os/rt/src/chdynamic.c \
            $(CHIBIOS)/os/common/oslib/src/chmboxes.c \
+           $(CHIBIOS)/os/common/oslib/src/chpipes.c \
            $(CHIBIOS)/os/common/oslib/src/chmemcore.c \
            $(CHIBIOS)/os/common/oslib/src/chheap.c \
            $(CHIBIOS)/os/common/oslib/src/chmempools.c \
+           $(CHIBIOS)/os/common/oslib/src/chslab.c \
+           $(CHIBIOS)/os/common/oslib/src/charena.c \
            $(CHIBIOS)/os/common/oslib/src/chfactory.c
 endif
 
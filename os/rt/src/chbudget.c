@@ -0,0 +1,369 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    chbudget.c
+ * @brief   CPU budgets module code.
+ *
+ * @addtogroup budgets
+ * @details CPU budgets related APIs and services.
+ *          <h2>Operation mode</h2>
+ *          A thread can be assigned a CPU budget expressed in realtime
+ *          counter cycles and a replenishment period in system ticks.
+ *          The cycles consumed by the thread are accounted on each context
+ *          switch, when the budget is exhausted the thread is demoted to
+ *          the @p CH_CFG_BUDGET_PRIO priority level.<br>
+ *          Replenishment is sporadic-server style, the budget is restored
+ *          one period after the thread started consuming it, at that time
+ *          the thread regains its original priority.
+ * @pre     In order to use the CPU budgets APIs the @p CH_CFG_USE_BUDGETS
+ *          option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_BUDGETS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Changes the priority of a thread.
+ * @details The thread is moved to its new position in the ready list or in
+ *          the priority ordered queue it is waiting on. If the thread is
+ *          waiting on a mutex then the new priority is propagated to the
+ *          mutex owners as done by the priority inheritance protocol.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] prio      the new priority
+ */
+static void budget_set_prio(thread_t *tp, tprio_t prio) {
+
+  do {
+    tp->prio = prio;
+
+    /* The following states need priority queues reordering.*/
+    switch (tp->state) {
+#if CH_CFG_USE_MUTEXES == TRUE
+    case CH_STATE_WTMTX:
+      /* Re-enqueues tp with its new priority, the mutex owner is boosted
+         if it has a lower priority.*/
+      queue_prio_insert(queue_dequeue(tp), &tp->u.wtmtxp->queue);
+      tp = tp->u.wtmtxp->owner;
+      /*lint -e{9042} [16.1] Continues the while.*/
+      continue;
+#endif
+#if (CH_CFG_USE_CONDVARS == TRUE) ||                                        \
+    ((CH_CFG_USE_SEMAPHORES == TRUE) &&                                     \
+     (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)) ||                           \
+    ((CH_CFG_USE_MESSAGES == TRUE) &&                                       \
+     (CH_CFG_USE_MESSAGES_PRIORITY == TRUE))
+#if CH_CFG_USE_CONDVARS == TRUE
+    case CH_STATE_WTCOND:
+#endif
+#if (CH_CFG_USE_SEMAPHORES == TRUE) &&                                      \
+    (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)
+    case CH_STATE_WTSEM:
+#endif
+#if (CH_CFG_USE_MESSAGES == TRUE) && (CH_CFG_USE_MESSAGES_PRIORITY == TRUE)
+    case CH_STATE_SNDMSGQ:
+#endif
+      /* Re-enqueues tp with its new priority on the queue.*/
+      queue_prio_insert(queue_dequeue(tp), &tp->u.wtmtxp->queue);
+      break;
+#endif
+    case CH_STATE_READY:
+#if CH_DBG_ENABLE_ASSERTS == TRUE
+      /* Prevents an assertion in chSchReadyI().*/
+      tp->state = CH_STATE_CURRENT;
+#endif
+      /* Re-enqueues tp with its new priority on the ready list.*/
+      (void) chSchReadyI(chSchDequeueReadyI(tp));
+      break;
+    default:
+      /* Nothing to do for other states.*/
+      break;
+    }
+    break;
+  } while (tp->prio < prio);
+}
+
+/**
+ * @brief   Demotes the current thread to the background priority.
+ * @note    The current thread is not in any queue, its priority is just
+ *          changed.
+ * @note    A thread boosted by priority inheritance keeps its priority
+ *          until it releases its mutexes.
+ *
+ * @param[in] tp        pointer to the thread
+ */
+static void budget_demote(thread_t *tp) {
+
+  tp->bdemoted = true;
+  tp->bexhausted++;
+#if CH_CFG_USE_MUTEXES == TRUE
+  tp->bprio    = tp->realprio;
+  tp->realprio = CH_CFG_BUDGET_PRIO;
+  if (tp->prio == tp->bprio) {
+    tp->prio = CH_CFG_BUDGET_PRIO;
+  }
+#else
+  tp->bprio    = tp->prio;
+  tp->prio     = CH_CFG_BUDGET_PRIO;
+#endif
+}
+
+/**
+ * @brief   Restores the priority of a demoted thread.
+ *
+ * @param[in] tp        pointer to the thread
+ */
+static void budget_restore(thread_t *tp) {
+
+  tp->bdemoted = false;
+#if CH_CFG_USE_MUTEXES == TRUE
+  tp->realprio = tp->bprio;
+
+  /* A boost above the restored priority is kept until the mutexes are
+     released.*/
+  if ((tp->prio > CH_CFG_BUDGET_PRIO) && (tp->prio >= tp->bprio)) {
+    return;
+  }
+#endif
+  if (tp->prio != tp->bprio) {
+    budget_set_prio(tp, tp->bprio);
+  }
+}
+
+/**
+ * @brief   Enforcement timer callback.
+ * @details The budget of the current thread is verified, the thread is
+ *          demoted if its budget is exhausted.
+ *
+ * @param[in] p         not used
+ */
+static void budget_check(void *p) {
+  thread_t *tp = currp;
+
+  (void)p;
+
+  chSysLockFromISR();
+  if ((tp->budget > (rtcnt_t)0) && !tp->bdemoted &&
+      ((tp->bused + (chSysGetRealtimeCounterX() - tp->bstart)) >=
+       tp->budget)) {
+    budget_demote(tp);
+    chVTResetI(&ch.budget_vt);
+  }
+  chSysUnlockFromISR();
+}
+
+/**
+ * @brief   Starts or stops the enforcement timer for a thread.
+ *
+ * @param[in] tp        pointer to the thread becoming current
+ */
+static void budget_monitor(thread_t *tp) {
+
+  if ((tp->budget > (rtcnt_t)0) && !tp->bdemoted) {
+    if (!chVTIsArmedI(&ch.budget_vt)) {
+      chVTDoSetPeriodicI(&ch.budget_vt,
+                         (sysinterval_t)CH_CFG_BUDGET_CHECK_INTERVAL,
+                         (sysinterval_t)CH_CFG_BUDGET_CHECK_INTERVAL,
+                         budget_check, NULL);
+    }
+  }
+  else {
+    if (chVTIsArmedI(&ch.budget_vt)) {
+      chVTResetI(&ch.budget_vt);
+    }
+  }
+}
+
+/**
+ * @brief   Replenishment timer callback.
+ *
+ * @param[in] p         pointer to the thread
+ */
+static void budget_replenish(void *p) {
+  thread_t *tp = (thread_t *)p;
+
+  chSysLockFromISR();
+  tp->bused = (rtcnt_t)0;
+  if (tp->bdemoted) {
+    budget_restore(tp);
+  }
+  if (tp == currp) {
+    /* The thread is consuming its budget, a new replenishment period
+       starts now.*/
+    tp->bstart = chSysGetRealtimeCounterX();
+    chVTDoSetI(&tp->bvt, tp->bperiod, budget_replenish, tp);
+    budget_monitor(tp);
+  }
+  chSysUnlockFromISR();
+}
+
+/**
+ * @brief   Starts the budget accounting of a thread becoming current.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] now       current realtime counter value
+ */
+static void budget_start(thread_t *tp, rtcnt_t now) {
+
+  tp->bstart = now;
+
+  /* The replenishment period starts when the thread starts consuming its
+     budget.*/
+  if (!chVTIsArmedI(&tp->bvt)) {
+    chVTDoSetI(&tp->bvt, tp->bperiod, budget_replenish, tp);
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes the CPU budgets module.
+ *
+ * @notapi
+ */
+void _budget_init(void) {
+
+  chVTObjectInit(&ch.budget_vt);
+}
+
+/**
+ * @brief   Stops the budget timers of a terminating thread.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void _budget_thread_exit(thread_t *tp) {
+
+  if (chVTIsArmedI(&tp->bvt)) {
+    chVTResetI(&tp->bvt);
+  }
+  tp->budget = (rtcnt_t)0;
+}
+
+/**
+ * @brief   Accounts the consumed cycles on a context switch.
+ * @note    It is invoked from within the kernel critical zone.
+ *
+ * @param[in] ntp       the thread to be switched in
+ * @param[in] otp       the thread to be switched out
+ *
+ * @notapi
+ */
+void _budget_switch(thread_t *ntp, thread_t *otp) {
+  rtcnt_t now;
+
+  if ((ntp->budget == (rtcnt_t)0) && (otp->budget == (rtcnt_t)0)) {
+    return;
+  }
+
+  now = chSysGetRealtimeCounterX();
+  if (otp->budget > (rtcnt_t)0) {
+    otp->bused += now - otp->bstart;
+  }
+  if (ntp->budget > (rtcnt_t)0) {
+    budget_start(ntp, now);
+  }
+  budget_monitor(ntp);
+}
+
+/**
+ * @brief   Assigns a CPU budget to a thread.
+ * @details The thread receives a full budget, a demoted thread regains its
+ *          priority immediately.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] budget    the budget in realtime counter cycles, zero removes
+ *                      the budget enforcement from the thread
+ * @param[in] period    the replenishment period, it must be different
+ *                      from zero
+ *
+ * @iclass
+ */
+void chBudgetSetI(thread_t *tp, rtcnt_t budget, sysinterval_t period) {
+
+  chDbgCheckClassI();
+  chDbgCheck((tp != NULL) && (period != (sysinterval_t)0));
+
+  if (chVTIsArmedI(&tp->bvt)) {
+    chVTResetI(&tp->bvt);
+  }
+  if (tp->bdemoted) {
+    budget_restore(tp);
+  }
+  tp->budget  = budget;
+  tp->bperiod = period;
+  tp->bused   = (rtcnt_t)0;
+  if (tp == currp) {
+    if (budget > (rtcnt_t)0) {
+      budget_start(tp, chSysGetRealtimeCounterX());
+    }
+    budget_monitor(tp);
+  }
+}
+
+/**
+ * @brief   Assigns a CPU budget to a thread.
+ * @details The thread receives a full budget, a demoted thread regains its
+ *          priority immediately.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] budget    the budget in realtime counter cycles, zero removes
+ *                      the budget enforcement from the thread
+ * @param[in] period    the replenishment period, it must be different
+ *                      from zero
+ *
+ * @api
+ */
+void chBudgetSet(thread_t *tp, rtcnt_t budget, sysinterval_t period) {
+
+  chSysLock();
+  chBudgetSetI(tp, budget, period);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+#endif /* CH_CFG_USE_BUDGETS == TRUE */
+
+/** @} */
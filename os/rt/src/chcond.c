@@ -92,7 +92,13 @@ void chCondSignal(condition_variable_t *cp) {
 
   chSysLock();
   if (queue_notempty(&cp->queue)) {
-    chSchWakeupS(queue_fifo_remove(&cp->queue), MSG_OK);
+    thread_t *tp = queue_fifo_remove(&cp->queue);
+
+    _trace_cond(CH_TRACE_EVENT_SIGNAL, cp, tp);
+    chSchWakeupS(tp, MSG_OK);
+  }
+  else {
+    _trace_cond(CH_TRACE_EVENT_SIGNAL, cp, NULL);
   }
   chSysUnlock();
 }
@@ -115,9 +121,13 @@ void chCondSignalI(condition_variable_t *cp) {
 
   if (queue_notempty(&cp->queue)) {
     thread_t *tp = queue_fifo_remove(&cp->queue);
+    _trace_cond(CH_TRACE_EVENT_SIGNAL, cp, tp);
     tp->u.rdymsg = MSG_OK;
     (void) chSchReadyI(tp);
   }
+  else {
+    _trace_cond(CH_TRACE_EVENT_SIGNAL, cp, NULL);
+  }
 }
 
 /**
@@ -154,6 +164,7 @@ void chCondBroadcastI(condition_variable_t *cp) {
   /* Empties the condition variable queue and inserts all the threads into the
      ready list in FIFO order. The wakeup message is set to @p MSG_RESET in
      order to make a chCondBroadcast() detectable from a chCondSignal().*/
+  _trace_cond(CH_TRACE_EVENT_BROADCAST, cp, NULL);
   while (queue_notempty(&cp->queue)) {
     chSchReadyI(queue_fifo_remove(&cp->queue))->u.rdymsg = MSG_RESET;
   }
@@ -211,6 +222,8 @@ msg_t chCondWaitS(condition_variable_t *cp) {
   chDbgCheck(cp != NULL);
   chDbgAssert(ctp->mtxlist != NULL, "not owning a mutex");
 
+  _trace_cond(CH_TRACE_EVENT_WAIT, cp, currp);
+
   /* Getting "current" mutex and releasing it.*/
   mp = chMtxGetNextMutexS();
   chMtxUnlockS(mp);
@@ -301,6 +314,8 @@ msg_t chCondWaitTimeoutS(condition_variable_t *cp, sysinterval_t timeout) {
   chDbgCheck((cp != NULL) && (timeout != TIME_IMMEDIATE));
   chDbgAssert(currp->mtxlist != NULL, "not owning a mutex");
 
+  _trace_cond(CH_TRACE_EVENT_WAIT, cp, currp);
+
   /* Getting "current" mutex and releasing it.*/
   mp = chMtxGetNextMutexS();
   chMtxUnlockS(mp);
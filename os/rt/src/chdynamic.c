@@ -64,6 +64,8 @@
  * @note    The memory allocated for the thread is not released automatically,
  *          it is responsibility of the creator thread to call @p chThdWait()
  *          and then release the allocated memory.
+ * @note    The working area can be placed in a specific memory region by
+ *          using a heap initialized with @p chHeapObjectInitFromRegion().
  *
  * @param[in] heapp     heap from which allocate the memory or @p NULL for the
  *                      default heap
@@ -96,7 +98,11 @@ thread_t *chThdCreateFromHeap(memory_heap_t *heapp, size_t size,
     (stkalign_t *)((uint8_t *)wsp + size),
     prio,
     pf,
-    arg
+    arg,
+#if CH_CFG_USE_EDF == TRUE
+    (sysinterval_t)0,
+    (sysinterval_t)0
+#endif
   };
 
 #if CH_DBG_FILL_THREADS == TRUE
@@ -160,7 +166,11 @@ thread_t *chThdCreateFromMemoryPool(memory_pool_t *mp, const char *name,
     (stkalign_t *)((uint8_t *)wsp + mp->object_size),
     prio,
     pf,
-    arg
+    arg,
+#if CH_CFG_USE_EDF == TRUE
+    (sysinterval_t)0,
+    (sysinterval_t)0
+#endif
   };
 
 #if CH_DBG_FILL_THREADS == TRUE
@@ -142,6 +142,8 @@ void chMtxLockS(mutex_t *mp) {
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
 
+  _trace_mtx(CH_TRACE_EVENT_LOCK, mp, mp->owner);
+
   /* Is the mutex already locked? */
   if (mp->owner != NULL) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
@@ -164,6 +166,7 @@ void chMtxLockS(mutex_t *mp) {
          owning thread? */
       while (tp->prio < ctp->prio) {
         /* Make priority of thread tp match the running thread's priority.*/
+        _trace_mtx(CH_TRACE_EVENT_BOOST, mp, tp);
         tp->prio = ctp->prio;
 
         /* The following states need priority queues reordering.*/
@@ -199,7 +202,7 @@ void chMtxLockS(mutex_t *mp) {
           tp->state = CH_STATE_CURRENT;
 #endif
           /* Re-enqueues tp with its new priority on the ready list.*/
-          (void) chSchReadyI(queue_dequeue(tp));
+          (void) chSchReadyI(chSchDequeueReadyI(tp));
           break;
         default:
           /* Nothing to do for other states.*/
@@ -284,6 +287,8 @@ bool chMtxTryLockS(mutex_t *mp) {
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
 
+  _trace_mtx(CH_TRACE_EVENT_LOCK, mp, mp->owner);
+
   if (mp->owner != NULL) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
 
@@ -372,6 +377,7 @@ void chMtxUnlock(mutex_t *mp) {
       mp->cnt = (cnt_t)1;
 #endif
       tp = queue_fifo_remove(&mp->queue);
+      _trace_mtx(CH_TRACE_EVENT_UNLOCK, mp, tp);
       mp->owner = tp;
       mp->next = tp->mtxlist;
       tp->mtxlist = mp;
@@ -384,6 +390,7 @@ void chMtxUnlock(mutex_t *mp) {
       chSchRescheduleS();
     }
     else {
+      _trace_mtx(CH_TRACE_EVENT_UNLOCK, mp, NULL);
       mp->owner = NULL;
     }
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
@@ -458,12 +465,14 @@ void chMtxUnlockS(mutex_t *mp) {
       mp->cnt = (cnt_t)1;
 #endif
       tp = queue_fifo_remove(&mp->queue);
+      _trace_mtx(CH_TRACE_EVENT_UNLOCK, mp, tp);
       mp->owner = tp;
       mp->next = tp->mtxlist;
       tp->mtxlist = mp;
       (void) chSchReadyI(tp);
     }
     else {
+      _trace_mtx(CH_TRACE_EVENT_UNLOCK, mp, NULL);
       mp->owner = NULL;
     }
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
@@ -495,6 +504,7 @@ void chMtxUnlockAllS(void) {
       mp->cnt = (cnt_t)1;
 #endif
       thread_t *tp = queue_fifo_remove(&mp->queue);
+      _trace_mtx(CH_TRACE_EVENT_UNLOCK, mp, tp);
       mp->owner = tp;
       mp->next = tp->mtxlist;
       tp->mtxlist = mp;
@@ -504,6 +514,7 @@ void chMtxUnlockAllS(void) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
       mp->cnt = (cnt_t)0;
 #endif
+      _trace_mtx(CH_TRACE_EVENT_UNLOCK, mp, NULL);
       mp->owner = NULL;
     }
   }
@@ -534,6 +545,7 @@ void chMtxUnlockAll(void) {
         mp->cnt = (cnt_t)1;
 #endif
         thread_t *tp = queue_fifo_remove(&mp->queue);
+        _trace_mtx(CH_TRACE_EVENT_UNLOCK, mp, tp);
         mp->owner = tp;
         mp->next = tp->mtxlist;
         tp->mtxlist = mp;
@@ -543,6 +555,7 @@ void chMtxUnlockAll(void) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
         mp->cnt = (cnt_t)0;
 #endif
+        _trace_mtx(CH_TRACE_EVENT_UNLOCK, mp, NULL);
         mp->owner = NULL;
       }
     } while (ctp->mtxlist != NULL);
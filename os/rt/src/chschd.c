@@ -53,6 +53,185 @@ ch_system_t ch;
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_RLIST_BITMAP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Counts the leading zeros of a non-zero bitmap word.
+ * @note    Ports can provide an optimized @p port_clz() macro, the compiler
+ *          builtin or a constant time software fallback is used otherwise.
+ *
+ * @param[in] w         the word to be scanned, must not be zero
+ * @return              The number of leading zero bits.
+ *
+ * @notapi
+ */
+static inline unsigned rlist_clz(uint32_t w) {
+#if defined(port_clz)
+  return (unsigned)port_clz(w);
+#elif defined(__GNUC__)
+  return (unsigned)__builtin_clz(w);
+#else
+  unsigned n = 0U;
+
+  if ((w & 0xFFFF0000U) == 0U) {n += 16U; w <<= 16;}
+  if ((w & 0xFF000000U) == 0U) {n +=  8U; w <<=  8;}
+  if ((w & 0xF0000000U) == 0U) {n +=  4U; w <<=  4;}
+  if ((w & 0xC0000000U) == 0U) {n +=  2U; w <<=  2;}
+  if ((w & 0x80000000U) == 0U) {n +=  1U;}
+
+  return n;
+#endif
+}
+
+/**
+ * @brief   Marks a priority level as non-empty.
+ *
+ * @param[in] prio      the priority level
+ *
+ * @notapi
+ */
+static inline void rlist_map_set(tprio_t prio) {
+  unsigned i = (unsigned)HIGHPRIO - (unsigned)prio;
+
+  ch.rlist.map[i >> 5] |= (uint32_t)1U << (i & 31U);
+  ch.rlist.summary     |= (uint32_t)1U << (i >> 5);
+}
+
+/**
+ * @brief   Marks a priority level as empty.
+ *
+ * @param[in] prio      the priority level
+ *
+ * @notapi
+ */
+static inline void rlist_map_clear(tprio_t prio) {
+  unsigned i = (unsigned)HIGHPRIO - (unsigned)prio;
+
+  ch.rlist.map[i >> 5] &= ~((uint32_t)1U << (i & 31U));
+  if (ch.rlist.map[i >> 5] == 0U) {
+    ch.rlist.summary &= ~((uint32_t)1U << (i >> 5));
+  }
+}
+
+/**
+ * @brief   Returns the lowest non-empty priority level above @p prio.
+ *
+ * @param[in] prio      the priority level
+ * @return              The priority level.
+ * @retval NOPRIO       if there are no non-empty levels above @p prio.
+ *
+ * @notapi
+ */
+static inline tprio_t rlist_map_above(tprio_t prio) {
+  unsigned i = (unsigned)HIGHPRIO - (unsigned)prio;
+  uint32_t w;
+
+  /* Higher levels in the same word, they are in the less significant
+     bits because the map is reversed.*/
+  w = ch.rlist.map[i >> 5] & (((uint32_t)1U << (i & 31U)) - 1U);
+  if (w == 0U) {
+    /* Searching the nearest non-empty word among the previous ones.*/
+    w = ch.rlist.summary & (((uint32_t)1U << (i >> 5)) - 1U);
+    if (w == 0U) {
+      return NOPRIO;
+    }
+    i = (31U - rlist_clz(w)) << 5;
+    w = ch.rlist.map[i >> 5];
+  }
+  else {
+    i &= ~31U;
+  }
+
+  return (tprio_t)((unsigned)HIGHPRIO - (i + (31U - rlist_clz(w))));
+}
+
+/**
+ * @brief   Returns the ready list element after which a thread with the
+ *          specified priority must be inserted ahead of its peers.
+ *
+ * @param[in] prio      the priority level
+ * @return              The last thread of the nearest non-empty higher
+ *                      priority level or the ready list header.
+ *
+ * @notapi
+ */
+static inline thread_t *rlist_insertion_point(tprio_t prio) {
+  tprio_t hp = rlist_map_above(prio);
+
+  if (hp == NOPRIO) {
+    return (thread_t *)&ch.rlist.queue;
+  }
+
+  return ch.rlist.tails[hp];
+}
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Inserts a thread in the EDF priority level.
+ * @details The level is scanned from its first thread, the thread is
+ *          positioned in deadline order behind or ahead of the threads with
+ *          the same deadline. Boosted fixed priority threads are positioned
+ *          before the EDF threads.
+ *
+ * @param[in] tp        the thread to be inserted
+ * @param[in] ahead     the thread goes ahead of its peers if @p true
+ * @return              The thread pointer.
+ *
+ * @notapi
+ */
+static thread_t *rlist_edf_insert(thread_t *tp, bool ahead) {
+  thread_t *cp = rlist_insertion_point(tp->prio)->queue.next;
+
+  while ((cp->prio == tp->prio) &&
+         (ahead ? sch_precedes(cp, tp) : sch_reaches(cp, tp))) {
+    cp = cp->queue.next;
+  }
+
+  /* Insertion on prev.*/
+  tp->queue.next             = cp;
+  tp->queue.prev             = cp->queue.prev;
+  tp->queue.prev->queue.next = tp;
+  cp->queue.prev             = tp;
+
+  /* The thread becomes the last of its level if the level was empty or if
+     it has been inserted after the previous last thread.*/
+  if (ch.rlist.tails[tp->prio] == NULL) {
+    rlist_map_set(tp->prio);
+    ch.rlist.tails[tp->prio] = tp;
+  }
+  else if (ch.rlist.tails[tp->prio] == tp->queue.prev) {
+    ch.rlist.tails[tp->prio] = tp;
+  }
+  else {
+    /* Nothing to do.*/
+  }
+
+  return tp;
+}
+#endif /* CH_CFG_USE_EDF == TRUE */
+#endif /* CH_CFG_RLIST_BITMAP == TRUE */
+
+/**
+ * @brief   Removes the first thread from the ready list and returns it.
+ *
+ * @return              The removed thread pointer.
+ *
+ * @notapi
+ */
+static inline thread_t *rlist_remove_first(void) {
+  thread_t *tp = queue_fifo_remove(&ch.rlist.queue);
+
+#if CH_CFG_RLIST_BITMAP == TRUE
+  /* The level becomes empty if the removed thread was also the last one
+     of its priority level.*/
+  if (ch.rlist.tails[tp->prio] == tp) {
+    ch.rlist.tails[tp->prio] = NULL;
+    rlist_map_clear(tp->prio);
+  }
+#endif
+
+  return tp;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -66,6 +245,19 @@ void _scheduler_init(void) {
 
   queue_init(&ch.rlist.queue);
   ch.rlist.prio = NOPRIO;
+#if CH_CFG_RLIST_BITMAP == TRUE
+  {
+    unsigned i;
+
+    ch.rlist.summary = 0U;
+    for (i = 0U; i < CH_RLIST_MAP_WORDS; i++) {
+      ch.rlist.map[i] = 0U;
+    }
+    for (i = 0U; i < CH_RLIST_PRIO_LEVELS; i++) {
+      ch.rlist.tails[i] = NULL;
+    }
+  }
+#endif
 #if CH_CFG_USE_REGISTRY == TRUE
   ch.rlist.newer = (thread_t *)&ch.rlist;
   ch.rlist.older = (thread_t *)&ch.rlist;
@@ -225,15 +417,38 @@ thread_t *chSchReadyI(thread_t *tp) {
               "invalid state");
 
   tp->state = CH_STATE_READY;
+#if CH_CFG_RLIST_BITMAP == TRUE
+#if CH_CFG_USE_EDF == TRUE
+  /* EDF threads are ordered by deadline within their level.*/
+  if (tp->prio == CH_CFG_EDF_PRIO) {
+    return rlist_edf_insert(tp, false);
+  }
+#endif
+  /* The thread goes after the last thread of its own priority level or,
+     if the level is empty, after the last one of the nearest higher
+     level.*/
+  cp = ch.rlist.tails[tp->prio];
+  if (cp == NULL) {
+    cp = rlist_insertion_point(tp->prio);
+    rlist_map_set(tp->prio);
+  }
+  ch.rlist.tails[tp->prio] = tp;
+  /* Insertion on next.*/
+  tp->queue.prev             = cp;
+  tp->queue.next             = cp->queue.next;
+  tp->queue.next->queue.prev = tp;
+  cp->queue.next             = tp;
+#else
   cp = (thread_t *)&ch.rlist.queue;
   do {
     cp = cp->queue.next;
-  } while (cp->prio >= tp->prio);
+  } while (sch_reaches(cp, tp));
   /* Insertion on prev.*/
   tp->queue.next             = cp;
   tp->queue.prev             = cp->queue.prev;
   tp->queue.prev->queue.next = tp;
   cp->queue.prev             = tp;
+#endif
 
   return tp;
 }
@@ -264,19 +479,84 @@ thread_t *chSchReadyAheadI(thread_t *tp) {
               "invalid state");
 
   tp->state = CH_STATE_READY;
+#if CH_CFG_RLIST_BITMAP == TRUE
+#if CH_CFG_USE_EDF == TRUE
+  /* EDF threads are ordered by deadline within their level.*/
+  if (tp->prio == CH_CFG_EDF_PRIO) {
+    return rlist_edf_insert(tp, true);
+  }
+#endif
+  /* The thread goes after the last thread of the nearest higher priority
+     level, it becomes the last of its level only if the level was empty.*/
+  cp = rlist_insertion_point(tp->prio);
+  if (ch.rlist.tails[tp->prio] == NULL) {
+    ch.rlist.tails[tp->prio] = tp;
+    rlist_map_set(tp->prio);
+  }
+  /* Insertion on next.*/
+  tp->queue.prev             = cp;
+  tp->queue.next             = cp->queue.next;
+  tp->queue.next->queue.prev = tp;
+  cp->queue.next             = tp;
+#else
   cp = (thread_t *)&ch.rlist.queue;
   do {
     cp = cp->queue.next;
-  } while (cp->prio > tp->prio);
+  } while (sch_precedes(cp, tp));
   /* Insertion on prev.*/
   tp->queue.next             = cp;
   tp->queue.prev             = cp->queue.prev;
   tp->queue.prev->queue.next = tp;
   cp->queue.prev             = tp;
+#endif
 
   return tp;
 }
 
+/**
+ * @brief   Removes a thread from the Ready List.
+ * @details The thread is removed from the ready list regardless of its
+ *          relative position, this function must be used in place of
+ *          @p queue_dequeue() for threads in @p CH_STATE_READY state.
+ * @note    The function does not rely on the thread priority so it can
+ *          be used on threads whose priority has been changed while in
+ *          the ready list.
+ * @post    The thread state is not changed, the caller is responsible for
+ *          re-inserting the thread in the ready list or in another list.
+ *
+ * @param[in] tp        the thread to be removed from the ready list
+ * @return              The thread pointer.
+ *
+ * @iclass
+ */
+thread_t *chSchDequeueReadyI(thread_t *tp) {
+#if CH_CFG_RLIST_BITMAP == TRUE
+  tprio_t prio;
+
+  chDbgCheckClassI();
+  chDbgCheck(tp != NULL);
+
+  /* Levels are contiguous in the list so, if the thread was the last
+     of its level, then its level is the lowest non-empty one above the
+     priority of the next element. The header has NOPRIO priority.*/
+  prio = rlist_map_above(tp->queue.next->prio);
+  if ((prio != NOPRIO) && (ch.rlist.tails[prio] == tp)) {
+    if (tp->queue.prev->prio == prio) {
+      ch.rlist.tails[prio] = tp->queue.prev;
+    }
+    else {
+      ch.rlist.tails[prio] = NULL;
+      rlist_map_clear(prio);
+    }
+  }
+#else
+  chDbgCheckClassI();
+  chDbgCheck(tp != NULL);
+#endif
+
+  return queue_dequeue(tp);
+}
+
 /**
  * @brief   Puts the current thread to sleep into the specified state.
  * @details The thread goes into a sleeping state. The possible
@@ -301,7 +581,7 @@ void chSchGoSleepS(tstate_t newstate) {
 #endif
 
   /* Next thread in ready list becomes current.*/
-  currp = queue_fifo_remove(&ch.rlist.queue);
+  currp = rlist_remove_first();
   currp->state = CH_STATE_CURRENT;
 
   /* Handling idle-enter hook.*/
@@ -426,7 +706,7 @@ void chSchWakeupS(thread_t *ntp, msg_t msg) {
      one then it is just inserted in the ready list else it made
      running immediately and the invoking thread goes in the ready
      list instead.*/
-  if (ntp->prio <= otp->prio) {
+  if (!sch_precedes(ntp, otp)) {
     (void) chSchReadyI(ntp);
   }
   else {
@@ -477,19 +757,19 @@ void chSchRescheduleS(void) {
  * @special
  */
 bool chSchIsPreemptionRequired(void) {
-  tprio_t p1 = firstprio(&ch.rlist.queue);
-  tprio_t p2 = currp->prio;
+  thread_t *ntp = ch.rlist.queue.next;
 
 #if CH_CFG_TIME_QUANTUM > 0
   /* If the running thread has not reached its time quantum, reschedule only
      if the first thread on the ready queue has a higher priority.
      Otherwise, if the running thread has used up its time quantum, reschedule
      if the first thread on the ready queue has equal or higher priority.*/
-  return (currp->ticks > (tslices_t)0) ? (p1 > p2) : (p1 >= p2);
+  return (currp->ticks > (tslices_t)0) ? sch_precedes(ntp, currp) :
+                                         sch_reaches(ntp, currp);
 #else
   /* If the round robin preemption feature is not enabled then performs a
      simpler comparison.*/
-  return p1 > p2;
+  return sch_precedes(ntp, currp);
 #endif
 }
 #endif /* !defined(CH_SCH_IS_PREEMPTION_REQUIRED_HOOKED) */
@@ -508,7 +788,7 @@ void chSchDoRescheduleBehind(void) {
   thread_t *otp = currp;
 
   /* Picks the first thread from the ready queue and makes it current.*/
-  currp = queue_fifo_remove(&ch.rlist.queue);
+  currp = rlist_remove_first();
   currp->state = CH_STATE_CURRENT;
 
   /* Handling idle-leave hook.*/
@@ -541,7 +821,7 @@ void chSchDoRescheduleAhead(void) {
   thread_t *otp = currp;
 
   /* Picks the first thread from the ready queue and makes it current.*/
-  currp = queue_fifo_remove(&ch.rlist.queue);
+  currp = rlist_remove_first();
   currp->state = CH_STATE_CURRENT;
 
   /* Handling idle-leave hook.*/
@@ -571,7 +851,7 @@ void chSchDoReschedule(void) {
   thread_t *otp = currp;
 
   /* Picks the first thread from the ready queue and makes it current.*/
-  currp = queue_fifo_remove(&ch.rlist.queue);
+  currp = rlist_remove_first();
   currp->state = CH_STATE_CURRENT;
 
   /* Handling idle-leave hook.*/
@@ -153,6 +153,8 @@ void chSemResetI(semaphore_t *sp, cnt_t n) {
               ((sp->cnt < (cnt_t)0) && queue_notempty(&sp->queue)),
               "inconsistent semaphore");
 
+  _trace_sem(CH_TRACE_EVENT_RESET, sp, NULL);
+
   cnt = sp->cnt;
   sp->cnt = n;
   while (++cnt <= (cnt_t)0) {
@@ -202,6 +204,8 @@ msg_t chSemWaitS(semaphore_t *sp) {
               ((sp->cnt < (cnt_t)0) && queue_notempty(&sp->queue)),
               "inconsistent semaphore");
 
+  _trace_sem(CH_TRACE_EVENT_WAIT, sp, currp);
+
   if (--sp->cnt < (cnt_t)0) {
     currp->u.wtsemp = sp;
     sem_insert(currp, &sp->queue);
@@ -269,6 +273,8 @@ msg_t chSemWaitTimeoutS(semaphore_t *sp, sysinterval_t timeout) {
               ((sp->cnt < (cnt_t)0) && queue_notempty(&sp->queue)),
               "inconsistent semaphore");
 
+  _trace_sem(CH_TRACE_EVENT_WAIT, sp, currp);
+
   if (--sp->cnt < (cnt_t)0) {
     if (TIME_IMMEDIATE == timeout) {
       sp->cnt++;
@@ -300,7 +306,13 @@ void chSemSignal(semaphore_t *sp) {
               ((sp->cnt < (cnt_t)0) && queue_notempty(&sp->queue)),
               "inconsistent semaphore");
   if (++sp->cnt <= (cnt_t)0) {
-    chSchWakeupS(queue_fifo_remove(&sp->queue), MSG_OK);
+    thread_t *tp = queue_fifo_remove(&sp->queue);
+
+    _trace_sem(CH_TRACE_EVENT_SIGNAL, sp, tp);
+    chSchWakeupS(tp, MSG_OK);
+  }
+  else {
+    _trace_sem(CH_TRACE_EVENT_SIGNAL, sp, NULL);
   }
   chSysUnlock();
 }
@@ -328,9 +340,13 @@ void chSemSignalI(semaphore_t *sp) {
     /* Note, it is done this way in order to allow a tail call on
              chSchReadyI().*/
     thread_t *tp = queue_fifo_remove(&sp->queue);
+    _trace_sem(CH_TRACE_EVENT_SIGNAL, sp, tp);
     tp->u.rdymsg = MSG_OK;
     (void) chSchReadyI(tp);
   }
+  else {
+    _trace_sem(CH_TRACE_EVENT_SIGNAL, sp, NULL);
+  }
 }
 
 /**
@@ -356,7 +372,13 @@ void chSemAddCounterI(semaphore_t *sp, cnt_t n) {
 
   while (n > (cnt_t)0) {
     if (++sp->cnt <= (cnt_t)0) {
-      chSchReadyI(queue_fifo_remove(&sp->queue))->u.rdymsg = MSG_OK;
+      thread_t *tp = queue_fifo_remove(&sp->queue);
+
+      _trace_sem(CH_TRACE_EVENT_SIGNAL, sp, tp);
+      chSchReadyI(tp)->u.rdymsg = MSG_OK;
+    }
+    else {
+      _trace_sem(CH_TRACE_EVENT_SIGNAL, sp, NULL);
     }
     n--;
   }
@@ -388,8 +410,15 @@ msg_t chSemSignalWait(semaphore_t *sps, semaphore_t *spw) {
               ((spw->cnt < (cnt_t)0) && queue_notempty(&spw->queue)),
               "inconsistent semaphore");
   if (++sps->cnt <= (cnt_t)0) {
-    chSchReadyI(queue_fifo_remove(&sps->queue))->u.rdymsg = MSG_OK;
+    thread_t *tp = queue_fifo_remove(&sps->queue);
+
+    _trace_sem(CH_TRACE_EVENT_SIGNAL, sps, tp);
+    chSchReadyI(tp)->u.rdymsg = MSG_OK;
+  }
+  else {
+    _trace_sem(CH_TRACE_EVENT_SIGNAL, sps, NULL);
   }
+  _trace_sem(CH_TRACE_EVENT_WAIT, spw, currp);
   if (--spw->cnt < (cnt_t)0) {
     thread_t *ctp = currp;
     sem_insert(ctp, &spw->queue);
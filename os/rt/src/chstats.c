@@ -50,6 +50,102 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns the cumulative ISRs cycles including the ISR in progress.
+ *
+ * @param[in] now       current realtime counter value
+ * @return              The ISRs cycles.
+ */
+static rttime_t stats_isr_cycles(rtcnt_t now) {
+  rttime_t c = ch.kernel_stats.isr_cycles;
+
+  if (ch.kernel_stats.isr_nest > (cnt_t)0) {
+    c += (rttime_t)(now - ch.kernel_stats.isr_start);
+  }
+
+  return c;
+}
+
+/**
+ * @brief   Returns the net cycles of a thread, ISRs time excluded.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] now       current realtime counter value
+ * @return              The thread net cycles.
+ */
+static rttime_t stats_thread_cycles(thread_t *tp, rtcnt_t now) {
+  rttime_t c = tp->stats.cumulative;
+  rttime_t isr = tp->isrcycles;
+
+  if (tp == currp) {
+    /* Adding the time spent since the thread was switched in.*/
+    c += (rttime_t)(now - tp->stats.last);
+    if (ch.kernel_stats.isr_nest > (cnt_t)0) {
+      isr += (rttime_t)(now - ch.kernel_stats.isr_start);
+    }
+  }
+
+  return c > isr ? c - isr : (rttime_t)0;
+}
+
+/**
+ * @brief   Returns a window cycles count as permille of the window.
+ *
+ * @param[in] c         cycles spent in the window
+ * @param[in] w         window length in cycles
+ * @return              The load in permille.
+ */
+static uint32_t stats_permille(rtcnt_t c, rtcnt_t w) {
+
+  if (w == (rtcnt_t)0) {
+    return (uint32_t)0;
+  }
+  return (uint32_t)(((rttime_t)c * (rttime_t)1000) / (rttime_t)w);
+}
+
+/**
+ * @brief   Window timer callback.
+ * @details Closes the current window and samples the cycles spent by ISRs
+ *          and by each registered thread.
+ *
+ * @param[in] p         not used
+ */
+static void stats_window(void *p) {
+  rtcnt_t now;
+  rttime_t c;
+  rtcnt_t busy;
+
+  (void)p;
+
+  chSysLockFromISR();
+  now = chSysGetRealtimeCounterX();
+  ch.kernel_stats.wcycles = now - ch.kernel_stats.wstart;
+  ch.kernel_stats.wstart = now;
+
+  c = stats_isr_cycles(now);
+  ch.kernel_stats.isr_wcycles = (rtcnt_t)(c - ch.kernel_stats.isr_wsnap);
+  ch.kernel_stats.isr_wsnap = c;
+  busy = ch.kernel_stats.isr_wcycles;
+
+#if CH_CFG_USE_REGISTRY == TRUE
+  {
+    thread_t *tp = ch.rlist.newer;
+
+    while (tp != (thread_t *)&ch.rlist) {
+      c = stats_thread_cycles(tp, now);
+      tp->wcycles = (rtcnt_t)(c - tp->wsnap);
+      tp->wsnap = c;
+      if (tp->prio != IDLEPRIO) {
+        busy += tp->wcycles;
+      }
+      tp = tp->newer;
+    }
+  }
+#endif
+  ch.kernel_stats.busy_wcycles = busy;
+  chSysUnlockFromISR();
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -63,17 +159,74 @@ void _stats_init(void) {
 
   ch.kernel_stats.n_irq = (ucnt_t)0;
   ch.kernel_stats.n_ctxswc = (ucnt_t)0;
+  ch.kernel_stats.n_vt_alarms = (ucnt_t)0;
+  ch.kernel_stats.n_vt_merged = (ucnt_t)0;
   chTMObjectInit(&ch.kernel_stats.m_crit_thd);
   chTMObjectInit(&ch.kernel_stats.m_crit_isr);
+#if CH_CFG_USE_TM_HISTOGRAMS == TRUE
+  chTMHistogramObjectInit(&ch.kernel_stats.h_crit_thd);
+  chTMHistogramObjectInit(&ch.kernel_stats.h_crit_isr);
+  chTMSetHistogramX(&ch.kernel_stats.m_crit_thd, &ch.kernel_stats.h_crit_thd);
+  chTMSetHistogramX(&ch.kernel_stats.m_crit_isr, &ch.kernel_stats.h_crit_isr);
+#endif
+  ch.kernel_stats.isr_nest = (cnt_t)0;
+  ch.kernel_stats.isr_start = (rtcnt_t)0;
+  ch.kernel_stats.isr_cycles = (rttime_t)0;
+  ch.kernel_stats.isr_wsnap = (rttime_t)0;
+  ch.kernel_stats.isr_wcycles = (rtcnt_t)0;
+  ch.kernel_stats.wstart = (rtcnt_t)0;
+  ch.kernel_stats.wcycles = (rtcnt_t)0;
+  ch.kernel_stats.busy_wcycles = (rtcnt_t)0;
+  chVTObjectInit(&ch.stats_vt);
+}
+
+/**
+ * @brief   Starts the CPU load sampling windows.
+ * @note    It is invoked after the system has been enabled.
+ *
+ * @special
+ */
+void _stats_start_window(void) {
+
+  chSysLock();
+  ch.kernel_stats.wstart = chSysGetRealtimeCounterX();
+  chVTDoSetPeriodicI(&ch.stats_vt,
+                     TIME_MS2I(CH_DBG_STATISTICS_WINDOW),
+                     TIME_MS2I(CH_DBG_STATISTICS_WINDOW),
+                     stats_window, NULL);
+  chSysUnlock();
 }
 
 /**
  * @brief   Increases the IRQ counter.
+ * @details The measurement of the ISRs time is started when entering the
+ *          outermost ISR.
  */
 void _stats_increase_irq(void) {
 
   port_lock_from_isr();
   ch.kernel_stats.n_irq++;
+  if (ch.kernel_stats.isr_nest++ == (cnt_t)0) {
+    ch.kernel_stats.isr_start = chSysGetRealtimeCounterX();
+  }
+  port_unlock_from_isr();
+}
+
+/**
+ * @brief   Accounts the ISR time.
+ * @details When leaving the outermost ISR its duration is added to the
+ *          global ISRs cycles and to the ISRs cycles of the current thread.
+ */
+void _stats_leave_irq(void) {
+
+  port_lock_from_isr();
+  if (--ch.kernel_stats.isr_nest == (cnt_t)0) {
+    rttime_t c = (rttime_t)(chSysGetRealtimeCounterX() -
+                            ch.kernel_stats.isr_start);
+
+    ch.kernel_stats.isr_cycles += c;
+    currp->isrcycles += c;
+  }
   port_unlock_from_isr();
 }
 
@@ -89,6 +242,24 @@ void _stats_ctxswc(thread_t *ntp, thread_t *otp) {
   chTMChainMeasurementToX(&otp->stats, &ntp->stats);
 }
 
+/**
+ * @brief   Increases the virtual timers alarm events counter.
+ * @note    It is invoked from within the kernel critical zone.
+ */
+void _stats_increase_vt_alarm(void) {
+
+  ch.kernel_stats.n_vt_alarms++;
+}
+
+/**
+ * @brief   Increases the merged virtual timers counter.
+ * @note    It is invoked from within the kernel critical zone.
+ */
+void _stats_increase_vt_merged(void) {
+
+  ch.kernel_stats.n_vt_merged++;
+}
+
 /**
  * @brief   Starts the measurement of a thread critical zone.
  */
@@ -121,6 +292,120 @@ void _stats_stop_measure_crit_isr(void) {
   chTMStopMeasurementX(&ch.kernel_stats.m_crit_isr);
 }
 
+/**
+ * @brief   Returns the net run time of a thread.
+ * @details The returned value is the number of realtime counter cycles
+ *          spent by the thread since its creation, ISRs time excluded.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The thread net cycles.
+ *
+ * @iclass
+ */
+rttime_t chStatsGetThreadCyclesI(thread_t *tp) {
+
+  chDbgCheckClassI();
+
+  return stats_thread_cycles(tp, chSysGetRealtimeCounterX());
+}
+
+/**
+ * @brief   Returns the CPU load of a thread.
+ * @details The load is computed over the last completed statistics window,
+ *          ISRs time is not accounted to the thread.
+ * @pre     The registry must be enabled, threads not in the registry
+ *          are not sampled.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The thread load in permille.
+ *
+ * @xclass
+ */
+uint32_t chStatsGetThreadLoadX(thread_t *tp) {
+  syssts_t sts;
+  rtcnt_t c, w;
+
+  /* The window fields are updated by the window timer, a consistent
+     snapshot is taken from any context.*/
+  sts = chSysGetStatusAndLockX();
+  c = tp->wcycles;
+  w = ch.kernel_stats.wcycles;
+  chSysRestoreStatusX(sts);
+
+  return stats_permille(c, w);
+}
+
+/**
+ * @brief   Returns the CPU load caused by ISRs.
+ * @details The load is computed over the last completed statistics window.
+ *
+ * @return              The ISRs load in permille.
+ *
+ * @xclass
+ */
+uint32_t chStatsGetISRLoadX(void) {
+  syssts_t sts;
+  rtcnt_t c, w;
+
+  sts = chSysGetStatusAndLockX();
+  c = ch.kernel_stats.isr_wcycles;
+  w = ch.kernel_stats.wcycles;
+  chSysRestoreStatusX(sts);
+
+  return stats_permille(c, w);
+}
+
+/**
+ * @brief   Returns the total CPU load.
+ * @details The load is computed over the last completed statistics window
+ *          and includes all threads except the idle thread plus ISRs.
+ * @note    If the registry is disabled then only the ISRs load is
+ *          accounted.
+ *
+ * @return              The CPU load in permille.
+ *
+ * @xclass
+ */
+uint32_t chStatsGetCPULoadX(void) {
+  syssts_t sts;
+  rtcnt_t c, w;
+  uint32_t load;
+
+  sts = chSysGetStatusAndLockX();
+  c = ch.kernel_stats.busy_wcycles;
+  w = ch.kernel_stats.wcycles;
+  chSysRestoreStatusX(sts);
+
+  load = stats_permille(c, w);
+  return load > (uint32_t)1000 ? (uint32_t)1000 : load;
+}
+
+#if (CH_CFG_USE_TM_HISTOGRAMS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the critical zones histograms.
+ * @details Both histograms are copied, and optionally reset, atomically
+ *          so the two snapshots refer to the same time interval.
+ * @note    The critical zone used by this function is recorded after the
+ *          snapshot.
+ *
+ * @param[out] thdp     pointer to the @p tm_histogram_t structure receiving
+ *                      the threads critical zones histogram or @p NULL
+ * @param[out] isrp     pointer to the @p tm_histogram_t structure receiving
+ *                      the ISRs critical zones histogram or @p NULL
+ * @param[in] reset     if @p true the histograms are reset after the copy
+ *
+ * @api
+ */
+void chStatsSnapshotHistograms(tm_histogram_t *thdp, tm_histogram_t *isrp,
+                               bool reset) {
+
+  chSysLock();
+  chTMHistogramSnapshotX(&ch.kernel_stats.h_crit_thd, thdp, reset);
+  chTMHistogramSnapshotX(&ch.kernel_stats.h_crit_isr, isrp, reset);
+  chSysUnlock();
+}
+#endif /* CH_CFG_USE_TM_HISTOGRAMS == TRUE */
+
 #endif /* CH_DBG_STATISTICS == TRUE */
 
 /** @} */
@@ -46,6 +46,13 @@
 THD_WORKING_AREA(ch_idle_thread_wa, PORT_IDLE_THREAD_STACK_SIZE);
 #endif
 
+#if (CH_CFG_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Virtual timers thread working area.
+ */
+THD_WORKING_AREA(ch_vt_thread_wa, CH_CFG_VT_DEFERRED_STACK_SIZE);
+#endif
+
 /*===========================================================================*/
 /* Module local types.                                                       */
 /*===========================================================================*/
@@ -116,12 +123,18 @@ void chSysInit(void) {
 #if CH_CFG_USE_HEAP == TRUE
   _heap_init();
 #endif
+#if CH_CFG_USE_SLAB == TRUE
+  _slab_init();
+#endif
 #if CH_CFG_USE_FACTORY == TRUE
   _factory_init();
 #endif
 #if CH_DBG_STATISTICS == TRUE
   _stats_init();
 #endif
+#if CH_CFG_USE_BUDGETS == TRUE
+  _budget_init();
+#endif
 
 #if CH_CFG_NO_IDLE_THREAD == FALSE
   /* Now this instructions flow becomes the main thread.*/
@@ -164,6 +177,11 @@ void chSysInit(void) {
   /* It is alive now.*/
   chSysEnable();
 
+#if CH_DBG_STATISTICS == TRUE
+  /* CPU load sampling requires the virtual timers to be usable.*/
+  _stats_start_window();
+#endif
+
 #if CH_CFG_NO_IDLE_THREAD == FALSE
   {
     static const thread_descriptor_t idle_descriptor = {
@@ -172,7 +190,11 @@ void chSysInit(void) {
       THD_WORKING_AREA_END(ch_idle_thread_wa),
       IDLEPRIO,
       _idle_thread,
-      NULL
+      NULL,
+#if CH_CFG_USE_EDF == TRUE
+      (sysinterval_t)0,
+      (sysinterval_t)0
+#endif
     };
 
     /* This thread has the lowest priority in the system, its role is just to
@@ -181,6 +203,25 @@ void chSysInit(void) {
     (void) chThdCreate(&idle_descriptor);
   }
 #endif
+#if CH_CFG_VT_DEFERRED == TRUE
+  {
+    static const thread_descriptor_t vt_descriptor = {
+      "timers",
+      THD_WORKING_AREA_BASE(ch_vt_thread_wa),
+      THD_WORKING_AREA_END(ch_vt_thread_wa),
+      CH_CFG_VT_DEFERRED_PRIO,
+      _vt_thread,
+      NULL,
+#if CH_CFG_USE_EDF == TRUE
+      (sysinterval_t)0,
+      (sysinterval_t)0
+#endif
+    };
+
+    /* This thread executes the deferred virtual timers callbacks.*/
+    (void) chThdCreate(&vt_descriptor);
+  }
+#endif
 }
 
 /**
@@ -250,6 +291,14 @@ bool chSysIntegrityCheckI(unsigned testmask) {
     n = (cnt_t)0;
     tp = ch.rlist.queue.next;
     while (tp != (thread_t *)&ch.rlist.queue) {
+#if CH_CFG_RLIST_BITMAP == TRUE
+      /* The last thread of each priority level must be referenced by the
+         tails array.*/
+      if ((tp->queue.next->prio != tp->prio) &&
+          (ch.rlist.tails[tp->prio] != tp)) {
+        return true;
+      }
+#endif
       n++;
       tp = tp->queue.next;
     }
@@ -270,15 +319,59 @@ bool chSysIntegrityCheckI(unsigned testmask) {
   /* Timers list integrity check.*/
   if ((testmask & CH_INTEGRITY_VTLIST) != 0U) {
     virtual_timer_t * vtp;
+#if CH_CFG_VT_WHEEL == TRUE
+    unsigned level, slot;
+
+    for (level = 0U; level < (unsigned)CH_CFG_VT_WHEEL_LEVELS; level++) {
+      for (slot = 0U; slot < CH_VT_WHEEL_SLOTS; slot++) {
+        virtual_timer_t *sp = (virtual_timer_t *)&ch.vtlist.slots[level][slot];
+        bool empty = (bool)(sp->next == sp);
+
+        /* Scanning the slot list forward.*/
+        n = (cnt_t)0;
+        vtp = sp->next;
+        while (vtp != sp) {
+          n++;
+          vtp = vtp->next;
+        }
+
+        /* Scanning the slot list backward.*/
+        vtp = sp->prev;
+        while (vtp != sp) {
+          n--;
+          vtp = vtp->prev;
+        }
+
+        /* The number of elements must match.*/
+        if (n != (cnt_t)0) {
+          return true;
+        }
+
+        /* The slot bitmap must reflect the slot state.*/
+        if (((ch.vtlist.map[level] & ((uint32_t)1U << slot)) == 0U) != empty) {
+          return true;
+        }
+      }
+    }
+#else /* CH_CFG_VT_WHEEL == FALSE */
+
+    sysinterval_t taildelta = (sysinterval_t)0;
 
     /* Scanning the timers list forward.*/
     n = (cnt_t)0;
     vtp = ch.vtlist.next;
     while (vtp != (virtual_timer_t *)&ch.vtlist) {
       n++;
+      taildelta += vtp->delta;
       vtp = vtp->next;
     }
 
+    /* The deltas must add up to the distance of the last timer.*/
+    if ((ch.vtlist.taildelta != CH_VT_TAILDELTA_UNKNOWN) &&
+        (ch.vtlist.taildelta != taildelta)) {
+      return true;
+    }
+
     /* Scanning the timers list backward.*/
     vtp = ch.vtlist.prev;
     while (vtp != (virtual_timer_t *)&ch.vtlist) {
@@ -290,6 +383,7 @@ bool chSysIntegrityCheckI(unsigned testmask) {
     if (n != (cnt_t)0) {
       return true;
     }
+#endif /* CH_CFG_VT_WHEEL == FALSE */
   }
 
 #if CH_CFG_USE_REGISTRY == TRUE
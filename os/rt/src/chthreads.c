@@ -100,6 +100,16 @@ thread_t *_thread_init(thread_t *tp, const char *name, tprio_t prio) {
 #if CH_CFG_USE_EVENTS == TRUE
   tp->epending  = (eventmask_t)0;
 #endif
+#if CH_CFG_USE_EDF == TRUE
+  tp->period    = (sysinterval_t)0;
+  tp->misses    = (ucnt_t)0;
+#endif
+#if CH_CFG_USE_BUDGETS == TRUE
+  tp->budget    = (rtcnt_t)0;
+  tp->bexhausted = (ucnt_t)0;
+  tp->bdemoted  = false;
+  chVTObjectInit(&tp->bvt);
+#endif
 #if CH_DBG_THREADS_PROFILING == TRUE
   tp->time      = (systime_t)0;
 #endif
@@ -118,6 +128,9 @@ thread_t *_thread_init(thread_t *tp, const char *name, tprio_t prio) {
 #endif
 #if CH_DBG_STATISTICS == TRUE
   chTMObjectInit(&tp->stats);
+  tp->isrcycles = (rttime_t)0;
+  tp->wsnap = (rttime_t)0;
+  tp->wcycles = (rtcnt_t)0;
 #endif
   CH_CFG_THREAD_INIT_HOOK(tp);
   return tp;
@@ -174,6 +187,12 @@ thread_t *chThdCreateSuspendedI(const thread_descriptor_t *tdp) {
              (tdp->wend > tdp->wbase) &&
              (((size_t)tdp->wend - (size_t)tdp->wbase) >= THD_WORKING_AREA_SIZE(0)));
   chDbgCheck((tdp->prio <= HIGHPRIO) && (tdp->funcp != NULL));
+#if CH_CFG_USE_EDF == TRUE
+  chDbgCheck((tdp->period == (sysinterval_t)0) ?
+             (tdp->prio != CH_CFG_EDF_PRIO) :
+             ((tdp->prio == CH_CFG_EDF_PRIO) &&
+              (tdp->deadline <= tdp->period)));
+#endif
 
   /* The thread structure is laid out in the upper part of the thread
      workspace. The thread position structure is aligned to the required
@@ -190,7 +209,20 @@ thread_t *chThdCreateSuspendedI(const thread_descriptor_t *tdp) {
   PORT_SETUP_CONTEXT(tp, tdp->wbase, tp, tdp->funcp, tdp->arg);
 
   /* The driver object is initialized but not started.*/
-  return _thread_init(tp, tdp->name, tdp->prio);
+  tp = _thread_init(tp, tdp->name, tdp->prio);
+
+#if CH_CFG_USE_EDF == TRUE
+  /* EDF parameters, the first job is released at creation time.*/
+  if (tdp->period > (sysinterval_t)0) {
+    tp->period      = tdp->period;
+    tp->reldeadline = tdp->deadline > (sysinterval_t)0 ? tdp->deadline :
+                                                         tdp->period;
+    tp->release     = chVTGetSystemTimeX();
+    tp->deadline    = chTimeAddX(tp->release, tp->reldeadline);
+  }
+#endif
+
+  return tp;
 }
 
 /**
@@ -329,6 +361,9 @@ thread_t *chThdCreateStatic(void *wsp, size_t size,
              (size >= THD_WORKING_AREA_SIZE(0)) &&
              MEM_IS_ALIGNED(size, PORT_STACK_ALIGN) &&
              (prio <= HIGHPRIO) && (pf != NULL));
+#if CH_CFG_USE_EDF == TRUE
+  chDbgCheck(prio != CH_CFG_EDF_PRIO);
+#endif
 
 #if (CH_CFG_USE_REGISTRY == TRUE) &&                                        \
     ((CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE))
@@ -507,6 +542,11 @@ void chThdExitS(msg_t msg) {
   /* Exit handler hook.*/
   CH_CFG_THREAD_EXIT_HOOK(tp);
 
+#if CH_CFG_USE_BUDGETS == TRUE
+  /* Stopping the budget replenishment.*/
+  _budget_thread_exit(tp);
+#endif
+
 #if CH_CFG_USE_WAITEXIT == TRUE
   /* Waking up any waiting thread.*/
   while (list_notempty(&tp->waiting)) {
@@ -589,6 +629,11 @@ msg_t chThdWait(thread_t *tp) {
  * @note    The function returns the real thread priority regardless of the
  *          current priority that could be higher than the real priority
  *          because the priority inheritance mechanism.
+ * @note    The @p CH_CFG_EDF_PRIO level is reserved to EDF threads, fixed
+ *          priority threads cannot be moved to it.
+ * @note    If the thread has been demoted because its CPU budget is
+ *          exhausted then the new priority is applied when the budget is
+ *          replenished.
  *
  * @param[in] newprio   the new priority level of the running thread
  * @return              The old priority level.
@@ -599,8 +644,23 @@ tprio_t chThdSetPriority(tprio_t newprio) {
   tprio_t oldprio;
 
   chDbgCheck(newprio <= HIGHPRIO);
+#if CH_CFG_USE_EDF == TRUE
+  chDbgCheck((newprio != CH_CFG_EDF_PRIO) ||
+             (currp->period > (sysinterval_t)0));
+#endif
 
   chSysLock();
+#if CH_CFG_USE_BUDGETS == TRUE
+  if (currp->bdemoted) {
+    /* The thread runs demoted until its budget is replenished, the new
+       priority is applied at that time.*/
+    oldprio = currp->bprio;
+    currp->bprio = newprio;
+    chSysUnlock();
+
+    return oldprio;
+  }
+#endif
 #if CH_CFG_USE_MUTEXES == TRUE
   oldprio = currp->realprio;
   if ((currp->prio == currp->realprio) || (newprio > currp->prio)) {
@@ -720,6 +780,48 @@ void chThdYield(void) {
   chSysUnlock();
 }
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Terminates the current job of an EDF thread.
+ * @details A deadline miss is recorded if the job completed after its
+ *          absolute deadline, then the invoking thread sleeps until the
+ *          release of the next job and its deadline is moved forward by
+ *          one period.
+ * @note    Releases are drift-free, if the next release time is already
+ *          passed then no sleep is performed and the next job starts
+ *          immediately.
+ * @pre     The invoking thread must be an EDF thread.
+ *
+ * @api
+ */
+void chThdWaitNextPeriod(void) {
+  thread_t *tp = currp;
+  systime_t now, prev;
+
+  chDbgCheck(tp->period > (sysinterval_t)0);
+
+  chSysLock();
+  now = chVTGetSystemTimeX();
+  if (chTimeDiffX(tp->release, now) > tp->reldeadline) {
+    tp->misses++;
+  }
+
+  /* Next job.*/
+  prev         = tp->release;
+  tp->release  = chTimeAddX(prev, tp->period);
+  tp->deadline = chTimeAddX(tp->release, tp->reldeadline);
+  if (chTimeIsInRangeX(now, prev, tp->release)) {
+    chThdSleepS(chTimeDiffX(now, tp->release));
+  }
+  else {
+    /* Overrun, the later deadline could make another EDF thread
+       preferable.*/
+    chSchRescheduleS();
+  }
+  chSysUnlock();
+}
+#endif /* CH_CFG_USE_EDF == TRUE */
+
 /**
  * @brief   Sends the current thread sleeping and sets a reference variable.
  * @note    This function must reschedule, it can only be called from thread
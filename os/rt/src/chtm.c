@@ -50,6 +50,39 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_TM_HISTOGRAMS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Records a measurement into a histogram.
+ *
+ * @param[in,out] hp    pointer to a @p tm_histogram_t structure
+ * @param[in] t         the measurement
+ */
+static inline void tm_histogram_record(tm_histogram_t *hp, rtcnt_t t) {
+  uint32_t w = (uint32_t)t;
+  unsigned i;
+
+  /* The bucket index is the position of the most significant bit.*/
+  if (w == 0U) {
+    i = 0U;
+  }
+  else {
+#if defined(__GNUC__)
+    i = 32U - (unsigned)__builtin_clz(w);
+#else
+    i = 1U;
+    while ((w >>= 1) != 0U) {
+      i++;
+    }
+#endif
+    if (i >= (unsigned)CH_CFG_TM_HISTOGRAM_BUCKETS) {
+      i = (unsigned)CH_CFG_TM_HISTOGRAM_BUCKETS - 1U;
+    }
+  }
+  hp->n++;
+  hp->buckets[i]++;
+}
+#endif
+
 static inline void tm_stop(time_measurement_t *tmp,
                            rtcnt_t now,
                            rtcnt_t offset) {
@@ -63,6 +96,11 @@ static inline void tm_stop(time_measurement_t *tmp,
   if (tmp->last < tmp->best) {
     tmp->best = tmp->last;
   }
+#if CH_CFG_USE_TM_HISTOGRAMS == TRUE
+  if (tmp->histogram != NULL) {
+    tm_histogram_record(tmp->histogram, tmp->last);
+  }
+#endif
 }
 
 /*===========================================================================*/
@@ -101,6 +139,9 @@ void chTMObjectInit(time_measurement_t *tmp) {
   tmp->last       = (rtcnt_t)0;
   tmp->n          = (ucnt_t)0;
   tmp->cumulative = (rttime_t)0;
+#if CH_CFG_USE_TM_HISTOGRAMS == TRUE
+  tmp->histogram  = NULL;
+#endif
 }
 
 /**
@@ -151,6 +192,47 @@ NOINLINE void chTMChainMeasurementToX(time_measurement_t *tmp1,
   tm_stop(tmp1, tmp2->last, (rtcnt_t)0);
 }
 
+#if (CH_CFG_USE_TM_HISTOGRAMS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a @p tm_histogram_t object.
+ *
+ * @param[out] hp       pointer to a @p tm_histogram_t structure
+ *
+ * @init
+ */
+void chTMHistogramObjectInit(tm_histogram_t *hp) {
+  unsigned i;
+
+  hp->n = (ucnt_t)0;
+  for (i = 0U; i < (unsigned)CH_CFG_TM_HISTOGRAM_BUCKETS; i++) {
+    hp->buckets[i] = (ucnt_t)0;
+  }
+}
+
+/**
+ * @brief   Copies a histogram and optionally resets it.
+ * @note    The operation is not atomic, the caller must make sure that
+ *          the histogram is not updated concurrently.
+ *
+ * @param[in,out] hp    pointer to the @p tm_histogram_t structure
+ * @param[out] snapp    pointer to the @p tm_histogram_t structure receiving
+ *                      the copy or @p NULL
+ * @param[in] reset     if @p true the histogram is reset after the copy
+ *
+ * @xclass
+ */
+void chTMHistogramSnapshotX(tm_histogram_t *hp, tm_histogram_t *snapp,
+                            bool reset) {
+
+  if (snapp != NULL) {
+    *snapp = *hp;
+  }
+  if (reset) {
+    chTMHistogramObjectInit(hp);
+  }
+}
+#endif /* CH_CFG_USE_TM_HISTOGRAMS == TRUE */
+
 #endif /* CH_CFG_USE_TM == TRUE */
 
 /** @} */
@@ -66,6 +66,7 @@ static NOINLINE void trace_next(void) {
   /* Trace hook, useful in order to interface debug tools.*/
   CH_CFG_TRACE_HOOK(ch.dbg.trace_buffer.ptr);
 
+  ch.dbg.trace_buffer.seq++;
   if (++ch.dbg.trace_buffer.ptr >=
       &ch.dbg.trace_buffer.buffer[CH_DBG_TRACE_BUFFER_SIZE]) {
     ch.dbg.trace_buffer.ptr = &ch.dbg.trace_buffer.buffer[0];
@@ -88,6 +89,7 @@ void _trace_init(void) {
   ch.dbg.trace_buffer.suspended = (uint16_t)~CH_DBG_TRACE_MASK;
   ch.dbg.trace_buffer.size      = CH_DBG_TRACE_BUFFER_SIZE;
   ch.dbg.trace_buffer.ptr       = &ch.dbg.trace_buffer.buffer[0];
+  ch.dbg.trace_buffer.seq       = 0U;
   for (i = 0U; i < (unsigned)CH_DBG_TRACE_BUFFER_SIZE; i++) {
     ch.dbg.trace_buffer.buffer[i].type = CH_TRACE_TYPE_UNUSED;
   }
@@ -169,6 +171,28 @@ void _trace_halt(const char *reason) {
   }
 }
 
+/**
+ * @brief   Inserts in the circular debug trace buffer an object event record.
+ * @note    The trace class suspension is checked by the caller, see the
+ *          @p _trace_sem(), @p _trace_mtx(), @p _trace_mbox(),
+ *          @p _trace_cond() and @p _trace_vt() macros.
+ *
+ * @param[in] type      the record type
+ * @param[in] event     the object event
+ * @param[in] objp      pointer to the object
+ * @param[in] argp      event argument
+ *
+ * @notapi
+ */
+void _trace_object(uint8_t type, uint8_t event, void *objp, void *argp) {
+
+  ch.dbg.trace_buffer.ptr->type       = type;
+  ch.dbg.trace_buffer.ptr->state      = event;
+  ch.dbg.trace_buffer.ptr->u.obj.objp = objp;
+  ch.dbg.trace_buffer.ptr->u.obj.argp = argp;
+  trace_next();
+}
+
 /**
  * @brief   Adds an user trace record to the trace buffer.
  *
@@ -260,6 +284,50 @@ void chDbgResumeTrace(uint16_t mask) {
   chDbgResumeTraceI(mask);
   chSysUnlock();
 }
+
+/**
+ * @brief   Fetches a record from the trace buffer.
+ * @details The record with sequence number @p *seqp is copied and the
+ *          sequence number is advanced, this allows to drain the trace
+ *          buffer while it is being written. If the requested record has
+ *          already been overwritten then the oldest record still in the
+ *          buffer is fetched instead, the difference between the new and
+ *          the old sequence numbers minus one is the number of records
+ *          lost.
+ *
+ * @param[in,out] seqp  pointer to the sequence number of the record to be
+ *                      fetched, zero is the first record ever written
+ * @param[out] tep      pointer to the record receiving the copy
+ * @return              The operation status.
+ * @retval false        if there are no new records.
+ * @retval true         if a record has been fetched.
+ *
+ * @iclass
+ */
+bool chDbgFetchTraceI(uint32_t *seqp, ch_trace_event_t *tep) {
+  uint32_t seq = ch.dbg.trace_buffer.seq;
+  uint32_t back;
+  unsigned i;
+
+  chDbgCheckClassI();
+
+  back = seq - *seqp;
+  if (back == 0U) {
+    return false;
+  }
+  if (back > (uint32_t)CH_DBG_TRACE_BUFFER_SIZE) {
+    back = (uint32_t)CH_DBG_TRACE_BUFFER_SIZE;
+  }
+
+  /* Position of the record relative to the next one to be written.*/
+  i = (unsigned)(ch.dbg.trace_buffer.ptr - &ch.dbg.trace_buffer.buffer[0]);
+  i = (i + (unsigned)CH_DBG_TRACE_BUFFER_SIZE - (unsigned)back) %
+      (unsigned)CH_DBG_TRACE_BUFFER_SIZE;
+  *tep  = ch.dbg.trace_buffer.buffer[i];
+  *seqp = seq - back + 1U;
+
+  return true;
+}
 #endif /* CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED */
 
 /** @} */
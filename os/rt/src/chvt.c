@@ -32,6 +32,20 @@
 /* Module local definitions.                                                 */
 /*===========================================================================*/
 
+#if (CH_CFG_VT_WHEEL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Mask of the slot index within a wheel level.
+ */
+#define VT_WHEEL_SLOT_MASK      (CH_VT_WHEEL_SLOTS - 1U)
+
+/**
+ * @brief   Time range covered by the whole wheel.
+ */
+#define VT_WHEEL_RANGE                                                      \
+  ((sysinterval_t)1 << (CH_VT_WHEEL_SLOT_BITS *                             \
+                        (unsigned)CH_CFG_VT_WHEEL_LEVELS))
+#endif /* CH_CFG_VT_WHEEL == TRUE */
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -48,61 +62,417 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
-/*===========================================================================*/
-/* Module exported functions.                                                */
-/*===========================================================================*/
+#if ((CH_CFG_VT_SLACK == TRUE) && (CH_CFG_ST_TIMEDELTA > 0)) ||               \
+    defined(__DOXYGEN__)
+/**
+ * @brief   Returns the end of a timer expiration window.
+ *
+ * @param[in] delta     the timer expiration time
+ * @param[in] slack     the timer tolerated expiration delay
+ * @return              The window end, saturated to the numeric range.
+ *
+ * @notapi
+ */
+static inline sysinterval_t vt_window_end(sysinterval_t delta,
+                                          sysinterval_t slack) {
+
+  if (delta + slack < delta) {
+    return (sysinterval_t)-1;
+  }
 
+  return delta + slack;
+}
+#endif /* (CH_CFG_VT_SLACK == TRUE) && (CH_CFG_ST_TIMEDELTA > 0) */
+
+#if (CH_CFG_VT_WHEEL == TRUE) || defined(__DOXYGEN__)
 /**
- * @brief   Virtual Timers initialization.
- * @note    Internal use only.
+ * @brief   Counts the trailing zeros of a non-zero bitmap word.
+ * @note    Ports can provide an optimized @p port_ctz() macro, the compiler
+ *          builtin or a constant time software fallback is used otherwise.
+ *
+ * @param[in] w         the word to be scanned, must not be zero
+ * @return              The number of trailing zero bits.
  *
  * @notapi
  */
-void _vt_init(void) {
+static inline unsigned vt_ctz(uint32_t w) {
+#if defined(port_ctz)
+  return (unsigned)port_ctz(w);
+#elif defined(__GNUC__)
+  return (unsigned)__builtin_ctz(w);
+#else
+  unsigned n = 0U;
 
-  ch.vtlist.next = (virtual_timer_t *)&ch.vtlist;
-  ch.vtlist.prev = (virtual_timer_t *)&ch.vtlist;
-  ch.vtlist.delta = (sysinterval_t)-1;
-#if CH_CFG_ST_TIMEDELTA == 0
-  ch.vtlist.systime = (systime_t)0;
-#else /* CH_CFG_ST_TIMEDELTA > 0 */
-  ch.vtlist.lasttime = (systime_t)0;
-#endif /* CH_CFG_ST_TIMEDELTA > 0 */
+  if ((w & 0x0000FFFFU) == 0U) {n += 16U; w >>= 16;}
+  if ((w & 0x000000FFU) == 0U) {n +=  8U; w >>=  8;}
+  if ((w & 0x0000000FU) == 0U) {n +=  4U; w >>=  4;}
+  if ((w & 0x00000003U) == 0U) {n +=  2U; w >>=  2;}
+  if ((w & 0x00000001U) == 0U) {n +=  1U;}
+
+  return n;
+#endif
 }
 
 /**
- * @brief   Enables a virtual timer.
- * @details The timer is enabled and programmed to trigger after the delay
- *          specified as parameter.
- * @pre     The timer must not be already armed before calling this function.
- * @note    The callback function is invoked from interrupt context.
+ * @brief   Checks if the wheel contains no armed timers.
  *
- * @param[out] vtp      the @p virtual_timer_t structure pointer
- * @param[in] delay     the number of ticks before the operation timeouts, the
- *                      special values are handled as follow:
- *                      - @a TIME_INFINITE is allowed but interpreted as a
- *                        normal time specification.
- *                      - @a TIME_IMMEDIATE this value is not allowed.
- *                      .
- * @param[in] vtfunc    the timer callback function. After invoking the
- *                      callback the timer is disabled and the structure can
- *                      be disposed or reused.
- * @param[in] par       a parameter that will be passed to the callback
- *                      function
+ * @return              The wheel state.
+ * @retval false        if the wheel contains at least one timer.
+ * @retval true         if the wheel is empty.
  *
- * @iclass
+ * @notapi
  */
-void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
-                vtfunc_t vtfunc, void *par) {
+static inline bool vt_wheel_is_empty(void) {
+  unsigned level;
+
+  for (level = 0U; level < (unsigned)CH_CFG_VT_WHEEL_LEVELS; level++) {
+    if (ch.vtlist.map[level] != 0U) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief   Returns the distance of the next event of a non-empty level.
+ * @details For the first level it is the expiration of its first non-empty
+ *          slot, for upper levels it is the cascade of their first non-empty
+ *          slot.
+ *
+ * @param[in] level     the wheel level, it must not be empty
+ * @return              The distance in ticks from the wheel time, it is
+ *                      always greater than zero.
+ *
+ * @notapi
+ */
+static inline sysinterval_t vt_wheel_level_event(unsigned level) {
+  sysinterval_t time = ch.vtlist.wheeltime;
+  unsigned shift = level * CH_VT_WHEEL_SLOT_BITS;
+  sysinterval_t base = time >> shift;
+  unsigned rot = ((unsigned)base + 1U) & VT_WHEEL_SLOT_MASK;
+  uint32_t map = ch.vtlist.map[level];
+  sysinterval_t ev;
+
+  /* Rotating the bitmap so that the slot following the current one is in
+     bit zero, the current slot is the farthest one.*/
+  map = (map >> rot) | (map << ((32U - rot) & 31U));
+  ev = (sysinterval_t)(base + (sysinterval_t)vt_ctz(map) + (sysinterval_t)1);
+
+  return (sysinterval_t)((sysinterval_t)(ev << shift) - time);
+}
+
+/**
+ * @brief   Inserts a timer in the wheel slot matching its expiration time.
+ * @pre     The timer expiration time is in its @p delta field and it does
+ *          not precede the wheel time.
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ *
+ * @notapi
+ */
+static void vt_wheel_insert(virtual_timer_t *vtp) {
+  sysinterval_t exp = vtp->delta;
+  sysinterval_t dist = exp - ch.vtlist.wheeltime;
+  unsigned level = 0U, shift = 0U, slot;
+  vt_slot_t *sp;
+
+  /* Timers beyond the wheel range are parked in the last level, they are
+     re-evaluated when their slot is cascaded.*/
+  if (dist >= VT_WHEEL_RANGE) {
+    dist = VT_WHEEL_RANGE - (sysinterval_t)1;
+    exp  = ch.vtlist.wheeltime + dist;
+  }
+
+  /* The level is selected by the distance, the slot by the bits of the
+     expiration time belonging to that level.*/
+  while (dist >= (sysinterval_t)CH_VT_WHEEL_SLOTS) {
+    dist >>= CH_VT_WHEEL_SLOT_BITS;
+    shift += CH_VT_WHEEL_SLOT_BITS;
+    level++;
+  }
+  slot = (unsigned)(exp >> shift) & VT_WHEEL_SLOT_MASK;
+
+  /* The timer is appended to the slot list.*/
+  sp = &ch.vtlist.slots[level][slot];
+  vtp->next = (virtual_timer_t *)sp;
+  vtp->prev = sp->prev;
+  vtp->prev->next = vtp;
+  sp->prev = vtp;
+  ch.vtlist.map[level] |= (uint32_t)1U << slot;
+}
+
+/**
+ * @brief   Removes a timer from its wheel slot.
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ *
+ * @notapi
+ */
+static inline void vt_wheel_remove(virtual_timer_t *vtp) {
+
+  vtp->prev->next = vtp->next;
+  vtp->next->prev = vtp->prev;
+
+  /* If both neighbours are the same element then it is the slot header and
+     the slot became empty.*/
+  if (vtp->prev == vtp->next) {
+    unsigned i = (unsigned)((vt_slot_t *)vtp->next - &ch.vtlist.slots[0][0]);
+
+    ch.vtlist.map[i / CH_VT_WHEEL_SLOTS] &=
+        ~((uint32_t)1U << (i & VT_WHEEL_SLOT_MASK));
+  }
+}
+
+/**
+ * @brief   Processes the wheel slots reached by the current wheel time.
+ * @details Upper levels slots whose boundary has been reached are cascaded
+ *          into the lower levels then the expired timers are removed and
+ *          their callbacks invoked.
+ * @note    The system lock is released before entering the callbacks and
+ *          re-acquired immediately after.
+ *
+ * @param[in] merged    @p true if timers have already been served by the
+ *                      current alarm event
+ * @return              The updated @p merged state.
+ *
+ * @notapi
+ */
+static bool vt_wheel_expire(bool merged) {
+  sysinterval_t time = ch.vtlist.wheeltime;
+  unsigned level, shift;
+  vt_slot_t *sp;
+
+  /* Cascading, the timers are re-inserted in the lower levels.*/
+  shift = CH_VT_WHEEL_SLOT_BITS;
+  for (level = 1U; level < (unsigned)CH_CFG_VT_WHEEL_LEVELS; level++) {
+    if ((time & (((sysinterval_t)1 << shift) - (sysinterval_t)1)) !=
+        (sysinterval_t)0) {
+      break;
+    }
+
+    sp = &ch.vtlist.slots[level][(unsigned)(time >> shift) &
+                                 VT_WHEEL_SLOT_MASK];
+    while (sp->next != (virtual_timer_t *)sp) {
+      virtual_timer_t *vtp = sp->next;
+
+      vt_wheel_remove(vtp);
+      vt_wheel_insert(vtp);
+    }
+    shift += CH_VT_WHEEL_SLOT_BITS;
+  }
+
+  /* Consuming all timers in the current slot of the first level, timers
+     armed by the callbacks or reloaded cannot fall in this slot.*/
+  sp = &ch.vtlist.slots[0][(unsigned)time & VT_WHEEL_SLOT_MASK];
+  while (sp->next != (virtual_timer_t *)sp) {
+    virtual_timer_t *vtp = sp->next;
+    vtfunc_t fn;
+
+    vt_wheel_remove(vtp);
+    _trace_vt(CH_TRACE_EVENT_FIRE, vtp);
+    fn = vtp->func;
+    if (vtp->reload > (sysinterval_t)0) {
+      /* Periodic timer, it is re-armed one period after its deadline so
+         that the callback latency does not accumulate.*/
+      vtp->delta += vtp->reload;
+      vt_wheel_insert(vtp);
+    }
+    else {
+      vtp->func = NULL;
+    }
+
+#if CH_CFG_ST_TIMEDELTA > 0
+    /* If the wheel becomes empty then the alarm timer is stopped.*/
+    if (vt_wheel_is_empty()) {
+      port_timer_stop_alarm();
+    }
+
+    /* Timers served after the first one are merged in the same alarm.*/
+    if (merged) {
+      _stats_increase_vt_merged();
+    }
+#endif
+    merged = true;
+
+#if CH_CFG_VT_DEFERRED == TRUE
+    if (vtp->deferred) {
+      /* The callback is executed by the virtual timers thread.*/
+      _vt_defer(vtp, fn);
+    }
+    else {
+      /* The callback is invoked outside the kernel critical zone.*/
+      chSysUnlockFromISR();
+      fn(vtp->par);
+      chSysLockFromISR();
+    }
+#else
+    /* The callback is invoked outside the kernel critical zone.*/
+    chSysUnlockFromISR();
+    fn(vtp->par);
+    chSysLockFromISR();
+#endif
+  }
+
+  return merged;
+}
+#endif /* CH_CFG_VT_WHEEL == TRUE */
+
+#if (CH_CFG_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Removes a timer from the deferred callbacks queue.
+ * @pre     The timer callback must be pending.
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ *
+ * @notapi
+ */
+static void vt_dequeue_deferred(virtual_timer_t *vtp) {
+  virtual_timer_t *p = NULL, *q = ch.vtlist.dhead;
+
+  while (q != vtp) {
+    p = q;
+    q = q->dnext;
+  }
+
+  if (p == NULL) {
+    ch.vtlist.dhead = vtp->dnext;
+  }
+  else {
+    p->dnext = vtp->dnext;
+  }
+  if (ch.vtlist.dtail == vtp) {
+    ch.vtlist.dtail = p;
+  }
+  vtp->pending = false;
+}
+#endif /* CH_CFG_VT_DEFERRED == TRUE */
+
+/**
+ * @brief   Inserts an armed timer in the timers list.
+ * @details The timer is inserted and the alarm is reprogrammed if needed
+ *          in tick-less mode.
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the operation timeouts
+ *
+ * @notapi
+ */
+static void vt_do_set(virtual_timer_t *vtp, sysinterval_t delay) {
+#if CH_CFG_VT_WHEEL == FALSE
   virtual_timer_t *p;
+#endif
   sysinterval_t delta;
 
-  chDbgCheckClassI();
-  chDbgCheck((vtp != NULL) && (vtfunc != NULL) && (delay != TIME_IMMEDIATE));
+  _trace_vt(CH_TRACE_EVENT_ARM, vtp);
 
-  vtp->par = par;
-  vtp->func = vtfunc;
+#if CH_CFG_VT_WHEEL == TRUE
+#if CH_CFG_ST_TIMEDELTA > 0
+  {
+    systime_t now = chVTGetSystemTimeX();
+    sysinterval_t nowdelta, evdelta;
+
+    /* If the requested delay is lower than the minimum safe delta then it
+       is raised to the minimum safe value.*/
+    if (delay < (sysinterval_t)CH_CFG_ST_TIMEDELTA) {
+      delay = (sysinterval_t)CH_CFG_ST_TIMEDELTA;
+    }
 
+    /* Special case where the wheel is empty.*/
+    if (vt_wheel_is_empty()) {
+
+      /* The current time becomes the new wheel base time, the timer is
+         inserted.*/
+      ch.vtlist.lasttime = now;
+      vtp->delta = ch.vtlist.wheeltime + delay;
+      vt_wheel_insert(vtp);
+
+      /* The first wheel event can be a cascade preceding the timer
+         expiration, it cannot be closer than the minimum safe delta.*/
+#if CH_CFG_VT_SLACK == TRUE
+      evdelta = _vt_coalesce_alarm();
+#else
+      (void)_vt_wheel_next_event(&evdelta);
+#endif
+      if (evdelta < (sysinterval_t)CH_CFG_ST_TIMEDELTA) {
+        evdelta = (sysinterval_t)CH_CFG_ST_TIMEDELTA;
+      }
+#if CH_CFG_INTERVALS_SIZE > CH_CFG_ST_RESOLUTION
+      /* The delta could be too large for the physical timer to handle.*/
+      else if (evdelta > (sysinterval_t)TIME_MAX_SYSTIME) {
+        evdelta = (sysinterval_t)TIME_MAX_SYSTIME;
+      }
+#endif
+
+      /* Being the only timer in the wheel the alarm timer is started.*/
+      port_timer_start_alarm(chTimeAddX(ch.vtlist.lasttime, evdelta));
+
+      return;
+    }
+
+    /* Delay as distance from the wheel time. Note, a very large delay can
+       exceed the numeric range, in that case it is clamped.*/
+    nowdelta = chTimeDiffX(ch.vtlist.lasttime, now);
+    delta = nowdelta + delay;
+    if (delta < nowdelta) {
+      delta = (sysinterval_t)-1;
+    }
+
+#if CH_CFG_VT_SLACK == TRUE
+    /* The timer is inserted in the wheel, the alarm is moved only if it is
+       beyond the end of the new timer window else the new timer is served
+       by the already programmed alarm.*/
+    vtp->delta = ch.vtlist.wheeltime + delta;
+    vt_wheel_insert(vtp);
+
+    evdelta = vt_window_end(delta, vtp->slack);
+    if (evdelta < chTimeDiffX(ch.vtlist.lasttime, port_timer_get_alarm())) {
+#if CH_CFG_INTERVALS_SIZE > CH_CFG_ST_RESOLUTION
+      /* The delta could be too large for the physical timer to handle.*/
+      if (evdelta > (sysinterval_t)TIME_MAX_SYSTIME) {
+        evdelta = (sysinterval_t)TIME_MAX_SYSTIME;
+      }
+#endif
+      port_timer_set_alarm(chTimeAddX(ch.vtlist.lasttime, evdelta));
+    }
+#else /* CH_CFG_VT_SLACK == FALSE */
+    /* The timer is inserted in the wheel, the alarm is moved only if the
+       new timer anticipated the next wheel event.*/
+    (void)_vt_wheel_next_event(&evdelta);
+    vtp->delta = ch.vtlist.wheeltime + delta;
+    vt_wheel_insert(vtp);
+
+    /* If the current time surpassed the next wheel event then the alarm
+       interrupt is already pending, just return.*/
+    if (nowdelta >= evdelta) {
+      return;
+    }
+
+    delta = evdelta;
+    (void)_vt_wheel_next_event(&evdelta);
+    if (evdelta < delta) {
+      /* Making sure to not schedule an event closer than
+         CH_CFG_ST_TIMEDELTA ticks from now.*/
+      if (evdelta < nowdelta + (sysinterval_t)CH_CFG_ST_TIMEDELTA) {
+        evdelta = nowdelta + (sysinterval_t)CH_CFG_ST_TIMEDELTA;
+      }
+#if CH_CFG_INTERVALS_SIZE > CH_CFG_ST_RESOLUTION
+      /* The delta could be too large for the physical timer to handle.*/
+      else if (evdelta > (sysinterval_t)TIME_MAX_SYSTIME) {
+        evdelta = (sysinterval_t)TIME_MAX_SYSTIME;
+      }
+#endif
+      port_timer_set_alarm(chTimeAddX(ch.vtlist.lasttime, evdelta));
+    }
+#endif /* CH_CFG_VT_SLACK == FALSE */
+  }
+#else /* CH_CFG_ST_TIMEDELTA == 0 */
+  /* The expiration time is relative to the current wheel time.*/
+  delta = delay;
+  vtp->delta = ch.vtlist.wheeltime + delta;
+  vt_wheel_insert(vtp);
+#endif /* CH_CFG_ST_TIMEDELTA == 0 */
+#else /* CH_CFG_VT_WHEEL == FALSE */
 #if CH_CFG_ST_TIMEDELTA > 0
   {
     systime_t now = chVTGetSystemTimeX();
@@ -124,6 +494,12 @@ void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
       vtp->next = (virtual_timer_t *)&ch.vtlist;
       vtp->prev = (virtual_timer_t *)&ch.vtlist;
       vtp->delta = delay;
+      ch.vtlist.taildelta = delay;
+
+#if CH_CFG_VT_SLACK == TRUE
+      /* The alarm is delayed to the end of the timer window.*/
+      delay = vt_window_end(delay, vtp->slack);
+#endif
 
 #if CH_CFG_INTERVALS_SIZE > CH_CFG_ST_RESOLUTION
       /* The delta could be too large for the physical timer to handle.*/
@@ -151,7 +527,30 @@ void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
          adjust the delta to wrap back in the previous numeric range.*/
       delta -= p->delta;
       p = p->next;
+
+      /* The distance of the last timer could exceed the numeric range.*/
+      ch.vtlist.taildelta = CH_VT_TAILDELTA_UNKNOWN;
+    }
+#if CH_CFG_VT_SLACK == TRUE
+    else {
+      sysinterval_t deadline_delta;
+
+      /* The alarm is moved only if it is beyond the end of the new timer
+         window else the new timer is served by the already programmed
+         alarm.*/
+      deadline_delta = vt_window_end(delta, vtp->slack);
+      if (deadline_delta < chTimeDiffX(ch.vtlist.lasttime,
+                                       port_timer_get_alarm())) {
+#if CH_CFG_INTERVALS_SIZE > CH_CFG_ST_RESOLUTION
+        /* The delta could be too large for the physical timer to handle.*/
+        if (deadline_delta > (sysinterval_t)TIME_MAX_SYSTIME) {
+          deadline_delta = (sysinterval_t)TIME_MAX_SYSTIME;
+        }
+#endif
+        port_timer_set_alarm(chTimeAddX(ch.vtlist.lasttime, deadline_delta));
+      }
     }
+#else /* CH_CFG_VT_SLACK == FALSE */
     else if (delta < p->delta) {
       sysinterval_t deadline_delta;
 
@@ -166,6 +565,7 @@ void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
 #endif
       port_timer_set_alarm(chTimeAddX(ch.vtlist.lasttime, deadline_delta));
     }
+#endif /* CH_CFG_VT_SLACK == FALSE */
   }
 #else /* CH_CFG_ST_TIMEDELTA == 0 */
   /* Delta is initially equal to the specified delay.*/
@@ -185,6 +585,13 @@ void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
     p = p->next;
   }
 
+  /* If the timer is inserted in last position then the list extends up to
+     its deadline.*/
+  if ((p == (virtual_timer_t *)&ch.vtlist) &&
+      (ch.vtlist.taildelta != CH_VT_TAILDELTA_UNKNOWN)) {
+    ch.vtlist.taildelta += delta;
+  }
+
   /* The timer is inserted in the delta list.*/
   vtp->next = p;
   vtp->prev = vtp->next->prev;
@@ -198,49 +605,368 @@ void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
   /* Special case when the timer is in last position in the list, the
      value in the header must be restored.*/
   ch.vtlist.delta = (sysinterval_t)-1;
+#endif /* CH_CFG_VT_WHEEL == FALSE */
 }
 
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
 /**
- * @brief   Disables a Virtual Timer.
- * @pre     The timer must be in armed state before calling this function.
- *
- * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @brief   Virtual Timers initialization.
+ * @note    Internal use only.
  *
- * @iclass
+ * @notapi
  */
-void chVTDoResetI(virtual_timer_t *vtp) {
-
-  chDbgCheckClassI();
-  chDbgCheck(vtp != NULL);
-  chDbgAssert(vtp->func != NULL, "timer not set or already triggered");
-
-#if CH_CFG_ST_TIMEDELTA == 0
-
-  /* The delta of the timer is added to the next timer.*/
-  vtp->next->delta += vtp->delta;
+void _vt_init(void) {
 
- /* Removing the element from the delta list.*/
-  vtp->prev->next = vtp->next;
-  vtp->next->prev = vtp->prev;
-  vtp->func = NULL;
+#if CH_CFG_VT_WHEEL == TRUE
+  unsigned level, slot;
 
-  /* The above code changes the value in the header when the removed element
-     is the last of the list, restoring it.*/
+  for (level = 0U; level < (unsigned)CH_CFG_VT_WHEEL_LEVELS; level++) {
+    for (slot = 0U; slot < CH_VT_WHEEL_SLOTS; slot++) {
+      ch.vtlist.slots[level][slot].next =
+          (virtual_timer_t *)&ch.vtlist.slots[level][slot];
+      ch.vtlist.slots[level][slot].prev =
+          (virtual_timer_t *)&ch.vtlist.slots[level][slot];
+    }
+    ch.vtlist.map[level] = 0U;
+  }
+  ch.vtlist.wheeltime = (sysinterval_t)0;
+#else /* CH_CFG_VT_WHEEL == FALSE */
+  ch.vtlist.next = (virtual_timer_t *)&ch.vtlist;
+  ch.vtlist.prev = (virtual_timer_t *)&ch.vtlist;
   ch.vtlist.delta = (sysinterval_t)-1;
+  ch.vtlist.taildelta = (sysinterval_t)0;
+#endif /* CH_CFG_VT_WHEEL == FALSE */
+#if CH_CFG_ST_TIMEDELTA == 0
+  ch.vtlist.systime = (systime_t)0;
 #else /* CH_CFG_ST_TIMEDELTA > 0 */
-  sysinterval_t nowdelta, delta;
-
-  /* If the timer is not the first of the list then it is simply unlinked
-     else the operation is more complex.*/
-  if (ch.vtlist.next != vtp) {
-    /* Removing the element from the delta list.*/
-    vtp->prev->next = vtp->next;
-    vtp->next->prev = vtp->prev;
-    vtp->func = NULL;
-
-    /* Adding delta to the next element, if it is not the last one.*/
-    if (&ch.vtlist != (virtual_timers_list_t *)vtp->next)
-      vtp->next->delta += vtp->delta;
+  ch.vtlist.lasttime = (systime_t)0;
+#endif /* CH_CFG_ST_TIMEDELTA > 0 */
+#if CH_CFG_VT_DEFERRED == TRUE
+  ch.vtlist.dhead = NULL;
+  ch.vtlist.dtail = NULL;
+  ch.vtlist.dthread = NULL;
+#endif
+}
+
+/**
+ * @brief   Enables a virtual timer.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter.
+ * @pre     The timer must not be already armed before calling this function.
+ * @note    The callback function is invoked from interrupt context.
+ * @note    When the timing wheel is enabled in tick-less mode a delay
+ *          exceeding the intervals numeric range, once added to the time
+ *          elapsed since the last wheel event, is clamped to that range.
+ *
+ * @param[out] vtp      the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the operation timeouts, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] vtfunc    the timer callback function. After invoking the
+ *                      callback the timer is disabled and the structure can
+ *                      be disposed or reused.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
+                vtfunc_t vtfunc, void *par) {
+
+  chDbgCheckClassI();
+  chDbgCheck((vtp != NULL) && (vtfunc != NULL) && (delay != TIME_IMMEDIATE));
+
+  vtp->par = par;
+  vtp->func = vtfunc;
+  vtp->reload = (sysinterval_t)0;
+#if CH_CFG_VT_SLACK == TRUE
+  vtp->slack = (sysinterval_t)0;
+#endif
+#if CH_CFG_VT_DEFERRED == TRUE
+  vtp->deferred = false;
+  vtp->pending = false;
+#endif
+  vt_do_set(vtp, delay);
+}
+
+/**
+ * @brief   Enables a periodic virtual timer.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter, then it is reloaded every @p period
+ *          ticks. The reload is performed on the timer deadline before
+ *          invoking the callback so the callback latency does not
+ *          accumulate as drift.
+ * @pre     The timer must not be already armed before calling this function.
+ * @note    The callback function is invoked from interrupt context, the
+ *          timer is already re-armed when the callback is invoked and
+ *          the callback can stop it using @p chVTResetI().
+ *
+ * @param[out] vtp      the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the first expiration, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] period    the number of ticks between expirations, zero for
+ *                      a one-shot timer
+ * @param[in] vtfunc    the timer callback function
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+void chVTDoSetPeriodicI(virtual_timer_t *vtp, sysinterval_t delay,
+                        sysinterval_t period, vtfunc_t vtfunc, void *par) {
+
+  chDbgCheckClassI();
+  chDbgCheck((vtp != NULL) && (vtfunc != NULL) && (delay != TIME_IMMEDIATE));
+
+  vtp->par = par;
+  vtp->func = vtfunc;
+  vtp->reload = period;
+#if CH_CFG_VT_SLACK == TRUE
+  vtp->slack = (sysinterval_t)0;
+#endif
+#if CH_CFG_VT_DEFERRED == TRUE
+  vtp->deferred = false;
+  vtp->pending = false;
+#endif
+  vt_do_set(vtp, delay);
+}
+
+#if (CH_CFG_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Enables a virtual timer with a deferred callback.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter, the callback is executed by the virtual
+ *          timers thread instead of the timer interrupt. The timer is
+ *          reloaded every @p period ticks if a period is specified.
+ * @pre     The timer must not be already armed before calling this function.
+ * @note    The callback function is invoked from thread context with the
+ *          kernel unlocked, it must use the normal thread API.
+ * @note    A timer stays armed until its callback is invoked, if a
+ *          periodic timer expires while its callback is still pending then
+ *          the expiration is lost.
+ *
+ * @param[out] vtp      the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the first expiration, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] period    the number of ticks between expirations, zero for
+ *                      a one-shot timer
+ * @param[in] vtfunc    the timer callback function
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+void chVTDoSetDeferredI(virtual_timer_t *vtp, sysinterval_t delay,
+                        sysinterval_t period, vtfunc_t vtfunc, void *par) {
+
+  chDbgCheckClassI();
+  chDbgCheck((vtp != NULL) && (vtfunc != NULL) && (delay != TIME_IMMEDIATE));
+
+  vtp->par = par;
+  vtp->func = vtfunc;
+  vtp->reload = period;
+#if CH_CFG_VT_SLACK == TRUE
+  vtp->slack = (sysinterval_t)0;
+#endif
+  vtp->deferred = true;
+  vtp->pending = false;
+  vt_do_set(vtp, delay);
+}
+#endif /* CH_CFG_VT_DEFERRED == TRUE */
+
+#if (CH_CFG_VT_SLACK == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Enables a virtual timer with a tolerated expiration delay.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter, the callback can be invoked up to
+ *          @p slack ticks later. In tick-less mode timers whose windows
+ *          overlap are served by a single alarm event.
+ * @pre     The timer must not be already armed before calling this function.
+ * @note    The callback function is invoked from interrupt context.
+ * @note    In tick mode the slack is ignored.
+ *
+ * @param[out] vtp      the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the operation timeouts, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] slack     the number of ticks the expiration can be delayed
+ *                      in order to be coalesced with other timers
+ * @param[in] vtfunc    the timer callback function. After invoking the
+ *                      callback the timer is disabled and the structure can
+ *                      be disposed or reused.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+void chVTDoSetWithSlackI(virtual_timer_t *vtp, sysinterval_t delay,
+                         sysinterval_t slack, vtfunc_t vtfunc, void *par) {
+
+  chDbgCheckClassI();
+  chDbgCheck((vtp != NULL) && (vtfunc != NULL) && (delay != TIME_IMMEDIATE));
+
+  vtp->par = par;
+  vtp->func = vtfunc;
+  vtp->reload = (sysinterval_t)0;
+  vtp->slack = slack;
+#if CH_CFG_VT_DEFERRED == TRUE
+  vtp->deferred = false;
+  vtp->pending = false;
+#endif
+  vt_do_set(vtp, delay);
+}
+#endif /* CH_CFG_VT_SLACK == TRUE */
+
+/**
+ * @brief   Disables a Virtual Timer.
+ * @pre     The timer must be in armed state before calling this function.
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ *
+ * @iclass
+ */
+void chVTDoResetI(virtual_timer_t *vtp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(vtp != NULL);
+  chDbgAssert(vtp->func != NULL, "timer not set or already triggered");
+
+  _trace_vt(CH_TRACE_EVENT_RESET, vtp);
+
+#if CH_CFG_VT_DEFERRED == TRUE
+  /* If the callback is pending then the timer is removed from the deferred
+     callbacks queue, one-shot timers are no more in the timers list.*/
+  if (vtp->pending) {
+    vt_dequeue_deferred(vtp);
+    if (vtp->reload == (sysinterval_t)0) {
+      vtp->func = NULL;
+
+      return;
+    }
+  }
+#endif
+
+#if CH_CFG_VT_WHEEL == TRUE
+#if CH_CFG_ST_TIMEDELTA == 0
+
+  /* Removing the element from its wheel slot.*/
+  vt_wheel_remove(vtp);
+  vtp->func = NULL;
+#else /* CH_CFG_ST_TIMEDELTA > 0 */
+  sysinterval_t nowdelta, evdelta, delta;
+
+#if CH_CFG_VT_SLACK == TRUE
+  /* Removing the element from its wheel slot.*/
+  vt_wheel_remove(vtp);
+  vtp->func = NULL;
+
+  /* If the wheel become empty then the alarm timer is stopped and done.*/
+  if (vt_wheel_is_empty()) {
+    port_timer_stop_alarm();
+
+    return;
+  }
+
+  /* The programmed alarm is compared with the coalesced one.*/
+  evdelta = chTimeDiffX(ch.vtlist.lasttime, port_timer_get_alarm());
+  delta = _vt_coalesce_alarm();
+#else /* CH_CFG_VT_SLACK == FALSE */
+  /* Removing the element from its wheel slot, the next wheel event is
+     sampled before and after the removal.*/
+  (void)_vt_wheel_next_event(&evdelta);
+  vt_wheel_remove(vtp);
+  vtp->func = NULL;
+
+  /* If the wheel become empty then the alarm timer is stopped and done.*/
+  if (!_vt_wheel_next_event(&delta)) {
+    port_timer_stop_alarm();
+
+    return;
+  }
+#endif /* CH_CFG_VT_SLACK == FALSE */
+
+  /* If the next wheel event is unchanged then the already programmed alarm
+     will serve it.*/
+  if (delta == evdelta) {
+    return;
+  }
+
+  /* Distance in ticks between the last alarm event and current time.*/
+  nowdelta = chTimeDiffX(ch.vtlist.lasttime, chVTGetSystemTimeX());
+
+  /* If the current time surpassed the time of the removed event then the
+     event interrupt is already pending, just return.*/
+  if (nowdelta >= evdelta) {
+    return;
+  }
+
+  /* Making sure to not schedule an event closer than CH_CFG_ST_TIMEDELTA
+     ticks from now.*/
+  if (delta < nowdelta + (sysinterval_t)CH_CFG_ST_TIMEDELTA) {
+    delta = nowdelta + (sysinterval_t)CH_CFG_ST_TIMEDELTA;
+  }
+#if CH_CFG_INTERVALS_SIZE > CH_CFG_ST_RESOLUTION
+  /* The delta could be too large for the physical timer to handle.*/
+  else if (delta > (sysinterval_t)TIME_MAX_SYSTIME) {
+    delta = (sysinterval_t)TIME_MAX_SYSTIME;
+  }
+#endif
+  port_timer_set_alarm(chTimeAddX(ch.vtlist.lasttime, delta));
+#endif /* CH_CFG_ST_TIMEDELTA > 0 */
+#else /* CH_CFG_VT_WHEEL == FALSE */
+#if CH_CFG_ST_TIMEDELTA == 0
+
+  /* The delta of the timer is added to the next timer, if the timer is the
+     last one then the list is shortened.*/
+  vtp->next->delta += vtp->delta;
+  if (vtp->next == (virtual_timer_t *)&ch.vtlist) {
+    ch.vtlist.taildelta -= vtp->delta;
+  }
+
+ /* Removing the element from the delta list.*/
+  vtp->prev->next = vtp->next;
+  vtp->next->prev = vtp->prev;
+  vtp->func = NULL;
+
+  /* The above code changes the value in the header when the removed element
+     is the last of the list, restoring it.*/
+  ch.vtlist.delta = (sysinterval_t)-1;
+#else /* CH_CFG_ST_TIMEDELTA > 0 */
+  sysinterval_t nowdelta, delta;
+
+  /* If the timer is not the first of the list then it is simply unlinked
+     else the operation is more complex.*/
+  if (ch.vtlist.next != vtp) {
+    /* Removing the element from the delta list.*/
+    vtp->prev->next = vtp->next;
+    vtp->next->prev = vtp->prev;
+    vtp->func = NULL;
+
+    /* Adding delta to the next element, if it is not the last one, else
+       the list is shortened.*/
+    if (&ch.vtlist != (virtual_timers_list_t *)vtp->next) {
+      vtp->next->delta += vtp->delta;
+    }
+    else if (ch.vtlist.taildelta != CH_VT_TAILDELTA_UNKNOWN) {
+      ch.vtlist.taildelta -= vtp->delta;
+    }
 
     return;
   }
@@ -252,6 +978,7 @@ void chVTDoResetI(virtual_timer_t *vtp) {
 
   /* If the list become empty then the alarm timer is stopped and done.*/
   if (&ch.vtlist == (virtual_timers_list_t *)ch.vtlist.next) {
+    ch.vtlist.taildelta = (sysinterval_t)0;
     port_timer_stop_alarm();
 
     return;
@@ -269,6 +996,20 @@ void chVTDoResetI(virtual_timer_t *vtp) {
   /* Distance in ticks between the last alarm event and current time.*/
   nowdelta = chTimeDiffX(ch.vtlist.lasttime, chVTGetSystemTimeX());
 
+#if CH_CFG_VT_SLACK == TRUE
+  /* If the current time surpassed the programmed alarm or the coalesced
+     alarm then the event interrupt is already pending, just return.*/
+  if (nowdelta >= chTimeDiffX(ch.vtlist.lasttime, port_timer_get_alarm())) {
+    return;
+  }
+  delta = _vt_coalesce_alarm();
+  if (nowdelta >= delta) {
+    return;
+  }
+
+  /* Distance from the coalesced event and now.*/
+  delta -= nowdelta;
+#else /* CH_CFG_VT_SLACK == FALSE */
   /* If the current time surpassed the time of the next element in list
      then the event interrupt is already pending, just return.*/
   if (nowdelta >= ch.vtlist.next->delta) {
@@ -277,6 +1018,7 @@ void chVTDoResetI(virtual_timer_t *vtp) {
 
   /* Distance from the next scheduled event and now.*/
   delta = ch.vtlist.next->delta - nowdelta;
+#endif /* CH_CFG_VT_SLACK == FALSE */
 
   /* Making sure to not schedule an event closer than CH_CFG_ST_TIMEDELTA
      ticks from now.*/
@@ -294,6 +1036,343 @@ void chVTDoResetI(virtual_timer_t *vtp) {
   }
   port_timer_set_alarm(chTimeAddX(ch.vtlist.lasttime, delta));
 #endif /* CH_CFG_ST_TIMEDELTA > 0 */
+#endif /* CH_CFG_VT_WHEEL == FALSE */
+}
+
+#if (CH_CFG_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Queues the callback of an expired timer.
+ * @details The timer is appended to the deferred callbacks queue and the
+ *          virtual timers thread is awakened, the timer stays armed until
+ *          its callback is executed.
+ * @note    If the callback of a periodic timer is still pending then the
+ *          expiration is lost.
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @param[in] fn        the timer callback function
+ *
+ * @notapi
+ */
+void _vt_defer(virtual_timer_t *vtp, vtfunc_t fn) {
+
+  if (vtp->pending) {
+    return;
+  }
+
+  vtp->func = fn;
+  vtp->pending = true;
+  vtp->dnext = NULL;
+  if (ch.vtlist.dhead == NULL) {
+    ch.vtlist.dhead = vtp;
+  }
+  else {
+    ch.vtlist.dtail->dnext = vtp;
+  }
+  ch.vtlist.dtail = vtp;
+
+  chThdResumeI(&ch.vtlist.dthread, MSG_OK);
+}
+
+/**
+ * @brief   Virtual timers thread.
+ * @details This thread executes the callbacks of the timers armed using
+ *          @p chVTDoSetDeferredI().
+ *
+ * @param[in] p         the thread parameter, unused in this scenario
+ *
+ * @notapi
+ */
+void _vt_thread(void *p) {
+
+  (void)p;
+
+  chSysLock();
+  while (true) {
+    virtual_timer_t *vtp;
+    vtfunc_t fn;
+    void *par;
+
+    /* Waiting for callbacks to be queued.*/
+    if (ch.vtlist.dhead == NULL) {
+      (void) chThdSuspendS(&ch.vtlist.dthread);
+      continue;
+    }
+
+    /* Removing the first timer from the queue, one-shot timers become
+       disarmed.*/
+    vtp = ch.vtlist.dhead;
+    ch.vtlist.dhead = vtp->dnext;
+    vtp->pending = false;
+    fn = vtp->func;
+    par = vtp->par;
+    if (vtp->reload == (sysinterval_t)0) {
+      vtp->func = NULL;
+    }
+
+    /* The callback is invoked outside the kernel critical zone.*/
+    chSysUnlock();
+    fn(par);
+    chSysLock();
+  }
+}
+#endif /* CH_CFG_VT_DEFERRED == TRUE */
+
+#if (CH_CFG_VT_WHEEL == FALSE) || defined(__DOXYGEN__)
+/**
+ * @brief   Reloads an expired periodic timer.
+ * @details The timer is re-inserted in the delta list one period after its
+ *          deadline, the alarm is not reprogrammed.
+ * @pre     The timer has just been removed from the list head and its
+ *          deadline is the delta list base time.
+ * @note    Timers sharing the same period are re-inserted at the list tail
+ *          in constant time, other timers are inserted scanning the list
+ *          backward from its tail.
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ *
+ * @notapi
+ */
+void _vt_reload(virtual_timer_t *vtp) {
+  virtual_timer_t *p = (virtual_timer_t *)&ch.vtlist;
+  sysinterval_t delta = vtp->reload;
+
+  /* The distance of the last timer is known again if the list is empty.*/
+  if (ch.vtlist.next == (virtual_timer_t *)&ch.vtlist) {
+    ch.vtlist.taildelta = (sysinterval_t)0;
+  }
+
+  if (ch.vtlist.taildelta == CH_VT_TAILDELTA_UNKNOWN) {
+    /* The delta list is scanned from its head in order to find the correct
+       position for this timer.*/
+    p = ch.vtlist.next;
+    while (p->delta < delta) {
+      delta -= p->delta;
+      p = p->next;
+    }
+  }
+  else if (delta >= ch.vtlist.taildelta) {
+    /* The deadline is at or after the last one, the timer is appended.*/
+    delta -= ch.vtlist.taildelta;
+    ch.vtlist.taildelta = vtp->reload;
+  }
+  else {
+    sysinterval_t prevdelta = ch.vtlist.taildelta;
+
+    /* The delta list is scanned backward from its tail, "prevdelta" is the
+       distance of the timer preceding the insertion point.*/
+    do {
+      p = p->prev;
+      prevdelta -= p->delta;
+    } while (prevdelta >= delta);
+    delta -= prevdelta;
+  }
+
+  /* The timer is inserted in the delta list.*/
+  vtp->next = p;
+  vtp->prev = p->prev;
+  vtp->prev->next = vtp;
+  p->prev = vtp;
+  vtp->delta = delta;
+
+  /* Calculate new delta for the following entry.*/
+  p->delta -= delta;
+
+  /* Special case when the timer is in last position in the list, the
+     value in the header must be restored.*/
+  ch.vtlist.delta = (sysinterval_t)-1;
+}
+#endif /* CH_CFG_VT_WHEEL == FALSE */
+
+#if ((CH_CFG_VT_SLACK == TRUE) && (CH_CFG_ST_TIMEDELTA > 0)) ||               \
+    defined(__DOXYGEN__)
+/**
+ * @brief   Returns the coalesced alarm time.
+ * @details The alarm is delayed as much as the windows of the timers it
+ *          serves allow, all timers expiring before the alarm time are
+ *          served by the same alarm event.
+ * @pre     The timers list must not be empty.
+ *
+ * @return              The alarm time as distance in ticks from the last
+ *                      alarm event.
+ *
+ * @notapi
+ */
+sysinterval_t _vt_coalesce_alarm(void) {
+#if CH_CFG_VT_WHEEL == TRUE
+  sysinterval_t limit = (sysinterval_t)-1;
+  unsigned level, rot;
+  uint32_t map;
+
+  /* Timers in upper levels are evaluated after being cascaded, the first
+     cascade bounds the alarm time.*/
+  for (level = 1U; level < (unsigned)CH_CFG_VT_WHEEL_LEVELS; level++) {
+    if (ch.vtlist.map[level] != 0U) {
+      sysinterval_t ev = vt_wheel_level_event(level);
+
+      if (ev < limit) {
+        limit = ev;
+      }
+    }
+  }
+
+  /* First level slots are scanned in expiration order, the windows of
+     the timers expiring within the limit can lower it.*/
+  rot = ((unsigned)ch.vtlist.wheeltime + 1U) & VT_WHEEL_SLOT_MASK;
+  map = ch.vtlist.map[0];
+  map = (map >> rot) | (map << ((32U - rot) & 31U));
+  while (map != 0U) {
+    sysinterval_t delta = (sysinterval_t)vt_ctz(map) + (sysinterval_t)1;
+    vt_slot_t *sp;
+    virtual_timer_t *vtp;
+
+    if (delta > limit) {
+      break;
+    }
+
+    sp = &ch.vtlist.slots[0][((unsigned)ch.vtlist.wheeltime +
+                              (unsigned)delta) & VT_WHEEL_SLOT_MASK];
+    vtp = sp->next;
+    while ((vtp != (virtual_timer_t *)sp) && (limit > delta)) {
+      sysinterval_t end = vt_window_end(delta, vtp->slack);
+
+      if (end < limit) {
+        limit = end;
+      }
+      vtp = vtp->next;
+    }
+    map &= map - 1U;
+  }
+
+  return limit;
+#else /* CH_CFG_VT_WHEEL == FALSE */
+  virtual_timer_t *vtp = ch.vtlist.next;
+  sysinterval_t delta = vtp->delta;
+  sysinterval_t limit = vt_window_end(delta, vtp->slack);
+
+  /* The following timers expiring within the limit are served by the same
+     alarm, their windows can lower the limit.*/
+  vtp = vtp->next;
+  while ((vtp != (virtual_timer_t *)&ch.vtlist) &&
+         (vtp->delta <= limit - delta)) {
+    sysinterval_t end;
+
+    delta += vtp->delta;
+    end = vt_window_end(delta, vtp->slack);
+    if (end < limit) {
+      limit = end;
+    }
+    vtp = vtp->next;
+  }
+
+  return limit;
+#endif /* CH_CFG_VT_WHEEL == FALSE */
+}
+#endif /* (CH_CFG_VT_SLACK == TRUE) && (CH_CFG_ST_TIMEDELTA > 0) */
+
+#if (CH_CFG_VT_WHEEL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the distance of the next wheel event.
+ * @details The next event is either the expiration of the first non-empty
+ *          slot of the first level or the cascade of the first non-empty
+ *          slot of an upper level, whichever comes first.
+ *
+ * @param[out] deltap   pointer to a variable that will contain the distance,
+ *                      in ticks, of the next event from the wheel time, it
+ *                      is always greater than zero
+ * @return              The wheel state.
+ * @retval false        if the wheel is empty.
+ * @retval true         if the wheel contains at least one timer.
+ *
+ * @notapi
+ */
+bool _vt_wheel_next_event(sysinterval_t *deltap) {
+  sysinterval_t delta = (sysinterval_t)0;
+  unsigned level;
+  bool found = false;
+
+  for (level = 0U; level < (unsigned)CH_CFG_VT_WHEEL_LEVELS; level++) {
+    if (ch.vtlist.map[level] != 0U) {
+      sysinterval_t ev = vt_wheel_level_event(level);
+
+      if (!found || (ev < delta)) {
+        delta = ev;
+        found = true;
+      }
+    }
+  }
+
+  *deltap = delta;
+
+  return found;
+}
+
+/**
+ * @brief   Timing wheel ticker.
+ * @note    The system lock is released before entering the callbacks and
+ *          re-acquired immediately after.
+ *
+ * @notapi
+ */
+void _vt_wheel_tick(void) {
+#if CH_CFG_ST_TIMEDELTA == 0
+
+  ch.vtlist.systime++;
+  ch.vtlist.wheeltime++;
+  (void)vt_wheel_expire(false);
+#else /* CH_CFG_ST_TIMEDELTA > 0 */
+  systime_t now;
+  sysinterval_t delta, nowdelta;
+  bool merged = false;
+
+  _stats_increase_vt_alarm();
+
+  /* Looping through wheel events.*/
+  while (true) {
+
+    /* If the wheel is empty then nothing else to do, the alarm has already
+       been stopped.*/
+    if (!_vt_wheel_next_event(&delta)) {
+      return;
+    }
+
+    /* Getting the system time as reference.*/
+    now = chVTGetSystemTimeX();
+    nowdelta = chTimeDiffX(ch.vtlist.lasttime, now);
+    if (nowdelta < delta) {
+      break;
+    }
+
+    /* The wheel is moved to the event time, no other events are between
+       the two.*/
+    ch.vtlist.lasttime = chTimeAddX(ch.vtlist.lasttime, delta);
+    ch.vtlist.wheeltime += delta;
+    merged = vt_wheel_expire(merged);
+  }
+
+  /* The "unprocessed nowdelta" time slice is added to "last time" and to
+     the wheel time.*/
+  ch.vtlist.lasttime = now;
+  ch.vtlist.wheeltime += nowdelta;
+#if CH_CFG_VT_SLACK == TRUE
+  /* Timers whose windows overlap are served by a single alarm.*/
+  delta = _vt_coalesce_alarm();
+#else
+  delta -= nowdelta;
+#endif
+
+  /* Recalculating the next alarm time.*/
+  if (delta < (sysinterval_t)CH_CFG_ST_TIMEDELTA) {
+    delta = (sysinterval_t)CH_CFG_ST_TIMEDELTA;
+  }
+#if CH_CFG_INTERVALS_SIZE > CH_CFG_ST_RESOLUTION
+  /* The delta could be too large for the physical timer to handle.*/
+  else if (delta > (sysinterval_t)TIME_MAX_SYSTIME) {
+    delta = (sysinterval_t)TIME_MAX_SYSTIME;
+  }
+#endif
+  port_timer_set_alarm(chTimeAddX(now, delta));
+#endif /* CH_CFG_ST_TIMEDELTA > 0 */
 }
+#endif /* CH_CFG_VT_WHEEL == TRUE */
 
 /** @} */
@@ -137,6 +137,132 @@
  */
 #define CH_CFG_OPTIMIZE_SPEED               TRUE
 
+/**
+ * @brief   Bitmap-indexed ready list.
+ * @details If enabled then the ready list is augmented with a priority
+ *          bitmap and a per-priority tail pointer, threads insertion in
+ *          the ready list becomes a constant time operation regardless
+ *          of the number of ready threads.
+ *
+ * @note    This option increases the size of the system structure by
+ *          one pointer for each priority level.
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_RLIST_BITMAP                 FALSE
+
+/**
+ * @brief   Timing wheel virtual timers.
+ * @details If enabled then virtual timers are kept in a hierarchical timing
+ *          wheel instead of a sorted delta list, arming and disarming a
+ *          timer become constant time operations regardless of the number
+ *          of armed timers.
+ *
+ * @note    This option increases the size of the system structure by
+ *          two pointers for each wheel slot.
+ * @note    In tick-less mode the cascade of the upper wheel levels can
+ *          cause additional alarm events.
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_VT_WHEEL                     FALSE
+
+/**
+ * @brief   Number of levels in the virtual timers wheel.
+ * @details Each level has 32 slots, the wheel covers a range of
+ *          2^(5 * @p CH_CFG_VT_WHEEL_LEVELS) ticks, longer timers are
+ *          parked in the last level and re-evaluated there.
+ * @note    The default is 4.
+ */
+#define CH_CFG_VT_WHEEL_LEVELS              4
+
+/**
+ * @brief   Virtual timers slack.
+ * @details If enabled then virtual timers can be armed with a tolerated
+ *          expiration delay using @p chVTDoSetWithSlackI(). In tick-less
+ *          mode the alarm is delayed as much as the armed timers allow so
+ *          that timers with overlapping windows are served by a single
+ *          alarm event.
+ *
+ * @note    This option increases the size of the @p virtual_timer_t
+ *          structure by one interval.
+ * @note    In tick mode the slack is ignored.
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_VT_SLACK                     FALSE
+
+/**
+ * @brief   Virtual timers deferred callbacks.
+ * @details If enabled then virtual timers can be armed using
+ *          @p chVTDoSetDeferredI() so that their callbacks are executed by
+ *          a dedicated kernel thread instead of the timer interrupt, this
+ *          reduces the time spent in ISR context when many timers expire
+ *          together.
+ *
+ * @note    This option creates an additional kernel thread.
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_VT_DEFERRED                  FALSE
+
+/**
+ * @brief   Priority of the virtual timers thread.
+ * @note    The default is @p HIGHPRIO.
+ */
+#define CH_CFG_VT_DEFERRED_PRIO             HIGHPRIO
+
+/**
+ * @brief   Stack size of the virtual timers thread.
+ * @details The stack must be large enough for the deferred callbacks.
+ * @note    The default is 256.
+ */
+#define CH_CFG_VT_DEFERRED_STACK_SIZE       256
+
+/**
+ * @brief   Earliest deadline first scheduling class.
+ * @details If enabled then threads created with a non-zero period in
+ *          their descriptor are EDF threads, they run at the
+ *          @p CH_CFG_EDF_PRIO priority level ordered by absolute deadline
+ *          and coexist with the fixed priority threads.
+ *
+ * @note    This option increases the size of the thread structure.
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_EDF                      FALSE
+
+/**
+ * @brief   Priority level reserved to EDF threads.
+ * @details Fixed priority threads cannot be created at this level nor moved
+ *          to it, they can reach it only when boosted by the priority
+ *          inheritance of a mutex, then they run ahead of the EDF threads
+ *          until the mutex is released.
+ * @note    The default is @p HIGHPRIO minus one.
+ */
+#define CH_CFG_EDF_PRIO                     (HIGHPRIO - 1)
+
+/**
+ * @brief   Threads CPU budgets.
+ * @details If enabled then threads can be assigned a CPU budget, measured
+ *          in realtime counter cycles and replenished over a period, using
+ *          @p chBudgetSet(). A thread exhausting its budget is demoted to
+ *          the @p CH_CFG_BUDGET_PRIO priority until replenishment.
+ *
+ * @note    This option requires a port supporting the realtime counter.
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_BUDGETS                  FALSE
+
+/**
+ * @brief   Background priority of threads with an exhausted budget.
+ * @note    The default is @p LOWPRIO.
+ */
+#define CH_CFG_BUDGET_PRIO                  LOWPRIO
+
+/**
+ * @brief   Budgets enforcement check interval in system ticks.
+ * @details The budget of a running thread is verified with this interval,
+ *          a thread can exceed its budget by up to one interval.
+ * @note    The default is 1.
+ */
+#define CH_CFG_BUDGET_CHECK_INTERVAL        1
+
 /** @} */
 
 /*===========================================================================*/
@@ -155,6 +281,26 @@
  */
 #define CH_CFG_USE_TM                       TRUE
 
+/**
+ * @brief   Time Measurement histograms.
+ * @details If enabled then time measurements can also be recorded into
+ *          logarithmic-bucket histograms, kernel statistics record the
+ *          critical zones duration into histograms.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_TM_HISTOGRAMS            FALSE
+
+/**
+ * @brief   Number of buckets in time measurement histograms.
+ * @details Bucket zero counts null measurements, bucket @p i counts
+ *          measurements between 2^(i-1) and 2^i-1 cycles, the last
+ *          bucket also counts all larger measurements.
+ *
+ * @note    The default is 24.
+ */
+#define CH_CFG_TM_HISTOGRAM_BUCKETS         24
+
 /**
  * @brief   Threads registry APIs.
  * @details If enabled then the registry APIs are included in the kernel.
@@ -277,6 +423,15 @@
  */
 #define CH_CFG_USE_MAILBOXES                TRUE
 
+/**
+ * @brief   Pipes APIs.
+ * @details If enabled then the byte pipes APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_USE_PIPES                    FALSE
+
 /**
  * @brief   Core Memory Manager APIs.
  * @details If enabled then the core memory manager APIs are included
@@ -286,6 +441,17 @@
  */
 #define CH_CFG_USE_MEMCORE                  TRUE
 
+/**
+ * @brief   Core Memory Manager regions.
+ * @details If enabled then the core memory manager can also allocate from
+ *          additional memory regions, each one with its own attributes,
+ *          for example tightly coupled or non-cacheable RAM.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMCORE.
+ */
+#define CH_CFG_USE_MEMCORE_REGIONS          FALSE
+
 /**
  * @brief   Heap Allocator APIs.
  * @details If enabled then the memory heap allocator APIs are included
@@ -298,6 +464,33 @@
  */
 #define CH_CFG_USE_HEAP                     TRUE
 
+/**
+ * @brief   TLSF heap allocator.
+ * @details If enabled then the heap allocator uses a Two-Level Segregated
+ *          Fit strategy instead of first-fit, allocation and release of
+ *          blocks become constant time operations regardless of the heap
+ *          fragmentation.
+ *
+ * @note    This option increases the size of the heap structure by the
+ *          free lists table.
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_HEAP.
+ */
+#define CH_CFG_HEAP_TLSF                    FALSE
+
+/**
+ * @brief   Heap allocations profiler.
+ * @details If enabled then the heap allocations and releases are recorded
+ *          by call site, size and lifetime, the heap fragmentation can be
+ *          sampled over time. The default heap is profiled from the
+ *          system start.
+ *
+ * @note    This option adds a tag to each allocated heap block.
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_HEAP.
+ */
+#define CH_CFG_HEAP_PROFILER                FALSE
+
 /**
  * @brief   Memory Pools Allocator APIs.
  * @details If enabled then the memory pools allocator APIs are included
@@ -307,6 +500,39 @@
  */
 #define CH_CFG_USE_MEMPOOLS                 TRUE
 
+/**
+ * @brief   Memory Pools magazine caches.
+ * @details If enabled then per-thread magazines can be placed in front of
+ *          memory pools, objects are allocated and released without
+ *          locking and moved from/to the pool in batches.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#define CH_CFG_USE_POOL_MAGAZINES           FALSE
+
+/**
+ * @brief   Slab allocator APIs.
+ * @details If enabled then the slab allocator APIs are included in the
+ *          kernel, small objects are allocated from memory pools of
+ *          configurable size classes instead of the heap.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#define CH_CFG_USE_SLAB                     FALSE
+
+/**
+ * @brief   Arena allocator APIs.
+ * @details If enabled then the arena allocator APIs are included in the
+ *          kernel, blocks are allocated by advancing a pointer and are
+ *          released all together.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMCORE.
+ */
+#define CH_CFG_USE_ARENAS                   FALSE
+
 /**
  * @brief  Objects FIFOs APIs.
  * @details If enabled then the objects FIFOs APIs are included
@@ -377,6 +603,24 @@
  */
 #define CH_CFG_FACTORY_OBJ_FIFOS            TRUE
 
+/**
+ * @brief   Enables the objects names hash index.
+ * @details If enabled then the objects are also indexed by name in an open
+ *          addressing hash table, lookups, creation and release of objects
+ *          become O(1) operations on average instead of scanning the lists.
+ *
+ * @note    The default is @p FALSE.
+ */
+#define CH_CFG_FACTORY_HASH_INDEX           FALSE
+
+/**
+ * @brief   Number of slots in the objects names hash index.
+ * @details Up to 3/4 of the slots are used, objects exceeding this number
+ *          are not indexed and are found by scanning the lists.
+ * @note    It must be a power of two.
+ */
+#define CH_CFG_FACTORY_HASH_SIZE            64
+
 /** @} */
 
 /*===========================================================================*/
@@ -393,6 +637,15 @@
  */
 #define CH_DBG_STATISTICS                   FALSE
 
+/**
+ * @brief   Debug option, CPU load statistics window.
+ * @details Size in milliseconds of the sliding window used for threads,
+ *          ISRs and total CPU load computation.
+ *
+ * @note    The default is 1000.
+ */
+#define CH_DBG_STATISTICS_WINDOW            1000
+
 /**
  * @brief   Debug option, system state check.
  * @details If enabled the correct call protocol for system APIs is checked
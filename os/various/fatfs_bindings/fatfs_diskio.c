@@ -13,11 +13,18 @@
 #error "cannot specify both MMC_SPI and SDC drivers"
 #endif
 
+#if !HAL_USE_MMC_SPI && !HAL_USE_SDC && defined(SIMULATOR)
+#define FATFS_USE_SIMBLK TRUE
+#include "simblk.h"
+#endif
+
 #if !defined(FATFS_HAL_DEVICE)
 #if HAL_USE_MMC_SPI
 #define FATFS_HAL_DEVICE MMCD1
-#else
+#elif HAL_USE_SDC
 #define FATFS_HAL_DEVICE SDCD1
+#else
+#define FATFS_HAL_DEVICE SIMBLKD1
 #endif
 #endif
 
@@ -25,6 +32,8 @@
 extern MMCDriver FATFS_HAL_DEVICE;
 #elif HAL_USE_SDC
 extern SDCDriver FATFS_HAL_DEVICE;
+#elif FATFS_USE_SIMBLK
+extern SimBlockDriver FATFS_HAL_DEVICE;
 #else
 #error "MMC_SPI or SDC driver must be specified"
 #endif
@@ -38,6 +47,7 @@ extern RTCDriver RTCD1;
 
 #define MMC     0
 #define SDC     0
+#define SIMBLK  0
 
 
 
@@ -60,7 +70,7 @@ DSTATUS disk_initialize (
     if (mmcIsWriteProtected(&FATFS_HAL_DEVICE))
       stat |=  STA_PROTECT;
     return stat;
-#else
+#elif HAL_USE_SDC
   case SDC:
     stat = 0;
     /* It is initialized externally, just reads the status.*/
@@ -69,6 +79,15 @@ DSTATUS disk_initialize (
     if (sdcIsWriteProtected(&FATFS_HAL_DEVICE))
       stat |=  STA_PROTECT;
     return stat;
+#else
+  case SIMBLK:
+    stat = 0;
+    /* It is initialized externally, just reads the status.*/
+    if (blkGetDriverState(&FATFS_HAL_DEVICE) != BLK_READY)
+      stat |= STA_NOINIT;
+    if (blkIsWriteProtected(&FATFS_HAL_DEVICE))
+      stat |=  STA_PROTECT;
+    return stat;
 #endif
   }
   return STA_NOINIT;
@@ -95,7 +114,7 @@ DSTATUS disk_status (
     if (mmcIsWriteProtected(&FATFS_HAL_DEVICE))
       stat |= STA_PROTECT;
     return stat;
-#else
+#elif HAL_USE_SDC
   case SDC:
     stat = 0;
     /* It is initialized externally, just reads the status.*/
@@ -104,6 +123,15 @@ DSTATUS disk_status (
     if (sdcIsWriteProtected(&FATFS_HAL_DEVICE))
       stat |= STA_PROTECT;
     return stat;
+#else
+  case SIMBLK:
+    stat = 0;
+    /* It is initialized externally, just reads the status.*/
+    if (blkGetDriverState(&FATFS_HAL_DEVICE) != BLK_READY)
+      stat |= STA_NOINIT;
+    if (blkIsWriteProtected(&FATFS_HAL_DEVICE))
+      stat |= STA_PROTECT;
+    return stat;
 #endif
   }
   return STA_NOINIT;
@@ -137,13 +165,20 @@ DRESULT disk_read (
     if (mmcStopSequentialRead(&FATFS_HAL_DEVICE))
         return RES_ERROR;
     return RES_OK;
-#else
+#elif HAL_USE_SDC
   case SDC:
     if (blkGetDriverState(&FATFS_HAL_DEVICE) != BLK_READY)
       return RES_NOTRDY;
     if (sdcRead(&FATFS_HAL_DEVICE, sector, buff, count))
       return RES_ERROR;
     return RES_OK;
+#else
+  case SIMBLK:
+    if (blkGetDriverState(&FATFS_HAL_DEVICE) != BLK_READY)
+      return RES_NOTRDY;
+    if (blkRead(&FATFS_HAL_DEVICE, sector, buff, count))
+      return RES_ERROR;
+    return RES_OK;
 #endif
   }
   return RES_PARERR;
@@ -180,13 +215,22 @@ DRESULT disk_write (
     if (mmcStopSequentialWrite(&FATFS_HAL_DEVICE))
         return RES_ERROR;
     return RES_OK;
-#else
+#elif HAL_USE_SDC
   case SDC:
     if (blkGetDriverState(&FATFS_HAL_DEVICE) != BLK_READY)
       return RES_NOTRDY;
     if (sdcWrite(&FATFS_HAL_DEVICE, sector, buff, count))
       return RES_ERROR;
     return RES_OK;
+#else
+  case SIMBLK:
+    if (blkGetDriverState(&FATFS_HAL_DEVICE) != BLK_READY)
+      return RES_NOTRDY;
+    if (blkIsWriteProtected(&FATFS_HAL_DEVICE))
+      return RES_WRPRT;
+    if (blkWrite(&FATFS_HAL_DEVICE, sector, buff, count))
+      return RES_ERROR;
+    return RES_OK;
 #endif
   }
   return RES_PARERR;
@@ -225,7 +269,7 @@ DRESULT disk_ioctl (
     default:
         return RES_PARERR;
     }
-#else
+#elif HAL_USE_SDC
   case SDC:
     switch (cmd) {
     case CTRL_SYNC:
@@ -249,6 +293,39 @@ DRESULT disk_ioctl (
     default:
         return RES_PARERR;
     }
+#else
+  case SIMBLK:
+    switch (cmd) {
+    case CTRL_SYNC:
+        if (blkSync(&FATFS_HAL_DEVICE))
+            return RES_ERROR;
+        return RES_OK;
+    case GET_SECTOR_COUNT:
+        {
+          BlockDeviceInfo bdi;
+
+          if (blkGetInfo(&FATFS_HAL_DEVICE, &bdi))
+              return RES_ERROR;
+          *((DWORD *)buff) = bdi.blk_num;
+        }
+        return RES_OK;
+#if FF_MAX_SS > FF_MIN_SS
+    case GET_SECTOR_SIZE:
+        {
+          BlockDeviceInfo bdi;
+
+          if (blkGetInfo(&FATFS_HAL_DEVICE, &bdi))
+              return RES_ERROR;
+          *((WORD *)buff) = (WORD)bdi.blk_size;
+        }
+        return RES_OK;
+#endif
+    case GET_BLOCK_SIZE:
+        *((DWORD *)buff) = 1; /* Erase block size unknown.*/
+        return RES_OK;
+    default:
+        return RES_PARERR;
+    }
 #endif
   }
   return RES_PARERR;
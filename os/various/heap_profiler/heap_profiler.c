@@ -0,0 +1,177 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    heap_profiler.c
+ * @brief   Heap profiler report code.
+ *
+ * @addtogroup heap_profiler
+ * @{
+ */
+
+#include "ch.h"
+#include "hal.h"
+#include "chprintf.h"
+#include "heap_profiler.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Copy of the profiler data being reported.
+ */
+static heap_profiler_t hp_snapshot;
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Prints the non-empty buckets of an histogram.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ * @param[in] title     histogram title
+ * @param[in] counter   name of the counted events
+ * @param[in] hist      pointer to the histogram buckets
+ */
+static void hp_print_histogram(BaseSequentialStream *chp, const char *title,
+                               const char *counter, const ucnt_t *hist) {
+  unsigned b;
+
+  chprintf(chp, "%s\r\n  %10s %10s %10s\r\n", title, "from", "to", counter);
+  for (b = 0U; b < CH_HEAP_PROFILER_BUCKETS; b++) {
+    unsigned long low = (b == 0U) ? 0UL : (1UL << b);
+
+    if (hist[b] == (ucnt_t)0) {
+      continue;
+    }
+    if (b < (CH_HEAP_PROFILER_BUCKETS - 1U)) {
+      chprintf(chp, "  %10lu %10lu %10lu\r\n",
+               low, (2UL << b) - 1UL, (unsigned long)hist[b]);
+    }
+    else {
+      chprintf(chp, "  %10lu %10s %10lu\r\n",
+               low, "-", (unsigned long)hist[b]);
+    }
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Prints the profiler data of a heap.
+ * @details The report lists the totals, the call sites, the allocations
+ *          sizes and blocks lifetimes histograms and the fragmentation
+ *          history, oldest sample first.
+ * @note    This function is not reentrant, the data is copied in a static
+ *          buffer before printing.
+ *
+ * @param[in] chp       pointer to a @p BaseSequentialStream object
+ * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
+ *                      access the default heap.
+ * @return              The operation status.
+ * @retval false        if the report has been printed.
+ * @retval true         if the heap is not being profiled.
+ */
+bool heapProfilerReport(BaseSequentialStream *chp, memory_heap_t *heapp) {
+  const heap_profiler_t *hpp = &hp_snapshot;
+  unsigned i, n;
+
+  if (chHeapProfilerSnapshot(heapp, &hp_snapshot)) {
+    return true;
+  }
+
+  chprintf(chp, "allocs %lu, frees %lu, failures %lu, "
+           "live %lu bytes, peak %lu bytes\r\n",
+           (unsigned long)hpp->allocs, (unsigned long)hpp->frees,
+           (unsigned long)hpp->failures, (unsigned long)hpp->live,
+           (unsigned long)hpp->peak);
+
+  chprintf(chp, "  %-8s %10s %10s %10s %10s\r\n",
+           "site", "allocs", "frees", "live", "peak");
+  for (i = 0U; i < CH_HEAP_PROFILER_SITES; i++) {
+    const heap_site_t *sp = &hpp->sites[i];
+
+    if (sp->allocs == (ucnt_t)0) {
+      continue;
+    }
+    if (i < (CH_HEAP_PROFILER_SITES - 1U)) {
+      chprintf(chp, "  %08lx ", (unsigned long)(uintptr_t)sp->site);
+    }
+    else {
+      chprintf(chp, "  %-8s ", "others");
+    }
+    chprintf(chp, "%10lu %10lu %10lu %10lu\r\n",
+             (unsigned long)sp->allocs, (unsigned long)sp->frees,
+             (unsigned long)sp->live, (unsigned long)sp->peak);
+  }
+
+  hp_print_histogram(chp, "allocations by size (bytes)", "allocs",
+                     hpp->sizes);
+  hp_print_histogram(chp, "releases by lifetime (ticks)", "frees",
+                     hpp->lifetimes);
+
+  chprintf(chp, "fragmentation history\r\n  %18s %10s %10s %6s\r\n",
+           "time", "total", "largest", "index");
+  n = (hpp->nextsample + CH_HEAP_PROFILER_HISTORY - hpp->nsamples) %
+      CH_HEAP_PROFILER_HISTORY;
+  for (i = 0U; i < hpp->nsamples; i++) {
+    const heap_sample_t *smp = &hpp->history[n];
+
+    chprintf(chp, "  %18lu %10lu %10lu %3u.%u%%\r\n",
+             (unsigned long)smp->time, (unsigned long)smp->total,
+             (unsigned long)smp->largest,
+             smp->index / 10U, smp->index % 10U);
+    n = (n + 1U) % CH_HEAP_PROFILER_HISTORY;
+  }
+
+  return false;
+}
+
+/**
+ * @brief   Heap fragmentation sampler thread function.
+ * @details The thread periodically samples the fragmentation of a heap,
+ *          the samples are stored in the profiler history.
+ * @note    The thread should be created with a low priority.
+ *
+ * @param[in] p         pointer to a heap descriptor or @p NULL in order to
+ *                      sample the default heap.
+ */
+THD_FUNCTION(heapProfilerThread, p) {
+  memory_heap_t *heapp = (memory_heap_t *)p;
+
+  while (true) {
+    (void)chHeapProfilerSample(heapp);
+    chThdSleepMilliseconds(HEAP_PROFILER_INTERVAL);
+  }
+}
+
+/** @} */
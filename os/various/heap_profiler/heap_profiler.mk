@@ -0,0 +1,8 @@
+# Heap profiler report files.
+HEAPPROFSRC = $(CHIBIOS)/os/various/heap_profiler/heap_profiler.c
+
+HEAPPROFINC = $(CHIBIOS)/os/various/heap_profiler
+
+# Shared variables
+ALLCSRC += $(HEAPPROFSRC)
+ALLINC  += $(HEAPPROFINC)
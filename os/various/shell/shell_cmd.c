@@ -22,6 +22,7 @@
  * @{
  */
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "ch.h"
@@ -30,6 +31,10 @@
 #include "shell_cmd.h"
 #include "chprintf.h"
 
+#if (SHELL_CMD_HEAP_ENABLED == TRUE) || defined(__DOXYGEN__)
+#include "heap_profiler.h"
+#endif
+
 #if (SHELL_CMD_TEST_ENABLED == TRUE) || defined(__DOXYGEN__)
 #include "rt_test_root.h"
 #include "oslib_test_root.h"
@@ -171,6 +176,74 @@ static void cmd_threads(BaseSequentialStream *chp, int argc, char *argv[]) {
 }
 #endif
 
+#if (SHELL_CMD_TOP_ENABLED == TRUE) || defined(__DOXYGEN__)
+static void cmd_top(BaseSequentialStream *chp, int argc, char *argv[]) {
+  static const char *states[] = {CH_STATE_NAMES};
+  thread_t *tp;
+  int n = SHELL_CMD_TOP_ITERATIONS;
+
+  if (argc > 1) {
+    shellUsage(chp, "top [iterations]");
+    return;
+  }
+  if (argc == 1) {
+    n = atoi(argv[0]);
+  }
+  while (n-- > 0) {
+    uint32_t cpu, isr;
+
+    chSysLock();
+    cpu = chStatsGetCPULoadX();
+    isr = chStatsGetISRLoadX();
+    chSysUnlock();
+
+    /* Clearing the screen and homing the cursor.*/
+    chprintf(chp, "\033[2J\033[H");
+    chprintf(chp, "CPU: %3lu.%lu%%  ISR: %3lu.%lu%%  window: %lu ms"
+             SHELL_NEWLINE_STR SHELL_NEWLINE_STR,
+             cpu / 10U, cpu % 10U, isr / 10U, isr % 10U,
+             (uint32_t)CH_DBG_STATISTICS_WINDOW);
+    chprintf(chp, "    addr prio     state   load      kcycles name"
+             SHELL_NEWLINE_STR);
+    tp = chRegFirstThread();
+    do {
+      uint32_t load;
+      rttime_t cycles;
+
+      chSysLock();
+      load = chStatsGetThreadLoadX(tp);
+      cycles = chStatsGetThreadCyclesI(tp);
+      chSysUnlock();
+
+      chprintf(chp, "%08lx %4lu %9s %3lu.%lu%% %12lu %s"SHELL_NEWLINE_STR,
+               (uint32_t)tp, (uint32_t)tp->prio, states[tp->state],
+               load / 10U, load % 10U, (uint32_t)(cycles / 1000U),
+               tp->name == NULL ? "" : tp->name);
+      tp = chRegNextThread(tp);
+    } while (tp != NULL);
+
+    if (n > 0) {
+      chThdSleepMilliseconds(CH_DBG_STATISTICS_WINDOW);
+    }
+  }
+}
+#endif
+
+#if (SHELL_CMD_HEAP_ENABLED == TRUE) || defined(__DOXYGEN__)
+static void cmd_heap(BaseSequentialStream *chp, int argc, char *argv[]) {
+
+  (void)argv;
+  if (argc > 0) {
+    shellUsage(chp, "heap");
+    return;
+  }
+  (void)chHeapProfilerSample(NULL);
+  if (heapProfilerReport(chp, NULL)) {
+    chprintf(chp, "heap not profiled"SHELL_NEWLINE_STR);
+  }
+}
+#endif
+
 #if (SHELL_CMD_TEST_ENABLED == TRUE) || defined(__DOXYGEN__)
 static THD_FUNCTION(test_rt, arg) {
   BaseSequentialStream *chp = (BaseSequentialStream *)arg;
@@ -238,6 +311,12 @@ const ShellCommand shell_local_commands[] = {
 #if SHELL_CMD_THREADS_ENABLED == TRUE
   {"threads", cmd_threads},
 #endif
+#if SHELL_CMD_TOP_ENABLED == TRUE
+  {"top", cmd_top},
+#endif
+#if SHELL_CMD_HEAP_ENABLED == TRUE
+  {"heap", cmd_heap},
+#endif
 #if SHELL_CMD_TEST_ENABLED == TRUE
   {"test", cmd_test},
 #endif
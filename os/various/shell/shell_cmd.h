@@ -57,6 +57,18 @@
 #define SHELL_CMD_THREADS_ENABLED           TRUE
 #endif
 
+#if !defined(SHELL_CMD_TOP_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_TOP_ENABLED               FALSE
+#endif
+
+#if !defined(SHELL_CMD_TOP_ITERATIONS) || defined(__DOXYGEN__)
+#define SHELL_CMD_TOP_ITERATIONS            10
+#endif
+
+#if !defined(SHELL_CMD_HEAP_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_HEAP_ENABLED              FALSE
+#endif
+
 #if !defined(SHELL_CMD_TEST_ENABLED) || defined(__DOXYGEN__)
 #define SHELL_CMD_TEST_ENABLED              TRUE
 #endif
@@ -81,6 +93,18 @@
 #error "SHELL_CMD_THREADS_ENABLED requires CH_CFG_USE_REGISTRY"
 #endif
 
+#if (SHELL_CMD_TOP_ENABLED == TRUE) && (CH_DBG_STATISTICS == FALSE)
+#error "SHELL_CMD_TOP_ENABLED requires CH_DBG_STATISTICS"
+#endif
+
+#if (SHELL_CMD_TOP_ENABLED == TRUE) && (CH_CFG_USE_REGISTRY == FALSE)
+#error "SHELL_CMD_TOP_ENABLED requires CH_CFG_USE_REGISTRY"
+#endif
+
+#if (SHELL_CMD_HEAP_ENABLED == TRUE) && (CH_CFG_HEAP_PROFILER == FALSE)
+#error "SHELL_CMD_HEAP_ENABLED requires CH_CFG_HEAP_PROFILER"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -154,6 +154,58 @@ caddr_t _sbrk_r(struct _reent *r, int incr)
 
 /***************************************************************************/
 
+/*
+ * Allocator functions routed to the slab allocator, define
+ * SYSCALLS_USE_SLAB in the makefile in order to enable them.
+ */
+#if (CH_CFG_USE_SLAB == TRUE) && defined(SYSCALLS_USE_SLAB)
+__attribute__((used))
+void *_malloc_r(struct _reent *r, size_t size)
+{
+  void *p;
+
+  p = chSlabAlloc(size);
+  if (p == NULL) {
+    __errno_r(r) = ENOMEM;
+  }
+  return p;
+}
+
+__attribute__((used))
+void _free_r(struct _reent *r, void *p)
+{
+  (void)r;
+
+  chSlabFree(p);
+}
+
+__attribute__((used))
+void *_calloc_r(struct _reent *r, size_t n, size_t size)
+{
+  void *p;
+
+  p = chSlabCalloc(n, size);
+  if (p == NULL) {
+    __errno_r(r) = ENOMEM;
+  }
+  return p;
+}
+
+__attribute__((used))
+void *_realloc_r(struct _reent *r, void *p, size_t size)
+{
+  void *newp;
+
+  newp = chSlabRealloc(p, size);
+  if ((newp == NULL) && (size > 0U)) {
+    __errno_r(r) = ENOMEM;
+  }
+  return newp;
+}
+#endif
+
+/***************************************************************************/
+
 __attribute__((used))
 int _fstat_r(struct _reent *r, int file, struct stat * st)
 {
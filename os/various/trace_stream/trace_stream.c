@@ -0,0 +1,354 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    trace_stream.c
+ * @brief   Trace buffer streaming exporter code.
+ *
+ * @addtogroup trace_stream
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "trace_stream.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum size of an encoded record, strings excluded.
+ */
+#define TS_RECORD_MAX_SIZE          (1U + (5U * 10U))
+
+/**
+ * @brief   Realtime stamps mask, the trace buffer keeps 24 bits.
+ */
+#define TS_RT_MASK                  0x00FFFFFFU
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Encodes an unsigned integer as a LEB128 quantity.
+ *
+ * @param[out] bp       pointer to the output buffer
+ * @param[in] n         the value to be encoded
+ * @return              The number of bytes written.
+ */
+static size_t ts_put_varint(uint8_t *bp, uint64_t n) {
+  size_t i = 0U;
+
+  while (n >= 0x80U) {
+    bp[i++] = (uint8_t)(n | 0x80U);
+    n >>= 7;
+  }
+  bp[i++] = (uint8_t)n;
+
+  return i;
+}
+
+/**
+ * @brief   Writes a meta record carrying a pointer and a string.
+ *
+ * @param[in] tsp       pointer to the @p TraceStreamer object
+ * @param[in] subtype   the meta record subtype
+ * @param[in] ptr       the pointer associated to the string
+ * @param[in] s         the string
+ */
+static void ts_put_string(TraceStreamer *tsp, unsigned subtype,
+                          const void *ptr, const char *s) {
+  uint8_t buf[TS_RECORD_MAX_SIZE];
+  size_t n, len = strlen(s);
+
+  buf[0] = (uint8_t)(subtype << 4);
+  n  = 1U;
+  n += ts_put_varint(&buf[n], (uint64_t)(uintptr_t)ptr);
+  n += ts_put_varint(&buf[n], (uint64_t)len);
+  (void)streamWrite(tsp->ts_channel, buf, n);
+  (void)streamWrite(tsp->ts_channel, (const uint8_t *)s, len);
+}
+
+/**
+ * @brief   Makes sure that a string has been exported.
+ *
+ * @param[in] tsp       pointer to the @p TraceStreamer object
+ * @param[in] s         the string
+ */
+static void ts_announce_string(TraceStreamer *tsp, const char *s) {
+  unsigned i;
+
+  if (s == NULL) {
+    return;
+  }
+  for (i = 0U; i < (unsigned)TRACE_STREAM_MAX_STRINGS; i++) {
+    if (tsp->ts_strings[i] == s) {
+      return;
+    }
+  }
+  ts_put_string(tsp, TRACE_STREAM_META_STRING, s, s);
+  tsp->ts_strings[tsp->ts_nextstring] = s;
+  tsp->ts_nextstring = (tsp->ts_nextstring + 1U) %
+                       (unsigned)TRACE_STREAM_MAX_STRINGS;
+}
+
+/**
+ * @brief   Makes sure that the name of a thread has been exported.
+ * @note    Thread names are only available if the registry is enabled,
+ *          the registry is scanned so the thread is only accessed if it
+ *          still exists.
+ *
+ * @param[in] tsp       pointer to the @p TraceStreamer object
+ * @param[in] ntp       the thread
+ */
+static void ts_announce_thread(TraceStreamer *tsp, thread_t *ntp) {
+  unsigned i;
+
+  for (i = 0U; i < tsp->ts_nthreads; i++) {
+    if (tsp->ts_threads[i] == ntp) {
+      return;
+    }
+  }
+  if (tsp->ts_nthreads >= (unsigned)TRACE_STREAM_MAX_THREADS) {
+    return;
+  }
+  tsp->ts_threads[tsp->ts_nthreads++] = ntp;
+
+#if CH_CFG_USE_REGISTRY == TRUE
+  {
+    thread_t *tp = chRegFirstThread();
+
+    do {
+      if ((tp == ntp) && (tp->name != NULL)) {
+        ts_put_string(tsp, TRACE_STREAM_META_THREAD, tp, tp->name);
+      }
+      tp = chRegNextThread(tp);
+    } while (tp != NULL);
+  }
+#endif
+}
+
+/**
+ * @brief   Exports a trace record.
+ *
+ * @param[in] tsp       pointer to the @p TraceStreamer object
+ * @param[in] tep       pointer to the trace record
+ */
+static void ts_put_record(TraceStreamer *tsp, const ch_trace_event_t *tep) {
+  uint8_t buf[TS_RECORD_MAX_SIZE];
+  size_t n;
+
+  /* Names referred by the record are exported first.*/
+  switch (tep->type) {
+  case CH_TRACE_TYPE_SWITCH:
+    ts_announce_thread(tsp, tep->u.sw.ntp);
+    break;
+  case CH_TRACE_TYPE_ISR_ENTER:
+  case CH_TRACE_TYPE_ISR_LEAVE:
+    ts_announce_string(tsp, tep->u.isr.name);
+    break;
+  case CH_TRACE_TYPE_HALT:
+    ts_announce_string(tsp, tep->u.halt.reason);
+    break;
+  case CH_TRACE_TYPE_SEM:
+  case CH_TRACE_TYPE_MTX:
+  case CH_TRACE_TYPE_COND:
+    if (tep->u.obj.argp != NULL) {
+      ts_announce_thread(tsp, (thread_t *)tep->u.obj.argp);
+    }
+    break;
+  default:
+    break;
+  }
+
+  /* Header with time deltas from the previous record.*/
+  buf[0] = (uint8_t)((tep->state << 4) | tep->type);
+  n  = 1U;
+  n += ts_put_varint(&buf[n],
+                     (uint64_t)chTimeDiffX(tsp->ts_lasttime, tep->time));
+  n += ts_put_varint(&buf[n],
+                     (uint64_t)((tep->rtstamp - tsp->ts_lastrt) & TS_RT_MASK));
+  tsp->ts_lasttime = tep->time;
+  tsp->ts_lastrt   = tep->rtstamp;
+
+  /* Payload.*/
+  switch (tep->type) {
+  case CH_TRACE_TYPE_SWITCH:
+    n += ts_put_varint(&buf[n], (uint64_t)(uintptr_t)tep->u.sw.ntp);
+    n += ts_put_varint(&buf[n], (uint64_t)(uintptr_t)tep->u.sw.wtobjp);
+    break;
+  case CH_TRACE_TYPE_ISR_ENTER:
+  case CH_TRACE_TYPE_ISR_LEAVE:
+    n += ts_put_varint(&buf[n], (uint64_t)(uintptr_t)tep->u.isr.name);
+    break;
+  case CH_TRACE_TYPE_HALT:
+    n += ts_put_varint(&buf[n], (uint64_t)(uintptr_t)tep->u.halt.reason);
+    break;
+  case CH_TRACE_TYPE_USER:
+    n += ts_put_varint(&buf[n], (uint64_t)(uintptr_t)tep->u.user.up1);
+    n += ts_put_varint(&buf[n], (uint64_t)(uintptr_t)tep->u.user.up2);
+    break;
+  case CH_TRACE_TYPE_SEM:
+  case CH_TRACE_TYPE_MTX:
+  case CH_TRACE_TYPE_MBOX:
+  case CH_TRACE_TYPE_COND:
+  case CH_TRACE_TYPE_VT:
+    n += ts_put_varint(&buf[n], (uint64_t)(uintptr_t)tep->u.obj.objp);
+    n += ts_put_varint(&buf[n], (uint64_t)(uintptr_t)tep->u.obj.argp);
+    break;
+  default:
+    break;
+  }
+  (void)streamWrite(tsp->ts_channel, buf, n);
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a trace streamer object.
+ * @note    Records written in the trace buffer before this call are not
+ *          exported.
+ *
+ * @param[out] tsp      pointer to the @p TraceStreamer object
+ * @param[in] chp       pointer to the output stream
+ *
+ * @api
+ */
+void traceStreamObjectInit(TraceStreamer *tsp, BaseSequentialStream *chp) {
+  unsigned i;
+
+  tsp->ts_channel    = chp;
+  chSysLock();
+  tsp->ts_seq        = ch.dbg.trace_buffer.seq;
+  chSysUnlock();
+  tsp->ts_lasttime   = (systime_t)0;
+  tsp->ts_lastrt     = 0U;
+  tsp->ts_lost       = 0U;
+  tsp->ts_nthreads   = 0U;
+  tsp->ts_nextstring = 0U;
+  for (i = 0U; i < (unsigned)TRACE_STREAM_MAX_STRINGS; i++) {
+    tsp->ts_strings[i] = NULL;
+  }
+}
+
+/**
+ * @brief   Writes the stream header.
+ *
+ * @param[in] tsp       pointer to the @p TraceStreamer object
+ *
+ * @api
+ */
+void traceStreamStart(TraceStreamer *tsp) {
+  uint8_t buf[TS_RECORD_MAX_SIZE];
+  size_t n;
+
+  memcpy(buf, TRACE_STREAM_MAGIC, 4U);
+  buf[4] = (uint8_t)TRACE_STREAM_VERSION;
+  buf[5] = (uint8_t)(sizeof (systime_t) * 8U);
+  n  = 6U;
+  n += ts_put_varint(&buf[n], (uint64_t)CH_CFG_ST_FREQUENCY);
+  n += ts_put_varint(&buf[n], (uint64_t)TRACE_STREAM_RT_FREQUENCY);
+  (void)streamWrite(tsp->ts_channel, buf, n);
+}
+
+/**
+ * @brief   Exports the records written since the previous call.
+ * @details Records overwritten before being exported are reported in the
+ *          stream by a lost records meta record. At most a buffer worth
+ *          of records is exported in a single call.
+ *
+ * @param[in] tsp       pointer to the @p TraceStreamer object
+ * @return              The number of exported records.
+ *
+ * @api
+ */
+size_t traceStreamDrain(TraceStreamer *tsp) {
+  ch_trace_event_t te;
+  size_t n = 0U;
+
+  while (n < (size_t)CH_DBG_TRACE_BUFFER_SIZE) {
+    uint32_t seq = tsp->ts_seq;
+    bool fetched;
+
+    chSysLock();
+    fetched = chDbgFetchTraceI(&tsp->ts_seq, &te);
+    chSysUnlock();
+    if (!fetched) {
+      break;
+    }
+
+    if (tsp->ts_seq - seq > 1U) {
+      uint8_t buf[TS_RECORD_MAX_SIZE];
+      size_t i;
+      uint32_t lost = tsp->ts_seq - seq - 1U;
+
+      buf[0] = (uint8_t)(TRACE_STREAM_META_LOST << 4);
+      i  = 1U;
+      i += ts_put_varint(&buf[i], (uint64_t)lost);
+      (void)streamWrite(tsp->ts_channel, buf, i);
+      tsp->ts_lost += lost;
+    }
+
+    if (te.type != CH_TRACE_TYPE_UNUSED) {
+      ts_put_record(tsp, &te);
+      n++;
+    }
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Trace streamer thread function.
+ * @details The thread writes the stream header then periodically drains
+ *          the trace buffer until terminated, a final drain is performed
+ *          before exiting.
+ * @note    The thread should be created with a low priority.
+ *
+ * @param[in] p         pointer to an initialized @p TraceStreamer object
+ */
+THD_FUNCTION(traceStreamThread, p) {
+  TraceStreamer *tsp = (TraceStreamer *)p;
+
+  chRegSetThreadName("tracestream");
+
+  traceStreamStart(tsp);
+  while (!chThdShouldTerminateX()) {
+    (void)traceStreamDrain(tsp);
+    chThdSleepMilliseconds(TRACE_STREAM_INTERVAL);
+  }
+  (void)traceStreamDrain(tsp);
+}
+
+/** @} */
@@ -0,0 +1,170 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    trace_stream.h
+ * @brief   Trace buffer streaming exporter header.
+ *
+ * @addtogroup trace_stream
+ * @{
+ */
+
+#ifndef TRACE_STREAM_H
+#define TRACE_STREAM_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Stream format
+ * @details The stream starts with an header composed of the four bytes
+ *          magic, a version byte, the @p systime_t width in bits, the
+ *          system tick frequency and the realtime counter frequency (zero
+ *          if unknown).<br>
+ *          Each record starts with a tag byte encoding the record type in
+ *          the lower four bits and the switched out thread state, or the
+ *          object event, in the upper four bits, trace records are
+ *          followed by the system time and realtime counter deltas from
+ *          the previous record and then by the record payload. Records of
+ *          type zero are meta records, their subtype is encoded in the
+ *          state field.<br>
+ *          All integers following the header magic are unsigned LEB128
+ *          variable length quantities, pointers are exported as integers.
+ * @{
+ */
+#define TRACE_STREAM_MAGIC          "CHTR"
+#define TRACE_STREAM_VERSION        2U
+#define TRACE_STREAM_META_LOST      1U
+#define TRACE_STREAM_META_THREAD    2U
+#define TRACE_STREAM_META_STRING    3U
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Interval in milliseconds between trace buffer drains.
+ * @note    The trace buffer must be drained before it wraps around or
+ *          records are lost.
+ */
+#if !defined(TRACE_STREAM_INTERVAL) || defined(__DOXYGEN__)
+#define TRACE_STREAM_INTERVAL       10
+#endif
+
+/**
+ * @brief   Realtime counter frequency exported in the stream header.
+ * @note    Zero means unknown, the decoder then uses the system time only.
+ */
+#if !defined(TRACE_STREAM_RT_FREQUENCY) || defined(__DOXYGEN__)
+#define TRACE_STREAM_RT_FREQUENCY   0
+#endif
+
+/**
+ * @brief   Number of threads whose name is remembered as already exported.
+ */
+#if !defined(TRACE_STREAM_MAX_THREADS) || defined(__DOXYGEN__)
+#define TRACE_STREAM_MAX_THREADS    16
+#endif
+
+/**
+ * @brief   Number of strings remembered as already exported.
+ */
+#if !defined(TRACE_STREAM_MAX_STRINGS) || defined(__DOXYGEN__)
+#define TRACE_STREAM_MAX_STRINGS    16
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_DBG_TRACE_MASK == CH_DBG_TRACE_MASK_DISABLED
+#error "the trace streamer requires CH_DBG_TRACE_MASK"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Trace streamer object.
+ */
+typedef struct {
+  /**
+   * @brief   Output stream.
+   */
+  BaseSequentialStream      *ts_channel;
+  /**
+   * @brief   Sequence number of the next record to be exported.
+   */
+  uint32_t                  ts_seq;
+  /**
+   * @brief   System time of the last exported record.
+   */
+  systime_t                 ts_lasttime;
+  /**
+   * @brief   Realtime stamp of the last exported record.
+   */
+  uint32_t                  ts_lastrt;
+  /**
+   * @brief   Total number of lost records.
+   */
+  uint32_t                  ts_lost;
+  /**
+   * @brief   Threads whose name has already been exported.
+   */
+  thread_t                  *ts_threads[TRACE_STREAM_MAX_THREADS];
+  /**
+   * @brief   Number of used entries in @p ts_threads.
+   */
+  unsigned                  ts_nthreads;
+  /**
+   * @brief   Strings already exported.
+   */
+  const char                *ts_strings[TRACE_STREAM_MAX_STRINGS];
+  /**
+   * @brief   Next entry to be replaced in @p ts_strings.
+   */
+  unsigned                  ts_nextstring;
+} TraceStreamer;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void traceStreamObjectInit(TraceStreamer *tsp, BaseSequentialStream *chp);
+  void traceStreamStart(TraceStreamer *tsp);
+  size_t traceStreamDrain(TraceStreamer *tsp);
+  THD_FUNCTION(traceStreamThread, p);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* TRACE_STREAM_H */
+
+/** @} */
@@ -0,0 +1,8 @@
+# Trace streamer files.
+TRACESTREAMSRC = $(CHIBIOS)/os/various/trace_stream/trace_stream.c
+
+TRACESTREAMINC = $(CHIBIOS)/os/various/trace_stream
+
+# Shared variables
+ALLCSRC += $(TRACESTREAMSRC)
+ALLINC  += $(TRACESTREAMINC)
@@ -200,6 +200,28 @@ uint32_t TimeNowInMilliseconds(void)
     return ST2MS(t);
 }
 
+#if (CH_CFG_USE_SLAB == TRUE) && defined(WOLFSSL_USE_SLAB)
+/* Allocations are served by the slab allocator, the heap is only used
+   for the objects larger than the largest size class, define
+   WOLFSSL_USE_SLAB in the makefile in order to enable them.*/
+void *chHeapRealloc (void *addr, uint32_t size)
+{
+    return chSlabRealloc(addr, size);
+}
+
+void *chibios_alloc(void *heap, int size)
+{
+    (void)heap;
+    if (size < 0)
+        return NULL;
+    return chSlabAlloc((size_t)size);
+}
+
+void chibios_free(void *ptr)
+{
+    chSlabFree(ptr);
+}
+#else
 void *chHeapRealloc (void *addr, uint32_t size)
 {
     union heap_header *hp;
@@ -241,7 +263,9 @@ void *chHeapRealloc (void *addr, uint32_t size)
 
 void *chibios_alloc(void *heap, int size)
 {
-    return chHeapAlloc(heap, size);
+    if (size < 0)
+        return NULL;
+    return chHeapAlloc(heap, (size_t)size);
 }
 
 void chibios_free(void *ptr)
@@ -249,4 +273,5 @@ void chibios_free(void *ptr)
     if (ptr)
         chHeapFree(ptr);
 }
+#endif
 
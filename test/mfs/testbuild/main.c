@@ -0,0 +1,344 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "simflash.h"
+#include "mfs.h"
+#include "mfs_test_root.h"
+#include "console.h"
+
+/*
+ * Persistent flash image, required by the power failure test because the
+ * flash device is restarted after each failure.
+ */
+#define FLASH_IMAGE             "build/mfs_flash.bin"
+
+/*
+ * Records written by the benchmark and the power failure test.
+ */
+#define NUM_RECORDS             8
+#define RECORD_SIZE             96
+#define BENCH_WRITES            2000
+#define PF_WRITES               80
+
+/*
+ * Realtime counter frequency, the simulator counts microseconds unless
+ * the virtual time mode is enabled.
+ */
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+#define RTC_FREQUENCY           PORT_SIM_VT_FREQUENCY
+#else
+#define RTC_FREQUENCY           1000000
+#endif
+
+/*
+ * Test suite device, two 4kB sectors without latency.
+ */
+static const SimFlashConfig flashcfg_test = {
+  .path             = NULL,
+  .sectors_count    = 2U,
+  .sectors          = NULL,
+  .sectors_size     = 4096U,
+  .page_size        = 256U,
+  .granularity      = 1U,
+  .program_time     = 0U,
+  .erase_time       = 0U
+};
+
+/*
+ * Benchmark device, eight 4kB sectors with typical serial NOR latencies.
+ */
+static const SimFlashConfig flashcfg_bench = {
+  .path             = FLASH_IMAGE,
+  .sectors_count    = 8U,
+  .sectors          = NULL,
+  .sectors_size     = 4096U,
+  .page_size        = 256U,
+  .granularity      = 1U,
+  .program_time     = 500U,
+  .erase_time       = 50U
+};
+
+/*
+ * Power failure test device, benchmark geometry without latency.
+ */
+static const SimFlashConfig flashcfg_pf = {
+  .path             = FLASH_IMAGE,
+  .sectors_count    = 8U,
+  .sectors          = NULL,
+  .sectors_size     = 4096U,
+  .page_size        = 256U,
+  .granularity      = 1U,
+  .program_time     = 0U,
+  .erase_time       = 0U
+};
+
+SimFlashDriver flash;
+
+const MFSConfig mfscfg1 = {
+  .flashp           = (BaseFlash *)&flash,
+  .erased           = 0xFFFFFFFFU,
+  .bank_size        = 4096U,
+  .bank0_start      = 0U,
+  .bank0_sectors    = 1U,
+  .bank1_start      = 1U,
+  .bank1_sectors    = 1U
+};
+
+static const MFSConfig mfscfg_bench = {
+  .flashp           = (BaseFlash *)&flash,
+  .erased           = 0xFFFFFFFFU,
+  .bank_size        = 16384U,
+  .bank0_start      = 0U,
+  .bank0_sectors    = 4U,
+  .bank1_start      = 4U,
+  .bank1_sectors    = 4U
+};
+
+static uint8_t record[RECORD_SIZE];
+
+/*
+ * Generation of each record, last acknowledged write.
+ */
+static unsigned acked[NUM_RECORDS];
+
+static void record_fill(mfs_id_t id, unsigned gen) {
+  size_t i;
+
+  record[0] = (uint8_t)id;
+  record[1] = (uint8_t)gen;
+  for (i = 2U; i < sizeof record; i++) {
+    record[i] = (uint8_t)(id + gen + i);
+  }
+}
+
+static bool record_check(mfs_id_t id, size_t n, unsigned *genp) {
+  size_t i;
+
+  if ((n != sizeof record) || (record[0] != (uint8_t)id)) {
+    return false;
+  }
+  for (i = 2U; i < sizeof record; i++) {
+    if (record[i] != (uint8_t)(id + record[1] + i)) {
+      return false;
+    }
+  }
+  *genp = record[1];
+  return true;
+}
+
+static void flash_restart(const SimFlashConfig *config) {
+
+  simflashStop(&flash);
+  simflashStart(&flash, config);
+}
+
+static void flash_format(const SimFlashConfig *config) {
+
+  flash_restart(config);
+  if ((flashStartEraseAll(&flash) != FLASH_NO_ERROR) ||
+      (flashWaitErase((BaseFlash *)&flash) != FLASH_NO_ERROR)) {
+    printf("*** flash erase failed\n");
+    exit(1);
+  }
+}
+
+/*
+ * Writes records round robin, the generation of each write is the write
+ * index divided by the number of records.
+ */
+static mfs_error_t workload(unsigned writes, rtcnt_t *worstp,
+                            unsigned *gcp) {
+  unsigned i;
+
+  for (i = 0U; i < writes; i++) {
+    mfs_id_t id = (mfs_id_t)(i % NUM_RECORDS) + 1U;
+    unsigned gen = (i / NUM_RECORDS) + 1U;
+    rtcnt_t start, elapsed;
+    mfs_error_t err;
+
+    record_fill(id, gen);
+    start = chSysGetRealtimeCounterX();
+    err = mfsWriteRecord(&mfs1, id, sizeof record, record);
+    elapsed = chSysGetRealtimeCounterX() - start;
+    if (MFS_IS_ERROR(err)) {
+      return err;
+    }
+    acked[id - 1U] = gen;
+    if ((worstp != NULL) && (elapsed > *worstp)) {
+      *worstp = elapsed;
+    }
+    if ((gcp != NULL) && (err == MFS_WARN_GC)) {
+      (*gcp)++;
+    }
+  }
+  return MFS_NO_ERROR;
+}
+
+/*
+ * Mount time, write amplification and GC pauses with emulated latencies.
+ */
+static void benchmark(void) {
+  const simflash_stats_t *stats = simflashGetStatistics(&flash);
+  rtcnt_t worst = (rtcnt_t)0;
+  unsigned gcs = 0U;
+  uint64_t user_bytes = (uint64_t)BENCH_WRITES * RECORD_SIZE;
+  rtcnt_t start;
+  mfs_error_t err;
+
+  printf("*** MFS benchmark, %u writes of %u bytes on %u records\n",
+         BENCH_WRITES, RECORD_SIZE, NUM_RECORDS);
+
+  flash_format(&flashcfg_bench);
+  if (mfsStart(&mfs1, &mfscfg_bench) != MFS_NO_ERROR) {
+    printf("*** mount failed\n");
+    exit(1);
+  }
+  simflashResetStatistics(&flash);
+  if (workload(BENCH_WRITES, &worst, &gcs) != MFS_NO_ERROR) {
+    printf("*** write failed\n");
+    exit(1);
+  }
+  printf("--- Write amplification: %.2f (%llu bytes programmed, "
+         "%llu bytes erased)\n",
+         (double)stats->program_bytes / (double)user_bytes,
+         (unsigned long long)stats->program_bytes,
+         (unsigned long long)stats->erase_bytes);
+  printf("--- Garbage collections: %u, worst write time: %u us\n",
+         gcs, (unsigned)RTC2US(RTC_FREQUENCY, worst));
+
+  /* Mounting again a used partition.*/
+  mfsStop(&mfs1);
+  flash_restart(&flashcfg_bench);
+  simflashResetStatistics(&flash);
+  start = chSysGetRealtimeCounterX();
+  err = mfsStart(&mfs1, &mfscfg_bench);
+  printf("--- Mount time: %u us, %lu bytes read\n",
+         (unsigned)RTC2US(RTC_FREQUENCY,
+                          chSysGetRealtimeCounterX() - start),
+         (unsigned long)stats->read_bytes);
+  mfsStop(&mfs1);
+  if (err != MFS_NO_ERROR) {
+    printf("*** mount failed\n");
+    exit(1);
+  }
+}
+
+/*
+ * Power failures injected at each program and erase operation of a
+ * workload, after each failure the partition must mount and each record
+ * must be intact and not older than its last acknowledged write.
+ */
+static bool powerfail(void) {
+  const simflash_stats_t *stats = simflashGetStatistics(&flash);
+  uint32_t op, ops;
+  unsigned failures = 0U;
+
+  /* Finding the number of injection points.*/
+  flash_format(&flashcfg_pf);
+  (void)mfsStart(&mfs1, &mfscfg_bench);
+  simflashResetStatistics(&flash);
+  (void)workload(PF_WRITES, NULL, NULL);
+  mfsStop(&mfs1);
+  ops = stats->program_ops + stats->erase_ops;
+
+  printf("*** MFS power failure test, %u injection points\n",
+         (unsigned)ops);
+
+  for (op = 1U; op <= ops; op++) {
+    mfs_id_t id;
+    mfs_error_t err;
+
+    flash_format(&flashcfg_pf);
+    memset(acked, 0, sizeof acked);
+    (void)mfsStart(&mfs1, &mfscfg_bench);
+    simflashInjectPowerFail(&flash, op);
+    (void)workload(PF_WRITES, NULL, NULL);
+    mfsStop(&mfs1);
+
+    /* Power up.*/
+    flash_restart(&flashcfg_pf);
+    err = mfsStart(&mfs1, &mfscfg_bench);
+    if (MFS_IS_ERROR(err)) {
+      printf("--- Failure at operation %u: mount error %d\n",
+             (unsigned)op, (int)err);
+      failures++;
+      continue;
+    }
+    for (id = 1U; id <= NUM_RECORDS; id++) {
+      size_t n = sizeof record;
+      unsigned gen = 0U;
+
+      err = mfsReadRecord(&mfs1, id, &n, record);
+      if (((err == MFS_ERR_NOT_FOUND) && (acked[id - 1U] == 0U)) ||
+          ((err == MFS_NO_ERROR) && record_check(id, n, &gen) &&
+           (gen >= acked[id - 1U]))) {
+        continue;
+      }
+      printf("--- Failure at operation %u: record %u, error %d, "
+             "generation %u, acknowledged %u\n",
+             (unsigned)op, (unsigned)id, (int)err, gen, acked[id - 1U]);
+      failures++;
+    }
+    mfsStop(&mfs1);
+  }
+
+  printf("--- Result: %s\n", failures == 0U ? "SUCCESS" : "FAILURE");
+
+  return failures > 0U;
+}
+
+/*
+ * Simulator main.
+ */
+int main(int argc, char *argv[]) {
+  bool failed;
+
+  (void)argc;
+  (void)argv;
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  conInit();
+  chSysInit();
+
+  simflashObjectInit(&flash);
+  mfsObjectInit(&mfs1);
+
+  simflashStart(&flash, &flashcfg_test);
+  test_execute((BaseSequentialStream *)&CD1, &mfs_test_suite);
+  failed = test_global_fail;
+
+  benchmark();
+  failed |= powerfail();
+
+  simflashStop(&flash);
+  if (failed)
+    exit(1);
+  else
+    exit(0);
+}
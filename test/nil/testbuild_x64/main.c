@@ -0,0 +1,75 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include <stdlib.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "nil_test_root.h"
+#include "oslib_test_root.h"
+#include "console.h"
+
+/*
+ * Tester thread.
+ */
+static THD_WORKING_AREA(waThread1, 256);
+static THD_FUNCTION(Thread1, arg) {
+
+  (void)arg;
+
+  test_execute((BaseSequentialStream *)&CD1, &nil_test_suite);
+  test_execute((BaseSequentialStream *)&CD1, &oslib_test_suite);
+  if (test_global_fail)
+    exit(1);
+  else
+    exit(0);
+}
+
+/*
+ * Threads static table, one entry per thread. The number of entries must
+ * match NIL_CFG_NUM_THREADS.
+ */
+THD_TABLE_BEGIN
+  THD_TABLE_ENTRY(wa_test_support, "test_support", test_support, (void *)&nil.threads[1])
+  THD_TABLE_ENTRY(waThread1, "tester", Thread1, NULL)
+THD_TABLE_END
+
+/*
+ * Simulator main.
+ */
+int main(int argc, char *argv[]) {
+
+  (void)argc;
+  (void)argv;
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  conInit();
+  chSysInit();
+
+  /* This is now the idle thread loop, the host process sleeps until the
+     next simulated interrupt.*/
+  while (true) {
+    port_wait_for_interrupt();
+  }
+}
@@ -3,7 +3,8 @@ TESTSRC += ${CHIBIOS}/test/oslib/source/test/oslib_test_root.c \
            ${CHIBIOS}/test/oslib/source/test/oslib_test_sequence_001.c \
            ${CHIBIOS}/test/oslib/source/test/oslib_test_sequence_002.c \
            ${CHIBIOS}/test/oslib/source/test/oslib_test_sequence_003.c \
-           ${CHIBIOS}/test/oslib/source/test/oslib_test_sequence_004.c
+           ${CHIBIOS}/test/oslib/source/test/oslib_test_sequence_004.c \
+           ${CHIBIOS}/test/oslib/source/test/oslib_test_sequence_005.c
 
 # Required include directories
 TESTINC += ${CHIBIOS}/test/oslib/source/test
@@ -39,6 +39,8 @@
  * - @subpage oslib_test_002_001
  * - @subpage oslib_test_002_002
  * - @subpage oslib_test_002_003
+ * - @subpage oslib_test_002_004
+ * - @subpage oslib_test_002_005
  * .
  */
 
@@ -50,11 +52,31 @@
 
 #define MEMORY_POOL_SIZE 4
 
-static uint32_t objects[MEMORY_POOL_SIZE];
-static MEMORYPOOL_DECL(mp1, sizeof (uint32_t), PORT_NATURAL_ALIGN, NULL);
+static void *objects[MEMORY_POOL_SIZE];
+static MEMORYPOOL_DECL(mp1, sizeof (void *), PORT_NATURAL_ALIGN, NULL);
 
 #if CH_CFG_USE_SEMAPHORES
-static GUARDEDMEMORYPOOL_DECL(gmp1, sizeof (uint32_t), PORT_NATURAL_ALIGN);
+static GUARDEDMEMORYPOOL_DECL(gmp1, sizeof (void *), PORT_NATURAL_ALIGN);
+#endif
+
+#if CH_CFG_USE_POOL_MAGAZINES
+#define MAGAZINE_POOL_SIZE (CH_POOL_MAGAZINE_SIZE * 2U)
+
+static void *mag_objects[MAGAZINE_POOL_SIZE];
+static pool_magazine_t mag1;
+#endif
+
+#if CH_CFG_USE_SLAB
+static const size_t slab_test_sizes[] = {
+  1, 8, 16, 17, 100,
+#if CH_CFG_USE_HEAP
+  4096
+#endif
+};
+
+#define SLAB_TEST_SIZES (sizeof slab_test_sizes / sizeof slab_test_sizes[0])
+
+static void *slab_objects[SLAB_TEST_SIZES];
 #endif
 
 static void *null_provider(size_t size, unsigned align) {
@@ -89,7 +111,7 @@ static void *null_provider(size_t size, unsigned align) {
  */
 
 static void oslib_test_002_001_setup(void) {
-  chPoolObjectInit(&mp1, sizeof (uint32_t), NULL);
+  chPoolObjectInit(&mp1, sizeof (void *), NULL);
 }
 
 static void oslib_test_002_001_execute(void) {
@@ -138,7 +160,7 @@ static void oslib_test_002_001_execute(void) {
      more memory.*/
   test_set_step(7);
   {
-    chPoolObjectInit(&mp1, sizeof (uint32_t), null_provider);
+    chPoolObjectInit(&mp1, sizeof (void *), null_provider);
     test_assert(chPoolAlloc(&mp1) == NULL, "provider returned memory");
   }
 }
@@ -176,7 +198,7 @@ static const testcase_t oslib_test_002_001 = {
  */
 
 static void oslib_test_002_002_setup(void) {
-  chGuardedPoolObjectInit(&gmp1, sizeof (uint32_t));
+  chGuardedPoolObjectInit(&gmp1, sizeof (void *));
 }
 
 static void oslib_test_002_002_execute(void) {
@@ -253,7 +275,7 @@ static const testcase_t oslib_test_002_002 = {
  */
 
 static void oslib_test_002_003_setup(void) {
-  chGuardedPoolObjectInit(&gmp1, sizeof (uint32_t));
+  chGuardedPoolObjectInit(&gmp1, sizeof (void *));
 }
 
 static void oslib_test_002_003_execute(void) {
@@ -274,6 +296,202 @@ static const testcase_t oslib_test_002_003 = {
 };
 #endif /* CH_CFG_USE_SEMAPHORES */
 
+#if (CH_CFG_USE_POOL_MAGAZINES) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_002_004 [2.4] Memory pool magazines
+ *
+ * <h2>Description</h2>
+ * Objects are allocated and released through a magazine, refills and
+ * flushes are checked using the magazine statistics.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_POOL_MAGAZINES
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.4.1] Loading the pool with twice the magazine size objects, the
+ *   first allocation refills the magazine with a batch of objects.
+ * - [2.4.2] Emptying the pool through the magazine, now must be empty.
+ * - [2.4.3] Releasing the objects through the magazine, the exceeding
+ *   objects are flushed to the pool in batches.
+ * - [2.4.4] Flushing the magazine, all the objects must be back in the
+ *   pool.
+ * .
+ */
+
+static void oslib_test_002_004_setup(void) {
+  chPoolObjectInit(&mp1, sizeof (void *), NULL);
+}
+
+static void oslib_test_002_004_execute(void) {
+  unsigned i;
+  const pool_magazine_stats_t *stats = chPoolMagazineGetStatisticsX(&mag1);
+
+  /* [2.4.1] Loading the pool with twice the magazine size objects, the first
+     allocation refills the magazine with a batch of objects.*/
+  test_set_step(1);
+  {
+    chPoolLoadArray(&mp1, mag_objects, MAGAZINE_POOL_SIZE);
+    chPoolMagazineObjectInit(&mag1, &mp1);
+    test_assert(chPoolMagazineAlloc(&mag1) != NULL, "list empty");
+    test_assert(stats->alloc_misses == 1U, "refill not counted");
+    test_assert(stats->refilled == CH_POOL_MAGAZINE_BATCH, "wrong batch size");
+  }
+
+  /* [2.4.2] Emptying the pool through the magazine, now must be empty.*/
+  test_set_step(2);
+  {
+    for (i = 1; i < MAGAZINE_POOL_SIZE; i++)
+      test_assert(chPoolMagazineAlloc(&mag1) != NULL, "list empty");
+    test_assert(chPoolMagazineAlloc(&mag1) == NULL, "list not empty");
+    test_assert(stats->refilled == MAGAZINE_POOL_SIZE, "objects lost");
+    test_assert(stats->alloc_hits + stats->alloc_misses == MAGAZINE_POOL_SIZE + 1U,
+                "wrong statistics");
+  }
+
+  /* [2.4.3] Releasing the objects through the magazine, the exceeding
+     objects are flushed to the pool in batches.*/
+  test_set_step(3);
+  {
+    for (i = 0; i < MAGAZINE_POOL_SIZE; i++)
+      chPoolMagazineFree(&mag1, &mag_objects[i]);
+    test_assert(stats->free_misses > 0U, "no flush");
+    test_assert(stats->flushed == stats->free_misses * CH_POOL_MAGAZINE_BATCH,
+                "wrong batch size");
+    test_assert(stats->free_hits + stats->free_misses == MAGAZINE_POOL_SIZE,
+                "wrong statistics");
+  }
+
+  /* [2.4.4] Flushing the magazine, all the objects must be back in the
+     pool.*/
+  test_set_step(4);
+  {
+    chPoolMagazineFlush(&mag1);
+    test_assert(stats->flushed == MAGAZINE_POOL_SIZE, "objects lost");
+    for (i = 0; i < MAGAZINE_POOL_SIZE; i++)
+      test_assert(chPoolAlloc(&mp1) != NULL, "list empty");
+    test_assert(chPoolAlloc(&mp1) == NULL, "list not empty");
+  }
+}
+
+static const testcase_t oslib_test_002_004 = {
+  "Memory pool magazines",
+  oslib_test_002_004_setup,
+  NULL,
+  oslib_test_002_004_execute
+};
+#endif /* CH_CFG_USE_POOL_MAGAZINES */
+
+#if (CH_CFG_USE_SLAB) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_002_005 [2.5] Slab allocator
+ *
+ * <h2>Description</h2>
+ * Objects of different sizes are allocated, resized and released using
+ * the slab allocator.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_SLAB
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.5.1] Allocating objects of different sizes, the usable size must
+ *   not be smaller than the requested size and the objects must be
+ *   aligned.
+ * - [2.5.2] Releasing the objects served by the size classes and
+ *   allocating them again, the same objects must be returned.
+ * - [2.5.3] Testing chSlabRealloc(), the content must be preserved when
+ *   the object is moved.
+ * - [2.5.4] Testing chSlabCalloc(), the object must be zero filled and
+ *   overflows must be detected.
+ * - [2.5.5] Releasing all the objects.
+ * .
+ */
+
+static void oslib_test_002_005_execute(void) {
+  unsigned i;
+
+  /* [2.5.1] Allocating objects of different sizes, the usable size must not
+     be smaller than the requested size and the objects must be aligned.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < SLAB_TEST_SIZES; i++) {
+      slab_objects[i] = chSlabAlloc(slab_test_sizes[i]);
+      test_assert(slab_objects[i] != NULL, "allocation failed");
+      test_assert(chSlabGetSize(slab_objects[i]) >= slab_test_sizes[i],
+                  "wrong usable size");
+      test_assert(MEM_IS_ALIGNED(slab_objects[i], CH_SLAB_ALIGNMENT),
+                  "unaligned object");
+    }
+  }
+
+  /* [2.5.2] Releasing the objects served by the size classes and allocating
+     them again, the same objects must be returned.*/
+  test_set_step(2);
+  {
+    for (i = 0; i < 5; i++) {
+      void *p = slab_objects[i];
+
+      chSlabFree(p);
+      slab_objects[i] = chSlabAlloc(slab_test_sizes[i]);
+      test_assert(slab_objects[i] == p, "different object");
+    }
+  }
+
+  /* [2.5.3] Testing chSlabRealloc(), the content must be preserved when the
+     object is moved.*/
+  test_set_step(3);
+  {
+    void *p;
+
+    *(uint8_t *)slab_objects[0] = 0x55U;
+    p = chSlabRealloc(slab_objects[0], chSlabGetSize(slab_objects[0]));
+    test_assert(p == slab_objects[0], "object moved");
+    p = chSlabRealloc(p, chSlabGetSize(p) + 1U);
+    test_assert(p != NULL, "allocation failed");
+    test_assert(p != slab_objects[0], "object not moved");
+    test_assert(*(uint8_t *)p == 0x55U, "content lost");
+    slab_objects[0] = p;
+    test_assert(chSlabRealloc(p, 0U) == NULL, "object not freed");
+    slab_objects[0] = NULL;
+  }
+
+  /* [2.5.4] Testing chSlabCalloc(), the object must be zero filled and
+     overflows must be detected.*/
+  test_set_step(4);
+  {
+    uint8_t *p;
+
+    p = chSlabCalloc(4U, 8U);
+    test_assert(p != NULL, "allocation failed");
+    for (i = 0; i < 32U; i++) {
+      test_assert(p[i] == 0U, "not zero filled");
+    }
+    chSlabFree(p);
+    test_assert(chSlabCalloc((size_t)-1, 2U) == NULL, "overflow not detected");
+  }
+
+  /* [2.5.5] Releasing all the objects.*/
+  test_set_step(5);
+  {
+    for (i = 0; i < SLAB_TEST_SIZES; i++) {
+      chSlabFree(slab_objects[i]);
+    }
+  }
+}
+
+static const testcase_t oslib_test_002_005 = {
+  "Slab allocator",
+  NULL,
+  NULL,
+  oslib_test_002_005_execute
+};
+#endif /* CH_CFG_USE_SLAB */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -288,6 +506,12 @@ const testcase_t * const oslib_test_sequence_002_array[] = {
 #endif
 #if (CH_CFG_USE_SEMAPHORES) || defined(__DOXYGEN__)
   &oslib_test_002_003,
+#endif
+#if (CH_CFG_USE_POOL_MAGAZINES) || defined(__DOXYGEN__)
+  &oslib_test_002_004,
+#endif
+#if (CH_CFG_USE_SLAB) || defined(__DOXYGEN__)
+  &oslib_test_002_005,
 #endif
   NULL
 };
@@ -38,6 +38,9 @@
  * <h2>Test Cases</h2>
  * - @subpage oslib_test_003_001
  * - @subpage oslib_test_003_002
+ * - @subpage oslib_test_003_003
+ * - @subpage oslib_test_003_004
+ * - @subpage oslib_test_003_005
  * .
  */
 
@@ -48,11 +51,40 @@
  ****************************************************************************/
 
 #define ALLOC_SIZE 16
+#if CH_CFG_HEAP_PROFILER
+/* Room for the profiler tags.*/
+#define HEAP_SIZE (ALLOC_SIZE * 16)
+#else
 #define HEAP_SIZE (ALLOC_SIZE * 8)
+#endif
 
 static memory_heap_t test_heap;
 static uint8_t test_heap_buffer[HEAP_SIZE];
 
+#if CH_CFG_USE_MEMCORE_REGIONS
+#define REGION_SIZE (HEAP_SIZE * 4)
+#define REGION_CONTAINS(p)                                                  \
+  (((uint8_t *)(p) >= &test_region_buffer[0]) &&                            \
+   ((uint8_t *)(p) < &test_region_buffer[REGION_SIZE]))
+
+static memory_region_t test_region;
+static uint8_t test_region_buffer[REGION_SIZE];
+#endif
+
+#if CH_CFG_USE_ARENAS
+#define ARENA_CONTAINS(p)                                                   \
+  (((uint8_t *)(p) >= &test_arena_buffer[0]) &&                             \
+   ((uint8_t *)(p) < &test_arena_buffer[HEAP_SIZE]))
+
+static memory_arena_t test_arena;
+static uint8_t test_arena_buffer[HEAP_SIZE];
+#endif
+
+#if CH_CFG_HEAP_PROFILER
+static heap_profiler_t test_profiler;
+static uint8_t test_profiler_buffer[HEAP_SIZE * 4];
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -256,6 +288,382 @@ static const testcase_t oslib_test_003_002 = {
   oslib_test_003_002_execute
 };
 
+#if ((CH_CFG_USE_MEMCORE_REGIONS == TRUE) && (CH_CFG_USE_MEMPOOLS == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_003_003 [3.3] Memory regions
+ *
+ * <h2>Description</h2>
+ * An additional memory region is registered, blocks are allocated from
+ * the region directly, using placement hints, from an heap and from a
+ * memory pool placed in the region.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_MEMCORE_REGIONS == TRUE) && (CH_CFG_USE_MEMPOOLS == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [3.3.1] Looking up the test region by name, unknown names must not
+ *   be found.
+ * - [3.3.2] Allocating from the region, the block must be aligned and
+ *   placed in the region, an allocation larger than the region must
+ *   fail.
+ * - [3.3.3] Allocating using placement hints, the region must serve
+ *   requests for fast memory and requests with attributes not provided
+ *   by any region must fail.
+ * - [3.3.4] Initializing a heap in the region, the allocated blocks must
+ *   be placed in the region.
+ * - [3.3.5] Loading a memory pool from the region, the objects must be
+ *   placed in the region.
+ * .
+ */
+
+static void oslib_test_003_003_setup(void) {
+  if (chCoreFindRegion("test") == NULL) {
+    chCoreAddRegion(&test_region, "test",
+                    test_region_buffer, sizeof test_region_buffer,
+                    CH_MEM_ATTR_FAST | CH_MEM_ATTR_NOCACHE);
+  }
+
+  /* The region memory is reclaimed on each execution.*/
+  test_region.nextmem = test_region_buffer;
+}
+
+static void oslib_test_003_003_execute(void) {
+  memory_pool_t mp;
+  size_t n;
+  void *p;
+
+  /* [3.3.1] Looking up the test region by name, unknown names must not be
+     found.*/
+  test_set_step(1);
+  {
+    test_assert(chCoreFindRegion("test") == &test_region, "region not found");
+    test_assert(chCoreFindRegion("none") == NULL, "unexpected region");
+  }
+
+  /* [3.3.2] Allocating from the region, the block must be aligned and placed
+     in the region, an allocation larger than the region must fail.*/
+  test_set_step(2);
+  {
+    n = chCoreGetRegionStatusX(&test_region);
+    p = chCoreAllocFromRegionAligned(&test_region, ALLOC_SIZE, 16U);
+    test_assert(p != NULL, "allocation failed");
+    test_assert(REGION_CONTAINS(p), "not in region");
+    test_assert(MEM_IS_ALIGNED(p, 16U), "unaligned block");
+    test_assert(chCoreGetRegionStatusX(&test_region) <= n - ALLOC_SIZE,
+                "wrong free memory");
+    p = chCoreAllocFromRegionAligned(&test_region, REGION_SIZE, 1U);
+    test_assert(p == NULL, "allocation not failed");
+  }
+
+  /* [3.3.3] Allocating using placement hints, the region must serve requests
+     for fast memory and requests with attributes not provided by any region
+     must fail.*/
+  test_set_step(3);
+  {
+    p = chCoreAllocHintAligned(ALLOC_SIZE, PORT_NATURAL_ALIGN,
+                               CH_MEM_ATTR_FAST);
+    test_assert(p != NULL, "allocation failed");
+    test_assert(REGION_CONTAINS(p), "not in region");
+    p = chCoreAllocHintAligned(ALLOC_SIZE, PORT_NATURAL_ALIGN,
+                               CH_MEM_ATTR_FAST | CH_MEM_ATTR_DMA);
+    test_assert(p == NULL, "allocation not failed");
+  }
+
+  /* [3.3.4] Initializing a heap in the region, the allocated blocks must be
+     placed in the region.*/
+  test_set_step(4);
+  {
+    test_assert(chHeapObjectInitFromRegion(&test_heap, &test_region,
+                                           HEAP_SIZE) == false,
+                "heap not initialized");
+    p = chHeapAlloc(&test_heap, ALLOC_SIZE);
+    test_assert(p != NULL, "allocation failed");
+    test_assert(REGION_CONTAINS(p), "not in region");
+    chHeapFree(p);
+    test_assert(chHeapObjectInitFromRegion(&test_heap, &test_region,
+                                           REGION_SIZE) == true,
+                "heap initialized");
+  }
+
+  /* [3.3.5] Loading a memory pool from the region, the objects must be
+     placed in the region.*/
+  test_set_step(5);
+  {
+    chPoolObjectInit(&mp, ALLOC_SIZE, NULL);
+    test_assert(chPoolLoadFromRegion(&mp, &test_region, 4U) == false,
+                "pool not loaded");
+    for (n = 0U; n < 4U; n++) {
+      p = chPoolAlloc(&mp);
+      test_assert(p != NULL, "allocation failed");
+      test_assert(REGION_CONTAINS(p), "not in region");
+    }
+    test_assert(chPoolAlloc(&mp) == NULL, "pool not empty");
+  }
+}
+
+static const testcase_t oslib_test_003_003 = {
+  "Memory regions",
+  oslib_test_003_003_setup,
+  NULL,
+  oslib_test_003_003_execute
+};
+#endif /* (CH_CFG_USE_MEMCORE_REGIONS == TRUE) && (CH_CFG_USE_MEMPOOLS == TRUE) */
+
+#if (CH_CFG_USE_ARENAS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_003_004 [3.4] Arena allocator
+ *
+ * <h2>Description</h2>
+ * Blocks are allocated from arenas on a static buffer and on the default
+ * heap, then released using marks and resets.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_ARENAS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [3.4.1] Initializing an arena on a static buffer, the blocks must be
+ *   aligned and placed in the buffer, the used memory must grow
+ *   accordingly.
+ * - [3.4.2] Taking nested marks and restoring them, the blocks allocated
+ *   after each mark must be released.
+ * - [3.4.3] Resetting the arena, all the blocks must be released and the
+ *   peak usage must be retained.
+ * - [3.4.4] Initializing a growing arena on the default heap, allocating
+ *   more than the first chunk must obtain more chunks, the chunks must
+ *   be reused after a reset and returned to the heap on disposal.
+ * .
+ */
+
+static void oslib_test_003_004_execute(void) {
+  arena_mark_t m1, m2;
+  void *p0, *p1, *p2;
+  size_t used;
+  unsigned i;
+
+  /* [3.4.1] Initializing an arena on a static buffer, the blocks must be
+     aligned and placed in the buffer, the used memory must grow
+     accordingly.*/
+  test_set_step(1);
+  {
+    chArenaObjectInit(&test_arena, test_arena_buffer,
+                      sizeof test_arena_buffer);
+    test_assert(chArenaGetUsedX(&test_arena) == 0U, "arena not empty");
+    p1 = chArenaAlloc(&test_arena, 1U);
+    test_assert(p1 != NULL, "allocation failed");
+    p0 = p1;
+    p2 = chArenaAlloc(&test_arena, 1U);
+    test_assert(p2 != NULL, "allocation failed");
+    test_assert(MEM_IS_ALIGNED(p2, PORT_NATURAL_ALIGN), "unaligned block");
+    test_assert((uint8_t *)p2 == (uint8_t *)p1 + PORT_NATURAL_ALIGN,
+                "not contiguous");
+    test_assert(ARENA_CONTAINS(p1) && ARENA_CONTAINS(p2), "not in buffer");
+    test_assert(chArenaGetUsedX(&test_arena) == PORT_NATURAL_ALIGN + 1U,
+                "wrong used memory");
+    test_assert(chArenaAlloc(&test_arena, sizeof test_arena_buffer) == NULL,
+                "allocation not failed");
+    test_assert(chArenaGetStatisticsX(&test_arena)->failures == 1U,
+                "failure not counted");
+  }
+
+  /* [3.4.2] Taking nested marks and restoring them, the blocks allocated
+     after each mark must be released.*/
+  test_set_step(2);
+  {
+    used = chArenaGetUsedX(&test_arena);
+    chArenaSaveX(&test_arena, &m1);
+    p1 = chArenaAlloc(&test_arena, ALLOC_SIZE);
+    chArenaSaveX(&test_arena, &m2);
+    p2 = chArenaAlloc(&test_arena, ALLOC_SIZE);
+    test_assert((p1 != NULL) && (p2 != NULL), "allocation failed");
+    chArenaRestore(&test_arena, &m2);
+    test_assert(chArenaAlloc(&test_arena, ALLOC_SIZE) == p2, "not released");
+    chArenaRestore(&test_arena, &m1);
+    test_assert(chArenaGetUsedX(&test_arena) == used, "wrong used memory");
+    test_assert(chArenaAlloc(&test_arena, ALLOC_SIZE) == p1, "not released");
+  }
+
+  /* [3.4.3] Resetting the arena, all the blocks must be released and the
+     peak usage must be retained.*/
+  test_set_step(3);
+  {
+    used = chArenaGetUsedX(&test_arena);
+    chArenaReset(&test_arena);
+    test_assert(chArenaGetUsedX(&test_arena) == 0U, "arena not empty");
+    test_assert(chArenaGetStatisticsX(&test_arena)->peak >= used,
+                "wrong peak");
+    test_assert(chArenaAlloc(&test_arena, 1U) == p0, "not released");
+  }
+
+  /* [3.4.4] Initializing a growing arena on the default heap, allocating
+     more than the first chunk must obtain more chunks, the chunks must be
+     reused after a reset and returned to the heap on disposal.*/
+  test_set_step(4);
+  {
+    test_assert(chArenaObjectInitFromHeap(&test_arena, NULL, ALLOC_SIZE * 2U,
+                                          ALLOC_SIZE * 2U) == false,
+                "arena not initialized");
+    for (i = 0U; i < 8U; i++) {
+      test_assert(chArenaAlloc(&test_arena, ALLOC_SIZE) != NULL,
+                  "allocation failed");
+    }
+    test_assert(chArenaGetStatisticsX(&test_arena)->chunks == 4U,
+                "wrong chunks number");
+    chArenaReset(&test_arena);
+    for (i = 0U; i < 8U; i++) {
+      test_assert(chArenaAlloc(&test_arena, ALLOC_SIZE) != NULL,
+                  "allocation failed");
+    }
+    test_assert(chArenaGetStatisticsX(&test_arena)->chunks == 4U,
+                "chunks not reused");
+    chArenaDispose(&test_arena);
+  }
+}
+
+static const testcase_t oslib_test_003_004 = {
+  "Arena allocator",
+  NULL,
+  NULL,
+  oslib_test_003_004_execute
+};
+#endif /* CH_CFG_USE_ARENAS == TRUE */
+
+#if (CH_CFG_HEAP_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_003_005 [3.5] Heap profiler
+ *
+ * <h2>Description</h2>
+ * A heap is profiled while blocks are allocated and released, the call
+ * sites, histograms, fragmentation samples and failures are checked.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_HEAP_PROFILER == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [3.5.1] Allocating blocks from two call sites, the allocations must
+ *   be recorded by call site and by size.
+ * - [3.5.2] Releasing the blocks, the releases must be recorded by call
+ *   site and by lifetime, the peak memory must be retained.
+ * - [3.5.3] Sampling the fragmentation, the index must be zero if the
+ *   free memory is contiguous and not zero if there is an hole, the
+ *   samples must be stored.
+ * - [3.5.4] Failed allocations must be recorded, after stopping the
+ *   profiler the allocations must not be recorded.
+ * .
+ */
+
+static void oslib_test_003_005_setup(void) {
+  chHeapObjectInit(&test_heap, test_profiler_buffer,
+                   sizeof test_profiler_buffer);
+  chHeapProfilerStart(&test_heap, &test_profiler);
+}
+
+static void oslib_test_003_005_execute(void) {
+  void *p[3];
+  ucnt_t n;
+  unsigned i;
+
+  /* [3.5.1] Allocating blocks from two call sites, the allocations must be
+     recorded by call site and by size.*/
+  test_set_step(1);
+  {
+    for (i = 0U; i < 2U; i++) {
+      p[i] = chHeapAllocAligned(&test_heap, ALLOC_SIZE, CH_HEAP_ALIGNMENT);
+      test_assert(p[i] != NULL, "allocation failed");
+    }
+    p[2] = chHeapAllocAligned(&test_heap, ALLOC_SIZE * 2U, CH_HEAP_ALIGNMENT);
+    test_assert(p[2] != NULL, "allocation failed");
+    test_assert(test_profiler.allocs == 3U, "wrong allocations counter");
+    test_assert(test_profiler.live == ALLOC_SIZE * 4U, "wrong live memory");
+    test_assert((test_profiler.sizes[4] == 2U) &&
+                (test_profiler.sizes[5] == 1U),
+                "wrong sizes histogram");
+    n = 0U;
+    for (i = 0U; i < CH_HEAP_PROFILER_SITES; i++) {
+      n += test_profiler.sites[i].allocs;
+    }
+    test_assert(n == 3U, "wrong call sites");
+#if defined(__GNUC__)
+    test_assert(test_profiler.sites[1].allocs > 0U, "single call site");
+#endif
+  }
+
+  /* [3.5.2] Releasing the blocks, the releases must be recorded by call site
+     and by lifetime, the peak memory must be retained.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i < 3U; i++) {
+      chHeapFree(p[i]);
+    }
+    test_assert(test_profiler.frees == 3U, "wrong releases counter");
+    test_assert(test_profiler.live == 0U, "wrong live memory");
+    test_assert(test_profiler.peak == ALLOC_SIZE * 4U, "wrong peak memory");
+    for (i = 0U; i < CH_HEAP_PROFILER_SITES; i++) {
+      test_assert((test_profiler.sites[i].frees ==
+                   test_profiler.sites[i].allocs) &&
+                  (test_profiler.sites[i].live == 0U),
+                  "wrong call site counters");
+    }
+    n = 0U;
+    for (i = 0U; i < CH_HEAP_PROFILER_BUCKETS; i++) {
+      n += test_profiler.lifetimes[i];
+    }
+    test_assert(n == 3U, "wrong lifetimes histogram");
+  }
+
+  /* [3.5.3] Sampling the fragmentation, the index must be zero if the free
+     memory is contiguous and not zero if there is an hole, the samples must
+     be stored.*/
+  test_set_step(3);
+  {
+    test_assert(chHeapProfilerSample(&test_heap) == 0U, "fragmented");
+    for (i = 0U; i < 3U; i++) {
+      p[i] = chHeapAllocAligned(&test_heap, ALLOC_SIZE, CH_HEAP_ALIGNMENT);
+      test_assert(p[i] != NULL, "allocation failed");
+    }
+    chHeapFree(p[1]);
+    test_assert(chHeapProfilerSample(&test_heap) > 0U, "not fragmented");
+    test_assert(test_profiler.nsamples == 2U, "samples not stored");
+    test_assert(test_profiler.history[1].index > 0U, "wrong sample");
+    chHeapFree(p[0]);
+    chHeapFree(p[2]);
+  }
+
+  /* [3.5.4] Failed allocations must be recorded, after stopping the profiler
+     the allocations must not be recorded.*/
+  test_set_step(4);
+  {
+    test_assert(chHeapAllocAligned(&test_heap, sizeof test_profiler_buffer,
+                                   CH_HEAP_ALIGNMENT) == NULL,
+                "allocation not failed");
+    test_assert(test_profiler.failures == 1U, "failure not recorded");
+    n = test_profiler.allocs;
+    chHeapProfilerStop(&test_heap);
+    p[0] = chHeapAllocAligned(&test_heap, ALLOC_SIZE, CH_HEAP_ALIGNMENT);
+    test_assert(p[0] != NULL, "allocation failed");
+    chHeapFree(p[0]);
+    test_assert(test_profiler.allocs == n, "allocation recorded");
+    test_assert(chHeapProfilerSnapshot(&test_heap, &test_profiler) == true,
+                "heap still profiled");
+  }
+}
+
+static const testcase_t oslib_test_003_005 = {
+  "Heap profiler",
+  oslib_test_003_005_setup,
+  NULL,
+  oslib_test_003_005_execute
+};
+#endif /* CH_CFG_HEAP_PROFILER == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -266,6 +674,15 @@ static const testcase_t oslib_test_003_002 = {
 const testcase_t * const oslib_test_sequence_003_array[] = {
   &oslib_test_003_001,
   &oslib_test_003_002,
+#if ((CH_CFG_USE_MEMCORE_REGIONS == TRUE) && (CH_CFG_USE_MEMPOOLS == TRUE)) || defined(__DOXYGEN__)
+  &oslib_test_003_003,
+#endif
+#if (CH_CFG_USE_ARENAS == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_003_004,
+#endif
+#if (CH_CFG_HEAP_PROFILER == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_003_005,
+#endif
   NULL
 };
 
@@ -41,6 +41,7 @@
  * - @subpage oslib_test_004_003
  * - @subpage oslib_test_004_004
  * - @subpage oslib_test_004_005
+ * - @subpage oslib_test_004_006
  * .
  */
 
@@ -50,6 +51,28 @@
  * Shared code.
  ****************************************************************************/
 
+#if (CH_CFG_FACTORY_HASH_INDEX == TRUE) &&                                  \
+    (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) &&                            \
+    (CH_CFG_FACTORY_GENERIC_BUFFERS == TRUE)
+#if CH_CFG_FACTORY_HASH_SIZE <= 64
+#define INDEX_OBJECTS   CH_CFG_FACTORY_HASH_SIZE
+#else
+#define INDEX_OBJECTS   64
+#endif
+
+static registered_object_t *index_objects[INDEX_OBJECTS];
+
+static void index_name(char *name, unsigned n) {
+
+  name[0] = 'o';
+  name[1] = 'b';
+  name[2] = 'j';
+  name[3] = (char)('0' + ((n / 100U) % 10U));
+  name[4] = (char)('0' + ((n / 10U) % 10U));
+  name[5] = (char)('0' + (n % 10U));
+  name[6] = '\0';
+}
+#endif
 
 /****************************************************************************
  * Test cases.
@@ -629,6 +652,152 @@ static const testcase_t oslib_test_004_005 = {
 };
 #endif /* CH_CFG_FACTORY_OBJ_FIFOS == TRUE */
 
+#if ((CH_CFG_FACTORY_HASH_INDEX == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) && (CH_CFG_FACTORY_GENERIC_BUFFERS == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_004_006 [4.6] Objects Names Index
+ *
+ * <h2>Description</h2>
+ * This test case verifies the objects names hash index, objects are
+ * registered, found and released, the objects exceed the index capacity
+ * if it has up to 64 slots.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_FACTORY_HASH_INDEX == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) && (CH_CFG_FACTORY_GENERIC_BUFFERS == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [4.6.1] Registering the objects, all registrations must succeed,
+ *   some objects must not be indexed if the index is smaller than the
+ *   number of objects.
+ * - [4.6.2] Registering the objects again, must fail because the names
+ *   are already in use.
+ * - [4.6.3] Retrieving the objects by name, all objects must be found,
+ *   then releasing the references.
+ * - [4.6.4] Creating a buffer with the same name of a registered object,
+ *   must succeed because objects of different types are distinct.
+ * - [4.6.5] Releasing the objects with even index, they must not be
+ *   found anymore while the other objects must still be found, the
+ *   objects not indexed must be moved into the index.
+ * - [4.6.6] Releasing the remaining objects, no object must be found and
+ *   the index must be empty.
+ * .
+ */
+
+static void oslib_test_004_006_teardown(void) {
+  unsigned i;
+
+  for (i = 0U; i < INDEX_OBJECTS; i++) {
+    if (index_objects[i] != NULL) {
+      chFactoryReleaseObject(index_objects[i]);
+      index_objects[i] = NULL;
+    }
+  }
+}
+
+static void oslib_test_004_006_execute(void) {
+  registered_object_t *rop;
+  char name[8];
+  unsigned i;
+
+  /* [4.6.1] Registering the objects, all registrations must succeed, some
+     objects must not be indexed if the index is smaller than the number of
+     objects.*/
+  test_set_step(1);
+  {
+    for (i = 0U; i < INDEX_OBJECTS; i++) {
+      index_name(name, i);
+      index_objects[i] = chFactoryRegisterObject(name,
+                                                 (void *)&index_objects[i]);
+      test_assert(index_objects[i] != NULL, "cannot register");
+    }
+    test_assert((INDEX_OBJECTS < CH_CFG_FACTORY_HASH_SIZE) ||
+                (ch_factory.obj_list.unindexed > 0U), "all objects indexed");
+  }
+
+  /* [4.6.2] Registering the objects again, must fail because the names are
+     already in use.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i < INDEX_OBJECTS; i++) {
+      index_name(name, i);
+      rop = chFactoryRegisterObject(name, (void *)&index_objects[i]);
+      test_assert(rop == NULL, "can register");
+    }
+  }
+
+  /* [4.6.3] Retrieving the objects by name, all objects must be found, then
+     releasing the references.*/
+  test_set_step(3);
+  {
+    for (i = 0U; i < INDEX_OBJECTS; i++) {
+      index_name(name, i);
+      rop = chFactoryFindObject(name);
+      test_assert(rop == index_objects[i], "wrong object");
+      chFactoryReleaseObject(rop);
+    }
+  }
+
+  /* [4.6.4] Creating a buffer with the same name of a registered object,
+     must succeed because objects of different types are distinct.*/
+  test_set_step(4);
+  {
+    dyn_buffer_t *dbp;
+
+    dbp = chFactoryCreateBuffer("obj000", 16U);
+    test_assert(dbp != NULL, "cannot create");
+    rop = chFactoryFindObject("obj000");
+    test_assert(rop == index_objects[0], "wrong object");
+    chFactoryReleaseObject(rop);
+    chFactoryReleaseBuffer(dbp);
+    test_assert(chFactoryFindBuffer("obj000") == NULL, "found");
+  }
+
+  /* [4.6.5] Releasing the objects with even index, they must not be found
+     anymore while the other objects must still be found, the objects not
+     indexed must be moved into the index.*/
+  test_set_step(5);
+  {
+    for (i = 0U; i < INDEX_OBJECTS; i += 2U) {
+      chFactoryReleaseObject(index_objects[i]);
+      index_objects[i] = NULL;
+    }
+    for (i = 0U; i < INDEX_OBJECTS; i++) {
+      index_name(name, i);
+      rop = chFactoryFindObject(name);
+      test_assert(rop == index_objects[i], "wrong object");
+      if (rop != NULL) {
+        chFactoryReleaseObject(rop);
+      }
+    }
+    test_assert(ch_factory.obj_list.unindexed == 0U, "objects not indexed");
+  }
+
+  /* [4.6.6] Releasing the remaining objects, no object must be found and the
+     index must be empty.*/
+  test_set_step(6);
+  {
+    for (i = 1U; i < INDEX_OBJECTS; i += 2U) {
+      chFactoryReleaseObject(index_objects[i]);
+      index_objects[i] = NULL;
+    }
+    for (i = 0U; i < INDEX_OBJECTS; i++) {
+      index_name(name, i);
+      test_assert(chFactoryFindObject(name) == NULL, "found");
+    }
+    test_assert(ch_factory.indexed == 0U, "index not empty");
+  }
+}
+
+static const testcase_t oslib_test_004_006 = {
+  "Objects Names Index",
+  NULL,
+  oslib_test_004_006_teardown,
+  oslib_test_004_006_execute
+};
+#endif /* (CH_CFG_FACTORY_HASH_INDEX == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) && (CH_CFG_FACTORY_GENERIC_BUFFERS == TRUE) */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -651,6 +820,9 @@ const testcase_t * const oslib_test_sequence_004_array[] = {
 #endif
 #if (CH_CFG_FACTORY_OBJ_FIFOS == TRUE) || defined(__DOXYGEN__)
   &oslib_test_004_005,
+#endif
+#if ((CH_CFG_FACTORY_HASH_INDEX == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) && (CH_CFG_FACTORY_GENERIC_BUFFERS == TRUE)) || defined(__DOXYGEN__)
+  &oslib_test_004_006,
 #endif
   NULL
 };
@@ -0,0 +1,360 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+
+/**
+ * @file    oslib_test_sequence_005.c
+ * @brief   Test Sequence 005 code.
+ *
+ * @page oslib_test_sequence_005 [5] Pipes
+ *
+ * File: @ref oslib_test_sequence_005.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS library functionalities related to
+ * pipes.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_PIPES
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_005_001
+ * - @subpage oslib_test_005_002
+ * - @subpage oslib_test_005_003
+ * .
+ */
+
+#if (CH_CFG_USE_PIPES) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#include <string.h>
+
+#define PIPE_SIZE 16
+
+static uint8_t buffer[PIPE_SIZE];
+static PIPE_DECL(pipe1, buffer, PIPE_SIZE);
+
+static const uint8_t pipe_pattern[] = "0123456789ABCDEF";
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page oslib_test_005_001 [5.1] Pipes normal API, non-blocking tests
+ *
+ * <h2>Description</h2>
+ * The pipe normal API is tested without triggering blocking conditions.
+ *
+ * <h2>Test Steps</h2>
+ * - [5.1.1] Resetting the pipe, the pipe must be empty and no data must
+ *   be transferred while in reset state, then the pipe is returned in
+ *   active state.
+ * - [5.1.2] Writing and reading a block, the data must be preserved.
+ * - [5.1.3] Filling the pipe with a block crossing the buffer limit then
+ *   emptying it, the data must be preserved.
+ * - [5.1.4] Writing more data than the free space and reading more data
+ *   than the available data with an immediate timeout, only part of the
+ *   data must be transferred.
+ * .
+ */
+
+static void oslib_test_005_001_setup(void) {
+  chPipeObjectInit(&pipe1, buffer, PIPE_SIZE);
+}
+
+static void oslib_test_005_001_teardown(void) {
+  chPipeReset(&pipe1);
+}
+
+static void oslib_test_005_001_execute(void) {
+  uint8_t buf[PIPE_SIZE];
+  size_t n;
+
+  /* [5.1.1] Resetting the pipe, the pipe must be empty and no data must be
+     transferred while in reset state, then the pipe is returned in active
+     state.*/
+  test_set_step(1);
+  {
+    chPipeReset(&pipe1);
+    test_assert_lock(chPipeGetFreeCountI(&pipe1) == PIPE_SIZE, "not empty");
+    test_assert_lock(chPipeGetUsedCountI(&pipe1) == 0U, "still full");
+    n = chPipeWriteTimeout(&pipe1, pipe_pattern, 4U, TIME_INFINITE);
+    test_assert(n == 0U, "not in reset state");
+    n = chPipeReadTimeout(&pipe1, buf, 4U, TIME_INFINITE);
+    test_assert(n == 0U, "not in reset state");
+    chPipeResumeX(&pipe1);
+  }
+
+  /* [5.1.2] Writing and reading a block, the data must be preserved.*/
+  test_set_step(2);
+  {
+    n = chPipeWriteTimeout(&pipe1, pipe_pattern, 10U, TIME_INFINITE);
+    test_assert(n == 10U, "wrong size");
+    test_assert_lock(chPipeGetUsedCountI(&pipe1) == 10U, "wrong count");
+    n = chPipeReadTimeout(&pipe1, buf, 10U, TIME_INFINITE);
+    test_assert(n == 10U, "wrong size");
+    test_assert(memcmp(buf, pipe_pattern, 10U) == 0, "wrong data");
+  }
+
+  /* [5.1.3] Filling the pipe with a block crossing the buffer limit then
+     emptying it, the data must be preserved.*/
+  test_set_step(3);
+  {
+    n = chPipeWriteTimeout(&pipe1, pipe_pattern, PIPE_SIZE, TIME_INFINITE);
+    test_assert(n == PIPE_SIZE, "wrong size");
+    test_assert_lock(chPipeGetFreeCountI(&pipe1) == 0U, "still empty");
+    test_assert(pipe1.rdptr == pipe1.wrptr, "pointers not aligned");
+    n = chPipeReadTimeout(&pipe1, buf, PIPE_SIZE, TIME_INFINITE);
+    test_assert(n == PIPE_SIZE, "wrong size");
+    test_assert(memcmp(buf, pipe_pattern, PIPE_SIZE) == 0, "wrong data");
+    test_assert_lock(chPipeGetUsedCountI(&pipe1) == 0U, "still full");
+  }
+
+  /* [5.1.4] Writing more data than the free space and reading more data than
+     the available data with an immediate timeout, only part of the data must
+     be transferred.*/
+  test_set_step(4);
+  {
+    n = chPipeWriteTimeout(&pipe1, pipe_pattern, 4U, TIME_IMMEDIATE);
+    test_assert(n == 4U, "wrong size");
+    n = chPipeWriteTimeout(&pipe1, pipe_pattern, PIPE_SIZE, TIME_IMMEDIATE);
+    test_assert(n == PIPE_SIZE - 4U, "wrong size");
+    n = chPipeReadTimeout(&pipe1, buf, 2U * 4U, TIME_IMMEDIATE);
+    test_assert(n == 2U * 4U, "wrong size");
+    test_assert(memcmp(buf, pipe_pattern, 4U) == 0, "wrong data");
+    test_assert(memcmp(&buf[4], pipe_pattern, 4U) == 0, "wrong data");
+    n = chPipeReadTimeout(&pipe1, buf, PIPE_SIZE, TIME_IMMEDIATE);
+    test_assert(n == PIPE_SIZE - (2U * 4U), "wrong size");
+    test_assert(memcmp(buf, &pipe_pattern[4], n) == 0, "wrong data");
+  }
+}
+
+static const testcase_t oslib_test_005_001 = {
+  "Pipes normal API, non-blocking tests",
+  oslib_test_005_001_setup,
+  oslib_test_005_001_teardown,
+  oslib_test_005_001_execute
+};
+
+/**
+ * @page oslib_test_005_002 [5.2] Pipes zero-copy API
+ *
+ * <h2>Description</h2>
+ * The spans acquired from a pipe are written and read in place, then
+ * committed.
+ *
+ * <h2>Test Steps</h2>
+ * - [5.2.1] Acquiring a span of free space in the empty pipe, the span
+ *   must cover the whole buffer, part of it is written and committed.
+ * - [5.2.2] Acquiring a span of data, the data must be accessible in
+ *   place, part of it is released.
+ * - [5.2.3] Acquiring spans near the buffer limit, the spans must not
+ *   cross the buffer limit.
+ * - [5.2.4] Committing a span after a reset, the data must be discarded,
+ *   no span must be acquired while in reset state.
+ * - [5.2.5] Committing spans acquired before a reset after the pipe has
+ *   been resumed, the commits must be ignored and the pipe must be left
+ *   empty.
+ * .
+ */
+
+static void oslib_test_005_002_setup(void) {
+  chPipeObjectInit(&pipe1, buffer, PIPE_SIZE);
+}
+
+static void oslib_test_005_002_teardown(void) {
+  chPipeReset(&pipe1);
+}
+
+static void oslib_test_005_002_execute(void) {
+  pipe_span_t wspan, rspan;
+  size_t n;
+
+  /* [5.2.1] Acquiring a span of free space in the empty pipe, the span must
+     cover the whole buffer, part of it is written and committed.*/
+  test_set_step(1);
+  {
+    n = chPipeWriteAcquireTimeout(&pipe1, &wspan, TIME_IMMEDIATE);
+    test_assert((n == PIPE_SIZE) && (wspan.buffer == buffer), "wrong span");
+    memcpy(wspan.buffer, pipe_pattern, 12U);
+    chPipeWriteCommit(&pipe1, &wspan, 12U);
+    test_assert_lock(chPipeGetUsedCountI(&pipe1) == 12U, "wrong count");
+  }
+
+  /* [5.2.2] Acquiring a span of data, the data must be accessible in place,
+     part of it is released.*/
+  test_set_step(2);
+  {
+    n = chPipeReadAcquireTimeout(&pipe1, &rspan, TIME_IMMEDIATE);
+    test_assert((n == 12U) && (rspan.buffer == buffer), "wrong span");
+    test_assert(memcmp(rspan.buffer, pipe_pattern, 12U) == 0, "wrong data");
+    chPipeReadCommit(&pipe1, &rspan, 8U);
+    test_assert_lock(chPipeGetUsedCountI(&pipe1) == 4U, "wrong count");
+  }
+
+  /* [5.2.3] Acquiring spans near the buffer limit, the spans must not cross
+     the buffer limit.*/
+  test_set_step(3);
+  {
+    n = chPipeWriteAcquireTimeout(&pipe1, &wspan, TIME_IMMEDIATE);
+    test_assert((n == PIPE_SIZE - 12U) && (wspan.buffer == &buffer[12]),
+                "wrong span");
+    memcpy(wspan.buffer, &pipe_pattern[12], n);
+    chPipeWriteCommit(&pipe1, &wspan, n);
+    n = chPipeWriteAcquireTimeout(&pipe1, &wspan, TIME_IMMEDIATE);
+    test_assert((n == 8U) && (wspan.buffer == buffer), "wrong span");
+    n = chPipeReadAcquireTimeout(&pipe1, &rspan, TIME_IMMEDIATE);
+    test_assert((n == 8U) && (rspan.buffer == &buffer[8]), "wrong span");
+    test_assert(memcmp(rspan.buffer, &pipe_pattern[8], n) == 0, "wrong data");
+    chPipeReadCommit(&pipe1, &rspan, n);
+    n = chPipeReadAcquireTimeout(&pipe1, &rspan, TIME_IMMEDIATE);
+    test_assert(n == 0U, "not empty");
+  }
+
+  /* [5.2.4] Committing a span after a reset, the data must be discarded, no
+     span must be acquired while in reset state.*/
+  test_set_step(4);
+  {
+    n = chPipeWriteAcquireTimeout(&pipe1, &wspan, TIME_IMMEDIATE);
+    test_assert(n > 0U, "no span");
+    chPipeReset(&pipe1);
+    chPipeWriteCommit(&pipe1, &wspan, n);
+    test_assert_lock(chPipeGetUsedCountI(&pipe1) == 0U, "not discarded");
+    n = chPipeWriteAcquireTimeout(&pipe1, &wspan, TIME_INFINITE);
+    test_assert(n == 0U, "not in reset state");
+    n = chPipeReadAcquireTimeout(&pipe1, &rspan, TIME_INFINITE);
+    test_assert(n == 0U, "not in reset state");
+  }
+
+  /* [5.2.5] Committing spans acquired before a reset after the pipe has been
+     resumed, the commits must be ignored and the pipe must be left empty.*/
+  test_set_step(5);
+  {
+    chPipeResumeX(&pipe1);
+    n = chPipeWriteTimeout(&pipe1, pipe_pattern, 4U, TIME_IMMEDIATE);
+    test_assert(n == 4U, "wrong size");
+    n = chPipeWriteAcquireTimeout(&pipe1, &wspan, TIME_IMMEDIATE);
+    test_assert(n == PIPE_SIZE - 4U, "wrong span");
+    n = chPipeReadAcquireTimeout(&pipe1, &rspan, TIME_IMMEDIATE);
+    test_assert(n == 4U, "wrong span");
+    chPipeReset(&pipe1);
+    chPipeResumeX(&pipe1);
+    chPipeWriteCommit(&pipe1, &wspan, wspan.size);
+    chPipeReadCommit(&pipe1, &rspan, rspan.size);
+    test_assert_lock(chPipeGetUsedCountI(&pipe1) == 0U, "not empty");
+    test_assert((pipe1.wrptr == buffer) && (pipe1.rdptr == buffer),
+                "pointers moved");
+  }
+}
+
+static const testcase_t oslib_test_005_002 = {
+  "Pipes zero-copy API",
+  oslib_test_005_002_setup,
+  oslib_test_005_002_teardown,
+  oslib_test_005_002_execute
+};
+
+/**
+ * @page oslib_test_005_003 [5.3] Pipes timeouts
+ *
+ * <h2>Description</h2>
+ * The pipe API is tested for timeouts.
+ *
+ * <h2>Test Steps</h2>
+ * - [5.3.1] Filling the pipe then writing with a timeout, the operations
+ *   must time out without transferring data.
+ * - [5.3.2] Emptying the pipe then reading with a timeout, the
+ *   operations must time out without transferring data.
+ * .
+ */
+
+static void oslib_test_005_003_setup(void) {
+  chPipeObjectInit(&pipe1, buffer, PIPE_SIZE);
+}
+
+static void oslib_test_005_003_teardown(void) {
+  chPipeReset(&pipe1);
+}
+
+static void oslib_test_005_003_execute(void) {
+  uint8_t buf[PIPE_SIZE];
+  pipe_span_t span;
+  size_t n;
+
+  /* [5.3.1] Filling the pipe then writing with a timeout, the operations
+     must time out without transferring data.*/
+  test_set_step(1);
+  {
+    n = chPipeWriteTimeout(&pipe1, pipe_pattern, PIPE_SIZE, TIME_INFINITE);
+    test_assert(n == PIPE_SIZE, "wrong size");
+    n = chPipeWriteTimeout(&pipe1, pipe_pattern, 1U, TIME_MS2I(1));
+    test_assert(n == 0U, "not full");
+    n = chPipeWriteAcquireTimeout(&pipe1, &span, TIME_MS2I(1));
+    test_assert(n == 0U, "not full");
+  }
+
+  /* [5.3.2] Emptying the pipe then reading with a timeout, the operations
+     must time out without transferring data.*/
+  test_set_step(2);
+  {
+    n = chPipeReadTimeout(&pipe1, buf, PIPE_SIZE, TIME_INFINITE);
+    test_assert(n == PIPE_SIZE, "wrong size");
+    n = chPipeReadTimeout(&pipe1, buf, 1U, TIME_MS2I(1));
+    test_assert(n == 0U, "not empty");
+    n = chPipeReadAcquireTimeout(&pipe1, &span, TIME_MS2I(1));
+    test_assert(n == 0U, "not empty");
+  }
+}
+
+static const testcase_t oslib_test_005_003 = {
+  "Pipes timeouts",
+  oslib_test_005_003_setup,
+  oslib_test_005_003_teardown,
+  oslib_test_005_003_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_005_array[] = {
+  &oslib_test_005_001,
+  &oslib_test_005_002,
+  &oslib_test_005_003,
+  NULL
+};
+
+/**
+ * @brief   Pipes.
+ */
+const testsequence_t oslib_test_sequence_005 = {
+  "Pipes",
+  oslib_test_sequence_005_array
+};
+
+#endif /* CH_CFG_USE_PIPES */
@@ -187,9 +187,33 @@ static void rt_test_001_003_execute(void) {
     test_print("--- CH_CFG_OPTIMIZE_SPEED:              ");
     test_printn(CH_CFG_OPTIMIZE_SPEED);
     test_println("");
+    test_print("--- CH_CFG_RLIST_BITMAP:                ");
+    test_printn(CH_CFG_RLIST_BITMAP);
+    test_println("");
+    test_print("--- CH_CFG_VT_WHEEL:                    ");
+    test_printn(CH_CFG_VT_WHEEL);
+    test_println("");
+    test_print("--- CH_CFG_VT_SLACK:                    ");
+    test_printn(CH_CFG_VT_SLACK);
+    test_println("");
+    test_print("--- CH_CFG_VT_DEFERRED:                 ");
+    test_printn(CH_CFG_VT_DEFERRED);
+    test_println("");
+    test_print("--- CH_CFG_USE_EDF:                     ");
+    test_printn(CH_CFG_USE_EDF);
+    test_println("");
+    test_print("--- CH_CFG_USE_BUDGETS:                 ");
+    test_printn(CH_CFG_USE_BUDGETS);
+    test_println("");
     test_print("--- CH_CFG_USE_TM:                      ");
     test_printn(CH_CFG_USE_TM);
     test_println("");
+    test_print("--- CH_CFG_USE_TM_HISTOGRAMS:           ");
+    test_printn(CH_CFG_USE_TM_HISTOGRAMS);
+    test_println("");
+    test_print("--- CH_CFG_TM_HISTOGRAM_BUCKETS:        ");
+    test_printn(CH_CFG_TM_HISTOGRAM_BUCKETS);
+    test_println("");
     test_print("--- CH_CFG_USE_REGISTRY:                ");
     test_printn(CH_CFG_USE_REGISTRY);
     test_println("");
@@ -229,15 +253,36 @@ static void rt_test_001_003_execute(void) {
     test_print("--- CH_CFG_USE_MAILBOXES:               ");
     test_printn(CH_CFG_USE_MAILBOXES);
     test_println("");
+    test_print("--- CH_CFG_USE_PIPES:                   ");
+    test_printn(CH_CFG_USE_PIPES);
+    test_println("");
     test_print("--- CH_CFG_USE_MEMCORE:                 ");
     test_printn(CH_CFG_USE_MEMCORE);
     test_println("");
+    test_print("--- CH_CFG_USE_MEMCORE_REGIONS:         ");
+    test_printn(CH_CFG_USE_MEMCORE_REGIONS);
+    test_println("");
     test_print("--- CH_CFG_USE_HEAP:                    ");
     test_printn(CH_CFG_USE_HEAP);
     test_println("");
+    test_print("--- CH_CFG_HEAP_TLSF:                   ");
+    test_printn(CH_CFG_HEAP_TLSF);
+    test_println("");
+    test_print("--- CH_CFG_HEAP_PROFILER:               ");
+    test_printn(CH_CFG_HEAP_PROFILER);
+    test_println("");
     test_print("--- CH_CFG_USE_MEMPOOLS:                ");
     test_printn(CH_CFG_USE_MEMPOOLS);
     test_println("");
+    test_print("--- CH_CFG_USE_POOL_MAGAZINES:          ");
+    test_printn(CH_CFG_USE_POOL_MAGAZINES);
+    test_println("");
+    test_print("--- CH_CFG_USE_SLAB:                    ");
+    test_printn(CH_CFG_USE_SLAB);
+    test_println("");
+    test_print("--- CH_CFG_USE_ARENAS:                  ");
+    test_printn(CH_CFG_USE_ARENAS);
+    test_println("");
     test_print("--- CH_CFG_USE_OBJ_FIFOS:               ");
     test_printn(CH_CFG_USE_OBJ_FIFOS);
     test_println("");
@@ -265,9 +310,15 @@ static void rt_test_001_003_execute(void) {
     test_print("--- CH_CFG_FACTORY_OBJ_FIFOS:           ");
     test_printn(CH_CFG_FACTORY_OBJ_FIFOS);
     test_println("");
+    test_print("--- CH_CFG_FACTORY_HASH_INDEX:          ");
+    test_printn(CH_CFG_FACTORY_HASH_INDEX);
+    test_println("");
     test_print("--- CH_DBG_STATISTICS:                  ");
     test_printn(CH_DBG_STATISTICS);
     test_println("");
+    test_print("--- CH_DBG_STATISTICS_WINDOW:           ");
+    test_printn(CH_DBG_STATISTICS_WINDOW);
+    test_println("");
     test_print("--- CH_DBG_SYSTEM_STATE_CHECK:          ");
     test_printn(CH_DBG_SYSTEM_STATE_CHECK);
     test_println("");
@@ -37,6 +37,11 @@
  * - @subpage rt_test_002_002
  * - @subpage rt_test_002_003
  * - @subpage rt_test_002_004
+ * - @subpage rt_test_002_005
+ * - @subpage rt_test_002_006
+ * - @subpage rt_test_002_007
+ * - @subpage rt_test_002_008
+ * - @subpage rt_test_002_009
  * .
  */
 
@@ -61,6 +66,44 @@ static void vtcb(void *p) {
   chSysUnlockFromISR();
 }
 
+/* Timer callback emitting the token passed as parameter.*/
+static void vttokencb(void *p) {
+
+  chSysLockFromISR();
+  test_emit_token_i(*(char *)p);
+  chSysUnlockFromISR();
+}
+
+/* Periodic timer callback stopping its own timer after three runs.*/
+static unsigned vtcnt;
+static void vtstopcb(void *p) {
+
+  chSysLockFromISR();
+  test_emit_token_i('A');
+  if (++vtcnt >= 3U) {
+    chVTResetI((virtual_timer_t *)p);
+  }
+  chSysUnlockFromISR();
+}
+
+#if CH_CFG_VT_DEFERRED == TRUE
+/* Deferred timer callback emitting the token passed as parameter if
+   executed by the virtual timers thread.*/
+static void vtdefcb(void *p) {
+
+  if (chThdGetPriorityX() == CH_CFG_VT_DEFERRED_PRIO) {
+    test_emit_token(*(char *)p);
+  }
+}
+
+/* Deferred timer callback stopping the timer passed as parameter.*/
+static void vtdefstopcb(void *p) {
+
+  test_emit_token('A');
+  chVTReset((virtual_timer_t *)p);
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -265,6 +308,446 @@ static const testcase_t rt_test_002_004 = {
   rt_test_002_004_execute
 };
 
+#if (CH_CFG_VT_SLACK == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_002_005 [2.5] Virtual timers slack functionality
+ *
+ * <h2>Description</h2>
+ * The virtual timers slack API is tested, timers armed with a slack
+ * must not expire before their delay and must expire within their
+ * window.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_VT_SLACK == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.5.1] Two timers are armed, the first expiring timer has a window
+ *   overlapping the expiration of the second, the expiration order is
+ *   tested.
+ * - [2.5.2] A timer is armed with a slack, it must not expire before
+ *   its delay.
+ * - [2.5.3] A timer is armed with a slack and then reset, it must not
+ *   expire.
+ * - [2.5.4] Two timers with overlapping windows are armed in tick-less
+ *   mode, they are expected to be served by a single alarm and the
+ *   merged timers counter is expected to grow.
+ * .
+ */
+
+static void rt_test_002_005_execute(void) {
+  virtual_timer_t vt1, vt2;
+
+  /* [2.5.1] Two timers are armed, the first expiring timer has a
+     window overlapping the expiration of the second, the expiration
+     order is tested.*/
+  test_set_step(1);
+  {
+    chVTObjectInit(&vt1);
+    chVTObjectInit(&vt2);
+    chVTSetWithSlack(&vt1, TIME_MS2I(20), 0, vttokencb, "B");
+    chVTSetWithSlack(&vt2, TIME_MS2I(10), TIME_MS2I(30), vttokencb, "A");
+    chThdSleepMilliseconds(100);
+
+    test_assert(!chVTIsArmed(&vt1) && !chVTIsArmed(&vt2),
+                "timer still armed");
+    test_assert_sequence("AB", "invalid sequence");
+  }
+
+  /* [2.5.2] A timer is armed with a slack, it must not expire before
+     its delay.*/
+  test_set_step(2);
+  {
+    chVTSetWithSlack(&vt1, TIME_MS2I(50), TIME_MS2I(50), vttokencb, "A");
+    chThdSleepMilliseconds(40);
+    test_assert(chVTIsArmed(&vt1), "timer expired too early");
+    chThdSleepMilliseconds(100);
+    test_assert(!chVTIsArmed(&vt1), "timer still armed");
+    test_assert_sequence("A", "invalid sequence");
+  }
+
+  /* [2.5.3] A timer is armed with a slack and then reset, it must not
+     expire.*/
+  test_set_step(3);
+  {
+    chVTSetWithSlack(&vt1, TIME_MS2I(20), TIME_MS2I(20), vttokencb, "A");
+    chVTSetWithSlack(&vt2, TIME_MS2I(30), 0, vttokencb, "B");
+    chVTReset(&vt1);
+    chThdSleepMilliseconds(100);
+    test_assert(!chVTIsArmed(&vt2), "timer still armed");
+    test_assert_sequence("B", "invalid sequence");
+  }
+
+  /* [2.5.4] Two timers with overlapping windows are armed in
+     tick-less mode, they are expected to be served by a single alarm
+     and the merged timers counter is expected to grow.*/
+  test_set_step(4);
+  {
+#if (CH_DBG_STATISTICS == TRUE) && (CH_CFG_ST_TIMEDELTA > 0)
+    ucnt_t merged = ch.kernel_stats.n_vt_merged;
+
+    chVTSetWithSlack(&vt1, TIME_MS2I(20), 0, vttokencb, "B");
+    chVTSetWithSlack(&vt2, TIME_MS2I(10), TIME_MS2I(30), vttokencb, "A");
+    chThdSleepMilliseconds(100);
+    test_assert(ch.kernel_stats.n_vt_merged > merged, "timers not merged");
+    test_assert_sequence("AB", "invalid sequence");
+#endif
+  }
+}
+
+static const testcase_t rt_test_002_005 = {
+  "Virtual timers slack functionality",
+  NULL,
+  NULL,
+  rt_test_002_005_execute
+};
+#endif /* CH_CFG_VT_SLACK == TRUE */
+
+/**
+ * @page rt_test_002_006 [2.6] Periodic virtual timers functionality
+ *
+ * <h2>Description</h2>
+ * The periodic virtual timers API is tested, the timers are reloaded by
+ * the kernel and can be stopped from their own callback.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.6.1] A periodic timer is armed, after five periods it is
+ *   expected to have expired five times and to be still armed.
+ * - [2.6.2] A periodic timer is armed, the callback stops the timer
+ *   after three expirations.
+ * - [2.6.3] A timer is armed with a zero period, it is expected to
+ *   expire once.
+ * .
+ */
+
+static void rt_test_002_006_execute(void) {
+  virtual_timer_t vt;
+
+  /* [2.6.1] A periodic timer is armed, after five periods it is
+     expected to have expired five times and to be still armed.*/
+  test_set_step(1);
+  {
+    chVTObjectInit(&vt);
+    chVTSetPeriodic(&vt, TIME_MS2I(10), TIME_MS2I(10), vttokencb, "A");
+    chThdSleepMilliseconds(55);
+    test_assert(chVTIsArmed(&vt), "timer not armed");
+    chVTReset(&vt);
+    test_assert(!chVTIsArmed(&vt), "timer still armed");
+    test_assert_sequence("AAAAA", "invalid sequence");
+  }
+
+  /* [2.6.2] A periodic timer is armed, the callback stops the timer
+     after three expirations.*/
+  test_set_step(2);
+  {
+    vtcnt = 0;
+    chVTSetPeriodic(&vt, TIME_MS2I(10), TIME_MS2I(10), vtstopcb, &vt);
+    chThdSleepMilliseconds(100);
+    test_assert(!chVTIsArmed(&vt), "timer still armed");
+    test_assert_sequence("AAA", "invalid sequence");
+  }
+
+  /* [2.6.3] A timer is armed with a zero period, it is expected to
+     expire once.*/
+  test_set_step(3);
+  {
+    chVTSetPeriodic(&vt, TIME_MS2I(10), 0, vttokencb, "A");
+    chThdSleepMilliseconds(50);
+    test_assert(!chVTIsArmed(&vt), "timer still armed");
+    test_assert_sequence("A", "invalid sequence");
+  }
+}
+
+static const testcase_t rt_test_002_006 = {
+  "Periodic virtual timers functionality",
+  NULL,
+  NULL,
+  rt_test_002_006_execute
+};
+
+#if (CH_CFG_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_002_007 [2.7] Deferred virtual timers functionality
+ *
+ * <h2>Description</h2>
+ * The deferred virtual timers API is tested, the callbacks are expected
+ * to be executed by the virtual timers thread.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_VT_DEFERRED == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.7.1] A timer with a deferred callback is armed, the callback is
+ *   expected to be executed once in thread context.
+ * - [2.7.2] A periodic timer with a deferred callback is armed, after
+ *   five periods it is expected to have expired five times and to be
+ *   still armed.
+ * - [2.7.3] Two timers with deferred callbacks expiring together are
+ *   armed, the first executed callback resets the other timer while its
+ *   callback is pending, only one callback is expected to be executed.
+ * .
+ */
+
+static void rt_test_002_007_execute(void) {
+  virtual_timer_t vt1, vt2;
+
+  /* [2.7.1] A timer with a deferred callback is armed, the callback
+     is expected to be executed once in thread context.*/
+  test_set_step(1);
+  {
+    chVTObjectInit(&vt1);
+    chVTSetDeferred(&vt1, TIME_MS2I(10), 0, vtdefcb, "A");
+    chThdSleepMilliseconds(50);
+    test_assert(!chVTIsArmed(&vt1), "timer still armed");
+    test_assert_sequence("A", "invalid sequence");
+  }
+
+  /* [2.7.2] A periodic timer with a deferred callback is armed, after
+     five periods it is expected to have expired five times and to be
+     still armed.*/
+  test_set_step(2);
+  {
+    chVTSetDeferred(&vt1, TIME_MS2I(10), TIME_MS2I(10), vtdefcb, "A");
+    chThdSleepMilliseconds(55);
+    test_assert(chVTIsArmed(&vt1), "timer not armed");
+    chVTReset(&vt1);
+    test_assert(!chVTIsArmed(&vt1), "timer still armed");
+    test_assert_sequence("AAAAA", "invalid sequence");
+  }
+
+  /* [2.7.3] Two timers with deferred callbacks expiring together are
+     armed, the first executed callback resets the other timer while
+     its callback is pending, only one callback is expected to be
+     executed.*/
+  test_set_step(3);
+  {
+    chVTObjectInit(&vt2);
+    chSysLock();
+    chVTSetDeferredI(&vt1, TIME_MS2I(10), 0, vtdefstopcb, &vt2);
+    chVTSetDeferredI(&vt2, TIME_MS2I(10), 0, vtdefstopcb, &vt1);
+    chSysUnlock();
+    chThdSleepMilliseconds(50);
+    test_assert(!chVTIsArmed(&vt1) && !chVTIsArmed(&vt2),
+                "timer still armed");
+    test_assert_sequence("A", "invalid sequence");
+  }
+}
+
+static const testcase_t rt_test_002_007 = {
+  "Deferred virtual timers functionality",
+  NULL,
+  NULL,
+  rt_test_002_007_execute
+};
+#endif /* CH_CFG_VT_DEFERRED == TRUE */
+
+#if (CH_CFG_USE_TM_HISTOGRAMS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_002_008 [2.8] Time measurement histograms
+ *
+ * <h2>Description</h2>
+ * The time measurement histograms are tested.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_TM_HISTOGRAMS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.8.1] A time measurement object is associated to a histogram then
+ *   16 measurements are performed, the histogram is expected to contain
+ *   16 samples.
+ * - [2.8.2] A measurement of a longer duration is performed, the sample
+ *   is expected to be counted in the bucket matching the measured
+ *   value.
+ * - [2.8.3] A snapshot of the histogram is taken with reset, the copy
+ *   is expected to contain all the samples and the histogram is
+ *   expected to be empty.
+ * - [2.8.4] The kernel critical zones histograms are reset, after a
+ *   critical zone the threads critical zones histogram is expected to
+ *   contain samples.
+ * .
+ */
+
+static void rt_test_002_008_execute(void) {
+  time_measurement_t tm;
+  tm_histogram_t h, snap;
+  unsigned i;
+  ucnt_t sum;
+
+  /* [2.8.1] A time measurement object is associated to a histogram
+     then 16 measurements are performed, the histogram is expected to
+     contain 16 samples.*/
+  test_set_step(1);
+  {
+    chTMObjectInit(&tm);
+    chTMHistogramObjectInit(&h);
+    chTMSetHistogramX(&tm, &h);
+    for (i = 0U; i < 16U; i++) {
+      chTMStartMeasurementX(&tm);
+      chTMStopMeasurementX(&tm);
+    }
+    sum = (ucnt_t)0;
+    for (i = 0U; i < (unsigned)CH_CFG_TM_HISTOGRAM_BUCKETS; i++) {
+      sum += h.buckets[i];
+    }
+    test_assert(h.n == (ucnt_t)16, "wrong number of samples");
+    test_assert(sum == (ucnt_t)16, "wrong buckets sum");
+  }
+
+  /* [2.8.2] A measurement of a longer duration is performed, the
+     sample is expected to be counted in the bucket matching the
+     measured value.*/
+  test_set_step(2);
+  {
+    chTMHistogramSnapshotX(&h, &snap, false);
+    chTMStartMeasurementX(&tm);
+    chSysPolledDelayX((rtcnt_t)1000);
+    chTMStopMeasurementX(&tm);
+    for (i = 0U; i < (unsigned)CH_CFG_TM_HISTOGRAM_BUCKETS; i++) {
+      if (h.buckets[i] != snap.buckets[i]) {
+        break;
+      }
+    }
+    test_assert(i < (unsigned)CH_CFG_TM_HISTOGRAM_BUCKETS, "not recorded");
+    test_assert(i > 0U, "wrong bucket");
+    test_assert(((uint32_t)tm.last >> (i - 1U)) != 0U, "wrong bucket");
+    if (i < (unsigned)CH_CFG_TM_HISTOGRAM_BUCKETS - 1U) {
+      test_assert(((uint32_t)tm.last >> i) == 0U, "wrong bucket");
+    }
+  }
+
+  /* [2.8.3] A snapshot of the histogram is taken with reset, the copy
+     is expected to contain all the samples and the histogram is
+     expected to be empty.*/
+  test_set_step(3);
+  {
+    chTMHistogramSnapshotX(&h, &snap, true);
+    test_assert(snap.n == (ucnt_t)17, "wrong number of samples");
+    test_assert(h.n == (ucnt_t)0, "histogram not reset");
+    for (i = 0U; i < (unsigned)CH_CFG_TM_HISTOGRAM_BUCKETS; i++) {
+      test_assert(h.buckets[i] == (ucnt_t)0, "bucket not reset");
+    }
+  }
+
+  /* [2.8.4] The kernel critical zones histograms are reset, after a
+     critical zone the threads critical zones histogram is expected to
+     contain samples.*/
+  test_set_step(4);
+  {
+#if CH_DBG_STATISTICS == TRUE
+    chStatsSnapshotHistograms(NULL, NULL, true);
+    chSysLock();
+    chSysUnlock();
+    chStatsSnapshotHistograms(&snap, NULL, false);
+    test_assert(snap.n >= (ucnt_t)2, "critical zones not recorded");
+#endif
+  }
+}
+
+static const testcase_t rt_test_002_008 = {
+  "Time measurement histograms",
+  NULL,
+  NULL,
+  rt_test_002_008_execute
+};
+#endif /* CH_CFG_USE_TM_HISTOGRAMS == TRUE */
+
+#if ((CH_CFG_USE_SEMAPHORES == TRUE) && (CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED) && ((CH_DBG_TRACE_MASK & CH_DBG_TRACE_MASK_SEM) != 0U)) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_002_009 [2.9] Objects trace records
+ *
+ * <h2>Description</h2>
+ * The objects trace records and the trace classes suspension are tested
+ * using a semaphore.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_SEMAPHORES == TRUE) && (CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED) && ((CH_DBG_TRACE_MASK & CH_DBG_TRACE_MASK_SEM) != 0U)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.9.1] The trace buffer is drained then a semaphore is signaled
+ *   with no waiting threads, a semaphore record with the signal event
+ *   and no thread is expected.
+ * - [2.9.2] A wait operation is performed on the semaphore, a semaphore
+ *   record with the wait event and the current thread is expected.
+ * - [2.9.3] The semaphores trace class is suspended, a signal operation
+ *   is expected to not produce any record. The class is then resumed.
+ * .
+ */
+
+static void rt_test_002_009_execute(void) {
+  semaphore_t sem;
+  ch_trace_event_t te;
+  uint32_t seq;
+  bool found;
+
+  /* [2.9.1] The trace buffer is drained then a semaphore is signaled
+     with no waiting threads, a semaphore record with the signal event
+     and no thread is expected.*/
+  test_set_step(1);
+  {
+    chSemObjectInit(&sem, (cnt_t)0);
+    seq = 0U;
+    chSysLock();
+    while (chDbgFetchTraceI(&seq, &te)) {
+    }
+    chSemSignalI(&sem);
+    found = chDbgFetchTraceI(&seq, &te);
+    chSysUnlock();
+    test_assert(found, "record not found");
+    test_assert(te.type == CH_TRACE_TYPE_SEM, "wrong record type");
+    test_assert(te.state == CH_TRACE_EVENT_SIGNAL, "wrong event");
+    test_assert(te.u.obj.objp == (void *)&sem, "wrong object");
+    test_assert(te.u.obj.argp == NULL, "wrong argument");
+  }
+
+  /* [2.9.2] A wait operation is performed on the semaphore, a
+     semaphore record with the wait event and the current thread is
+     expected.*/
+  test_set_step(2);
+  {
+    chSysLock();
+    (void) chSemWaitS(&sem);
+    found = chDbgFetchTraceI(&seq, &te);
+    chSysUnlock();
+    test_assert(found, "record not found");
+    test_assert(te.type == CH_TRACE_TYPE_SEM, "wrong record type");
+    test_assert(te.state == CH_TRACE_EVENT_WAIT, "wrong event");
+    test_assert(te.u.obj.argp == (void *)chThdGetSelfX(), "wrong argument");
+  }
+
+  /* [2.9.3] The semaphores trace class is suspended, a signal
+     operation is expected to not produce any record. The class is
+     then resumed.*/
+  test_set_step(3);
+  {
+    chSysLock();
+    chDbgSuspendTraceI(CH_DBG_TRACE_MASK_SEM);
+    chSemSignalI(&sem);
+    found = chDbgFetchTraceI(&seq, &te);
+    chDbgResumeTraceI(CH_DBG_TRACE_MASK_SEM);
+    chSysUnlock();
+    test_assert(!found, "class not suspended");
+  }
+}
+
+static const testcase_t rt_test_002_009 = {
+  "Objects trace records",
+  NULL,
+  NULL,
+  rt_test_002_009_execute
+};
+#endif /* (CH_CFG_USE_SEMAPHORES == TRUE) && (CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED) && ((CH_DBG_TRACE_MASK & CH_DBG_TRACE_MASK_SEM) != 0U) */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -277,6 +760,19 @@ const testcase_t * const rt_test_sequence_002_array[] = {
   &rt_test_002_002,
   &rt_test_002_003,
   &rt_test_002_004,
+#if (CH_CFG_VT_SLACK == TRUE) || defined(__DOXYGEN__)
+  &rt_test_002_005,
+#endif
+  &rt_test_002_006,
+#if (CH_CFG_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+  &rt_test_002_007,
+#endif
+#if (CH_CFG_USE_TM_HISTOGRAMS == TRUE) || defined(__DOXYGEN__)
+  &rt_test_002_008,
+#endif
+#if ((CH_CFG_USE_SEMAPHORES == TRUE) && (CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED) && ((CH_DBG_TRACE_MASK & CH_DBG_TRACE_MASK_SEM) != 0U)) || defined(__DOXYGEN__)
+  &rt_test_002_009,
+#endif
   NULL
 };
 
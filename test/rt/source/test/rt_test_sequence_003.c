@@ -34,6 +34,9 @@
  * - @subpage rt_test_003_002
  * - @subpage rt_test_003_003
  * - @subpage rt_test_003_004
+ * - @subpage rt_test_003_005
+ * - @subpage rt_test_003_006
+ * - @subpage rt_test_003_007
  * .
  */
 
@@ -46,6 +49,112 @@ static THD_FUNCTION(thread, p) {
   test_emit_token(*(char *)p);
 }
 
+#if CH_CFG_USE_EDF == TRUE
+static thread_t *edf_create(unsigned n, tprio_t prio, sysinterval_t period,
+                            tfunc_t funcp, void *arg) {
+  thread_descriptor_t td = {
+    "edf",
+    (stkalign_t *)wa[n],
+    (stkalign_t *)((uint8_t *)wa[n] + WA_SIZE),
+    prio,
+    funcp,
+    arg,
+    period,
+    (sysinterval_t)0
+  };
+
+  return chThdCreateSuspended(&td);
+}
+
+#define EDF_JOBS 4
+
+static systime_t edf_done[EDF_JOBS];
+
+static THD_FUNCTION(edfjobs, p) {
+  unsigned i;
+
+  (void)p;
+
+  /* The first job overruns its deadline and delays the second one, the
+     completion time of each job is recorded.*/
+  chThdSleepMilliseconds(25);
+  for (i = 0U; i < EDF_JOBS; i++) {
+    edf_done[i] = chVTGetSystemTimeX();
+    chThdWaitNextPeriod();
+  }
+}
+
+#if CH_CFG_USE_MUTEXES == TRUE
+static MUTEX_DECL(edfmtx);
+static thread_reference_t edftr;
+
+static THD_FUNCTION(edfowner, p) {
+
+  /* The mutex is held while waiting to be resumed, a thread locking it
+     meanwhile boosts this thread.*/
+  chMtxLock(&edfmtx);
+  chSysLock();
+  (void) chThdSuspendS(&edftr);
+  chSysUnlock();
+  test_emit_token(*(char *)p);
+  chMtxUnlock(&edfmtx);
+}
+
+static THD_FUNCTION(edflocker, p) {
+
+  chMtxLock(&edfmtx);
+  test_emit_token(*(char *)p);
+  chMtxUnlock(&edfmtx);
+}
+#endif
+#endif
+
+#if CH_CFG_USE_BUDGETS == TRUE
+static THD_FUNCTION(budgetthread, p) {
+
+  (void)p;
+
+  /* Consuming CPU until termination is requested.*/
+  while (!chThdShouldTerminateX()) {
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+#if CH_CFG_USE_MUTEXES == TRUE
+static MUTEX_DECL(budgetmtx);
+
+static THD_FUNCTION(budgetwaiter, p) {
+
+  (void)p;
+
+  /* Consuming CPU until demoted, then waiting on the mutex.*/
+  while (!chBudgetIsExhaustedX(chThdGetSelfX())) {
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+  chMtxLock(&budgetmtx);
+  chMtxUnlock(&budgetmtx);
+}
+
+static THD_FUNCTION(budgetowner, p) {
+
+  (void)p;
+
+  /* Consuming CPU with the mutex locked until termination is requested.*/
+  chMtxLock(&budgetmtx);
+  while (!chThdShouldTerminateX()) {
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+  chMtxUnlock(&budgetmtx);
+}
+#endif
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -325,6 +434,363 @@ static const testcase_t rt_test_003_004 = {
 };
 #endif /* CH_CFG_USE_MUTEXES */
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_003_005 [3.5] EDF scheduling class
+ *
+ * <h2>Description</h2>
+ * The EDF scheduling class is tested, EDF threads are expected to be
+ * scheduled by deadline within their priority level and their deadline
+ * misses are expected to be counted.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_EDF == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [3.5.1] Two fixed priority threads, above and below the EDF level,
+ *   and two EDF threads are created suspended, the EDF thread with the
+ *   later deadline is created first. The threads are started together,
+ *   the execution order is expected to follow priorities first and
+ *   deadlines within the EDF level.
+ * - [3.5.2] An EDF thread with a 10 milliseconds period overruns its
+ *   first job and delays the second one, the jobs completion times are
+ *   recorded. The deadline misses are expected to match the jobs
+ *   completed after their deadline, jobs completed within two
+ *   milliseconds before their deadline may or may not be counted.
+ * - [3.5.3] A fixed priority thread below the EDF level holds a mutex
+ *   and an EDF thread blocks on it, the boosted thread is resumed
+ *   together with an EDF thread having an earlier deadline. The boosted
+ *   thread is expected to run first, then the EDF threads in deadline
+ *   order.
+ * .
+ */
+
+static void rt_test_003_005_execute(void) {
+  thread_t *tp;
+  systime_t release;
+  ucnt_t misses, expected, uncertain;
+  unsigned i;
+
+  /* [3.5.1] Two fixed priority threads, above and below the EDF
+     level, and two EDF threads are created suspended, the EDF thread
+     with the later deadline is created first. The threads are started
+     together, the execution order is expected to follow priorities
+     first and deadlines within the EDF level.*/
+  test_set_step(1);
+  {
+    threads[0] = edf_create(0, CH_CFG_EDF_PRIO - 1, (sysinterval_t)0, thread, "D");
+    threads[1] = edf_create(1, CH_CFG_EDF_PRIO, TIME_MS2I(300), thread, "C");
+    threads[2] = edf_create(2, CH_CFG_EDF_PRIO, TIME_MS2I(200), thread, "B");
+    threads[3] = edf_create(3, HIGHPRIO, (sysinterval_t)0, thread, "A");
+    chSysLock();
+    (void) chThdStartI(threads[0]);
+    (void) chThdStartI(threads[1]);
+    (void) chThdStartI(threads[2]);
+    (void) chThdStartI(threads[3]);
+    chSchRescheduleS();
+    chSysUnlock();
+    test_wait_threads();
+    test_assert_sequence("ABCD", "invalid sequence");
+  }
+
+  /* [3.5.2] An EDF thread with a 10 milliseconds period overruns its
+     first job and delays the second one, the jobs completion times are
+     recorded. The deadline misses are expected to match the jobs
+     completed after their deadline, jobs completed within two
+     milliseconds before their deadline may or may not be counted.*/
+  test_set_step(2);
+  {
+    threads[0] = edf_create(0, CH_CFG_EDF_PRIO, TIME_MS2I(10), edfjobs, NULL);
+    tp = threads[0];
+    release = tp->release;
+    (void) chThdStart(tp);
+    test_wait_threads();
+    misses = chRegGetThreadMissesX(tp);
+    expected = (ucnt_t)0;
+    uncertain = (ucnt_t)0;
+    for (i = 0U; i < EDF_JOBS; i++) {
+      sysinterval_t late = chTimeDiffX(release, edf_done[i]) -
+                           ((sysinterval_t)i * TIME_MS2I(10));
+
+      if (late > TIME_MS2I(10)) {
+        expected++;
+      }
+      else if (late + TIME_MS2I(2) > TIME_MS2I(10)) {
+        uncertain++;
+      }
+    }
+    test_assert(expected >= (ucnt_t)2, "first jobs not overrun");
+    test_assert((misses >= expected) && (misses <= expected + uncertain),
+                "invalid number of deadline misses");
+  }
+
+  /* [3.5.3] A fixed priority thread below the EDF level holds a mutex
+     and an EDF thread blocks on it, the boosted thread is resumed
+     together with an EDF thread having an earlier deadline. The
+     boosted thread is expected to run first, then the EDF threads in
+     deadline order.*/
+  test_set_step(3);
+  {
+#if CH_CFG_USE_MUTEXES == TRUE
+    threads[0] = edf_create(0, CH_CFG_EDF_PRIO - 1, (sysinterval_t)0, edfowner, "A");
+    threads[1] = edf_create(1, CH_CFG_EDF_PRIO, TIME_MS2I(300), edflocker, "C");
+    threads[2] = edf_create(2, CH_CFG_EDF_PRIO, TIME_MS2I(200), thread, "B");
+    (void) chThdStart(threads[0]);
+    (void) chThdStart(threads[1]);
+    test_assert(threads[0]->prio == CH_CFG_EDF_PRIO, "not boosted");
+    chSysLock();
+    (void) chThdStartI(threads[2]);
+    chThdResumeI(&edftr, MSG_OK);
+    chSchRescheduleS();
+    chSysUnlock();
+    test_wait_threads();
+    test_assert_sequence("ABC", "invalid sequence");
+#endif
+  }
+}
+
+static const testcase_t rt_test_003_005 = {
+  "EDF scheduling class",
+  NULL,
+  NULL,
+  rt_test_003_005_execute
+};
+#endif /* CH_CFG_USE_EDF == TRUE */
+
+#if (CH_CFG_USE_BUDGETS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_003_006 [3.6] Threads CPU budgets
+ *
+ * <h2>Description</h2>
+ * The CPU budgets enforcement is tested, a thread exhausting its budget
+ * is expected to be demoted until its budget is replenished.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_BUDGETS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [3.6.1] The number of realtime counter cycles in 10 milliseconds is
+ *   measured.
+ * - [3.6.2] A thread consuming CPU is created with a budget of 5
+ *   milliseconds every 50 milliseconds, then the current thread lowers
+ *   its priority below the new thread. The current thread is expected
+ *   to run again only after the budget has been exhausted.
+ * - [3.6.3] After 120 milliseconds the budget is expected to have been
+ *   replenished and exhausted again.
+ * - [3.6.4] The thread is terminated and the original priority is
+ *   restored.
+ * - [3.6.5] A thread with a budget exhausts it and then waits on a
+ *   mutex owned by the current thread. On replenishment the thread is
+ *   expected to regain its priority in the mutex queue and to boost the
+ *   mutex owner.
+ * - [3.6.6] A thread with a budget locks a mutex and exhausts its
+ *   budget while holding it, then the current thread locks the mutex
+ *   boosting the demoted thread. After releasing the mutex the thread
+ *   is expected to return to the background priority until
+ *   replenishment.
+ * .
+ */
+
+static void rt_test_003_006_execute(void) {
+  tprio_t prio;
+  rtcnt_t start, cycles;
+
+  /* [3.6.1] The number of realtime counter cycles in 10 milliseconds
+     is measured.*/
+  test_set_step(1);
+  {
+    start = chSysGetRealtimeCounterX();
+    chThdSleepMilliseconds(10);
+    cycles = chSysGetRealtimeCounterX() - start;
+    test_assert(cycles > (rtcnt_t)0, "realtime counter not running");
+  }
+
+  /* [3.6.2] A thread consuming CPU is created with a budget of 5
+     milliseconds every 50 milliseconds, then the current thread
+     lowers its priority below the new thread. The current thread is
+     expected to run again only after the budget has been exhausted.*/
+  test_set_step(2);
+  {
+    prio = chThdGetPriorityX();
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio - 1, budgetthread, NULL);
+    chBudgetSet(threads[0], cycles / (rtcnt_t)2, TIME_MS2I(50));
+    start = chSysGetRealtimeCounterX();
+    (void) chThdSetPriority(prio - 2);
+    test_assert(chSysGetRealtimeCounterX() - start >= cycles / (rtcnt_t)2,
+                "budget not consumed");
+    test_assert(chBudgetIsExhaustedX(threads[0]), "budget not exhausted");
+    test_assert(chBudgetGetExhaustionsX(threads[0]) == (ucnt_t)1,
+                "invalid number of exhaustions");
+  }
+
+  /* [3.6.3] After 120 milliseconds the budget is expected to have
+     been replenished and exhausted again.*/
+  test_set_step(3);
+  {
+    chThdSleepMilliseconds(120);
+    test_assert(chBudgetGetExhaustionsX(threads[0]) >= (ucnt_t)2,
+                "budget not replenished");
+  }
+
+  /* [3.6.4] The thread is terminated and the original priority is
+     restored.*/
+  test_set_step(4);
+  {
+    chThdTerminate(threads[0]);
+    test_wait_threads();
+    (void) chThdSetPriority(prio);
+  }
+
+  /* [3.6.5] A thread with a budget exhausts it and then waits on a
+     mutex owned by the current thread. On replenishment the thread is
+     expected to regain its priority in the mutex queue and to boost
+     the mutex owner.*/
+  test_set_step(5);
+  {
+#if CH_CFG_USE_MUTEXES == TRUE
+    chMtxLock(&budgetmtx);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio - 1, budgetwaiter, NULL);
+    chBudgetSet(threads[0], cycles / (rtcnt_t)2, TIME_MS2I(50));
+    (void) chThdSetPriority(prio - 2);
+    chThdSleepMilliseconds(10);
+    test_assert(threads[0]->state == CH_STATE_WTMTX, "not waiting on the mutex");
+    test_assert(chThdGetPriorityX() == prio - 2, "unexpected priority level");
+    chThdSleepMilliseconds(50);
+    test_assert(!chBudgetIsExhaustedX(threads[0]), "budget not replenished");
+    test_assert(chThdGetPriorityX() == prio - 1, "owner not boosted");
+    chMtxUnlock(&budgetmtx);
+    test_wait_threads();
+    (void) chThdSetPriority(prio);
+#endif
+  }
+
+  /* [3.6.6] A thread with a budget locks a mutex and exhausts its
+     budget while holding it, then the current thread locks the mutex
+     boosting the demoted thread. After releasing the mutex the thread
+     is expected to return to the background priority until
+     replenishment.*/
+  test_set_step(6);
+  {
+#if CH_CFG_USE_MUTEXES == TRUE
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio - 1, budgetowner, NULL);
+    chBudgetSet(threads[0], cycles / (rtcnt_t)2, TIME_MS2I(50));
+    (void) chThdSetPriority(prio - 2);
+    test_assert(chBudgetIsExhaustedX(threads[0]), "budget not exhausted");
+    test_assert(threads[0]->prio == CH_CFG_BUDGET_PRIO, "not demoted");
+    chThdTerminate(threads[0]);
+    chMtxLock(&budgetmtx);
+    test_assert(threads[0]->prio == CH_CFG_BUDGET_PRIO, "demotion lost");
+    test_assert(threads[0]->realprio == CH_CFG_BUDGET_PRIO, "demotion lost");
+    chMtxUnlock(&budgetmtx);
+    test_wait_threads();
+    (void) chThdSetPriority(prio);
+#endif
+  }
+}
+
+static const testcase_t rt_test_003_006 = {
+  "Threads CPU budgets",
+  NULL,
+  NULL,
+  rt_test_003_006_execute
+};
+#endif /* CH_CFG_USE_BUDGETS == TRUE */
+
+#if ((CH_DBG_STATISTICS == TRUE) && (CH_CFG_USE_REGISTRY == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_003_007 [3.7] Threads CPU load statistics
+ *
+ * <h2>Description</h2>
+ * The threads run time accounting and the CPU load statistics are
+ * tested.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_DBG_STATISTICS == TRUE) && (CH_CFG_USE_REGISTRY == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [3.7.1] The number of realtime counter cycles in 10 milliseconds is
+ *   measured.
+ * - [3.7.2] The current thread consumes CPU for the measured number of
+ *   cycles, its net run time is expected to increase accordingly.
+ * - [3.7.3] The current thread sleeps for two statistics windows, its
+ *   load is expected to be low while the idle thread, if present, is
+ *   expected to have used most of the CPU time.
+ * .
+ */
+
+static void rt_test_003_007_execute(void) {
+  rttime_t c1, c2;
+  rtcnt_t start, cycles;
+
+  /* [3.7.1] The number of realtime counter cycles in 10 milliseconds
+     is measured.*/
+  test_set_step(1);
+  {
+    start = chSysGetRealtimeCounterX();
+    chThdSleepMilliseconds(10);
+    cycles = chSysGetRealtimeCounterX() - start;
+    test_assert(cycles > (rtcnt_t)0, "realtime counter not running");
+  }
+
+  /* [3.7.2] The current thread consumes CPU for the measured number
+     of cycles, its net run time is expected to increase accordingly.*/
+  test_set_step(2);
+  {
+    chSysLock();
+    c1 = chStatsGetThreadCyclesI(chThdGetSelfX());
+    chSysUnlock();
+    start = chSysGetRealtimeCounterX();
+    while (chSysGetRealtimeCounterX() - start < cycles) {
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    }
+    chSysLock();
+    c2 = chStatsGetThreadCyclesI(chThdGetSelfX());
+    chSysUnlock();
+    test_assert(c2 - c1 >= (rttime_t)(cycles / (rtcnt_t)2),
+                "run time not accounted");
+  }
+
+  /* [3.7.3] The current thread sleeps for two statistics windows, its
+     load is expected to be low while the idle thread, if present, is
+     expected to have used most of the CPU time.*/
+  test_set_step(3);
+  {
+    chThdSleepMilliseconds(CH_DBG_STATISTICS_WINDOW * 2);
+    test_assert(chStatsGetThreadLoadX(chThdGetSelfX()) < (uint32_t)100,
+                "thread load too high");
+    test_assert(chStatsGetCPULoadX() <= (uint32_t)1000, "invalid CPU load");
+#if CH_CFG_NO_IDLE_THREAD == FALSE
+    {
+      thread_t *tp = chRegFindThreadByName("idle");
+
+      test_assert(tp != NULL, "idle thread not found");
+      test_assert(chStatsGetThreadLoadX(tp) >= (uint32_t)500,
+                  "idle load too low");
+      chThdRelease(tp);
+    }
+#endif
+  }
+}
+
+static const testcase_t rt_test_003_007 = {
+  "Threads CPU load statistics",
+  NULL,
+  NULL,
+  rt_test_003_007_execute
+};
+#endif /* (CH_DBG_STATISTICS == TRUE) && (CH_CFG_USE_REGISTRY == TRUE) */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -338,6 +804,15 @@ const testcase_t * const rt_test_sequence_003_array[] = {
   &rt_test_003_003,
 #if (CH_CFG_USE_MUTEXES) || defined(__DOXYGEN__)
   &rt_test_003_004,
+#endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  &rt_test_003_005,
+#endif
+#if (CH_CFG_USE_BUDGETS == TRUE) || defined(__DOXYGEN__)
+  &rt_test_003_006,
+#endif
+#if ((CH_DBG_STATISTICS == TRUE) && (CH_CFG_USE_REGISTRY == TRUE)) || defined(__DOXYGEN__)
+  &rt_test_003_007,
 #endif
   NULL
 };
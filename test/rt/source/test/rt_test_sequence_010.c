@@ -46,6 +46,16 @@
  * - @subpage rt_test_010_010
  * - @subpage rt_test_010_011
  * - @subpage rt_test_010_012
+ * - @subpage rt_test_010_013
+ * - @subpage rt_test_010_014
+ * - @subpage rt_test_010_015
+ * - @subpage rt_test_010_016
+ * - @subpage rt_test_010_017
+ * - @subpage rt_test_010_018
+ * - @subpage rt_test_010_019
+ * - @subpage rt_test_010_020
+ * - @subpage rt_test_010_021
+ * - @subpage rt_test_010_022
  * .
  */
 
@@ -59,9 +69,177 @@ static semaphore_t sem1;
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
 static mutex_t mtx1;
 #endif
+#if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
+static condition_variable_t cnd1;
+#endif
 
 static void tmo(void *param) {(void)param;}
 
+#if CH_CFG_USE_HEAP == TRUE
+static memory_heap_t bmk_heap;
+static void *bmk_blocks[128];
+#endif
+
+#if CH_CFG_USE_POOL_MAGAZINES == TRUE
+#define BMK_POOL_BURST 12U
+
+static memory_pool_t bmk_pool;
+static pool_magazine_t bmk_mag;
+static void *bmk_objects[BMK_POOL_BURST];
+#endif
+
+#if (CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE)
+#define BMK_FACTORY_OBJECTS 1000U
+
+static registered_object_t *bmk_registered[BMK_FACTORY_OBJECTS];
+
+static void bmk_name(char *name, unsigned n) {
+
+  name[0] = 'o';
+  name[1] = (char)('0' + ((n / 1000U) % 10U));
+  name[2] = (char)('0' + ((n / 100U) % 10U));
+  name[3] = (char)('0' + ((n / 10U) % 10U));
+  name[4] = (char)('0' + (n % 10U));
+  name[5] = '\0';
+}
+
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+static ucnt_t bmk_indexed, bmk_unindexed;
+
+static void bmk_print_index(void) {
+
+  test_print("--- Index        : ");
+  test_printn((uint32_t)bmk_indexed);
+  test_print(" indexed, ");
+  test_printn((uint32_t)bmk_unindexed);
+  test_println(" unindexed");
+}
+#endif
+
+/* Returns the number of loops in a second, zero if the objects could not
+   be registered.*/
+static uint32_t bmk_factory(unsigned n) {
+  registered_object_t *rop;
+  uint32_t cnt, seed;
+  systime_t start, end;
+  char name[8];
+  unsigned i;
+
+  for (i = 0U; i < n; i++) {
+    bmk_name(name, i);
+    bmk_registered[i] = chFactoryRegisterObject(name,
+                                                (void *)&bmk_registered[i]);
+    if (bmk_registered[i] == NULL) {
+      break;
+    }
+  }
+
+  cnt = 0U;
+  if (i == n) {
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+    /* Index occupation with all the objects registered.*/
+    bmk_indexed = ch_factory.indexed;
+    bmk_unindexed = ch_factory.obj_list.unindexed;
+#endif
+    seed = 1U;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      seed = (seed * 1103515245U) + 12345U;
+      bmk_name(name, (unsigned)(seed >> 16) % n);
+      rop = chFactoryFindObject(name);
+      chFactoryReleaseObject(rop);
+      bmk_name(name, n);
+      rop = chFactoryRegisterObject(name, NULL);
+      chFactoryReleaseObject(rop);
+      cnt++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+
+  while (i > 0U) {
+    i--;
+    chFactoryReleaseObject(bmk_registered[i]);
+  }
+
+  return cnt;
+}
+#endif
+
+#if CH_CFG_USE_PIPES == TRUE
+static uint8_t bmk_pipe_buffer[256];
+static uint8_t bmk_pipe_block[64];
+static uint8_t bmk_pipe_rdblock[64];
+static pipe_t bmk_pipe;
+
+static THD_FUNCTION(bmk_pipe_reader, p) {
+
+  (void)p;
+  while (chPipeReadTimeout(&bmk_pipe, bmk_pipe_rdblock,
+                           sizeof bmk_pipe_rdblock, TIME_INFINITE) ==
+         sizeof bmk_pipe_rdblock) {
+  }
+}
+
+static THD_FUNCTION(bmk_pipe_span_reader, p) {
+  pipe_span_t span;
+  size_t size;
+
+  (void)p;
+  do {
+    size = chPipeReadAcquireTimeout(&bmk_pipe, &span, TIME_INFINITE);
+    if (size > sizeof bmk_pipe_rdblock) {
+      size = sizeof bmk_pipe_rdblock;
+    }
+    chPipeReadCommit(&bmk_pipe, &span, size);
+  } while (size > 0U);
+}
+#endif
+
+static volatile uint32_t bmk_reloads;
+
+/* Periodic timer callback counting the reloads.*/
+static void bmk_reloadcb(void *p) {
+
+  (void)p;
+
+  bmk_reloads++;
+}
+
+#if CH_DBG_STATISTICS == TRUE
+static volatile uint32_t bmk_vtcnt;
+
+/* Timer callback executing a critical zone from ISR context.*/
+static void bmk_vtcb(void *p) {
+  unsigned i;
+
+  (void)p;
+
+  chSysLockFromISR();
+  for (i = 0U; i < 64U; i++) {
+    bmk_vtcnt++;
+  }
+  chSysUnlockFromISR();
+}
+
+#if CH_CFG_VT_DEFERRED == TRUE
+/* Timer callback executing a critical zone from thread context.*/
+static void bmk_vtdefcb(void *p) {
+  unsigned i;
+
+  (void)p;
+
+  chSysLock();
+  for (i = 0U; i < 64U; i++) {
+    bmk_vtcnt++;
+  }
+  chSysUnlock();
+}
+#endif
+#endif
+
 #if CH_CFG_USE_MESSAGES
 static THD_FUNCTION(bmk_thread1, p) {
   thread_t *tp;
@@ -134,6 +312,26 @@ static THD_FUNCTION(bmk_thread8, p) {
   } while(!chThdShouldTerminateX());
 }
 
+#if CH_CFG_USE_CONDVARS
+/* Threads of the ready list benchmark, spread over BMK_RL_LEVELS priority
+   levels so that the insertion cost depends on the ready list
+   organization.*/
+#define BMK_RL_THREADS 40U
+#define BMK_RL_LEVELS 20U
+
+static THD_WORKING_AREA(bmk_rl_wa[BMK_RL_THREADS], THREADS_STACK_SIZE);
+static thread_t *bmk_rl_threads[BMK_RL_THREADS];
+
+static THD_FUNCTION(bmk_thread9, p) {
+
+  (void)p;
+  chMtxLock(&mtx1);
+  while (!chThdShouldTerminateX())
+    chCondWait(&cnd1);
+  chMtxUnlock(&mtx1);
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -994,38 +1192,1117 @@ static const testcase_t rt_test_010_012 = {
   rt_test_010_012_execute
 };
 
-/****************************************************************************
- * Exported data.
- ****************************************************************************/
+#if (CH_CFG_USE_CONDVARS) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_010_013 [10.13] Ready list insertion performance
+ *
+ * <h2>Description</h2>
+ * Forty threads are created over twenty higher priority levels and
+ * wait on a condition variable. The condition variable is broadcast
+ * into a continuous loop, the threads are made ready in decreasing
+ * priority order so each thread is inserted in the ready list behind
+ * the threads already made ready.<br> The performance is calculated by
+ * measuring the number of iterations after a second of continuous
+ * operations.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_CONDVARS
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [10.13.1] Forty threads are created over twenty higher priority
+ *   levels, the threads immediately wait on a condition variable.
+ * - [10.13.2] The condition variable is broadcast waking up the forty
+ *   threads. The operation is repeated continuously in a one-second
+ *   time window.
+ * - [10.13.3] The forty threads are terminated.
+ * - [10.13.4] The score is printed.
+ * .
+ */
+
+static void rt_test_010_013_setup(void) {
+  chMtxObjectInit(&mtx1);
+  chCondObjectInit(&cnd1);
+}
+
+static void rt_test_010_013_execute(void) {
+  uint32_t n;
+
+  /* [10.13.1] Forty threads are created over twenty higher priority
+     levels, the threads immediately wait on a condition variable.*/
+  test_set_step(1);
+  {
+    unsigned i;
+
+    for (i = 0U; i < BMK_RL_THREADS; i++) {
+      bmk_rl_threads[i] = chThdCreateStatic(bmk_rl_wa[i], sizeof (bmk_rl_wa[i]),
+                                            chThdGetPriorityX() + 1 + (tprio_t)(i % BMK_RL_LEVELS),
+                                            bmk_thread9, NULL);
+    }
+  }
+
+  /* [10.13.2] The condition variable is broadcast waking up the forty
+     threads. The operation is repeated continuously in a one-second
+     time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      chCondBroadcast(&cnd1);
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+
+  /* [10.13.3] The forty threads are terminated.*/
+  test_set_step(3);
+  {
+    unsigned i;
+
+    for (i = 0U; i < BMK_RL_THREADS; i++) {
+      chThdTerminate(bmk_rl_threads[i]);
+    }
+    chCondBroadcast(&cnd1);
+    for (i = 0U; i < BMK_RL_THREADS; i++) {
+      chThdWait(bmk_rl_threads[i]);
+    }
+  }
+
+  /* [10.13.4] The score is printed.*/
+  test_set_step(4);
+  {
+    test_print("--- Score : ");
+    test_printn(n);
+    test_print(" reschedules/S, ");
+    test_printn(n * (BMK_RL_THREADS + 1U));
+    test_println(" ctxswc/S");
+  }
+}
+
+static const testcase_t rt_test_010_013 = {
+  "Ready list insertion performance",
+  rt_test_010_013_setup,
+  NULL,
+  rt_test_010_013_execute
+};
+#endif /* CH_CFG_USE_CONDVARS */
 
 /**
- * @brief   Array of test cases.
+ * @page rt_test_010_014 [10.14] Virtual Timers scalability
+ *
+ * <h2>Description</h2>
+ * N virtual timers with scattered delays are armed then disarmed into a
+ * continuous loop, N doubles from 1 up to 1024 or up to the number of
+ * timers fitting the test buffer.<br> The performance is calculated,
+ * for each N, by measuring the number of armed and disarmed timers
+ * after 100 milliseconds of continuous operations.
+ *
+ * <h2>Test Steps</h2>
+ * - [10.14.1] The maximum number of timers is calculated, the test
+ *   buffer is used as timers storage.
+ * - [10.14.2] For each N the timers are armed then disarmed without
+ *   waiting for their counter to elapse, the operation is repeated
+ *   continuously in a 100 milliseconds time window and the score is
+ *   printed.
+ * .
  */
-const testcase_t * const rt_test_sequence_010_array[] = {
-#if (CH_CFG_USE_MESSAGES) || defined(__DOXYGEN__)
-  &rt_test_010_001,
+
+static void rt_test_010_014_execute(void) {
+  virtual_timer_t *vtp = (virtual_timer_t *)test_buffer;
+  unsigned i, n, max;
+
+  /* [10.14.1] The maximum number of timers is calculated, the test
+     buffer is used as timers storage.*/
+  test_set_step(1);
+  {
+    max = sizeof test_buffer / sizeof (virtual_timer_t);
+    if (max > 1024U) {
+      max = 1024U;
+    }
+  }
+
+  /* [10.14.2] For each N the timers are armed then disarmed without
+     waiting for their counter to elapse, the operation is repeated
+     continuously in a 100 milliseconds time window and the score is
+     printed.*/
+  test_set_step(2);
+  {
+    for (n = 1U; n <= max; n *= 2U) {
+      systime_t start, end;
+      uint32_t iter = 0;
+
+      start = test_wait_tick();
+      end = chTimeAddX(start, TIME_MS2I(100));
+      do {
+        for (i = 0U; i < n; i++) {
+          chSysLock();
+          chVTDoSetI(&vtp[i],
+                     TIME_MS2I(1000) + (sysinterval_t)((i * 613U) & 1023U),
+                     tmo, NULL);
+          chSysUnlock();
+        }
+        for (i = 0U; i < n; i++) {
+          chSysLock();
+          chVTDoResetI(&vtp[i]);
+          chSysUnlock();
+        }
+        iter++;
+#if defined(SIMULATOR)
+        _sim_check_for_interrupts();
 #endif
-#if (CH_CFG_USE_MESSAGES) || defined(__DOXYGEN__)
-  &rt_test_010_002,
+      } while (chVTIsSystemTimeWithinX(start, end));
+
+      test_print("--- Timers ");
+      test_printn(n);
+      test_print(" : ");
+      test_printn(iter * n * 10U);
+      test_println(" timers/S");
+    }
+  }
+}
+
+static const testcase_t rt_test_010_014 = {
+  "Virtual Timers scalability",
+  NULL,
+  NULL,
+  rt_test_010_014_execute
+};
+
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_010_015 [10.15] Virtual Timers callbacks critical zones
+ *
+ * <h2>Description</h2>
+ * Sixteen virtual timers expiring on the same tick are armed, their
+ * callbacks execute a critical zone. The worst critical zone measured
+ * in ISR context is printed for callbacks executed by the timer
+ * interrupt and, if enabled, for callbacks deferred to the virtual
+ * timers thread.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_DBG_STATISTICS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [10.15.1] The timers are armed with callbacks executed by the timer
+ *   interrupt, the worst ISR critical zone is printed.
+ * - [10.15.2] The timers are armed with callbacks deferred to the
+ *   virtual timers thread, the worst ISR critical zone is printed.
+ * .
+ */
+
+static void rt_test_010_015_execute(void) {
+  virtual_timer_t *vtp = (virtual_timer_t *)test_buffer;
+  unsigned i;
+
+  /* [10.15.1] The timers are armed with callbacks executed by the
+     timer interrupt, the worst ISR critical zone is printed.*/
+  test_set_step(1);
+  {
+    chSysLock();
+    chTMObjectInit(&ch.kernel_stats.m_crit_isr);
+    for (i = 0U; i < 16U; i++) {
+      chVTDoSetI(&vtp[i], TIME_MS2I(10), bmk_vtcb, NULL);
+    }
+    chSysUnlock();
+    chThdSleepMilliseconds(50);
+
+    test_print("--- ISR crit. : ");
+    test_printn(ch.kernel_stats.m_crit_isr.worst);
+    test_println(" cycles (immediate)");
+  }
+
+  /* [10.15.2] The timers are armed with callbacks deferred to the
+     virtual timers thread, the worst ISR critical zone is printed.*/
+  test_set_step(2);
+  {
+#if CH_CFG_VT_DEFERRED == TRUE
+    chSysLock();
+    chTMObjectInit(&ch.kernel_stats.m_crit_isr);
+    for (i = 0U; i < 16U; i++) {
+      chVTDoSetDeferredI(&vtp[i], TIME_MS2I(10), 0, bmk_vtdefcb, NULL);
+    }
+    chSysUnlock();
+    chThdSleepMilliseconds(50);
+
+    test_print("--- ISR crit. : ");
+    test_printn(ch.kernel_stats.m_crit_isr.worst);
+    test_println(" cycles (deferred)");
 #endif
-#if (CH_CFG_USE_MESSAGES) || defined(__DOXYGEN__)
-  &rt_test_010_003,
+  }
+}
+
+static const testcase_t rt_test_010_015 = {
+  "Virtual Timers callbacks critical zones",
+  NULL,
+  NULL,
+  rt_test_010_015_execute
+};
+#endif /* CH_DBG_STATISTICS == TRUE */
+
+#if (CH_CFG_USE_HEAP) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_010_016 [10.16] Memory Heaps fragmentation stress
+ *
+ * <h2>Description</h2>
+ * Blocks of random size and alignment are allocated and freed in random
+ * order into a continuous loop, the heap is kept fragmented and
+ * partially full.<br> The performance is calculated by measuring the
+ * number of allocations and releases after a second of continuous
+ * operations, the number of failed allocations and the final
+ * fragmentation are also printed.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_HEAP
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [10.16.1] The heap is initialized on the test buffer, the heap must
+ *   not be fragmented.
+ * - [10.16.2] Blocks of random size, one in four with a 64 bytes
+ *   alignment, are allocated into random slots or freed if the slot is
+ *   already in use. The operation is repeated continuously in a
+ *   one-second time window.
+ * - [10.16.3] The fragmentation state is printed.
+ * - [10.16.4] All the blocks are freed, the heap must be back to the
+ *   initial state.
+ * .
+ */
+
+static void rt_test_010_016_execute(void) {
+  size_t n, total;
+  uint32_t fails;
+  unsigned i;
+
+  /* [10.16.1] The heap is initialized on the test buffer, the heap
+     must not be fragmented.*/
+  test_set_step(1);
+  {
+    chHeapObjectInit(&bmk_heap, test_buffer, sizeof test_buffer);
+    n = chHeapStatus(&bmk_heap, &total, NULL);
+    test_assert(n == 1U, "heap fragmented");
+    for (i = 0U; i < 128U; i++) {
+      bmk_blocks[i] = NULL;
+    }
+  }
+
+  /* [10.16.2] Blocks of random size, one in four with a 64 bytes
+     alignment, are allocated into random slots or freed if the slot
+     is already in use. The operation is repeated continuously in a
+     one-second time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+    uint32_t seed = 1U;
+#if CH_CFG_USE_TM == TRUE
+    time_measurement_t tm;
+
+    chTMObjectInit(&tm);
 #endif
-  &rt_test_010_004,
-  &rt_test_010_005,
-  &rt_test_010_006,
-#if (CH_CFG_USE_SEMAPHORES) || defined(__DOXYGEN__)
-  &rt_test_010_007,
+
+    n = 0U;
+    fails = 0U;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      seed = (seed * 1103515245U) + 12345U;
+      i = (seed >> 16) & 127U;
+      if (bmk_blocks[i] != NULL) {
+        test_assert(*(uint8_t *)bmk_blocks[i] == (uint8_t)i, "corrupted block");
+        chHeapFree(bmk_blocks[i]);
+        bmk_blocks[i] = NULL;
+      }
+      else {
+        size_t size = 1U + ((seed >> 4) % (sizeof test_buffer / 64U));
+
+#if CH_CFG_USE_TM == TRUE
+        chTMStartMeasurementX(&tm);
 #endif
-  &rt_test_010_008,
-  &rt_test_010_009,
-#if (CH_CFG_USE_SEMAPHORES) || defined(__DOXYGEN__)
-  &rt_test_010_010,
+        if ((i & 3U) == 0U) {
+          bmk_blocks[i] = chHeapAllocAligned(&bmk_heap, size, 64U);
+        }
+        else {
+          bmk_blocks[i] = chHeapAlloc(&bmk_heap, size);
+        }
+#if CH_CFG_USE_TM == TRUE
+        chTMStopMeasurementX(&tm);
 #endif
-#if (CH_CFG_USE_MUTEXES) || defined(__DOXYGEN__)
-  &rt_test_010_011,
+        if (bmk_blocks[i] != NULL) {
+          *(uint8_t *)bmk_blocks[i] = (uint8_t)i;
+        }
+        else {
+          fails++;
+        }
+      }
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
 #endif
-  &rt_test_010_012,
+    } while (chVTIsSystemTimeWithinX(start, end));
+
+    test_print("--- Score : ");
+    test_printn(n);
+    test_print(" alloc+free/S, ");
+    test_printn(fails);
+    test_println(" failed");
+#if CH_CFG_USE_TM == TRUE
+    test_print("--- Alloc : ");
+    test_printn(tm.worst);
+    test_println(" cycles worst");
+#endif
+  }
+
+  /* [10.16.3] The fragmentation state is printed.*/
+  test_set_step(3);
+  {
+    size_t ftotal, flargest;
+
+    n = chHeapStatus(&bmk_heap, &ftotal, &flargest);
+    test_print("--- Frag. : ");
+    test_printn(n);
+    test_print(" fragments, ");
+    test_printn(flargest);
+    test_print("/");
+    test_printn(ftotal);
+    test_println(" largest/free bytes");
+  }
+
+  /* [10.16.4] All the blocks are freed, the heap must be back to the
+     initial state.*/
+  test_set_step(4);
+  {
+    size_t ftotal;
+
+    for (i = 0U; i < 128U; i++) {
+      if (bmk_blocks[i] != NULL) {
+        chHeapFree(bmk_blocks[i]);
+      }
+    }
+    n = chHeapStatus(&bmk_heap, &ftotal, NULL);
+    test_assert(n == 1U, "heap fragmented");
+    test_assert(ftotal == total, "size changed");
+  }
+}
+
+static const testcase_t rt_test_010_016 = {
+  "Memory Heaps fragmentation stress",
+  NULL,
+  NULL,
+  rt_test_010_016_execute
+};
+#endif /* CH_CFG_USE_HEAP */
+
+#if (CH_CFG_USE_POOL_MAGAZINES) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_010_017 [10.17] Memory Pools magazines
+ *
+ * <h2>Description</h2>
+ * Bursts of objects are allocated and then released, first directly from
+ * a memory pool then through a magazine.<br> The performance is
+ * calculated by measuring the number of allocations and releases after a
+ * second of continuous operations, the magazine hit rates and the number
+ * of objects moved in batches are also printed.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_POOL_MAGAZINES
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [10.17.1] The pool is loaded with 16 bytes objects from the test
+ *   buffer, bursts of objects are allocated and then released directly
+ *   from the pool. The operation is repeated continuously in a
+ *   one-second time window.
+ * - [10.17.2] The same bursts are allocated and released through a
+ *   magazine in a one-second time window, the hit rates and the number
+ *   of objects moved in batches are printed.
+ * - [10.17.3] The magazine is flushed, all the objects must be back in
+ *   the pool.
+ * .
+ */
+
+static void rt_test_010_017_execute(void) {
+  uint32_t n;
+  size_t objects;
+  unsigned i;
+
+  /* [10.17.1] The pool is loaded with 16 bytes objects from the test buffer,
+     bursts of objects are allocated and then released directly from the
+     pool. The operation is repeated continuously in a one-second time
+     window.*/
+  test_set_step(1);
+  {
+    systime_t start, end;
+
+    chPoolObjectInit(&bmk_pool, 16U, NULL);
+    objects = sizeof test_buffer / 16U;
+    chPoolLoadArray(&bmk_pool, test_buffer, objects);
+
+    n = 0U;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      for (i = 0U; i < BMK_POOL_BURST; i++) {
+        bmk_objects[i] = chPoolAlloc(&bmk_pool);
+      }
+      for (i = 0U; i < BMK_POOL_BURST; i++) {
+        chPoolFree(&bmk_pool, bmk_objects[i]);
+      }
+      n += BMK_POOL_BURST;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+
+    test_print("--- Pool  : ");
+    test_printn(n);
+    test_println(" alloc+free/S");
+  }
+
+  /* [10.17.2] The same bursts are allocated and released through a magazine
+     in a one-second time window, the hit rates and the number of objects
+     moved in batches are printed.*/
+  test_set_step(2);
+  {
+    const pool_magazine_stats_t *stats;
+    systime_t start, end;
+
+    chPoolMagazineObjectInit(&bmk_mag, &bmk_pool);
+    stats = chPoolMagazineGetStatisticsX(&bmk_mag);
+
+    n = 0U;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      for (i = 0U; i < BMK_POOL_BURST; i++) {
+        bmk_objects[i] = chPoolMagazineAlloc(&bmk_mag);
+      }
+      for (i = 0U; i < BMK_POOL_BURST; i++) {
+        chPoolMagazineFree(&bmk_mag, bmk_objects[i]);
+      }
+      n += BMK_POOL_BURST;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+
+    test_print("--- Magaz.: ");
+    test_printn(n);
+    test_println(" alloc+free/S");
+    test_print("--- Hits  : ");
+    test_printn((uint32_t)(((uint64_t)stats->alloc_hits * 100U) /
+                           (stats->alloc_hits + stats->alloc_misses)));
+    test_print("% alloc, ");
+    test_printn((uint32_t)(((uint64_t)stats->free_hits * 100U) /
+                           (stats->free_hits + stats->free_misses)));
+    test_println("% free");
+    test_print("--- Batch : ");
+    test_printn(stats->refilled + stats->flushed);
+    test_println(" objects moved");
+  }
+
+  /* [10.17.3] The magazine is flushed, all the objects must be back in the
+     pool.*/
+  test_set_step(3);
+  {
+    chPoolMagazineFlush(&bmk_mag);
+    for (i = 0U; i < objects; i++) {
+      test_assert(chPoolAlloc(&bmk_pool) != NULL, "objects lost");
+    }
+    test_assert(chPoolAlloc(&bmk_pool) == NULL, "too many objects");
+  }
+}
+
+static const testcase_t rt_test_010_017 = {
+  "Memory Pools magazines",
+  NULL,
+  NULL,
+  rt_test_010_017_execute
+};
+#endif /* CH_CFG_USE_POOL_MAGAZINES */
+
+#if ((CH_CFG_USE_SLAB == TRUE) && (CH_CFG_USE_HEAP == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_010_018 [10.18] Slab allocator vs heap
+ *
+ * <h2>Description</h2>
+ * Objects of random small size are allocated and freed in random order
+ * into a continuous loop, first using a heap then using the slab
+ * allocator.<br> The performance is calculated by measuring the number
+ * of allocations and releases after a second of continuous operations,
+ * the heap fragmentation is also printed.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_SLAB == TRUE) && (CH_CFG_USE_HEAP == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [10.18.1] The heap is initialized on the test buffer, objects from 1
+ *   to 128 bytes are allocated into random slots or freed if the slot is
+ *   already in use. The operation is repeated continuously in a
+ *   one-second time window.
+ * - [10.18.2] The heap objects are freed, the heap must be back to the
+ *   initial state.
+ * - [10.18.3] The same sequence is repeated using the slab allocator.
+ * - [10.18.4] The slab objects are freed.
+ * .
+ */
+
+static void rt_test_010_018_execute(void) {
+  uint32_t n, seed;
+  systime_t start, end;
+  size_t frags, total;
+  unsigned i;
+
+  /* [10.18.1] The heap is initialized on the test buffer, objects from 1 to
+     128 bytes are allocated into random slots or freed if the slot is
+     already in use. The operation is repeated continuously in a one-second
+     time window.*/
+  test_set_step(1);
+  {
+    chHeapObjectInit(&bmk_heap, test_buffer, sizeof test_buffer);
+    (void)chHeapStatus(&bmk_heap, &total, NULL);
+    for (i = 0U; i < 64U; i++) {
+      bmk_blocks[i] = NULL;
+    }
+
+    n = 0U;
+    seed = 1U;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      seed = (seed * 1103515245U) + 12345U;
+      i = (seed >> 16) & 63U;
+      if (bmk_blocks[i] != NULL) {
+        chHeapFree(bmk_blocks[i]);
+        bmk_blocks[i] = NULL;
+      }
+      else {
+        bmk_blocks[i] = chHeapAlloc(&bmk_heap, 1U + ((seed >> 4) & 127U));
+      }
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+
+    frags = chHeapStatus(&bmk_heap, NULL, NULL);
+    test_print("--- Heap  : ");
+    test_printn(n);
+    test_print(" alloc+free/S, ");
+    test_printn(frags);
+    test_println(" fragments");
+  }
+
+  /* [10.18.2] The heap objects are freed, the heap must be back to the
+     initial state.*/
+  test_set_step(2);
+  {
+    size_t ftotal;
+
+    for (i = 0U; i < 64U; i++) {
+      if (bmk_blocks[i] != NULL) {
+        chHeapFree(bmk_blocks[i]);
+        bmk_blocks[i] = NULL;
+      }
+    }
+    frags = chHeapStatus(&bmk_heap, &ftotal, NULL);
+    test_assert(frags == 1U, "heap fragmented");
+    test_assert(ftotal == total, "size changed");
+  }
+
+  /* [10.18.3] The same sequence is repeated using the slab allocator.*/
+  test_set_step(3);
+  {
+    n = 0U;
+    seed = 1U;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      seed = (seed * 1103515245U) + 12345U;
+      i = (seed >> 16) & 63U;
+      if (bmk_blocks[i] != NULL) {
+        chSlabFree(bmk_blocks[i]);
+        bmk_blocks[i] = NULL;
+      }
+      else {
+        bmk_blocks[i] = chSlabAlloc(1U + ((seed >> 4) & 127U));
+      }
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+
+    test_print("--- Slab  : ");
+    test_printn(n);
+    test_println(" alloc+free/S");
+  }
+
+  /* [10.18.4] The slab objects are freed.*/
+  test_set_step(4);
+  {
+    for (i = 0U; i < 64U; i++) {
+      chSlabFree(bmk_blocks[i]);
+      bmk_blocks[i] = NULL;
+    }
+  }
+}
+
+static const testcase_t rt_test_010_018 = {
+  "Slab allocator vs heap",
+  NULL,
+  NULL,
+  rt_test_010_018_execute
+};
+#endif /* (CH_CFG_USE_SLAB == TRUE) && (CH_CFG_USE_HEAP == TRUE) */
+
+#if ((CH_CFG_USE_ARENAS == TRUE) && (CH_CFG_USE_HEAP == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_010_019 [10.19] Arena allocator vs heap
+ *
+ * <h2>Description</h2>
+ * Bursts of eight objects of random small size are allocated and then
+ * all released, as done when processing a request, first using a heap
+ * then using an arena.<br> The performance is calculated by measuring
+ * the number of allocations after a second of continuous operations,
+ * each allocation includes its release.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_ARENAS == TRUE) && (CH_CFG_USE_HEAP == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [10.19.1] The heap is initialized on the test buffer, eight objects
+ *   from 1 to 16 bytes are allocated then freed. The operation is
+ *   repeated continuously in a one-second time window.
+ * - [10.19.2] The same sequence is repeated using an arena on the test
+ *   buffer, the objects are released by resetting the arena.
+ * .
+ */
+
+static void rt_test_010_019_execute(void) {
+  uint32_t n, seed;
+  systime_t start, end;
+  memory_arena_t arena;
+  unsigned i;
+
+  /* [10.19.1] The heap is initialized on the test buffer, eight objects from
+     1 to 16 bytes are allocated then freed. The operation is repeated
+     continuously in a one-second time window.*/
+  test_set_step(1);
+  {
+    chHeapObjectInit(&bmk_heap, test_buffer, sizeof test_buffer);
+
+    n = 0U;
+    seed = 1U;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      for (i = 0U; i < 8U; i++) {
+        seed = (seed * 1103515245U) + 12345U;
+        bmk_blocks[i] = chHeapAlloc(&bmk_heap, 1U + ((seed >> 16) & 15U));
+      }
+      for (i = 0U; i < 8U; i++) {
+        chHeapFree(bmk_blocks[i]);
+      }
+      n += 8U;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+
+    test_print("--- Heap  : ");
+    test_printn(n);
+    test_println(" alloc+free/S");
+  }
+
+  /* [10.19.2] The same sequence is repeated using an arena on the test
+     buffer, the objects are released by resetting the arena.*/
+  test_set_step(2);
+  {
+    chArenaObjectInit(&arena, test_buffer, sizeof test_buffer);
+
+    n = 0U;
+    seed = 1U;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      for (i = 0U; i < 8U; i++) {
+        seed = (seed * 1103515245U) + 12345U;
+        bmk_blocks[i] = chArenaAlloc(&arena, 1U + ((seed >> 16) & 15U));
+      }
+      chArenaReset(&arena);
+      n += 8U;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+
+    test_print("--- Arena : ");
+    test_printn(n);
+    test_println(" alloc+free/S");
+  }
+}
+
+static const testcase_t rt_test_010_019 = {
+  "Arena allocator vs heap",
+  NULL,
+  NULL,
+  rt_test_010_019_execute
+};
+#endif /* (CH_CFG_USE_ARENAS == TRUE) && (CH_CFG_USE_HEAP == TRUE) */
+
+#if ((CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_010_020 [10.20] Objects factory lookups
+ *
+ * <h2>Description</h2>
+ * A number of objects is registered in the objects factory, then a
+ * random object is retrieved by name and a new object is registered,
+ * both are released, into a continuous loop.<br> The performance is
+ * calculated by measuring the number of loops after a second of
+ * continuous operations, the test is repeated with 10, 100 and 1000
+ * registered objects.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [10.20.1] Registering 10 objects, then finding a random object and
+ *   registering a new object, both references are released. The
+ *   operation is repeated continuously in a one-second time window.
+ * - [10.20.2] The same sequence is repeated with 100 objects.
+ * - [10.20.3] The same sequence is repeated with 1000 objects.
+ * .
+ */
+
+static void rt_test_010_020_execute(void) {
+  uint32_t n;
+
+  /* [10.20.1] Registering 10 objects, then finding a random object and
+     registering a new object, both references are released. The operation is
+     repeated continuously in a one-second time window.*/
+  test_set_step(1);
+  {
+    n = bmk_factory(10U);
+    test_print("--- Objects 10   : ");
+    if (n == 0U) {
+      test_println("not enough memory");
+    }
+    else {
+      test_printn(n);
+      test_println(" find+create/S");
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+      bmk_print_index();
+#endif
+    }
+  }
+
+  /* [10.20.2] The same sequence is repeated with 100 objects.*/
+  test_set_step(2);
+  {
+    n = bmk_factory(100U);
+    test_print("--- Objects 100  : ");
+    if (n == 0U) {
+      test_println("not enough memory");
+    }
+    else {
+      test_printn(n);
+      test_println(" find+create/S");
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+      bmk_print_index();
+#endif
+    }
+  }
+
+  /* [10.20.3] The same sequence is repeated with 1000 objects.*/
+  test_set_step(3);
+  {
+    n = bmk_factory(1000U);
+    test_print("--- Objects 1000 : ");
+    if (n == 0U) {
+      test_println("not enough memory");
+    }
+    else {
+      test_printn(n);
+      test_println(" find+create/S");
+#if CH_CFG_FACTORY_HASH_INDEX == TRUE
+      bmk_print_index();
+#endif
+    }
+  }
+}
+
+static const testcase_t rt_test_010_020 = {
+  "Objects factory lookups",
+  NULL,
+  NULL,
+  rt_test_010_020_execute
+};
+#endif /* (CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) */
+
+#if (CH_CFG_USE_PIPES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_010_021 [10.21] Pipes throughput
+ *
+ * <h2>Description</h2>
+ * A thread reads blocks of bytes from a pipe while the test thread
+ * writes blocks into the pipe into a continuous loop, first copying the
+ * blocks then accessing the pipe buffer in place.<br> The performance is
+ * calculated by measuring the number of bytes transferred after a second
+ * of continuous operations.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_PIPES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [10.21.1] The reader thread is started, blocks are written into the
+ *   pipe using chPipeWriteTimeout() and read using chPipeReadTimeout().
+ *   The operation is repeated continuously in a one-second time window.
+ * - [10.21.2] The same sequence is repeated acquiring and committing
+ *   spans of the pipe buffer, no data is copied.
+ * .
+ */
+
+static void rt_test_010_021_execute(void) {
+  uint32_t n;
+  systime_t start, end;
+
+  /* [10.21.1] The reader thread is started, blocks are written into the pipe
+     using chPipeWriteTimeout() and read using chPipeReadTimeout(). The
+     operation is repeated continuously in a one-second time window.*/
+  test_set_step(1);
+  {
+    chPipeObjectInit(&bmk_pipe, bmk_pipe_buffer, sizeof bmk_pipe_buffer);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1, bmk_pipe_reader, NULL);
+
+    n = 0U;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      n += (uint32_t)chPipeWriteTimeout(&bmk_pipe, bmk_pipe_block,
+                                         sizeof bmk_pipe_block, TIME_INFINITE);
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+    chPipeReset(&bmk_pipe);
+    test_wait_threads();
+
+    test_print("--- Copy     : ");
+    test_printn(n);
+    test_println(" bytes/S");
+  }
+
+  /* [10.21.2] The same sequence is repeated acquiring and committing spans
+     of the pipe buffer, no data is copied.*/
+  test_set_step(2);
+  {
+    chPipeObjectInit(&bmk_pipe, bmk_pipe_buffer, sizeof bmk_pipe_buffer);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1, bmk_pipe_span_reader, NULL);
+
+    n = 0U;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      pipe_span_t span;
+      size_t size;
+
+      size = chPipeWriteAcquireTimeout(&bmk_pipe, &span, TIME_INFINITE);
+      if (size > sizeof bmk_pipe_block) {
+        size = sizeof bmk_pipe_block;
+      }
+      chPipeWriteCommit(&bmk_pipe, &span, size);
+      n += (uint32_t)size;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+    chPipeReset(&bmk_pipe);
+    test_wait_threads();
+
+    test_print("--- Zero-copy: ");
+    test_printn(n);
+    test_println(" bytes/S");
+  }
+}
+
+static const testcase_t rt_test_010_021 = {
+  "Pipes throughput",
+  NULL,
+  NULL,
+  rt_test_010_021_execute
+};
+#endif /* CH_CFG_USE_PIPES == TRUE */
+
+/**
+ * @page rt_test_010_022 [10.22] Periodic Virtual Timers reload
+ *
+ * <h2>Description</h2>
+ * N periodic virtual timers with the same period and scattered phases
+ * are armed, each reload re-inserts the expired timer after all the
+ * other timers. N doubles from 1 up to 1024 or up to the number of
+ * timers fitting the test buffer.<br> The performance is calculated, for
+ * each N, by measuring the number of loops performed by the test thread
+ * and the number of timer reloads after 100 milliseconds of continuous
+ * operations, the loops drop as the reloads cost grows with N.
+ *
+ * <h2>Test Steps</h2>
+ * - [10.22.1] The maximum number of timers is calculated, the test
+ *   buffer is used as timers storage.
+ * - [10.22.2] For each N the timers are armed with a 10 milliseconds
+ *   period, the test thread counts loops in a 100 milliseconds time
+ *   window, then the timers are disarmed and the score is printed.
+ * .
+ */
+
+static void rt_test_010_022_execute(void) {
+  virtual_timer_t *vtp = (virtual_timer_t *)test_buffer;
+  unsigned i, n, max;
+
+  /* [10.22.1] The maximum number of timers is calculated, the test buffer is
+     used as timers storage.*/
+  test_set_step(1);
+  {
+    max = sizeof test_buffer / sizeof (virtual_timer_t);
+    if (max > 1024U) {
+      max = 1024U;
+    }
+  }
+
+  /* [10.22.2] For each N the timers are armed with a 10 milliseconds period,
+     the test thread counts loops in a 100 milliseconds time window, then the
+     timers are disarmed and the score is printed.*/
+  test_set_step(2);
+  {
+    for (n = 1U; n <= max; n *= 2U) {
+      systime_t start, end;
+      uint32_t iter = 0, reloads;
+
+      chSysLock();
+      for (i = 0U; i < n; i++) {
+        chVTDoSetPeriodicI(&vtp[i], (sysinterval_t)(1U + (i % 10U)),
+                           TIME_MS2I(10), bmk_reloadcb, NULL);
+      }
+      chSysUnlock();
+
+      start = test_wait_tick();
+      end = chTimeAddX(start, TIME_MS2I(100));
+      bmk_reloads = 0U;
+      do {
+        iter++;
+#if defined(SIMULATOR)
+        _sim_check_for_interrupts();
+#endif
+      } while (chVTIsSystemTimeWithinX(start, end));
+
+      chSysLock();
+      reloads = bmk_reloads;
+      for (i = 0U; i < n; i++) {
+        chVTResetI(&vtp[i]);
+      }
+      chSysUnlock();
+
+      test_print("--- Timers ");
+      test_printn(n);
+      test_print(" : ");
+      test_printn(iter * 10U);
+      test_print(" loops/S, ");
+      test_printn(reloads * 10U);
+      test_println(" reloads/S");
+    }
+  }
+}
+
+static const testcase_t rt_test_010_022 = {
+  "Periodic Virtual Timers reload",
+  NULL,
+  NULL,
+  rt_test_010_022_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const rt_test_sequence_010_array[] = {
+#if (CH_CFG_USE_MESSAGES) || defined(__DOXYGEN__)
+  &rt_test_010_001,
+#endif
+#if (CH_CFG_USE_MESSAGES) || defined(__DOXYGEN__)
+  &rt_test_010_002,
+#endif
+#if (CH_CFG_USE_MESSAGES) || defined(__DOXYGEN__)
+  &rt_test_010_003,
+#endif
+  &rt_test_010_004,
+  &rt_test_010_005,
+  &rt_test_010_006,
+#if (CH_CFG_USE_SEMAPHORES) || defined(__DOXYGEN__)
+  &rt_test_010_007,
+#endif
+  &rt_test_010_008,
+  &rt_test_010_009,
+#if (CH_CFG_USE_SEMAPHORES) || defined(__DOXYGEN__)
+  &rt_test_010_010,
+#endif
+#if (CH_CFG_USE_MUTEXES) || defined(__DOXYGEN__)
+  &rt_test_010_011,
+#endif
+  &rt_test_010_012,
+#if (CH_CFG_USE_CONDVARS) || defined(__DOXYGEN__)
+  &rt_test_010_013,
+#endif
+  &rt_test_010_014,
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+  &rt_test_010_015,
+#endif
+#if (CH_CFG_USE_HEAP) || defined(__DOXYGEN__)
+  &rt_test_010_016,
+#endif
+#if (CH_CFG_USE_POOL_MAGAZINES) || defined(__DOXYGEN__)
+  &rt_test_010_017,
+#endif
+#if ((CH_CFG_USE_SLAB == TRUE) && (CH_CFG_USE_HEAP == TRUE)) || defined(__DOXYGEN__)
+  &rt_test_010_018,
+#endif
+#if ((CH_CFG_USE_ARENAS == TRUE) && (CH_CFG_USE_HEAP == TRUE)) || defined(__DOXYGEN__)
+  &rt_test_010_019,
+#endif
+#if ((CH_CFG_USE_FACTORY == TRUE) && (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE)) || defined(__DOXYGEN__)
+  &rt_test_010_020,
+#endif
+#if (CH_CFG_USE_PIPES == TRUE) || defined(__DOXYGEN__)
+  &rt_test_010_021,
+#endif
+  &rt_test_010_022,
   NULL
 };
 
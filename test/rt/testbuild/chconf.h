@@ -155,6 +155,156 @@
 #define CH_CFG_OPTIMIZE_SPEED               TRUE
 #endif
 
+/**
+ * @brief   Bitmap-indexed ready list.
+ * @details If enabled then the ready list is augmented with a priority
+ *          bitmap and a per-priority tail pointer, threads insertion in
+ *          the ready list becomes a constant time operation regardless
+ *          of the number of ready threads.
+ *
+ * @note    This option increases the size of the system structure by
+ *          one pointer for each priority level.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_RLIST_BITMAP) || defined(__DOXYGEN__)
+#define CH_CFG_RLIST_BITMAP                 FALSE
+#endif
+
+/**
+ * @brief   Timing wheel virtual timers.
+ * @details If enabled then virtual timers are kept in a hierarchical timing
+ *          wheel instead of a sorted delta list, arming and disarming a
+ *          timer become constant time operations regardless of the number
+ *          of armed timers.
+ *
+ * @note    This option increases the size of the system structure by
+ *          two pointers for each wheel slot.
+ * @note    In tick-less mode the cascade of the upper wheel levels can
+ *          cause additional alarm events.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_VT_WHEEL) || defined(__DOXYGEN__)
+#define CH_CFG_VT_WHEEL                     FALSE
+#endif
+
+/**
+ * @brief   Number of levels in the virtual timers wheel.
+ * @details Each level has 32 slots, the wheel covers a range of
+ *          2^(5 * @p CH_CFG_VT_WHEEL_LEVELS) ticks, longer timers are
+ *          parked in the last level and re-evaluated there.
+ * @note    The default is 4.
+ */
+#if !defined(CH_CFG_VT_WHEEL_LEVELS) || defined(__DOXYGEN__)
+#define CH_CFG_VT_WHEEL_LEVELS              4
+#endif
+
+/**
+ * @brief   Virtual timers slack.
+ * @details If enabled then virtual timers can be armed with a tolerated
+ *          expiration delay using @p chVTDoSetWithSlackI(). In tick-less
+ *          mode the alarm is delayed as much as the armed timers allow so
+ *          that timers with overlapping windows are served by a single
+ *          alarm event.
+ *
+ * @note    This option increases the size of the @p virtual_timer_t
+ *          structure by one interval.
+ * @note    In tick mode the slack is ignored.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_VT_SLACK) || defined(__DOXYGEN__)
+#define CH_CFG_VT_SLACK                     FALSE
+#endif
+
+/**
+ * @brief   Virtual timers deferred callbacks.
+ * @details If enabled then virtual timers can be armed using
+ *          @p chVTDoSetDeferredI() so that their callbacks are executed by
+ *          a dedicated kernel thread instead of the timer interrupt, this
+ *          reduces the time spent in ISR context when many timers expire
+ *          together.
+ *
+ * @note    This option creates an additional kernel thread.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_VT_DEFERRED) || defined(__DOXYGEN__)
+#define CH_CFG_VT_DEFERRED                  FALSE
+#endif
+
+/**
+ * @brief   Priority of the virtual timers thread.
+ * @note    The default is @p HIGHPRIO.
+ */
+#if !defined(CH_CFG_VT_DEFERRED_PRIO) || defined(__DOXYGEN__)
+#define CH_CFG_VT_DEFERRED_PRIO             HIGHPRIO
+#endif
+
+/**
+ * @brief   Stack size of the virtual timers thread.
+ * @details The stack must be large enough for the deferred callbacks.
+ * @note    The default is 256.
+ */
+#if !defined(CH_CFG_VT_DEFERRED_STACK_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_VT_DEFERRED_STACK_SIZE       256
+#endif
+
+/**
+ * @brief   Earliest deadline first scheduling class.
+ * @details If enabled then threads created with a non-zero period in
+ *          their descriptor are EDF threads, they run at the
+ *          @p CH_CFG_EDF_PRIO priority level ordered by absolute deadline
+ *          and coexist with the fixed priority threads.
+ *
+ * @note    This option increases the size of the thread structure.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_EDF) || defined(__DOXYGEN__)
+#define CH_CFG_USE_EDF                      FALSE
+#endif
+
+/**
+ * @brief   Priority level reserved to EDF threads.
+ * @details Fixed priority threads cannot be created at this level nor moved
+ *          to it, they can reach it only when boosted by the priority
+ *          inheritance of a mutex, then they run ahead of the EDF threads
+ *          until the mutex is released.
+ * @note    The default is @p HIGHPRIO minus one.
+ */
+#if !defined(CH_CFG_EDF_PRIO) || defined(__DOXYGEN__)
+#define CH_CFG_EDF_PRIO                     (HIGHPRIO - 1)
+#endif
+
+/**
+ * @brief   Threads CPU budgets.
+ * @details If enabled then threads can be assigned a CPU budget, measured
+ *          in realtime counter cycles and replenished over a period, using
+ *          @p chBudgetSet(). A thread exhausting its budget is demoted to
+ *          the @p CH_CFG_BUDGET_PRIO priority until replenishment.
+ *
+ * @note    This option requires a port supporting the realtime counter.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_BUDGETS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_BUDGETS                  FALSE
+#endif
+
+/**
+ * @brief   Background priority of threads with an exhausted budget.
+ * @note    The default is @p LOWPRIO.
+ */
+#if !defined(CH_CFG_BUDGET_PRIO) || defined(__DOXYGEN__)
+#define CH_CFG_BUDGET_PRIO                  LOWPRIO
+#endif
+
+/**
+ * @brief   Budgets enforcement check interval in system ticks.
+ * @details The budget of a running thread is verified with this interval,
+ *          a thread can exceed its budget by up to one interval.
+ * @note    The default is 1.
+ */
+#if !defined(CH_CFG_BUDGET_CHECK_INTERVAL) || defined(__DOXYGEN__)
+#define CH_CFG_BUDGET_CHECK_INTERVAL        1
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -175,6 +325,30 @@
 #define CH_CFG_USE_TM                       TRUE
 #endif
 
+/**
+ * @brief   Time Measurement histograms.
+ * @details If enabled then time measurements can also be recorded into
+ *          logarithmic-bucket histograms, kernel statistics record the
+ *          critical zones duration into histograms.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_TM_HISTOGRAMS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_TM_HISTOGRAMS            FALSE
+#endif
+
+/**
+ * @brief   Number of buckets in time measurement histograms.
+ * @details Bucket zero counts null measurements, bucket @p i counts
+ *          measurements between 2^(i-1) and 2^i-1 cycles, the last
+ *          bucket also counts all larger measurements.
+ *
+ * @note    The default is 24.
+ */
+#if !defined(CH_CFG_TM_HISTOGRAM_BUCKETS) || defined(__DOXYGEN__)
+#define CH_CFG_TM_HISTOGRAM_BUCKETS         24
+#endif
+
 /**
  * @brief   Threads registry APIs.
  * @details If enabled then the registry APIs are included in the kernel.
@@ -323,6 +497,17 @@
 #define CH_CFG_USE_MAILBOXES                TRUE
 #endif
 
+/**
+ * @brief   Pipes APIs.
+ * @details If enabled then the byte pipes APIs are included in the
+ *          kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_PIPES) || defined(__DOXYGEN__)
+#define CH_CFG_USE_PIPES                    FALSE
+#endif
+
 /**
  * @brief   Core Memory Manager APIs.
  * @details If enabled then the core memory manager APIs are included
@@ -334,6 +519,19 @@
 #define CH_CFG_USE_MEMCORE                  TRUE
 #endif
 
+/**
+ * @brief   Core Memory Manager regions.
+ * @details If enabled then the core memory manager can also allocate from
+ *          additional memory regions, each one with its own attributes,
+ *          for example tightly coupled or non-cacheable RAM.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMCORE.
+ */
+#if !defined(CH_CFG_USE_MEMCORE_REGIONS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_MEMCORE_REGIONS          FALSE
+#endif
+
 /**
  * @brief   Heap Allocator APIs.
  * @details If enabled then the memory heap allocator APIs are included
@@ -348,6 +546,37 @@
 #define CH_CFG_USE_HEAP                     TRUE
 #endif
 
+/**
+ * @brief   TLSF heap allocator.
+ * @details If enabled then the heap allocator uses a Two-Level Segregated
+ *          Fit strategy instead of first-fit, allocation and release of
+ *          blocks become constant time operations regardless of the heap
+ *          fragmentation.
+ *
+ * @note    This option increases the size of the heap structure by the
+ *          free lists table.
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_HEAP.
+ */
+#if !defined(CH_CFG_HEAP_TLSF) || defined(__DOXYGEN__)
+#define CH_CFG_HEAP_TLSF                    FALSE
+#endif
+
+/**
+ * @brief   Heap allocations profiler.
+ * @details If enabled then the heap allocations and releases are recorded
+ *          by call site, size and lifetime, the heap fragmentation can be
+ *          sampled over time. The default heap is profiled from the
+ *          system start.
+ *
+ * @note    This option adds a tag to each allocated heap block.
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_HEAP.
+ */
+#if !defined(CH_CFG_HEAP_PROFILER) || defined(__DOXYGEN__)
+#define CH_CFG_HEAP_PROFILER                FALSE
+#endif
+
 /**
  * @brief   Memory Pools Allocator APIs.
  * @details If enabled then the memory pools allocator APIs are included
@@ -359,6 +588,45 @@
 #define CH_CFG_USE_MEMPOOLS                 TRUE
 #endif
 
+/**
+ * @brief   Memory Pools magazine caches.
+ * @details If enabled then per-thread magazines can be placed in front of
+ *          memory pools, objects are allocated and released without
+ *          locking and moved from/to the pool in batches.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#if !defined(CH_CFG_USE_POOL_MAGAZINES) || defined(__DOXYGEN__)
+#define CH_CFG_USE_POOL_MAGAZINES           FALSE
+#endif
+
+/**
+ * @brief   Slab allocator APIs.
+ * @details If enabled then the slab allocator APIs are included in the
+ *          kernel, small objects are allocated from memory pools of
+ *          configurable size classes instead of the heap.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#if !defined(CH_CFG_USE_SLAB) || defined(__DOXYGEN__)
+#define CH_CFG_USE_SLAB                     FALSE
+#endif
+
+/**
+ * @brief   Arena allocator APIs.
+ * @details If enabled then the arena allocator APIs are included in the
+ *          kernel, blocks are allocated by advancing a pointer and are
+ *          released all together.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMCORE.
+ */
+#if !defined(CH_CFG_USE_ARENAS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_ARENAS                   FALSE
+#endif
+
 /**
  * @brief  Objects FIFOs APIs.
  * @details If enabled then the objects FIFOs APIs are included
@@ -435,6 +703,28 @@
  */
 #define CH_CFG_FACTORY_OBJ_FIFOS            TRUE
 
+/**
+ * @brief   Enables the objects names hash index.
+ * @details If enabled then the objects are also indexed by name in an open
+ *          addressing hash table, lookups, creation and release of objects
+ *          become O(1) operations on average instead of scanning the lists.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_INDEX) || defined(__DOXYGEN__)
+#define CH_CFG_FACTORY_HASH_INDEX           FALSE
+#endif
+
+/**
+ * @brief   Number of slots in the objects names hash index.
+ * @details Up to 3/4 of the slots are used, objects exceeding this number
+ *          are not indexed and are found by scanning the lists.
+ * @note    It must be a power of two.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_FACTORY_HASH_SIZE            64
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -453,6 +743,17 @@
 #define CH_DBG_STATISTICS                   FALSE
 #endif
 
+/**
+ * @brief   Debug option, CPU load statistics window.
+ * @details Size in milliseconds of the sliding window used for threads,
+ *          ISRs and total CPU load computation.
+ *
+ * @note    The default is 1000.
+ */
+#if !defined(CH_DBG_STATISTICS_WINDOW) || defined(__DOXYGEN__)
+#define CH_DBG_STATISTICS_WINDOW            1000
+#endif
+
 /**
  * @brief   Debug option, system state check.
  * @details If enabled the correct call protocol for system APIs is checked
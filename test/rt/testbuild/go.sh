@@ -122,6 +122,33 @@ test cfg32 "-DCH_CFG_ST_RESOLUTION=16 -DCH_CFG_INTERVALS_SIZE=64"
 test cfg33 "-DCH_CFG_INTERVALS_SIZE=64"
 test cfg34 "-DCH_CFG_USE_OBJ_FIFOS=FALSE"
 test cfg35 "-DCH_CFG_USE_FACTORY=FALSE"
+test cfg36 "-DCH_CFG_RLIST_BITMAP=TRUE"
+test cfg37 "-DCH_CFG_VT_WHEEL=TRUE"
+test cfg38 "-DCH_CFG_VT_WHEEL=TRUE -DCH_CFG_VT_WHEEL_LEVELS=2 -DCH_CFG_ST_RESOLUTION=16 -DCH_CFG_INTERVALS_SIZE=16"
+test cfg39 "-DCH_CFG_VT_SLACK=TRUE"
+test cfg40 "-DCH_CFG_VT_SLACK=TRUE -DCH_CFG_VT_WHEEL=TRUE"
+test cfg41 "-DCH_CFG_VT_DEFERRED=TRUE"
+test cfg42 "-DCH_CFG_VT_DEFERRED=TRUE -DCH_CFG_VT_WHEEL=TRUE -DCH_DBG_STATISTICS=TRUE"
+test cfg43 "-DCH_CFG_USE_EDF=TRUE"
+test cfg44 "-DCH_CFG_USE_EDF=TRUE -DCH_CFG_RLIST_BITMAP=TRUE -DCH_CFG_TIME_QUANTUM=0"
+test cfg45 "-DCH_CFG_USE_BUDGETS=TRUE"
+test cfg46 "-DCH_CFG_USE_BUDGETS=TRUE -DCH_CFG_USE_MUTEXES=FALSE -DCH_CFG_USE_CONDVARS=FALSE"
+test cfg47 "-DCH_DBG_STATISTICS=TRUE -DCH_DBG_STATISTICS_WINDOW=100"
+test cfg48 "-DCH_CFG_USE_TM_HISTOGRAMS=TRUE -DCH_DBG_STATISTICS=TRUE"
+test cfg49 "-DCH_DBG_TRACE_MASK=CH_DBG_TRACE_MASK_ALL -DCH_CFG_USE_MUTEXES_RECURSIVE=TRUE"
+test cfg50 "-DCH_CFG_ST_TIMEDELTA=2 -DCH_CFG_ST_FREQUENCY=10000 -DCH_DBG_THREADS_PROFILING=FALSE"
+test cfg51 "-DPORT_SIM_VIRTUAL_TIME=TRUE"
+test cfg52 "-DCH_CFG_HEAP_TLSF=TRUE"
+test cfg53 "-DCH_CFG_USE_POOL_MAGAZINES=TRUE"
+test cfg54 "-DCH_CFG_USE_SLAB=TRUE"
+test cfg55 "-DCH_CFG_USE_MEMCORE_REGIONS=TRUE"
+test cfg56 "-DCH_CFG_USE_ARENAS=TRUE"
+test cfg57 "-DCH_CFG_HEAP_PROFILER=TRUE"
+test cfg58 "-DCH_CFG_FACTORY_HASH_INDEX=TRUE -DCH_CFG_FACTORY_HASH_SIZE=16"
+test cfg59 "-DCH_CFG_USE_PIPES=TRUE"
+test cfg60 "-DCH_CFG_ST_TIMEDELTA=2 -DCH_CFG_ST_FREQUENCY=10000 -DCH_DBG_THREADS_PROFILING=FALSE -DCH_CFG_VT_SLACK=TRUE -DCH_DBG_STATISTICS=TRUE"
+test cfg61 "-DCH_CFG_ST_TIMEDELTA=2 -DCH_CFG_ST_FREQUENCY=10000 -DCH_DBG_THREADS_PROFILING=FALSE -DCH_CFG_VT_WHEEL=TRUE"
+test cfg62 "-DCH_CFG_FACTORY_HASH_INDEX=TRUE -DCH_CFG_FACTORY_HASH_SIZE=2048"
 
 rm *log.txt 2> /dev/null
 echo
@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+#
+#    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+
+"""Converts a ChibiOS/RT binary trace stream into Chrome trace-event JSON.
+
+The stream is produced by the trace streamer in os/various/trace_stream, the
+output can be loaded in chrome://tracing or https://ui.perfetto.dev.
+
+Usage: chtrace2json.py <input.bin> [<output.json>]
+"""
+
+import json
+import sys
+
+MAGIC = b"CHTR"
+VERSION = 2
+
+TYPE_META = 0
+TYPE_SWITCH = 1
+TYPE_ISR_ENTER = 2
+TYPE_ISR_LEAVE = 3
+TYPE_HALT = 4
+TYPE_USER = 5
+TYPE_SEM = 6
+TYPE_MTX = 7
+TYPE_MBOX = 8
+TYPE_COND = 9
+TYPE_VT = 10
+
+OBJECT_NAMES = {TYPE_SEM: "sem", TYPE_MTX: "mtx", TYPE_MBOX: "mbox",
+                TYPE_COND: "cond", TYPE_VT: "vt"}
+EVENT_NAMES = ["wait", "signal", "broadcast", "reset", "lock", "unlock",
+               "boost", "post", "fetch", "arm", "fire"]
+
+# Object records whose argument is a thread.
+THREAD_ARG_TYPES = (TYPE_SEM, TYPE_MTX, TYPE_COND)
+
+META_LOST = 1
+META_THREAD = 2
+META_STRING = 3
+
+RT_BITS = 24
+
+STATE_NAMES = ["READY", "CURRENT", "WTSTART", "SUSPENDED", "QUEUED", "WTSEM",
+               "WTMTX", "WTCOND", "SLEEPING", "WTEXIT", "WTOREVT", "WTANDEVT",
+               "SNDMSGQ", "SNDMSG", "WTMSG", "FINAL"]
+
+PID = 1
+ISR_TID = 0
+
+
+class Reader:
+    """Sequential reader of the stream bytes."""
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def eof(self):
+        return self.pos >= len(self.data)
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise EOFError
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def bytes(self, n):
+        if self.pos + n > len(self.data):
+            raise EOFError
+        b = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return b
+
+    def varint(self):
+        n = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            n |= (b & 0x7F) << shift
+            shift += 7
+            if b < 0x80:
+                return n
+
+
+class Decoder:
+    """Stream decoder producing Chrome trace events."""
+
+    def __init__(self, data):
+        self.r = Reader(data)
+        self.events = []
+        self.threads = {}
+        self.strings = {}
+        self.tids = {}
+        self.current = None
+        self.isr_depth = 0
+        self.systime = 0
+        self.rttime = 0
+        self.lost = 0
+        self.first = True
+
+        if self.r.bytes(4) != MAGIC:
+            raise ValueError("not a trace stream")
+        version = self.r.byte()
+        if version != VERSION:
+            raise ValueError("unsupported stream version %d" % version)
+        self.st_bits = self.r.byte()
+        self.st_freq = self.r.varint()
+        self.rt_freq = self.r.varint()
+
+    def tid(self, tp):
+        """Maps a thread address to a small thread identifier."""
+        if tp not in self.tids:
+            self.tids[tp] = len(self.tids) + 1
+        return self.tids[tp]
+
+    def context_tid(self):
+        """Track of the context executing the current record."""
+        if self.isr_depth > 0 or self.current is None:
+            return ISR_TID
+        return self.tid(self.current)
+
+    def thread_name(self, tp):
+        return self.threads.get(tp, "0x%x" % tp)
+
+    def string(self, ptr):
+        return self.strings.get(ptr, "0x%x" % ptr)
+
+    def timestamp(self, dsys, drt):
+        """Advances the time, returns the current time in microseconds.
+
+        The realtime counter is only 24 bits wide in the trace buffer, its
+        wraps are resolved using the system time delta.
+        """
+        if self.first:
+            # The first record deltas are absolute values, the timeline
+            # starts from the first record.
+            self.first = False
+            return 0.0
+        self.systime += dsys
+        if self.rt_freq == 0:
+            return self.systime * 1000000.0 / self.st_freq
+        expected = dsys * self.rt_freq / self.st_freq
+        wraps = max(0, round((expected - drt) / (1 << RT_BITS)))
+        self.rttime += drt + (wraps << RT_BITS)
+        return self.rttime * 1000000.0 / self.rt_freq
+
+    def emit(self, **ev):
+        ev["pid"] = PID
+        self.events.append(ev)
+
+    def meta(self, subtype):
+        if subtype == META_LOST:
+            n = self.r.varint()
+            self.lost += n
+            self.emit(name="lost records", ph="i", s="g", ts=self.last_ts,
+                      tid=ISR_TID, args={"count": n})
+        elif subtype in (META_THREAD, META_STRING):
+            ptr = self.r.varint()
+            text = self.r.bytes(self.r.varint()).decode("utf-8", "replace")
+            if subtype == META_THREAD:
+                self.threads[ptr] = text
+            else:
+                self.strings[ptr] = text
+        else:
+            raise ValueError("unknown meta record %d" % subtype)
+
+    def run(self):
+        self.last_ts = 0.0
+        while not self.r.eof():
+            try:
+                tag = self.r.byte()
+                rtype = tag & 15
+                state = tag >> 4
+                if rtype == TYPE_META:
+                    self.meta(state)
+                    continue
+                ts = self.timestamp(self.r.varint(), self.r.varint())
+                self.last_ts = ts
+                if rtype == TYPE_SWITCH:
+                    ntp = self.r.varint()
+                    wtobjp = self.r.varint()
+                    if self.current is not None:
+                        self.emit(name="run", ph="E", ts=ts,
+                                  tid=self.tid(self.current),
+                                  args={"state": STATE_NAMES[state]
+                                        if state < len(STATE_NAMES)
+                                        else str(state),
+                                        "wtobjp": "0x%x" % wtobjp})
+                    self.emit(name="run", ph="B", ts=ts, tid=self.tid(ntp))
+                    self.current = ntp
+                elif rtype in (TYPE_ISR_ENTER, TYPE_ISR_LEAVE):
+                    name = self.string(self.r.varint())
+                    self.emit(name=name,
+                              ph="B" if rtype == TYPE_ISR_ENTER else "E",
+                              ts=ts, tid=ISR_TID)
+                    if rtype == TYPE_ISR_ENTER:
+                        self.isr_depth += 1
+                    elif self.isr_depth > 0:
+                        self.isr_depth -= 1
+                elif rtype == TYPE_HALT:
+                    reason = self.string(self.r.varint())
+                    self.emit(name="halt", ph="i", s="g", ts=ts,
+                              tid=ISR_TID, args={"reason": reason})
+                elif rtype == TYPE_USER:
+                    up1 = self.r.varint()
+                    up2 = self.r.varint()
+                    self.emit(name="user", ph="i", s="t", ts=ts,
+                              tid=self.context_tid(),
+                              args={"up1": "0x%x" % up1,
+                                    "up2": "0x%x" % up2})
+                elif rtype in OBJECT_NAMES:
+                    objp = self.r.varint()
+                    argp = self.r.varint()
+                    event = EVENT_NAMES[state] \
+                        if state < len(EVENT_NAMES) else str(state)
+                    args = {"object": "0x%x" % objp}
+                    if rtype in THREAD_ARG_TYPES:
+                        if argp != 0:
+                            args["thread"] = self.thread_name(argp)
+                    elif rtype == TYPE_MBOX:
+                        args["msg"] = "0x%x" % argp
+                    else:
+                        args["par"] = "0x%x" % argp
+                        if argp in self.threads:
+                            # Threads timeouts have the thread as parameter.
+                            args["thread"] = self.thread_name(argp)
+                    self.emit(name="%s %s" % (OBJECT_NAMES[rtype], event),
+                              ph="i", s="t", ts=ts, tid=self.context_tid(),
+                              args=args)
+                else:
+                    raise ValueError("unknown record type %d" % rtype)
+            except EOFError:
+                # Truncated capture, the partial record is discarded.
+                break
+        if self.current is not None:
+            self.emit(name="run", ph="E", ts=self.last_ts,
+                      tid=self.tid(self.current))
+
+        # Naming the tracks.
+        names = [dict(name="thread_name", ph="M", tid=ISR_TID,
+                      args={"name": "ISRs"})]
+        for tp, tid in self.tids.items():
+            name = self.thread_name(tp)
+            names.append(dict(name="thread_name", ph="M", tid=tid,
+                              args={"name": name}))
+        for ev in names:
+            ev["pid"] = PID
+        return names + self.events
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 1
+    with open(argv[1], "rb") as f:
+        data = f.read()
+    decoder = Decoder(data)
+    events = decoder.run()
+    out = {"traceEvents": events, "displayTimeUnit": "ns",
+           "otherData": {"lost": decoder.lost}}
+    if len(argv) == 3:
+        with open(argv[2], "w") as f:
+            json.dump(out, f, indent=1)
+    else:
+        json.dump(out, sys.stdout, indent=1)
+    if decoder.lost != 0:
+        sys.stderr.write("warning: %d records lost\n" % decoder.lost)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
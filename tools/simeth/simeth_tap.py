@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+#
+#    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+
+"""Bridges the Posix simulator Ethernet driver to a Linux TAP interface.
+
+The simulator listens on a Unix SOCK_SEQPACKET socket, one Ethernet frame
+per packet. This script connects to it and forwards the frames to and from
+a TAP interface so that the simulated TCP/IP stack is reachable from the
+host. Creating the TAP interface requires the CAP_NET_ADMIN capability.
+
+Usage: simeth_tap.py [-s <socket path>] [-i <tap name>] [-a <address/prefix>]
+"""
+
+import argparse
+import fcntl
+import os
+import select
+import socket
+import struct
+import subprocess
+import sys
+import time
+
+TUNSETIFF = 0x400454CA
+IFF_TAP = 0x0002
+IFF_NO_PI = 0x1000
+
+FRAME_MAX = 1522
+
+
+def open_tap(name):
+    fd = os.open("/dev/net/tun", os.O_RDWR)
+    fcntl.ioctl(fd, TUNSETIFF,
+                struct.pack("16sH", name.encode(), IFF_TAP | IFF_NO_PI))
+    return fd
+
+
+def connect(path, retries):
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET)
+    for _ in range(retries):
+        try:
+            sock.connect(path)
+            return sock
+        except (FileNotFoundError, ConnectionRefusedError):
+            time.sleep(0.1)
+    sys.exit("simeth_tap: cannot connect to %s" % path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-s", "--socket", default="/tmp/chibios-eth0",
+                        help="simulator socket path")
+    parser.add_argument("-i", "--iface", default="chtap0",
+                        help="TAP interface name")
+    parser.add_argument("-a", "--address", default="192.168.1.1/24",
+                        help="host address assigned to the interface")
+    parser.add_argument("-w", "--wait", type=float, default=10.0,
+                        help="seconds to wait for the simulator socket")
+    args = parser.parse_args()
+
+    tap = open_tap(args.iface)
+    subprocess.check_call(["ip", "addr", "replace", args.address,
+                           "dev", args.iface])
+    subprocess.check_call(["ip", "link", "set", args.iface, "up"])
+
+    sock = connect(args.socket, int(args.wait * 10) or 1)
+    print("simeth_tap: %s <-> %s (%s)" % (args.socket, args.iface,
+                                          args.address))
+
+    frames_in = frames_out = 0
+    try:
+        while True:
+            ready, _, _ = select.select([tap, sock], [], [])
+            if tap in ready:
+                sock.send(os.read(tap, FRAME_MAX))
+                frames_in += 1
+            if sock in ready:
+                frame = sock.recv(FRAME_MAX)
+                if not frame:
+                    break
+                os.write(tap, frame)
+                frames_out += 1
+    except KeyboardInterrupt:
+        pass
+    finally:
+        print("simeth_tap: %d frames to simulator, %d frames from simulator"
+              % (frames_in, frames_out))
+
+
+if __name__ == "__main__":
+    main()